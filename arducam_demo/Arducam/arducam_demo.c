@@ -5,6 +5,11 @@
 #include "hardware/spi.h"
 #include "pico/binary_info.h"
 #include "src/arducam.h"
+#include "src/jpeg_rate.h"
+
+// Frames a second to hold over the UART, and per capture
+#define TARGET_FPS 10
+#define BURST_FRAMES 4
 int main() {
     uint8_t id_H, id_L, spiTestVal;
     arducam.systemInit();
@@ -16,8 +21,26 @@ int main() {
     }
     arducam.cameraInit();
     arducam.setJpegSize(res_320x240);
+    struct jpeg_rate rate;
+    const struct jpeg_rate_config rateConfig = {
+        .target = jpeg_rate_target(BAUD_RATE, TARGET_FPS),
+        .min_size = res_160x120,
+        .max_size = res_800x600,
+        .hold = 1,
+    };
+    // 320x240 at the default QS, as the sensor was just set up
+    jpeg_rate_init(&rate, &rateConfig, res_320x240, 3);
     while (true) {
-         singleCapture();
+         unsigned int length;
+         // Several frames per capture and FIFO drain
+         int images = burstCapture(BURST_FRAMES, &length);
+         int changed = jpeg_rate_update(&rate, length / (images ? images : BURST_FRAMES));
+         if (changed & JPEG_RATE_SIZE) {
+             arducam.setJpegSize(rate.size);
+         }
+         if (changed & JPEG_RATE_QUALITY) {
+             arducam.setJpegQuality(jpeg_rate_qs(&rate));
+         }
     }
     return 0;
 }
@@ -5,11 +5,19 @@
 #include "hardware/i2c.h"
 #include "hardware/spi.h"
 #include "hardware/irq.h"
+#include "hardware/dma.h"
 #include "pico/binary_info.h"
 #include "arducam.h"
 #include "ov2640.h"
+#include "fifo_burst.h"
+#include "jpeg_split.h"
 uint8_t cameraCommand = 0;
 
+// The FIFO is drained through two buffers of this size
+#define FIFO_CHUNK 4096
+static uint8_t fifoChunks[2 * FIFO_CHUNK];
+static uint fifoTxChannel, fifoRxChannel, uartTxChannel;
+
 // RX interrupt handler
 void on_uart_rx() {
     while (uart_is_readable(UART_ID)) {
@@ -61,6 +69,16 @@ void picoSystemInit(){
 
     // Now enable the UART to send interrupts - RX only
     uart_set_irq_enables(UART_ID, true, false);
+
+    fifoTxChannel = dma_claim_unused_channel(true);
+    fifoRxChannel = dma_claim_unused_channel(true);
+    uartTxChannel = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(uartTxChannel);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, uart_get_dreq(UART_ID, true));
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    dma_channel_configure(uartTxChannel, &c, &uart_get_hw(UART_ID)->dr, NULL, 0, false);
 }
 
 //int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
@@ -227,6 +245,13 @@ void OV2640_set_JPEG_size(unsigned char size)
 	}
 }
 
+// Quantization scale, DSP register 0x44: larger is coarser and smaller
+void OV2640_set_JPEG_quality(unsigned char qs)
+{
+    wrSensorReg8_8(0xff, 0x00);
+    wrSensorReg8_8(0x44, qs);
+}
+
 void ov2640Init(){
     wrSensorReg8_8(0xff, 0x01);
     wrSensorReg8_8(0x12, 0x80);
@@ -237,23 +262,42 @@ void ov2640Init(){
     wrSensorReg8_8(0x15, 0x00);
     wrSensorRegs8_8(OV2640_320x240_JPEG);
 }
-void singleCapture(void){
-   int i , count;
-   uint8_t value[1024*40];
+// Sends the part of an image found in a chunk, one DMA transfer at a time
+static void sendImage(void *ctx, const uint8_t *data, size_t size, bool end)
+{
+    dma_channel_wait_for_finish_blocking(uartTxChannel);
+    dma_channel_transfer_from_buffer_now(uartTxChannel, data, size);
+}
+
+static void sendChunk(void *ctx, const uint8_t *data, size_t size)
+{
+    jpeg_split_feed((struct jpeg_split *)ctx, data, size, sendImage, NULL);
+    // The chunk is read into again next
+    dma_channel_wait_for_finish_blocking(uartTxChannel);
+}
+
+int burstCapture(uint8_t frames, unsigned int *fifoLength){
+   struct jpeg_split split;
+   if (frames < 1) frames = 1;
+   if (frames > BURST_FRAMES_MAX) frames = BURST_FRAMES_MAX;
+   write_reg(ARDUCHIP_FRAMES, frames - 1);
    //Flush the FIFO
    flush_fifo();
    //Start capture
    start_capture(); 
    while(!get_bit(ARDUCHIP_TRIG , CAP_DONE_MASK)){;}
    int length = read_fifo_length();
-   count = length;
-   i = 0 ;
+   if (fifoLength) *fifoLength = length;
+   jpeg_split_init(&split);
    cs_select();
    set_fifo_burst();//Set fifo burst mode
-   spi_read_blocking(SPI_PORT, BURST_FIFO_READ,value, length);
-   uart_write_blocking(UART_ID, value, length);
-	 count = 0;
-	 cs_deselect();
+   fifo_burst_read(SPI_PORT, fifoTxChannel, fifoRxChannel, fifoChunks, FIFO_CHUNK, length,
+                   sendChunk, &split);
+   cs_deselect();
+   return split.images;
+}
+void singleCapture(void){
+   burstCapture(1, NULL);
 }
 uint8_t spiBusDetect(void){
     write_reg(0x00, 0x55);
@@ -286,4 +330,5 @@ struct camera_operate arducam = {
     .cameraProbe = ov2640Probe,
     .cameraInit  = ov2640Init,
     .setJpegSize = OV2640_set_JPEG_size,
+    .setJpegQuality = OV2640_set_JPEG_quality,
 };
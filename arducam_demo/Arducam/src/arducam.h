@@ -43,6 +43,7 @@ struct camera_operate{
     uint8_t (*cameraProbe) (void);
     void  (*cameraInit) (void);
     void (*setJpegSize)(uint8_t size);
+    void (*setJpegQuality)(uint8_t qs);
 };
 #define res_160x120 		0	//160x120
 #define res_176x144 		1	//176x144
@@ -53,6 +54,8 @@ struct camera_operate{
 #define res_1024x768		6	//1024x768
 #define res_1280x1024	7	//1280x1024
 #define res_1600x1200	8	//1600x1200
+#define ARDUCHIP_FRAMES    		0x01  //Frames per capture, less one
+#define BURST_FRAMES_MAX   		7
 #define ARDUCHIP_FIFO      		0x04  //FIFO and I2C control
 #define FIFO_CLEAR_MASK    		0x01
 #define FIFO_START_MASK    		0x02
@@ -88,4 +91,8 @@ int wrSensorRegs8_8(const struct sensor_reg reglist[]);
 void write_reg(uint8_t address, uint8_t value);
 uint8_t read_reg(uint8_t address);
 void singleCapture(void);
+// Captures frames (1 to BURST_FRAMES_MAX) back to back into the FIFO and
+// sends them over the UART; returns the number of whole JPEGs sent and
+// stores the bytes the FIFO held in fifoLength unless it is NULL
+int burstCapture(uint8_t frames, unsigned int *fifoLength);
 #endif
\ No newline at end of file
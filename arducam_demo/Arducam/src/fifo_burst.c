@@ -0,0 +1,60 @@
+#include "fifo_burst.h"
+#include "hardware/dma.h"
+
+// BURST_FIFO_READ, clocked out while reading as spi_read_blocking() did
+static const uint8_t fifo_burst_filler = 0x3C;
+
+static void fifo_burst_start(spi_inst_t *spi, uint tx_channel, uint rx_channel, uint8_t *dst,
+                             size_t count) {
+    dma_channel_config c = dma_channel_get_default_config(tx_channel);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi_get_dreq(spi, true));
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    dma_channel_configure(
+        tx_channel, &c,
+        &spi_get_hw(spi)->dr,
+        &fifo_burst_filler,
+        count,
+        false
+    );
+
+    c = dma_channel_get_default_config(rx_channel);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, spi_get_dreq(spi, false));
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    dma_channel_configure(
+        rx_channel, &c,
+        dst,
+        &spi_get_hw(spi)->dr,
+        count,
+        false
+    );
+
+    dma_start_channel_mask((1u << tx_channel) | (1u << rx_channel));
+}
+
+void fifo_burst_read(spi_inst_t *spi, uint tx_channel, uint rx_channel, uint8_t *buf,
+                     size_t chunk, size_t length, fifo_burst_consume consume, void *ctx) {
+    uint8_t *chunks[2] = {buf, buf + chunk};
+    size_t size = length < chunk ? length : chunk;
+    size_t offset = 0;
+    int next = 0;
+    if (length == 0) {
+        return;
+    }
+    fifo_burst_start(spi, tx_channel, rx_channel, chunks[next], size);
+    while (offset < length) {
+        dma_channel_wait_for_finish_blocking(rx_channel);
+        const uint8_t *data = chunks[next];
+        const size_t read = size;
+        offset += read;
+        next ^= 1;
+        if (offset < length) {
+            size = length - offset < chunk ? length - offset : chunk;
+            fifo_burst_start(spi, tx_channel, rx_channel, chunks[next], size);
+        }
+        consume(ctx, data, read);
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef __FIFO_BURST_H
+#define __FIFO_BURST_H
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/spi.h"
+
+// Drains the ArduChip burst FIFO through two chunk sized buffers instead
+// of one frame sized one. A pair of DMA channels reads the next chunk off
+// the SPI while the previous one is handed on, so SRAM use stays the same
+// whatever the size of the frames in the FIFO.
+
+typedef void (*fifo_burst_consume)(void *ctx, const uint8_t *data, size_t size);
+
+// Reads length bytes into the two halves of buf, chunk bytes each, and
+// calls consume with every chunk while the next is being read. consume
+// must be done with the data when it returns. The caller has selected the
+// chip and sent BURST_FIFO_READ.
+void fifo_burst_read(spi_inst_t *spi, uint tx_channel, uint rx_channel, uint8_t *buf,
+                     size_t chunk, size_t length, fifo_burst_consume consume, void *ctx);
+#endif
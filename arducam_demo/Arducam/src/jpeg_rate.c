@@ -0,0 +1,128 @@
+#include "jpeg_rate.h"
+
+static const uint8_t jpeg_rate_qs_steps[JPEG_RATE_QUALITIES] = {
+    0x04, 0x06, 0x08, 0x0c, 0x10, 0x18, 0x20, 0x30,
+};
+
+// Pixels sent for res_160x120 to res_1600x1200; the 1280x1024 table
+// sends 1280x960
+static const uint32_t jpeg_rate_sizes[] = {
+    160 * 120, 176 * 144, 320 * 240, 352 * 288, 640 * 480,
+    800 * 600, 1024 * 768, 1280 * 960, 1600 * 1200,
+};
+#define JPEG_RATE_SIZES (sizeof(jpeg_rate_sizes) / sizeof(jpeg_rate_sizes[0]))
+// Frames averaged before frames that are too large, or too small, are
+// acted on
+#define JPEG_RATE_SHRINK_SAMPLES 3
+#define JPEG_RATE_GROW_SAMPLES 6
+// Frames averaged before a step up once the last one had to be undone
+#define JPEG_RATE_RETRY_SAMPLES 300
+
+uint32_t jpeg_rate_target(uint32_t baud, uint32_t fps) {
+    return fps ? baud / 10 / fps : baud / 10;
+}
+
+uint32_t jpeg_rate_pixels(uint8_t size) {
+    return size < JPEG_RATE_SIZES ? jpeg_rate_sizes[size] : 0;
+}
+
+uint8_t jpeg_rate_qs(const struct jpeg_rate *rate) {
+    return jpeg_rate_qs_steps[rate->quality];
+}
+
+void jpeg_rate_init(struct jpeg_rate *rate, const struct jpeg_rate_config *config,
+                    uint8_t size, uint8_t quality) {
+    rate->config = *config;
+    if (rate->config.max_size >= JPEG_RATE_SIZES) {
+        rate->config.max_size = JPEG_RATE_SIZES - 1;
+    }
+    if (rate->config.min_size > rate->config.max_size) {
+        rate->config.min_size = rate->config.max_size;
+    }
+    size = size < rate->config.min_size ? rate->config.min_size : size;
+    size = size > rate->config.max_size ? rate->config.max_size : size;
+    rate->size = size;
+    rate->quality = quality < JPEG_RATE_QUALITIES ? quality : JPEG_RATE_QUALITIES - 1;
+    rate->average = 0;
+    rate->samples = 0;
+    rate->holding = 0;
+    rate->grew = false;
+    rate->grow_samples = JPEG_RATE_GROW_SAMPLES;
+    rate->quality_changes = 0;
+    rate->size_changes = 0;
+}
+
+// Bytes of the average frame at another size and quality step, taking
+// them to go with the pixels and inversely with QS
+static uint64_t jpeg_rate_predict(const struct jpeg_rate *rate, uint8_t size, uint8_t quality) {
+    const uint64_t bytes = (uint64_t)rate->average / 4 * jpeg_rate_sizes[size] *
+                           jpeg_rate_qs_steps[rate->quality];
+    return bytes / ((uint64_t)jpeg_rate_sizes[rate->size] * jpeg_rate_qs_steps[quality]);
+}
+
+// The finest quality step from first to last whose frames are predicted
+// to fit in room, or -1
+static int jpeg_rate_fit(const struct jpeg_rate *rate, int first, int last, uint64_t room) {
+    for (int quality = first; quality <= last; quality++) {
+        if (jpeg_rate_predict(rate, rate->size, quality) <= room) {
+            return quality;
+        }
+    }
+    return -1;
+}
+
+int jpeg_rate_update(struct jpeg_rate *rate, uint32_t bytes) {
+    const uint32_t target = rate->config.target;
+    // Steps are sized to leave an eighth of the budget spare
+    const uint64_t room = target - target / 8;
+    if (rate->holding) {
+        // The frames just after a change may still be from the old settings
+        rate->holding--;
+        return 0;
+    }
+    rate->average = rate->samples ? rate->average - rate->average / 4 + bytes : 4 * bytes;
+    rate->samples += rate->samples < UINT16_MAX;
+    const uint32_t average = rate->average / 4;
+    int changed = 0;
+    if (average > target && rate->samples >= JPEG_RATE_SHRINK_SAMPLES) {
+        // As little coarser as gets under the budget, the size only once
+        // QS is as coarse as it goes
+        const int quality = rate->quality < JPEG_RATE_QUALITIES - 1 ?
+            jpeg_rate_fit(rate, rate->quality + 1, JPEG_RATE_QUALITIES - 1, room) : -1;
+        if (quality >= 0) {
+            rate->quality = quality;
+            changed = JPEG_RATE_QUALITY;
+        } else if (rate->size > rate->config.min_size) {
+            rate->size--;
+            changed = JPEG_RATE_SIZE;
+        } else if (rate->quality < JPEG_RATE_QUALITIES - 1) {
+            rate->quality = JPEG_RATE_QUALITIES - 1;
+            changed = JPEG_RATE_QUALITY;
+        }
+    } else if (average < target - target / 4 &&
+               rate->samples >= rate->grow_samples) {
+        const int quality = rate->quality ? jpeg_rate_fit(rate, 0, rate->quality - 1, room) : -1;
+        if (rate->size < rate->config.max_size &&
+            jpeg_rate_predict(rate, rate->size + 1, rate->quality) <= room) {
+            rate->size++;
+            changed = JPEG_RATE_SIZE;
+        } else if (quality >= 0) {
+            rate->quality = quality;
+            changed = JPEG_RATE_QUALITY;
+        }
+    }
+    if (changed) {
+        const bool grew = average < target;
+        if (!grew) {
+            // Either the last step up did not fit after all, and is not
+            // tried again for a while, or the scene itself got busier
+            rate->grow_samples = rate->grew ? JPEG_RATE_RETRY_SAMPLES : JPEG_RATE_GROW_SAMPLES;
+        }
+        rate->grew = grew;
+        rate->quality_changes += changed == JPEG_RATE_QUALITY;
+        rate->size_changes += changed == JPEG_RATE_SIZE;
+        rate->holding = rate->config.hold;
+        rate->samples = 0;
+    }
+    return changed;
+}
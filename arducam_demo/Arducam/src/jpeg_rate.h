@@ -0,0 +1,68 @@
+#ifndef __JPEG_RATE_H
+#define __JPEG_RATE_H
+#include <stdbool.h>
+#include <stdint.h>
+
+// Closed-loop control of the JPEG size. The UART takes about ten bit times
+// per byte, so a frame rate over it is a byte budget per frame. After each
+// capture the controller is given the bytes a frame took and moves the
+// OV2640 quantization scale (QS, DSP register 0x44) and the res_ size to
+// keep frames within the budget.
+//
+// Register writes are kept rare: the bytes are averaged over a few frames,
+// nothing changes for hold frames after a change, and a step is only taken
+// if the frame it predicts leaves part of the budget spare, so a step up
+// is seldom undone by the next step down. When one is, the next step up
+// waits for some hundreds of frames. QS costs one
+// register write and is tried first when frames are too large; the size
+// table costs some forty and is tried first when there is room to spare,
+// since the resolution matters more than the quantization.
+
+// What jpeg_rate_update() changed
+#define JPEG_RATE_QUALITY 0x01
+#define JPEG_RATE_SIZE    0x02
+
+// Quantization steps, finest first; QS 0x0c is the sensor default
+#define JPEG_RATE_QUALITIES 8
+
+struct jpeg_rate_config {
+    // Bytes a frame may take
+    uint32_t target;
+    // res_ sizes the controller may use
+    uint8_t min_size;
+    uint8_t max_size;
+    // Frames to leave alone after a change
+    uint8_t hold;
+};
+
+struct jpeg_rate {
+    struct jpeg_rate_config config;
+    // res_ size and quality step in use
+    uint8_t size;
+    uint8_t quality;
+    // Average bytes per frame, times 4, over samples frames
+    uint32_t average;
+    uint16_t samples;
+    // The last change was a step up
+    bool grew;
+    // Frames to average before a step up
+    uint16_t grow_samples;
+    // Frames left before the average can cause a change
+    uint8_t holding;
+    // Registers written: QS changes and size table changes
+    uint32_t quality_changes;
+    uint32_t size_changes;
+};
+
+// Budget for fps frames a second over a UART at baud, 8N1
+uint32_t jpeg_rate_target(uint32_t baud, uint32_t fps);
+void jpeg_rate_init(struct jpeg_rate *rate, const struct jpeg_rate_config *config,
+                    uint8_t size, uint8_t quality);
+// Takes the bytes of the last frame; returns which of JPEG_RATE_QUALITY
+// and JPEG_RATE_SIZE now differ from what the sensor is set to
+int jpeg_rate_update(struct jpeg_rate *rate, uint32_t bytes);
+// QS register value for the quality step in use
+uint8_t jpeg_rate_qs(const struct jpeg_rate *rate);
+// Pixels in a frame of res_ size
+uint32_t jpeg_rate_pixels(uint8_t size);
+#endif
@@ -0,0 +1,46 @@
+#include "jpeg_split.h"
+
+// The 0xFF of an SOI that straddles two chunks
+static const uint8_t jpeg_split_ff = 0xFF;
+
+void jpeg_split_init(struct jpeg_split *split) {
+    split->in_image = false;
+    split->marker = false;
+    split->images = 0;
+    split->size = 0;
+}
+
+void jpeg_split_feed(struct jpeg_split *split, const uint8_t *data, size_t size,
+                     jpeg_split_emit emit, void *ctx) {
+    size_t start = 0;
+    for (size_t i = 0; i < size; i++) {
+        const uint8_t byte = data[i];
+        const bool marker = split->marker;
+        split->marker = byte == 0xFF;
+        if (!marker) {
+            continue;
+        }
+        if (!split->in_image && byte == 0xD8) {
+            split->in_image = true;
+            split->size = 0;
+            if (i == 0) {
+                emit(ctx, &jpeg_split_ff, 1, false);
+                split->size = 1;
+                start = 0;
+            } else {
+                start = i - 1;
+            }
+        } else if (split->in_image && byte == 0xD9) {
+            emit(ctx, data + start, i + 1 - start, true);
+            split->in_image = false;
+            split->size = 0;
+            split->images++;
+            // A 0xFF ending this one does not start the next
+            split->marker = false;
+        }
+    }
+    if (split->in_image && start < size) {
+        emit(ctx, data + start, size - start, false);
+        split->size += size - start;
+    }
+}
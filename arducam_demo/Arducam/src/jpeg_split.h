@@ -0,0 +1,31 @@
+#ifndef __JPEG_SPLIT_H
+#define __JPEG_SPLIT_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Finds the JPEG images in the bytes read out of the ArduChip FIFO, which
+// holds the frames of a burst back to back with filler between them. It
+// has no hardware dependencies and keeps no more than a byte of state, so
+// the FIFO can be fed in chunks of any size. Every image is passed on from
+// its SOI (FF D8) to its EOI (FF D9); inside an image a 0xFF is followed by
+// 0x00 or a marker, so no EOI is found early.
+
+typedef void (*jpeg_split_emit)(void *ctx, const uint8_t *data, size_t size, bool end);
+
+struct jpeg_split {
+    bool in_image;
+    // The last byte fed was 0xFF
+    bool marker;
+    // Images passed on whole
+    uint32_t images;
+    // Bytes of the image being passed on
+    size_t size;
+};
+
+void jpeg_split_init(struct jpeg_split *split);
+// Calls emit with the parts of data that belong to an image, end set on
+// the one that finishes it
+void jpeg_split_feed(struct jpeg_split *split, const uint8_t *data, size_t size,
+                     jpeg_split_emit emit, void *ctx);
+#endif
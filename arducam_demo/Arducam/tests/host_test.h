@@ -0,0 +1,54 @@
+#ifndef _HOST_TEST__H
+#define _HOST_TEST__H
+// Minimal test harness for the hardware-independent parts of the driver,
+// built and run on the development machine. Output follows the tflmicro
+// tests: "n/m tests passed" and "~~~ALL TESTS PASSED~~~" on success.
+#include <stdio.h>
+
+static int tests_passed;
+static int tests_failed;
+static int did_test_fail;
+
+#define HOST_TEST(name) \
+	static void name(void)
+
+#define HOST_TEST_RUN(name)                     \
+	do {                                        \
+		printf("Testing " #name "\n");          \
+		did_test_fail = 0;                      \
+		name();                                 \
+		if (did_test_fail) tests_failed++;      \
+		else tests_passed++;                    \
+	} while (0)
+
+#define HOST_TEST_EXPECT(x)                                            \
+	do {                                                               \
+		if (!(x)) {                                                    \
+			printf("%s failed at %s:%d\n", #x, __FILE__, __LINE__);    \
+			did_test_fail = 1;                                         \
+		}                                                              \
+	} while (0)
+
+#define HOST_TEST_EXPECT_EQ(x, y)                                      \
+	do {                                                               \
+		long vx = (long)(x);                                           \
+		long vy = (long)(y);                                           \
+		if (vx != vy) {                                                \
+			printf("%s == %s failed at %s:%d (%ld vs %ld)\n",          \
+			       #x, #y, __FILE__, __LINE__, vx, vy);                \
+			did_test_fail = 1;                                         \
+		}                                                              \
+	} while (0)
+
+#define HOST_TEST_END()                                                \
+	do {                                                               \
+		printf("%d/%d tests passed\n", tests_passed,                   \
+		       tests_passed + tests_failed);                           \
+		if (tests_failed == 0) {                                       \
+			printf("~~~ALL TESTS PASSED~~~\n");                        \
+			return 0;                                                  \
+		}                                                              \
+		printf("~~~SOME TESTS FAILED~~~\n");                           \
+		return 1;                                                      \
+	} while (0)
+#endif
@@ -0,0 +1,163 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "jpeg_rate.h"
+#include "host_test.h"
+
+// Runs the controller against a model of the OV2640 JPEG encoder fed
+// synthetic scenes. The model does not match the one the controller
+// predicts with: bytes grow with pixels to the power 0.9 and fall with QS
+// to the power 0.8, over a header of 600 bytes, and every frame varies
+// with sensor noise. A change takes effect two frames late, as it does
+// with the FIFO holding frames shot before the registers were written.
+
+// 921600 baud at 10 frames a second
+#define TARGET 9216
+#define FRAMES 1500
+
+static uint32_t seed;
+static uint8_t sensor_size, sensor_qs;
+static uint8_t pending_size[2], pending_qs[2];
+
+static double next_uniform(void) {
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 8 & 0xffff) / 65536.0;
+}
+
+// Bytes of a frame of a scene of the given detail, noise its spread
+static uint32_t shoot(double detail, double noise) {
+	const double bytes = detail * pow(jpeg_rate_pixels(sensor_size), 0.9) *
+	                     pow(12.0 / sensor_qs, 0.8);
+	return 600 + (uint32_t)(bytes * (1 + noise * (2 * next_uniform() - 1)));
+}
+
+static void start(struct jpeg_rate *rate, uint8_t min_size, uint8_t max_size) {
+	const struct jpeg_rate_config config = {
+		.target = TARGET, .min_size = min_size, .max_size = max_size, .hold = 3,
+	};
+	// Where arducam_demo starts: 320x240 at the default QS
+	jpeg_rate_init(rate, &config, 2, 3);
+	sensor_size = pending_size[0] = pending_size[1] = rate->size;
+	sensor_qs = pending_qs[0] = pending_qs[1] = jpeg_rate_qs(rate);
+}
+
+// One frame: returns its bytes, after the controller has seen them
+static uint32_t step(struct jpeg_rate *rate, double detail, double noise) {
+	const uint32_t bytes = shoot(detail, noise);
+	jpeg_rate_update(rate, bytes);
+	sensor_size = pending_size[0];
+	sensor_qs = pending_qs[0];
+	pending_size[0] = pending_size[1];
+	pending_qs[0] = pending_qs[1];
+	pending_size[1] = rate->size;
+	pending_qs[1] = jpeg_rate_qs(rate);
+	return bytes;
+}
+
+static uint32_t changes(const struct jpeg_rate *rate) {
+	return rate->quality_changes + rate->size_changes;
+}
+
+HOST_TEST(Target) {
+	HOST_TEST_EXPECT_EQ(9216, jpeg_rate_target(921600, 10));
+	HOST_TEST_EXPECT_EQ(92160, jpeg_rate_target(921600, 0));
+}
+
+HOST_TEST(SettlesOnStaticScene) {
+	struct jpeg_rate rate;
+	seed = 1;
+	// Detail giving 320x240 frames of twice the budget
+	const double detail = 0.7;
+	start(&rate, 0, 8);
+	for (int i = 0; i < 100; i++) {
+		step(&rate, detail, 0.05);
+	}
+	const uint32_t settled = changes(&rate);
+	printf("settled at size %u QS 0x%02x after %u changes\n", rate.size, jpeg_rate_qs(&rate),
+	       (unsigned)settled);
+	HOST_TEST_EXPECT(settled <= 6);
+	uint64_t total = 0;
+	uint32_t over = 0;
+	for (int i = 0; i < FRAMES; i++) {
+		const uint32_t bytes = step(&rate, detail, 0.05);
+		total += bytes;
+		over += bytes > TARGET;
+	}
+	// Nothing written once settled, and the budget is used but kept
+	HOST_TEST_EXPECT_EQ(settled, changes(&rate));
+	HOST_TEST_EXPECT(total / FRAMES <= TARGET);
+	HOST_TEST_EXPECT(total / FRAMES >= TARGET / 2);
+	HOST_TEST_EXPECT(over < FRAMES / 50);
+}
+
+HOST_TEST(NoisySceneDoesNotThrash) {
+	struct jpeg_rate rate;
+	seed = 2;
+	start(&rate, 0, 8);
+	for (int i = 0; i < 100; i++) {
+		step(&rate, 0.1, 0.3);
+	}
+	const uint32_t settled = changes(&rate);
+	for (int i = 0; i < FRAMES; i++) {
+		step(&rate, 0.1, 0.3);
+	}
+	printf("%u changes in %d noisy frames\n", (unsigned)(changes(&rate) - settled), FRAMES);
+	HOST_TEST_EXPECT(changes(&rate) - settled <= FRAMES / 200);
+	// The size table, which is forty register writes, least of all
+	HOST_TEST_EXPECT(rate.size_changes <= 4);
+}
+
+HOST_TEST(FollowsSceneChanges) {
+	struct jpeg_rate rate;
+	seed = 3;
+	start(&rate, 0, 8);
+	const double details[] = {0.1, 0.4, 0.04, 0.1};
+	for (size_t scene = 0; scene < sizeof(details) / sizeof(details[0]); scene++) {
+		const uint32_t before = changes(&rate);
+		uint64_t total = 0;
+		for (int i = 0; i < 400; i++) {
+			const uint32_t bytes = step(&rate, details[scene], 0.1);
+			// Back within the budget soon after the scene changes
+			if (i >= 40) {
+				total += bytes;
+			}
+		}
+		printf("detail %.2f: size %u QS 0x%02x, %u changes\n", details[scene], rate.size,
+		       jpeg_rate_qs(&rate), (unsigned)(changes(&rate) - before));
+		HOST_TEST_EXPECT(total / 360 <= TARGET);
+		HOST_TEST_EXPECT(total / 360 >= TARGET / 3);
+		HOST_TEST_EXPECT(changes(&rate) - before <= 8);
+	}
+}
+
+HOST_TEST(StopsAtLimits) {
+	struct jpeg_rate rate;
+	seed = 4;
+	// Too much detail to fit even at the smallest size and coarsest QS
+	start(&rate, 0, 4);
+	for (int i = 0; i < 200; i++) {
+		step(&rate, 20, 0.1);
+	}
+	HOST_TEST_EXPECT_EQ(0, rate.size);
+	HOST_TEST_EXPECT_EQ(0x30, jpeg_rate_qs(&rate));
+	const uint32_t settled = changes(&rate);
+	for (int i = 0; i < 200; i++) {
+		step(&rate, 20, 0.1);
+	}
+	HOST_TEST_EXPECT_EQ(settled, changes(&rate));
+	// A blank scene goes no larger than allowed, at the finest QS
+	for (int i = 0; i < 400; i++) {
+		step(&rate, 0.001, 0.1);
+	}
+	HOST_TEST_EXPECT_EQ(4, rate.size);
+	HOST_TEST_EXPECT_EQ(0x04, jpeg_rate_qs(&rate));
+}
+
+int main(void) {
+	HOST_TEST_RUN(Target);
+	HOST_TEST_RUN(SettlesOnStaticScene);
+	HOST_TEST_RUN(NoisySceneDoesNotThrash);
+	HOST_TEST_RUN(FollowsSceneChanges);
+	HOST_TEST_RUN(StopsAtLimits);
+	HOST_TEST_END();
+}
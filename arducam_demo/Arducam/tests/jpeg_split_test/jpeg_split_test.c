@@ -0,0 +1,170 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "jpeg_split.h"
+#include "host_test.h"
+
+// Feeds made up burst FIFOs through the splitter in chunks of every size
+// from one byte up, the way burstCapture() drains them, and checks that
+// each image comes out whole and nothing else does.
+
+#define MAX_IMAGES 7
+#define MAX_IMAGE 600
+
+static uint8_t images[MAX_IMAGES][MAX_IMAGE];
+static size_t image_sizes[MAX_IMAGES];
+static uint8_t fifo[MAX_IMAGES * (MAX_IMAGE + 64)];
+static size_t fifo_size;
+static uint8_t out[sizeof(fifo)];
+static size_t out_size;
+static size_t ends[MAX_IMAGES + 1];
+static int end_count;
+static uint32_t seed;
+
+static uint32_t next_random(void) {
+	seed = seed * 1103515245 + 12345;
+	return seed >> 16;
+}
+
+// An SOI, a header marker, entropy data with its 0xFF bytes stuffed, and
+// an EOI
+static void make_image(int n) {
+	uint8_t *p = images[n];
+	size_t size = 0;
+	const size_t data = 64 + next_random() % (MAX_IMAGE - 80);
+	p[size++] = 0xFF;
+	p[size++] = 0xD8;
+	p[size++] = 0xFF;
+	p[size++] = 0xDB;
+	while (size < data) {
+		const uint8_t byte = next_random() % 4 == 0 ? 0xFF : next_random();
+		p[size++] = byte;
+		if (byte == 0xFF) {
+			p[size++] = next_random() % 2 ? 0x00 : 0xD0 + next_random() % 8;
+		}
+	}
+	p[size++] = 0xFF;
+	p[size++] = 0xD9;
+	image_sizes[n] = size;
+}
+
+// Filler the ArduChip leaves around the images, with stray 0xFF bytes
+static void add_filler(size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		const uint8_t byte = next_random() % 3 == 0 ? 0xFF : next_random() % 0xD0;
+		fifo[fifo_size++] = byte;
+	}
+}
+
+static void make_fifo(int count) {
+	fifo_size = 0;
+	for (int n = 0; n < count; n++) {
+		make_image(n);
+		add_filler(next_random() % 9);
+		memcpy(fifo + fifo_size, images[n], image_sizes[n]);
+		fifo_size += image_sizes[n];
+	}
+	add_filler(8);
+}
+
+static void collect(void *ctx, const uint8_t *data, size_t size, bool end) {
+	(void)ctx;
+	HOST_TEST_EXPECT(size > 0);
+	memcpy(out + out_size, data, size);
+	out_size += size;
+	if (end) {
+		ends[end_count++] = out_size;
+	}
+}
+
+static int split_matches(int count, size_t chunk) {
+	struct jpeg_split split;
+	jpeg_split_init(&split);
+	out_size = 0;
+	end_count = 0;
+	for (size_t offset = 0; offset < fifo_size; offset += chunk) {
+		const size_t size = fifo_size - offset < chunk ? fifo_size - offset : chunk;
+		jpeg_split_feed(&split, fifo + offset, size, collect, NULL);
+	}
+	if ((int)split.images != count || end_count != count || split.in_image) {
+		return 0;
+	}
+	size_t start = 0;
+	for (int n = 0; n < count; n++) {
+		if (ends[n] - start != image_sizes[n] ||
+		    memcmp(out + start, images[n], image_sizes[n]) != 0) {
+			return 0;
+		}
+		start = ends[n];
+	}
+	return out_size == start;
+}
+
+HOST_TEST(SplitsBackToBackImages) {
+	seed = 1;
+	for (int count = 1; count <= MAX_IMAGES; count++) {
+		make_fifo(count);
+		for (size_t chunk = 1; chunk <= 70; chunk++) {
+			HOST_TEST_EXPECT(split_matches(count, chunk));
+		}
+		HOST_TEST_EXPECT(split_matches(count, fifo_size));
+	}
+}
+
+HOST_TEST(SoiAcrossChunks) {
+	// The 0xFF of every SOI ends a chunk
+	seed = 2;
+	make_fifo(3);
+	struct jpeg_split split;
+	jpeg_split_init(&split);
+	out_size = 0;
+	end_count = 0;
+	size_t offset = 0;
+	for (size_t i = 0; i + 1 < fifo_size; i++) {
+		if (fifo[i] == 0xFF && fifo[i + 1] == 0xD8) {
+			jpeg_split_feed(&split, fifo + offset, i + 1 - offset, collect, NULL);
+			offset = i + 1;
+		}
+	}
+	jpeg_split_feed(&split, fifo + offset, fifo_size - offset, collect, NULL);
+	HOST_TEST_EXPECT_EQ(3, split.images);
+	HOST_TEST_EXPECT_EQ(image_sizes[0] + image_sizes[1] + image_sizes[2], out_size);
+	HOST_TEST_EXPECT(memcmp(out, images[0], image_sizes[0]) == 0);
+}
+
+HOST_TEST(TruncatedLastImage) {
+	// A FIFO that filled up part way through an image
+	seed = 3;
+	make_fifo(2);
+	fifo_size -= 8 + image_sizes[1] / 2;
+	struct jpeg_split split;
+	jpeg_split_init(&split);
+	out_size = 0;
+	end_count = 0;
+	jpeg_split_feed(&split, fifo, fifo_size, collect, NULL);
+	HOST_TEST_EXPECT_EQ(1, split.images);
+	HOST_TEST_EXPECT(split.in_image);
+	HOST_TEST_EXPECT_EQ(image_sizes[1] - image_sizes[1] / 2, split.size);
+	HOST_TEST_EXPECT_EQ(image_sizes[0] + split.size, out_size);
+}
+
+HOST_TEST(NothingOutsideImages) {
+	seed = 4;
+	fifo_size = 0;
+	add_filler(500);
+	struct jpeg_split split;
+	jpeg_split_init(&split);
+	out_size = 0;
+	end_count = 0;
+	jpeg_split_feed(&split, fifo, fifo_size, collect, NULL);
+	HOST_TEST_EXPECT_EQ(0, split.images);
+	HOST_TEST_EXPECT_EQ(0, out_size);
+}
+
+int main(void) {
+	HOST_TEST_RUN(SplitsBackToBackImages);
+	HOST_TEST_RUN(SoiAcrossChunks);
+	HOST_TEST_RUN(TruncatedLastImage);
+	HOST_TEST_RUN(NothingOutsideImages);
+	HOST_TEST_END();
+}
@@ -1,18 +1,21 @@
 #include <stdio.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "arducam.h"
 #include "ov2640_init.h"
 #include "hm01b0_init.h"
 #include "hardware/dma.h"
-#include "hardware/i2c.h"
+#include "hardware/irq.h"
 #include "hardware/pwm.h"
+#include "hardware/sync.h"
 #include "image.pio.h"
+#include "sccb_pio.h"
 
 
 
 int PIN_LED = 25;
-int PIN_CAM_SIOC = 5; // I2C0 SCL
-int PIN_CAM_SIOD = 4; // I2C0 SDA
+int PIN_CAM_SIOC = 5; // SCCB SCL
+int PIN_CAM_SIOD = 4; // SCCB SDA
 int PIN_CAM_RESETB = 2;
 int PIN_CAM_XCLK = 3;
 int PIN_CAM_VSYNC = 16;     //GP15 hsync  GP14 pixel clock     
@@ -20,204 +23,35 @@ int PIN_CAM_Y2_PIO_BASE = 6;   // data GPIO6
 
 
 
-#if defined (SOFTWARE_I2C)
-#define SCCB_SIC_H()      gpio_put(PIN_CAM_SIOC,1)	 	//SCL H
-#define SCCB_SIC_L()      gpio_put(PIN_CAM_SIOC,0)		 	//SCL H
-#define SCCB_SID_H()      gpio_put(PIN_CAM_SIOD,1)   //SDA	H
-#define SCCB_SID_L()      gpio_put(PIN_CAM_SIOD,0)    //SDA	H 
-#define SCCB_DATA_IN      gpio_set_dir(PIN_CAM_SIOD, GPIO_IN);
-#define SCCB_DATA_OUT     gpio_set_dir(PIN_CAM_SIOD, GPIO_OUT);
-#define SCCB_SID_STATE	  gpio_get(PIN_CAM_SIOD)
-void sccb_bus_init(void);
-void sccb_bus_start(void);
-void sccb_bus_stop(void);
-void sccb_bus_send_noack(void);
-void sccb_bus_send_ack(void);
-unsigned char sccb_bus_write_byte(unsigned char data);
-unsigned char sccb_bus_read_byte(void);
-unsigned char I2C_TIM;
+// Commands waiting for the SCCB state machine; 64 register writes
+static uint32_t sccb_buf[256];
 
-void sccb_bus_start(void)
-{
-    SCCB_SID_H();             
-    sleep_us(I2C_TIM);
-    SCCB_SIC_H();	           
-    sleep_us(I2C_TIM);
-    SCCB_SID_L();
-    sleep_us(I2C_TIM);
-    SCCB_SIC_L();	           
-    sleep_us(I2C_TIM);
+static int arducam_reg_bytes(struct arducam_config *config) {
+	return config->sccb_mode == I2C_MODE_16_8 ? 2 : 1;
 }
 
-void sccb_bus_stop(void)
-{
-    SCCB_SID_L();
-    sleep_us(I2C_TIM);
-    SCCB_SIC_H();	
-    sleep_us(I2C_TIM);  
-    SCCB_SID_H();	
-    sleep_us(I2C_TIM);  
+// PCLKs the sensor takes to send one pixel
+static uint arducam_pixel_clocks(struct arducam_config *config) {
+	return config->bus_width == BUS_WIDTH_1 ? 8 : 8 / config->bus_width;
 }
 
-void sccb_bus_send_noack(void)
-{	
-	SCCB_SID_H();	
-	sleep_us(I2C_TIM);	
-	SCCB_SIC_H();	
-	sleep_us(I2C_TIM);	
-	SCCB_SIC_L();	
-	sleep_us(I2C_TIM);	
-	SCCB_SID_L();	
-	sleep_us(I2C_TIM);
-}
-
-void sccb_bus_send_ack(void)
-{	
-	SCCB_SID_L();	
-	sleep_us(I2C_TIM);	
-	SCCB_SIC_L();	
-	sleep_us(I2C_TIM);	
-	SCCB_SIC_H();	
-	sleep_us(I2C_TIM);	
-	SCCB_SIC_L();	
-	sleep_us(I2C_TIM);	
-	SCCB_SID_L();	
-	sleep_us(I2C_TIM);
-}
-
-unsigned char sccb_bus_write_byte(unsigned char data)
-{
-	unsigned char i;
-	unsigned char tem;
-	for(i = 0; i < 8; i++) 
-	{
-		if((data<<i) & 0x80)
-		{
-			SCCB_SID_H();
-		}
-		else 
-		{
-			SCCB_SID_L();
+// Loads program with the instructions at its `sample` and, if it has one,
+// `pixel_clocks` label rewritten for the configured bus. See image.pio.
+static uint arducam_add_program(struct arducam_config *config, const pio_program_t *program,
+                                uint sample, int pixel_clocks) {
+	uint16_t instructions[32];
+	memcpy(instructions, program->instructions, program->length * sizeof(uint16_t));
+	if (config->bus_width != BUS_WIDTH_1) {
+		instructions[sample] = pio_encode_in(pio_pins, config->bus_width);
+		if (pixel_clocks >= 0) {
+			instructions[pixel_clocks] = pio_encode_set(pio_x, arducam_pixel_clocks(config) - 1);
 		}
-		sleep_us(I2C_TIM);
-		SCCB_SIC_H();	
-		sleep_us(I2C_TIM);
-		SCCB_SIC_L();	
-	}
-	SCCB_DATA_IN;
-	sleep_us(I2C_TIM);
-	SCCB_SIC_H();	
-	sleep_us(I2C_TIM);
-	if(SCCB_SID_STATE)
-	{
-		tem = 0;              
 	}
-	else 
-	{
-		tem = 1;               
-	}
-
-	SCCB_SIC_L();	
-	sleep_us(I2C_TIM);	
-	SCCB_DATA_OUT;
-	return tem;  
-}
-
-unsigned char sccb_bus_read_byte(void)
-{	
-	unsigned char i;
-	unsigned char read = 0;
-	SCCB_DATA_IN;
-	for(i = 8; i > 0; i--)
-	{		     
-		sleep_us(I2C_TIM);
-		SCCB_SIC_H();
-		sleep_us(I2C_TIM);
-		read = read << 1;
-		if(SCCB_SID_STATE)
-		{
-			read += 1; 
-		}
-		SCCB_SIC_L();
-		sleep_us(I2C_TIM);
-	}	
-    SCCB_DATA_OUT;
-	return read;
+	pio_program_t patched = *program;
+	patched.instructions = instructions;
+	return pio_add_program(config->pio, &patched);
 }
 
-unsigned char wrSensorReg16_8( uint8_t slave_address, int regID, int regDat)
-{
-	sccb_bus_start();
-	if(0==sccb_bus_write_byte(slave_address<<1))
-	{
-		sccb_bus_stop();
-		return(0);
-	}
-	sleep_us(10);
-  if(0==sccb_bus_write_byte(regID>>8))
-	{
-		sccb_bus_stop();
-		return(0);
-	}
-	sleep_us(10);
-  if(0==sccb_bus_write_byte(regID))
-	{
-		sccb_bus_stop();
-		return(0);
-	}
-	sleep_us(10);
-  if(0==sccb_bus_write_byte(regDat))
-	{
-		sccb_bus_stop();
-		return(0);
-	}
-  sccb_bus_stop();
-	
-  return(1);
-}
-
-
-unsigned char rdSensorReg16_8(uint8_t slave_address, unsigned int regID, unsigned char* regDat)
-{
-	sccb_bus_start();                  
-	if(0==sccb_bus_write_byte(slave_address<<1))
-	{
-		sccb_bus_stop();
-		return(0);
-	}
-	sleep_us(20);
-	sleep_us(20);
-  if(0==sccb_bus_write_byte(regID>>8))
-	{
-		sccb_bus_stop();
-		return(0);
-	}
-	sleep_us(20);
-  if(0==sccb_bus_write_byte(regID))
-	{
-		sccb_bus_stop();
-		return(0);
-	}
-	sleep_us(20);
-	sccb_bus_stop();
-	
-	sleep_us(20);
-	
-	
-	sccb_bus_start();                 
-	if(0==sccb_bus_write_byte((slave_address<<1)|0x01))
-	{
-		sccb_bus_stop();
-		return(0);
-	}
-	sleep_us(20);
-  *regDat=sccb_bus_read_byte();
-  sccb_bus_send_noack();
-  sccb_bus_stop();
-  return(1);
-}
-#endif
-
 void arducam_init(struct arducam_config *config){
 	gpio_set_function(config->pin_xclk, GPIO_FUNC_PWM);
 	uint slice_num = pwm_gpio_to_slice_num(config->pin_xclk);
@@ -225,17 +59,11 @@ void arducam_init(struct arducam_config *config){
 	pwm_set_wrap(slice_num, 9);
 	pwm_set_gpio_level(config->pin_xclk, 3);
 	pwm_set_enabled(slice_num, true);
-#ifndef SOFTWARE_I2C
-	// SCCB I2C @ 100 kHz
-	gpio_set_function(config->pin_sioc, GPIO_FUNC_I2C);
-	gpio_set_function(config->pin_siod, GPIO_FUNC_I2C);
-	i2c_init(config->sccb, 100 * 1000);
-#else
-	gpio_init(config->pin_sioc);
-	gpio_init(config->pin_siod);
-	gpio_set_dir(config->pin_sioc, GPIO_OUT);
-	gpio_set_dir(config->pin_siod, GPIO_OUT);
-#endif
+	// SCCB @ 400 kHz on a PIO state machine
+	dma_channel_claim(config->sccb_dma_channel);
+	sccb_pio_init(config->sccb_pio, config->sccb_sm, config->pin_siod, config->pin_sioc,
+	              400 * 1000, config->sccb_dma_channel, sccb_buf,
+	              sizeof(sccb_buf) / sizeof(sccb_buf[0]));
 
 	// Initialise reset pin
 	gpio_init(config->pin_resetb);
@@ -248,9 +76,98 @@ void arducam_init(struct arducam_config *config){
 	sleep_ms(100);
 	// Initialise the camera itself over SCCB
 	arducam_regs_write(config, hm01b0_324x244);
+	if (config->bus_width == BUS_WIDTH_4) {
+		arducam_regs_write(config, hm01b0_bus_4bit);
+	} else if (config->bus_width == BUS_WIDTH_8) {
+		arducam_regs_write(config, hm01b0_bus_8bit);
+	}
 	// Enable image RX PIO
-	uint offset = pio_add_program(config->pio, &image_program);
+	uint offset = arducam_add_program(config, &image_program, image_offset_sample, -1);
 	image_program_init(config->pio, config->pio_sm, offset, config->pin_y2_pio_base);
+	config->roi_enabled = false;
+}
+
+void arducam_set_roi(struct arducam_config *config, const struct arducam_roi *roi) {
+	if (!config->roi_enabled) {
+		config->roi_offset = arducam_add_program(config, &image_roi_program,
+		                                         image_roi_offset_sample,
+		                                         image_roi_offset_pixel_clocks);
+		// Keep the second channel off the one the caller picked
+		if (!dma_channel_is_claimed(config->dma_channel)) {
+			dma_channel_claim(config->dma_channel);
+		}
+		config->roi_dma_channel = dma_claim_unused_channel(true);
+	}
+	pio_sm_set_enabled(config->pio, config->pio_sm, false);
+	image_roi_program_init(config->pio, config->pio_sm, config->roi_offset,
+	                       config->pin_y2_pio_base);
+	// See image.pio for the meaning of the words
+	const uint clocks = arducam_pixel_clocks(config);
+	config->roi_top = roi->y;
+	config->roi_row[0] = clocks * roi->x;
+	config->roi_row[1] = roi->width - 1;
+	config->roi_row[2] = clocks * (roi->factor - 1);
+	config->roi_row[3] = roi->factor - 1;
+	config->roi_height = roi->height;
+	config->roi_enabled = true;
+	config->image_buf_size = (size_t)roi->width * roi->height;
+
+	dma_channel_config c = dma_channel_get_default_config(config->roi_dma_channel);
+	channel_config_set_read_increment(&c, true);
+	channel_config_set_write_increment(&c, false);
+	// Wrap the read address every 16 bytes, over the four row words
+	channel_config_set_ring(&c, false, 4);
+	channel_config_set_dreq(&c, pio_get_dreq(config->pio, config->pio_sm, true));
+	channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+	dma_channel_configure(
+		config->roi_dma_channel, &c,
+		&config->pio->txf[config->pio_sm],
+		config->roi_row,
+		4 * roi->height,
+		false
+	);
+}
+
+void arducam_set_window(struct arducam_config *config, const struct hm01b0_window *window) {
+	struct hm01b0_window_plan plan;
+	if (hm01b0_window_plan(window, &plan) != 0) {
+		return;
+	}
+	// Held in standby so the readout mode and frame length change together
+	const uint8_t readout = plan.binning ? 0x03 : 0x01;
+	arducam_reg_write(config, 0x0100, 0x00);
+	arducam_reg_write(config, 0x0383, readout);
+	arducam_reg_write(config, 0x0387, readout);
+	arducam_reg_write(config, 0x0390, plan.binning ? 0x03 : 0x00);
+	arducam_reg_write(config, 0x0340, plan.frame_lines >> 8);
+	arducam_reg_write(config, 0x0341, plan.frame_lines & 0xFF);
+	arducam_reg_write(config, 0x0104, 0x01);
+	arducam_reg_write(config, 0x0100, 0x01);
+	const struct arducam_roi roi = {
+		.x = plan.x,
+		.y = plan.y,
+		.width = plan.width,
+		.height = plan.height,
+		.factor = plan.factor,
+	};
+	arducam_set_roi(config, &roi);
+	sccb_pio_wait();
+}
+
+// Puts the state machine back at the start of a frame with empty FIFOs.
+// In ROI mode the program is restarted from the top and its window words
+// are queued again.
+static void arducam_rewind(struct arducam_config *config) {
+	pio_sm_clear_fifos(config->pio, config->pio_sm);
+	pio_sm_restart(config->pio, config->pio_sm);
+	if (!config->roi_enabled) {
+		return;
+	}
+	dma_channel_abort(config->roi_dma_channel);
+	pio_sm_exec(config->pio, config->pio_sm, pio_encode_jmp(config->roi_offset));
+	pio_sm_put(config->pio, config->pio_sm, config->roi_top);
+	dma_channel_set_read_addr(config->roi_dma_channel, config->roi_row, false);
+	dma_channel_set_trans_count(config->roi_dma_channel, 4 * config->roi_height, true);
 }
 void arducam_capture_frame(struct arducam_config *config) {
 	dma_channel_config c = dma_channel_get_default_config(config->dma_channel);
@@ -270,55 +187,116 @@ void arducam_capture_frame(struct arducam_config *config) {
 	while (gpio_get(config->pin_vsync) == true);
 	while (gpio_get(config->pin_vsync) == false);
 	
+	arducam_rewind(config);
 	dma_channel_start(config->dma_channel);
 	pio_sm_set_enabled(config->pio, config->pio_sm, true);
 	dma_channel_wait_for_finish_blocking(config->dma_channel);
 	pio_sm_set_enabled(config->pio, config->pio_sm, false);
 }
 
-void arducam_reg_write(struct arducam_config *config, uint16_t reg, uint8_t value) {
-	uint8_t data[3];
-	uint8_t length =0;
-	switch (config->sccb_mode){
-		case I2C_MODE_16_8:
-			data[0] = (uint8_t)(reg>>8)&0xFF;
-			data[1] = (uint8_t)(reg)&0xFF;
-			data[2] = value;
-			length = 3;
-			break;
-		case I2C_MODE_8_8:
-			data[0] = (uint8_t)(reg)&0xFF;
-			data[1] = value;
-			length = 2; 
-			break;
+// The GPIO and DMA interrupt callbacks carry no context, so only one camera
+// can stream at a time.
+static struct arducam_config *stream_config = NULL;
+
+static void arducam_stream_dma_irq(void) {
+	struct arducam_config *config = stream_config;
+	if (config == NULL || !dma_channel_get_irq0_status(config->dma_channel)) {
+		return;
 	}
-	//printf("length: %x data[0]: = %x  data[1] = %x data[2] = %x\r\n", length, data[0],data[1],data[2]);
-#ifndef SOFTWARE_I2C
-	int ret = i2c_write_blocking(config->sccb, config->sensor_address, data, length, false);
-#else
-	int ret = wrSensorReg16_8(config->sensor_address, reg, value);
-#endif
-	//printf("ret: %x\r\n", ret);
+	dma_channel_acknowledge_irq0(config->dma_channel);
+	pio_sm_set_enabled(config->pio, config->pio_sm, false);
+	pingpong_frame_done(&config->stream);
 }
 
-uint8_t arducam_reg_read(struct arducam_config *config, uint16_t reg) {
-	uint8_t data[2];
-	uint8_t length;
-	switch (config->sccb_mode){
-		case I2C_MODE_16_8:
-			data[0] = (uint8_t)(reg>>8)&0xFF;
-			data[1] = (uint8_t)(reg)&0xFF;
-			length = 2;
-		case I2C_MODE_8_8:
-			data[0] = (uint8_t)reg&0xFF;
-			length = 1;
+static void arducam_stream_vsync_irq(uint gpio, uint32_t events) {
+	struct arducam_config *config = stream_config;
+	if (config == NULL || gpio != config->pin_vsync) {
+		return;
+	}
+	pio_sm_set_enabled(config->pio, config->pio_sm, false);
+	if (config->stream.capturing != PINGPONG_NONE) {
+		// Aborting raises the completion interrupt, keep it from marking
+		// the truncated frame as done.
+		dma_channel_set_irq0_enabled(config->dma_channel, false);
+		dma_channel_abort(config->dma_channel);
+		dma_channel_acknowledge_irq0(config->dma_channel);
+		dma_channel_set_irq0_enabled(config->dma_channel, true);
+	}
+	int index = pingpong_frame_start(&config->stream);
+	if (index < 0) {
+		return;
+	}
+	// Drop whatever was shifted in during the blanking interval
+	arducam_rewind(config);
+	dma_channel_set_write_addr(config->dma_channel, config->stream.buf[index], true);
+	pio_sm_set_enabled(config->pio, config->pio_sm, true);
+}
+
+void arducam_start_streaming(struct arducam_config *config, uint8_t *buf0, uint8_t *buf1) {
+	pingpong_init(&config->stream, buf0, buf1);
+
+	dma_channel_config c = dma_channel_get_default_config(config->dma_channel);
+	channel_config_set_read_increment(&c, false);
+	channel_config_set_write_increment(&c, true);
+	channel_config_set_dreq(&c, pio_get_dreq(config->pio, config->pio_sm, false));
+	channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+	dma_channel_configure(
+		config->dma_channel, &c,
+		buf0,
+		&config->pio->rxf[config->pio_sm],
+		config->image_buf_size,
+		false
+	);
+
+	stream_config = config;
+	dma_channel_acknowledge_irq0(config->dma_channel);
+	dma_channel_set_irq0_enabled(config->dma_channel, true);
+	irq_set_exclusive_handler(DMA_IRQ_0, arducam_stream_dma_irq);
+	irq_set_enabled(DMA_IRQ_0, true);
+	gpio_set_irq_enabled_with_callback(config->pin_vsync, GPIO_IRQ_EDGE_RISE, true,
+	                                   arducam_stream_vsync_irq);
+}
+
+void arducam_stop_streaming(struct arducam_config *config) {
+	gpio_set_irq_enabled(config->pin_vsync, GPIO_IRQ_EDGE_RISE, false);
+	dma_channel_set_irq0_enabled(config->dma_channel, false);
+	dma_channel_abort(config->dma_channel);
+	dma_channel_acknowledge_irq0(config->dma_channel);
+	irq_set_enabled(DMA_IRQ_0, false);
+	irq_remove_handler(DMA_IRQ_0, arducam_stream_dma_irq);
+	pio_sm_set_enabled(config->pio, config->pio_sm, false);
+	if (config->roi_enabled) {
+		dma_channel_abort(config->roi_dma_channel);
 	}
-	i2c_write_blocking(config->sccb, config->sensor_address, data, length, false);
+	config->stream.capturing = PINGPONG_NONE;
+	stream_config = NULL;
+}
+
+uint8_t *arducam_get_latest_frame(struct arducam_config *config, uint32_t *frame_id) {
+	uint32_t status = save_and_disable_interrupts();
+	uint8_t *frame = pingpong_acquire(&config->stream, frame_id);
+	restore_interrupts(status);
+	return frame;
+}
 
-	uint8_t value;
-	i2c_read_blocking(config->sccb, config->sensor_address, &value, 1, false);
+void arducam_release_frame(struct arducam_config *config) {
+	uint32_t status = save_and_disable_interrupts();
+	pingpong_release(&config->stream);
+	restore_interrupts(status);
+}
 
-	return value;
+void arducam_reg_write(struct arducam_config *config, uint16_t reg, uint8_t value) {
+	uint32_t cmds[SCCB_MAX_COMMANDS];
+	const size_t count = sccb_encode_reg_write(config->sensor_address, reg,
+	                                           arducam_reg_bytes(config), value, cmds);
+	sccb_pio_send(cmds, count);
+}
+
+uint8_t arducam_reg_read(struct arducam_config *config, uint16_t reg) {
+	uint32_t cmds[SCCB_MAX_COMMANDS];
+	const size_t count = sccb_encode_reg_read(config->sensor_address, reg,
+	                                          arducam_reg_bytes(config), cmds);
+	return sccb_decode_read(sccb_pio_transfer(cmds, count));
 }
 
 void arducam_regs_write(struct arducam_config *config, struct senosr_reg* regs_list) {
@@ -3,8 +3,8 @@
 #include "stdint.h"
 #include "pico/stdio.h"
 #include "hardware/pio.h"
-#include "hardware/i2c.h"
-#define SOFTWARE_I2C 1
+#include "frame_pingpong.h"
+#include "hm01b0_window.h"
 
 
 
@@ -19,10 +19,34 @@ struct senosr_reg{
 	uint8_t  val;
 };
 
+// Data bus the HM01B0 sends pixels over. The serial bus needs only Y2;
+// the 4-bit one uses the four pins from pin_y2_pio_base up and the 8-bit
+// one all eight. Wider buses take 2 or 1 PCLKs per pixel instead of 8.
+enum bus_width{
+	BUS_WIDTH_1 = 0,
+	BUS_WIDTH_4 = 4,
+	BUS_WIDTH_8 = 8,
+};
+
+// Region of interest for arducam_set_roi(): every factor-th pixel of every
+// factor-th line of the window whose top-left corner is at x, y.
+struct arducam_roi {
+	uint16_t x;
+	uint16_t y;
+	// Output size; the window is width * factor pixels wide
+	uint16_t width;
+	uint16_t height;
+	uint8_t factor;
+};
+
 struct arducam_config {
     uint8_t sensor_address;
-	i2c_inst_t *sccb;
 	enum i2c_mode sccb_mode;
+	// State machine and DMA channel that run the SCCB bus. sccb.pio does
+	// not fit next to the image programs, so this is another PIO than pio.
+	PIO sccb_pio;
+	uint sccb_sm;
+	uint sccb_dma_channel;
 	uint pin_sioc;
 	uint pin_siod;
 	uint pin_resetb;
@@ -30,22 +54,55 @@ struct arducam_config {
 	uint pin_vsync;
 	// Y2, Y3, Y4, Y5, Y6, Y7, Y8, PCLK, HREF
 	uint pin_y2_pio_base;
+	enum bus_width bus_width;
 	PIO pio;
 	uint pio_sm;
 	uint dma_channel;
 	uint8_t *image_buf;
 	size_t image_buf_size;
+	// Filled in by arducam_start_streaming()
+	struct frame_pingpong stream;
+	// Filled in by arducam_set_roi(). The row words are read by a DMA
+	// ring, which needs them aligned to their size.
+	bool roi_enabled;
+	uint roi_offset;
+	uint roi_dma_channel;
+	uint32_t roi_top;
+	uint16_t roi_height;
+	uint32_t roi_row[4] __attribute__((aligned(16)));
 };
 extern int PIN_LED;
-extern int PIN_CAM_SIOC; // I2C0 SCL
-extern int PIN_CAM_SIOD; // I2C0 SDA
+extern int PIN_CAM_SIOC; // SCCB SCL
+extern int PIN_CAM_SIOD; // SCCB SDA
 extern int PIN_CAM_RESETB;
 extern int PIN_CAM_XCLK;
 extern int PIN_CAM_VSYNC;
 extern int PIN_CAM_Y2_PIO_BASE;
 void arducam_init(struct arducam_config *config);
 void arducam_capture_frame(struct arducam_config *config);
+// Makes every later capture, single or streamed, deliver only roi: the PIO
+// drops the other pixels, so image_buf needs just width * height bytes
+// (image_buf_size is updated to match) and can be the model input itself.
+// Claims a second DMA channel the first time it is called.
+void arducam_set_roi(struct arducam_config *config, const struct arducam_roi *roi);
+// Like arducam_set_roi() with roi in sensor pixels, but even factors are
+// halved by HM01B0 2x2 binning first, see hm01b0_window.h. Returns once
+// the sensor runs in the new mode; a window outside the frame is ignored.
+void arducam_set_window(struct arducam_config *config, const struct hm01b0_window *window);
+// Continuous capture: every VSYNC starts a DMA transfer of image_buf_size
+// bytes into whichever of buf0/buf1 is free, so frames keep arriving while
+// the application works on the previous one.
+void arducam_start_streaming(struct arducam_config *config, uint8_t *buf0, uint8_t *buf1);
+void arducam_stop_streaming(struct arducam_config *config);
+// Returns the newest completed frame without waiting (NULL before the first
+// one) and keeps it from being overwritten until the next call or until
+// arducam_release_frame(). frame_id increments with every captured frame.
+uint8_t *arducam_get_latest_frame(struct arducam_config *config, uint32_t *frame_id);
+void arducam_release_frame(struct arducam_config *config);
+// Queues the write and returns; it goes out on the bus while the caller
+// carries on, such as while streaming.
 void arducam_reg_write(struct arducam_config *config, uint16_t reg, uint8_t value);
+// Waits for the writes queued before it, then for the register
 uint8_t arducam_reg_read(struct arducam_config *config, uint16_t reg);
 void arducam_regs_write(struct arducam_config *config, struct senosr_reg* regs_list);
 #endif
@@ -0,0 +1,295 @@
+#include <string.h>
+#include "frame_link.h"
+
+static void put16(uint8_t *p, uint16_t value) {
+	p[0] = value & 0xFF;
+	p[1] = value >> 8;
+}
+
+static uint16_t get16(const uint8_t *p) {
+	return p[0] | (p[1] << 8);
+}
+
+uint16_t frame_link_crc16(uint16_t crc, const uint8_t *data, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		crc ^= (uint16_t)data[i] << 8;
+		for (int bit = 0; bit < 8; bit++) {
+			crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+	return crc;
+}
+
+size_t frame_link_rle_encode(const uint8_t *src, size_t size, uint8_t *dst) {
+	uint8_t *out = dst;
+	size_t i = 0;
+	while (i < size) {
+		// Runs of three or more are worth a repeat
+		size_t run = 1;
+		while (i + run < size && run < 128 && src[i + run] == src[i]) {
+			run++;
+		}
+		if (run >= 3) {
+			*out++ = 257 - run;
+			*out++ = src[i];
+			i += run;
+			continue;
+		}
+		// Literals up to the next run of three
+		size_t literal = 0;
+		while (i + literal < size && literal < 128) {
+			if (i + literal + 2 < size && src[i + literal] == src[i + literal + 1] &&
+			    src[i + literal] == src[i + literal + 2]) {
+				break;
+			}
+			literal++;
+		}
+		*out++ = literal - 1;
+		memcpy(out, src + i, literal);
+		out += literal;
+		i += literal;
+	}
+	return out - dst;
+}
+
+// Decodes into dst, or adds the decoded bytes to it when add is set.
+static int rle_decode(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity, int add) {
+	size_t in = 0, out = 0;
+	while (in < size) {
+		uint8_t n = src[in++];
+		if (n < 128) {
+			size_t literal = n + 1;
+			if (in + literal > size || out + literal > capacity) {
+				return -1;
+			}
+			for (size_t k = 0; k < literal; k++) {
+				dst[out + k] = add ? dst[out + k] + src[in + k] : src[in + k];
+			}
+			in += literal;
+			out += literal;
+		} else if (n > 128) {
+			size_t run = 257 - n;
+			if (in >= size || out + run > capacity) {
+				return -1;
+			}
+			for (size_t k = 0; k < run; k++) {
+				dst[out + k] = add ? dst[out + k] + src[in] : src[in];
+			}
+			in++;
+			out += run;
+		} else {
+			return -1;
+		}
+	}
+	return out == capacity ? (int)out : -1;
+}
+
+int frame_link_rle_decode(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity) {
+	return rle_decode(src, size, dst, capacity, 0);
+}
+
+void frame_link_init(struct frame_link *link, uint8_t *buf, size_t size, uint8_t *prev,
+                     size_t prev_size) {
+	link->buf = buf;
+	link->size = size;
+	link->pushed = 0;
+	link->popped = 0;
+	link->seq = 0;
+	link->prev = prev;
+	link->prev_size = prev != NULL ? prev_size : 0;
+	link->prev_length = 0;
+	link->prev_seq = 0;
+	link->since_key = 0;
+	link->dropped = 0;
+}
+
+// Finds room for need contiguous bytes after the newest packet, wrapping
+// to the start of the buffer if the end is too short. Returns -1 if the
+// packets still queued leave no such room.
+static long reserve(const struct frame_link *link, size_t need) {
+	uint8_t popped = link->popped;
+	uint8_t queued = link->pushed - popped;
+	if (queued == FRAME_LINK_QUEUE_DEPTH) {
+		return -1;
+	}
+	if (queued == 0) {
+		return need <= link->size ? 0 : -1;
+	}
+	const struct frame_link_packet *first = &link->queue[popped % FRAME_LINK_QUEUE_DEPTH];
+	const struct frame_link_packet *last =
+		&link->queue[(uint8_t)(link->pushed - 1) % FRAME_LINK_QUEUE_DEPTH];
+	size_t end = last->start + last->size;
+	if (last->start >= first->start) {
+		if (link->size - end >= need) {
+			return end;
+		}
+		return need <= first->start ? 0 : -1;
+	}
+	return first->start - end >= need ? (long)end : -1;
+}
+
+int frame_link_queue(struct frame_link *link, enum frame_link_type type, const uint8_t *data,
+                     uint16_t size, enum frame_link_encoding encoding) {
+	if (type != FRAME_LINK_IMAGE) {
+		encoding = FRAME_LINK_RAW;
+	}
+	if (encoding == FRAME_LINK_DELTA && (size > link->prev_size || size != link->prev_length ||
+	                                     link->since_key >= FRAME_LINK_KEY_INTERVAL)) {
+		encoding = FRAME_LINK_RLE;
+	}
+	long start = reserve(link, FRAME_LINK_PACKET_SIZE(size));
+	if (start < 0) {
+		link->dropped++;
+		return -1;
+	}
+	uint8_t *packet = link->buf + start;
+	uint8_t *payload = packet + FRAME_LINK_HEADER_SIZE;
+	size_t length = size;
+	if (encoding == FRAME_LINK_RLE) {
+		length = frame_link_rle_encode(data, size, payload);
+	} else if (encoding == FRAME_LINK_DELTA) {
+		// The difference is formed in the previous image, which then
+		// becomes this one
+		for (size_t i = 0; i < size; i++) {
+			link->prev[i] = data[i] - link->prev[i];
+		}
+		put16(payload, link->prev_seq);
+		length = 2 + frame_link_rle_encode(link->prev, size, payload + 2);
+	}
+	if (length >= size) {
+		encoding = FRAME_LINK_RAW;
+		length = size;
+	}
+	if (encoding == FRAME_LINK_RAW) {
+		memcpy(payload, data, size);
+	}
+	if (type == FRAME_LINK_IMAGE && size <= link->prev_size) {
+		memcpy(link->prev, data, size);
+		link->prev_length = size;
+		link->prev_seq = link->seq;
+		link->since_key = encoding == FRAME_LINK_DELTA ? link->since_key + 1 : 0;
+	}
+
+	packet[0] = FRAME_LINK_SYNC0;
+	packet[1] = FRAME_LINK_SYNC1;
+	packet[2] = type;
+	packet[3] = encoding;
+	put16(packet + 4, link->seq++);
+	put16(packet + 6, length);
+	put16(packet + 8, size);
+	uint16_t crc = frame_link_crc16(0xFFFF, packet + 2, FRAME_LINK_HEADER_SIZE - 2 + length);
+	put16(payload + length, crc);
+
+	struct frame_link_packet *entry = &link->queue[link->pushed % FRAME_LINK_QUEUE_DEPTH];
+	entry->start = start;
+	entry->size = FRAME_LINK_HEADER_SIZE + length + FRAME_LINK_CRC_SIZE;
+	// The consumer may look at the packet as soon as it is counted
+	__sync_synchronize();
+	link->pushed++;
+	return 0;
+}
+
+const uint8_t *frame_link_peek(struct frame_link *link, size_t *size) {
+	if (link->pushed == link->popped) {
+		return NULL;
+	}
+	const struct frame_link_packet *entry = &link->queue[link->popped % FRAME_LINK_QUEUE_DEPTH];
+	*size = entry->size;
+	return link->buf + entry->start;
+}
+
+void frame_link_pop(struct frame_link *link) {
+	if (link->pushed != link->popped) {
+		link->popped++;
+	}
+}
+
+void frame_link_decoder_init(struct frame_link_decoder *dec, uint8_t *buf, size_t size,
+                             uint8_t *image, size_t image_size) {
+	memset(dec, 0, sizeof(*dec));
+	dec->buf = buf;
+	dec->size = size;
+	dec->image = image;
+	dec->image_size = image_size;
+}
+
+// Decodes the complete packet in dec->buf.
+static int decode_packet(struct frame_link_decoder *dec) {
+	const uint8_t *header = dec->buf;
+	const uint8_t *payload = header + FRAME_LINK_HEADER_SIZE;
+	const uint8_t type = header[2];
+	const uint8_t encoding = header[3];
+	const uint16_t seq = get16(header + 4);
+	const size_t length = get16(header + 6);
+	const size_t raw_length = get16(header + 8);
+	if (dec->synced && seq != dec->next_seq) {
+		dec->lost += (uint16_t)(seq - dec->next_seq);
+	}
+	dec->synced = 1;
+	dec->next_seq = seq + 1;
+
+	if (type != FRAME_LINK_IMAGE) {
+		if (encoding != FRAME_LINK_RAW || length != raw_length) {
+			dec->lost++;
+			return 0;
+		}
+		dec->data = payload;
+	} else {
+		int ok = raw_length <= dec->image_size;
+		if (ok && encoding == FRAME_LINK_RAW) {
+			ok = length == raw_length;
+			if (ok) {
+				memcpy(dec->image, payload, length);
+			}
+		} else if (ok && encoding == FRAME_LINK_RLE) {
+			ok = rle_decode(payload, length, dec->image, raw_length, 0) >= 0;
+		} else if (ok && encoding == FRAME_LINK_DELTA) {
+			ok = length >= 2 && dec->image_valid && get16(payload) == dec->image_seq &&
+			     rle_decode(payload + 2, length - 2, dec->image, raw_length, 1) >= 0;
+		} else {
+			ok = 0;
+		}
+		// A failed decode may have left the image half written
+		dec->image_valid = ok;
+		if (!ok) {
+			dec->lost++;
+			return 0;
+		}
+		dec->image_seq = seq;
+		dec->data = dec->image;
+	}
+	dec->type = type;
+	dec->seq = seq;
+	dec->data_size = raw_length;
+	return 1;
+}
+
+int frame_link_decode(struct frame_link_decoder *dec, uint8_t byte) {
+	if (dec->fill == 0 && byte != FRAME_LINK_SYNC0) {
+		return 0;
+	}
+	if (dec->fill == 1 && byte != FRAME_LINK_SYNC1) {
+		dec->fill = byte == FRAME_LINK_SYNC0;
+		return 0;
+	}
+	dec->buf[dec->fill++] = byte;
+	if (dec->fill < FRAME_LINK_HEADER_SIZE) {
+		return 0;
+	}
+	const size_t total = FRAME_LINK_HEADER_SIZE + get16(dec->buf + 6) + FRAME_LINK_CRC_SIZE;
+	if (total > dec->size) {
+		// Not a packet this decoder could hold, so not a real one
+		dec->fill = 0;
+		return 0;
+	}
+	if (dec->fill < total) {
+		return 0;
+	}
+	dec->fill = 0;
+	const size_t covered = total - 2 - FRAME_LINK_CRC_SIZE;
+	if (frame_link_crc16(0xFFFF, dec->buf + 2, covered) != get16(dec->buf + 2 + covered)) {
+		dec->crc_errors++;
+		return 0;
+	}
+	return decode_packet(dec);
+}
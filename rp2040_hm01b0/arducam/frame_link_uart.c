@@ -0,0 +1,67 @@
+#include "frame_link_uart.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+// The DMA interrupt carries no context, hence a single link.
+static struct frame_link *uart_link = NULL;
+static uint link_dma_channel;
+static volatile bool link_sending = false;
+
+// Starts the DMA on the oldest queued packet, if there is one.
+static void frame_link_uart_start(void) {
+	size_t size;
+	const uint8_t *packet = frame_link_peek(uart_link, &size);
+	link_sending = packet != NULL;
+	if (packet != NULL) {
+		dma_channel_transfer_from_buffer_now(link_dma_channel, packet, size);
+	}
+}
+
+static void frame_link_uart_dma_irq(void) {
+	if (uart_link == NULL || !dma_channel_get_irq1_status(link_dma_channel)) {
+		return;
+	}
+	dma_channel_acknowledge_irq1(link_dma_channel);
+	frame_link_pop(uart_link);
+	frame_link_uart_start();
+}
+
+void frame_link_uart_init(struct frame_link *link, uart_inst_t *uart, uint dma_channel) {
+	uart_link = link;
+	link_dma_channel = dma_channel;
+	link_sending = false;
+
+	dma_channel_config c = dma_channel_get_default_config(dma_channel);
+	channel_config_set_read_increment(&c, true);
+	channel_config_set_write_increment(&c, false);
+	channel_config_set_dreq(&c, uart_get_dreq(uart, true));
+	channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+	dma_channel_configure(
+		dma_channel, &c,
+		&uart_get_hw(uart)->dr,
+		NULL,
+		0,
+		false
+	);
+	dma_channel_acknowledge_irq1(dma_channel);
+	dma_channel_set_irq1_enabled(dma_channel, true);
+	irq_add_shared_handler(DMA_IRQ_1, frame_link_uart_dma_irq,
+	                       PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+	irq_set_enabled(DMA_IRQ_1, true);
+}
+
+int frame_link_uart_send(enum frame_link_type type, const uint8_t *data, uint16_t size,
+                         enum frame_link_encoding encoding) {
+	int result = frame_link_queue(uart_link, type, data, size, encoding);
+	uint32_t status = save_and_disable_interrupts();
+	if (!link_sending) {
+		frame_link_uart_start();
+	}
+	restore_interrupts(status);
+	return result;
+}
+
+bool frame_link_uart_busy(void) {
+	return link_sending;
+}
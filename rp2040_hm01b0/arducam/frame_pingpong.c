@@ -0,0 +1,55 @@
+#include <stddef.h>
+#include "frame_pingpong.h"
+
+void pingpong_init(struct frame_pingpong *pp, uint8_t *buf0, uint8_t *buf1) {
+	pp->buf[0] = buf0;
+	pp->buf[1] = buf1;
+	pp->seq[0] = 0;
+	pp->seq[1] = 0;
+	pp->capturing = PINGPONG_NONE;
+	pp->ready = PINGPONG_NONE;
+	pp->held = PINGPONG_NONE;
+	pp->completed = 0;
+	pp->dropped = 0;
+}
+
+int pingpong_frame_start(struct frame_pingpong *pp) {
+	if (pp->capturing != PINGPONG_NONE) {
+		// The previous frame never finished, start over in the same buffer.
+		pp->dropped++;
+		return pp->capturing;
+	}
+	uint8_t busy = pp->ready != PINGPONG_NONE ? pp->ready : pp->held;
+	if (pp->held != PINGPONG_NONE && pp->held != busy) {
+		pp->dropped++;
+		return -1;
+	}
+	pp->capturing = busy == 0 ? 1 : 0;
+	return pp->capturing;
+}
+
+void pingpong_frame_done(struct frame_pingpong *pp) {
+	uint8_t index = pp->capturing;
+	if (index == PINGPONG_NONE) {
+		return;
+	}
+	pp->seq[index] = ++pp->completed;
+	pp->ready = index;
+	pp->capturing = PINGPONG_NONE;
+}
+
+uint8_t *pingpong_acquire(struct frame_pingpong *pp, uint32_t *seq) {
+	uint8_t index = pp->ready;
+	pp->held = index;
+	if (index == PINGPONG_NONE) {
+		return NULL;
+	}
+	if (seq != NULL) {
+		*seq = pp->seq[index];
+	}
+	return pp->buf[index];
+}
+
+void pingpong_release(struct frame_pingpong *pp) {
+	pp->held = PINGPONG_NONE;
+}
@@ -0,0 +1,42 @@
+#ifndef _FRAME_PINGPONG__H
+#define _FRAME_PINGPONG__H
+#include <stdint.h>
+
+// Buffer bookkeeping for continuous capture into two frame buffers.
+// It has no hardware dependencies: arducam.c drives it from the VSYNC and
+// DMA interrupts, and the host tests drive it from a simulated PIO FIFO.
+//
+// A buffer is in at most one of three roles at a time: being written by
+// the DMA (capturing), holding the newest completed frame (ready), or being
+// read by the application (held).  The ready and held roles may name the
+// same buffer.  A new frame is never started into the held or the ready
+// buffer; when those are two different buffers the frame is skipped, so
+// the latest completed frame is always available without waiting.
+
+#define PINGPONG_NONE 0xFF
+
+struct frame_pingpong {
+	uint8_t *buf[2];
+	uint32_t seq[2];
+	volatile uint8_t capturing;
+	volatile uint8_t ready;
+	volatile uint8_t held;
+	// Frames completed since pingpong_init().
+	volatile uint32_t completed;
+	// Frame starts skipped because both buffers were busy, plus frames
+	// restarted because the previous one never completed.
+	volatile uint32_t dropped;
+};
+
+void pingpong_init(struct frame_pingpong *pp, uint8_t *buf0, uint8_t *buf1);
+// Called on VSYNC. Returns the buffer index to capture into, or -1 when
+// the frame has to be skipped.
+int pingpong_frame_start(struct frame_pingpong *pp);
+// Called when the DMA has filled the buffer returned by the last start.
+void pingpong_frame_done(struct frame_pingpong *pp);
+// Hands the newest completed frame to the caller, releasing any frame it
+// was still holding. Returns NULL until the first frame completes. The
+// frame number is stored in *seq when seq is not NULL.
+uint8_t *pingpong_acquire(struct frame_pingpong *pp, uint32_t *seq);
+void pingpong_release(struct frame_pingpong *pp);
+#endif
@@ -87,4 +87,20 @@ struct senosr_reg hm01b0_324x244[] = {
     {0x0100,0x01},
     {0xFFFF,0xFF},
 };
+// Written after hm01b0_324x244 to move the output to the parallel bus.
+// BIT_CONTROL (0x3059) selects it: 0x22 serial, 0x42 4-bit, 0x02 8-bit.
+struct senosr_reg hm01b0_bus_4bit[] = {
+    {0x0100,0x00},
+    {0x3059,0x42},
+    {0x0104,0x01},
+    {0x0100,0x01},
+    {0xFFFF,0xFF},
+};
+struct senosr_reg hm01b0_bus_8bit[] = {
+    {0x0100,0x00},
+    {0x3059,0x02},
+    {0x0104,0x01},
+    {0x0100,0x01},
+    {0xFFFF,0xFF},
+};
 #endif 
\ No newline at end of file
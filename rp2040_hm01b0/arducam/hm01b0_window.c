@@ -0,0 +1,21 @@
+#include "hm01b0_window.h"
+
+int hm01b0_window_plan(const struct hm01b0_window *window, struct hm01b0_window_plan *plan) {
+	if (window->factor == 0 || window->width == 0 || window->height == 0) {
+		return -1;
+	}
+	if (window->x + window->width * window->factor > HM01B0_FRAME_SIZE ||
+	    window->y + window->height * window->factor > HM01B0_FRAME_SIZE) {
+		return -1;
+	}
+	const bool binning = window->factor % 2 == 0;
+	const uint16_t scale = binning ? 2 : 1;
+	plan->binning = binning;
+	plan->frame_lines = HM01B0_FRAME_LINES - HM01B0_FRAME_SIZE + HM01B0_FRAME_SIZE / scale;
+	plan->x = window->x / scale;
+	plan->y = window->y / scale;
+	plan->width = window->width;
+	plan->height = window->height;
+	plan->factor = window->factor / scale;
+	return 0;
+}
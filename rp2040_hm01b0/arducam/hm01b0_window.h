@@ -0,0 +1,43 @@
+#ifndef _HM01B0_WINDOW__H
+#define _HM01B0_WINDOW__H
+#include <stdbool.h>
+#include <stdint.h>
+
+// Works out how the HM01B0 delivers a window of its 324x324 frame. The
+// sensor has no crop registers, only 2x2 binning (READOUT_X/Y and
+// BINNING_MODE), so an even factor is halved by binning and the PIO ROI
+// takes what is left from the 162x162 binned frame. Binned pixels average
+// four photosites instead of dropping three, and the shorter frame leaves
+// the PIO half the pixel clocks to skip.
+
+#define HM01B0_FRAME_SIZE 324
+// Lines the stock table runs a full frame in, FRAME_LENGTH_LINES
+#define HM01B0_FRAME_LINES 378
+
+struct hm01b0_window {
+	// Sensor pixels, as in struct arducam_roi
+	uint16_t x;
+	uint16_t y;
+	uint16_t width;
+	uint16_t height;
+	uint8_t factor;
+};
+
+struct hm01b0_window_plan {
+	bool binning;
+	// FRAME_LENGTH_LINES (0x0340, 0x0341): the frame rows plus the same
+	// vertical blanking as the stock table
+	uint16_t frame_lines;
+	// What to hand arducam_set_roi(), in pixels of the frame the sensor
+	// sends. Binning floors x and y, moving the window by at most one
+	// sensor pixel.
+	uint16_t x;
+	uint16_t y;
+	uint16_t width;
+	uint16_t height;
+	uint8_t factor;
+};
+
+// Returns 0, or -1 if the window does not fit the frame.
+int hm01b0_window_plan(const struct hm01b0_window *window, struct hm01b0_window_plan *plan);
+#endif
@@ -0,0 +1,137 @@
+#include <stddef.h>
+#include "preprocess.h"
+
+#define BYTES_HIGH 0x80808080u
+#define LANES_EVEN 0x00FF00FFu
+
+// Reads a byte stream four bytes at a time using only aligned loads, which
+// the Cortex-M0+ requires. Unaligned streams are stitched together from
+// neighbouring words.
+struct word_reader {
+	const uint32_t *p;
+	uint32_t cur;
+	uint32_t shift;
+};
+
+static inline void reader_init(struct word_reader *r, const uint8_t *src) {
+	uintptr_t addr = (uintptr_t)src;
+	r->p = (const uint32_t *)(addr & ~(uintptr_t)3);
+	r->shift = (addr & 3) * 8;
+	r->cur = r->shift ? *r->p++ : 0;
+}
+
+static inline uint32_t reader_next(struct word_reader *r) {
+	uint32_t next = *r->p++;
+	if (r->shift == 0) {
+		return next;
+	}
+	uint32_t word = (r->cur >> r->shift) | (next << (32 - r->shift));
+	r->cur = next;
+	return word;
+}
+
+// Byte-wise a - b modulo 256 on four packed bytes, without borrows
+// crossing into the neighbouring byte.
+static inline uint32_t sub_bytes(uint32_t a, uint32_t b) {
+	return ((a | BYTES_HIGH) - (b & ~BYTES_HIGH)) ^ ((a ^ ~b) & BYTES_HIGH);
+}
+
+// Packs bytes 0 and 2 of a word into its low half-word.
+static inline uint32_t pack_even(uint32_t lanes) {
+	return (lanes | (lanes >> 8)) & 0xFFFF;
+}
+
+// Sums of horizontally adjacent byte pairs, in two 16-bit lanes.
+static inline uint32_t pair_sums(uint32_t word) {
+	return (word & LANES_EVEN) + ((word >> 8) & LANES_EVEN);
+}
+
+static uint8_t sample(const struct preprocess_config *config, const uint8_t *src, int x, int y) {
+	const uint8_t *p = src + (size_t)(config->crop_y + y * config->factor) * config->src_stride +
+	                   config->crop_x + x * config->factor;
+	if (config->mode == PREPROCESS_SUBSAMPLE || config->factor == 1) {
+		return *p;
+	}
+	uint32_t sum = 0;
+	for (int j = 0; j < config->factor; j++) {
+		for (int i = 0; i < config->factor; i++) {
+			sum += p[j * config->src_stride + i];
+		}
+	}
+	uint32_t count = config->factor * config->factor;
+	return (sum + count / 2) / count;
+}
+
+// Produces the first width & ~3 pixels of output row y, four at a time.
+static void row_words(const struct preprocess_config *config, const uint8_t *src, int y,
+                      uint32_t *dst) {
+	const uint8_t *row = src + (size_t)(config->crop_y + y * config->factor) * config->src_stride +
+	                     config->crop_x;
+	const uint32_t zero_point = config->zero_point * 0x01010101u;
+	const int words = config->out_width / 4;
+	struct word_reader r[4];
+	int rows = config->mode == PREPROCESS_AVERAGE ? config->factor : 1;
+	for (int j = 0; j < rows; j++) {
+		reader_init(&r[j], row + j * config->src_stride);
+	}
+
+	for (int n = 0; n < words; n++) {
+		uint32_t out;
+		if (config->factor == 1) {
+			out = reader_next(&r[0]);
+		} else if (config->factor == 2 && rows == 1) {
+			uint32_t lo = reader_next(&r[0]) & LANES_EVEN;
+			uint32_t hi = reader_next(&r[0]) & LANES_EVEN;
+			out = pack_even(lo) | (pack_even(hi) << 16);
+		} else if (config->factor == 2) {
+			uint32_t lo = pair_sums(reader_next(&r[0])) + pair_sums(reader_next(&r[1]));
+			uint32_t hi = pair_sums(reader_next(&r[0])) + pair_sums(reader_next(&r[1]));
+			lo = ((lo + 0x00020002u) >> 2) & LANES_EVEN;
+			hi = ((hi + 0x00020002u) >> 2) & LANES_EVEN;
+			out = pack_even(lo) | (pack_even(hi) << 16);
+		} else if (rows == 1) {
+			out = reader_next(&r[0]) & 0xFF;
+			out |= (reader_next(&r[0]) & 0xFF) << 8;
+			out |= (reader_next(&r[0]) & 0xFF) << 16;
+			out |= reader_next(&r[0]) << 24;
+		} else {
+			out = 0;
+			for (int k = 0; k < 4; k++) {
+				uint32_t sums = pair_sums(reader_next(&r[0])) + pair_sums(reader_next(&r[1])) +
+				                pair_sums(reader_next(&r[2])) + pair_sums(reader_next(&r[3]));
+				out |= ((((sums & 0xFFFF) + (sums >> 16) + 8) >> 4) & 0xFF) << (k * 8);
+			}
+		}
+		dst[n] = sub_bytes(out, zero_point);
+	}
+}
+
+void preprocess_frame(const struct preprocess_config *config, const uint8_t *src, int8_t *dst) {
+	int fast = config->factor == 1 || config->factor == 2 || config->factor == 4;
+	for (int y = 0; y < config->out_height; y++) {
+		int8_t *out = dst + (size_t)y * config->out_width;
+		int x = 0;
+		if (fast && ((uintptr_t)out & 3) == 0) {
+			row_words(config, src, y, (uint32_t *)out);
+			x = config->out_width & ~3;
+		}
+		for (; x < config->out_width; x++) {
+			out[x] = (int8_t)(uint8_t)(sample(config, src, x, y) - config->zero_point);
+		}
+	}
+}
+
+void preprocess_zero_point(int8_t *image, size_t size, uint8_t zero_point) {
+	size_t i = 0;
+	if (((uintptr_t)image & 3) == 0) {
+		const uint32_t zero_points = zero_point * 0x01010101u;
+		uint32_t *words = (uint32_t *)image;
+		for (; i + 4 <= size; i += 4) {
+			*words = sub_bytes(*words, zero_points);
+			words++;
+		}
+	}
+	for (; i < size; i++) {
+		image[i] = (int8_t)((uint8_t)image[i] - zero_point);
+	}
+}
@@ -0,0 +1,94 @@
+#include "sccb_pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "sccb.pio.h"
+
+// The DMA interrupt carries no context, hence a single bus.
+static struct sccb_queue sccb_queue;
+static PIO sccb_pio;
+static uint sccb_sm;
+static uint sccb_offset;
+static uint sccb_dma_channel;
+static volatile bool sccb_sending = false;
+// Commands the DMA channel is on
+static size_t sccb_in_flight;
+
+// Starts the DMA on the oldest queued commands, if there are any.
+static void sccb_pio_start(void) {
+	const uint32_t *cmds = sccb_queue_peek(&sccb_queue, &sccb_in_flight);
+	sccb_sending = cmds != NULL;
+	if (cmds != NULL) {
+		dma_channel_transfer_from_buffer_now(sccb_dma_channel, cmds, sccb_in_flight);
+	}
+}
+
+static void sccb_pio_dma_irq(void) {
+	if (sccb_pio == NULL || !dma_channel_get_irq1_status(sccb_dma_channel)) {
+		return;
+	}
+	dma_channel_acknowledge_irq1(sccb_dma_channel);
+	sccb_queue_pop(&sccb_queue, sccb_in_flight);
+	sccb_pio_start();
+}
+
+void sccb_pio_init(PIO pio, uint sm, uint pin_sda, uint pin_scl, uint baudrate,
+                   uint dma_channel, uint32_t *buf, size_t size) {
+	sccb_queue_init(&sccb_queue, buf, size);
+	sccb_pio = pio;
+	sccb_sm = sm;
+	sccb_dma_channel = dma_channel;
+	sccb_sending = false;
+
+	sccb_offset = pio_add_program(pio, &sccb_program);
+	sccb_program_init(pio, sm, sccb_offset, pin_sda, pin_scl, baudrate);
+
+	dma_channel_config c = dma_channel_get_default_config(dma_channel);
+	channel_config_set_read_increment(&c, true);
+	channel_config_set_write_increment(&c, false);
+	channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
+	channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+	dma_channel_configure(
+		dma_channel, &c,
+		&pio->txf[sm],
+		NULL,
+		0,
+		false
+	);
+	dma_channel_acknowledge_irq1(dma_channel);
+	dma_channel_set_irq1_enabled(dma_channel, true);
+	irq_add_shared_handler(DMA_IRQ_1, sccb_pio_dma_irq,
+	                       PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+	irq_set_enabled(DMA_IRQ_1, true);
+}
+
+void sccb_pio_send(const uint32_t *cmds, size_t count) {
+	// The queue only drains while the DMA is running, which it is whenever
+	// the queue is not empty
+	while (sccb_queue_push(&sccb_queue, cmds, count) != 0) {
+		tight_loop_contents();
+	}
+	uint32_t status = save_and_disable_interrupts();
+	if (!sccb_sending) {
+		sccb_pio_start();
+	}
+	restore_interrupts(status);
+}
+
+uint32_t sccb_pio_transfer(const uint32_t *cmds, size_t count) {
+	sccb_pio_send(cmds, count);
+	return pio_sm_get_blocking(sccb_pio, sccb_sm);
+}
+
+bool sccb_pio_busy(void) {
+	// The last command is on the bus until the state machine is back at
+	// the pull at the top of the program
+	return sccb_sending || !pio_sm_is_tx_fifo_empty(sccb_pio, sccb_sm) ||
+	       pio_sm_get_pc(sccb_pio, sccb_sm) != sccb_offset;
+}
+
+void sccb_pio_wait(void) {
+	while (sccb_pio_busy()) {
+		tight_loop_contents();
+	}
+}
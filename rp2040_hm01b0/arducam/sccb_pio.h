@@ -0,0 +1,38 @@
+#ifndef _SCCB_PIO__H
+#define _SCCB_PIO__H
+#include <stdbool.h>
+#include "hardware/pio.h"
+#include "sccb_queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Runs the SCCB master in sccb.pio on a state machine, fed from a
+// sccb_queue by a DMA channel. Queuing a write costs only its encoding;
+// the transfer then overlaps with whatever the application does next.
+// Completion is handled on DMA_IRQ_1, which may be shared with other
+// handlers. There is a single bus per application.
+//
+// Writes are not checked for an acknowledge, as with the bit-banged bus
+// this replaces; reading the register back checks one.
+
+// Loads the program and starts the state machine, with SCL at baudrate.
+// buf holds size commands, a power of two; it bounds how many writes can
+// be in flight.
+void sccb_pio_init(PIO pio, uint sm, uint pin_sda, uint pin_scl, uint baudrate,
+                   uint dma_channel, uint32_t *buf, size_t size);
+// Queues cmds, then starts sending if the bus was idle. Waits for room
+// when the queue is full.
+void sccb_pio_send(const uint32_t *cmds, size_t count);
+// Queues cmds, which must push one word, and waits for that word: the
+// writes queued before it are done by then.
+uint32_t sccb_pio_transfer(const uint32_t *cmds, size_t count);
+// True while commands are queued or on the bus
+bool sccb_pio_busy(void);
+void sccb_pio_wait(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
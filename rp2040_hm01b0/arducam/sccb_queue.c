@@ -0,0 +1,86 @@
+#include "sccb_queue.h"
+
+// SDA is driven through its pin direction, so the bits go out inverted
+#define SCCB_BITS(nine) ((uint32_t)(~(nine) & 0x1FF) << 22)
+
+uint32_t sccb_encode_write(uint8_t byte) {
+	// The acknowledge slot is left to the slave
+	return SCCB_BITS(((uint32_t)byte << 1) | 1);
+}
+
+uint32_t sccb_encode_read(int ack) {
+	return SCCB_BITS(0x1FE | (ack ? 0 : 1)) | SCCB_PUSH;
+}
+
+uint8_t sccb_decode_read(uint32_t word) {
+	return (word >> 1) & 0xFF;
+}
+
+// The register number, most significant byte first
+static size_t encode_reg(uint16_t reg, int reg_bytes, uint32_t *cmds) {
+	size_t count = 0;
+	if (reg_bytes == 2) {
+		cmds[count++] = sccb_encode_write(reg >> 8);
+	}
+	cmds[count++] = sccb_encode_write(reg & 0xFF);
+	return count;
+}
+
+size_t sccb_encode_reg_write(uint8_t address, uint16_t reg, int reg_bytes, uint8_t value,
+                             uint32_t *cmds) {
+	size_t count = 0;
+	cmds[count++] = SCCB_START | sccb_encode_write(address << 1);
+	count += encode_reg(reg, reg_bytes, cmds + count);
+	cmds[count++] = sccb_encode_write(value) | SCCB_STOP;
+	return count;
+}
+
+size_t sccb_encode_reg_read(uint8_t address, uint16_t reg, int reg_bytes, uint32_t *cmds) {
+	size_t count = 0;
+	cmds[count++] = SCCB_START | sccb_encode_write(address << 1);
+	count += encode_reg(reg, reg_bytes, cmds + count);
+	cmds[count - 1] |= SCCB_STOP;
+	cmds[count++] = SCCB_START | sccb_encode_write((address << 1) | 1);
+	cmds[count++] = sccb_encode_read(0) | SCCB_STOP;
+	return count;
+}
+
+void sccb_queue_init(struct sccb_queue *queue, uint32_t *buf, size_t size) {
+	queue->buf = buf;
+	queue->size = size;
+	queue->pushed = 0;
+	queue->popped = 0;
+}
+
+size_t sccb_queue_free(const struct sccb_queue *queue) {
+	return queue->size - (uint32_t)(queue->pushed - queue->popped);
+}
+
+int sccb_queue_push(struct sccb_queue *queue, const uint32_t *cmds, size_t count) {
+	if (count > sccb_queue_free(queue)) {
+		return -1;
+	}
+	uint32_t pushed = queue->pushed;
+	for (size_t i = 0; i < count; i++, pushed++) {
+		queue->buf[pushed % queue->size] = cmds[i];
+	}
+	// Only now does the consumer see them
+	queue->pushed = pushed;
+	return 0;
+}
+
+const uint32_t *sccb_queue_peek(const struct sccb_queue *queue, size_t *count) {
+	const uint32_t popped = queue->popped;
+	const size_t queued = (uint32_t)(queue->pushed - popped);
+	if (queued == 0) {
+		return NULL;
+	}
+	const size_t start = popped % queue->size;
+	*count = queued < queue->size - start ? queued : queue->size - start;
+	return queue->buf + start;
+}
+
+void sccb_queue_pop(struct sccb_queue *queue, size_t count) {
+	const size_t queued = (uint32_t)(queue->pushed - queue->popped);
+	queue->popped += count < queued ? count : queued;
+}
@@ -0,0 +1,65 @@
+#ifndef _SCCB_QUEUE__H
+#define _SCCB_QUEUE__H
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Commands for the SCCB master in sccb.pio, and the queue of commands
+// waiting for it. It has no hardware dependencies: sccb_pio.c feeds the
+// queue to the state machine with a DMA channel, and the host tests run
+// the encoded transactions through a model of the program.
+//
+// A command is one byte on the bus; see sccb.pio for the bits.
+
+#define SCCB_START (1u << 31)
+#define SCCB_STOP (1u << 21)
+#define SCCB_PUSH (1u << 20)
+// Most commands a register access takes
+#define SCCB_MAX_COMMANDS 8
+
+// A byte the master sends; the slave acknowledges it
+uint32_t sccb_encode_write(uint8_t byte);
+// A byte the slave sends; the master acknowledges it when ack is set,
+// which it does for all but the last byte of a read. The command pushes
+// what was read.
+uint32_t sccb_encode_read(int ack);
+// The byte read by a command from sccb_encode_read()
+uint8_t sccb_decode_read(uint32_t word);
+
+// The transactions of a register write and of a register read, to the
+// 7-bit address and with a register number of reg_bytes bytes. A read is
+// a write of the register number followed by a read transaction, with a
+// STOP in between, and pushes one word. Both return the command count.
+size_t sccb_encode_reg_write(uint8_t address, uint16_t reg, int reg_bytes, uint8_t value,
+                             uint32_t *cmds);
+size_t sccb_encode_reg_read(uint8_t address, uint16_t reg, int reg_bytes, uint32_t *cmds);
+
+// One producer queues commands and one consumer, typically an interrupt
+// handler, takes them off. Each side only writes its own counter, so no
+// locking is needed.
+struct sccb_queue {
+	uint32_t *buf;
+	size_t size;
+	// Commands queued and taken off; the difference is the queue length
+	volatile uint32_t pushed;
+	volatile uint32_t popped;
+};
+
+// buf holds size commands; size must be a power of two
+void sccb_queue_init(struct sccb_queue *queue, uint32_t *buf, size_t size);
+size_t sccb_queue_free(const struct sccb_queue *queue);
+// Adds all of cmds to the end of the queue, or none of them. Returns 0,
+// or -1 if there was no room.
+int sccb_queue_push(struct sccb_queue *queue, const uint32_t *cmds, size_t count);
+// The oldest queued commands that are next to each other in buf, or NULL
+// when the queue is empty. They stay valid until sccb_queue_pop().
+const uint32_t *sccb_queue_peek(const struct sccb_queue *queue, size_t *count);
+void sccb_queue_pop(struct sccb_queue *queue, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
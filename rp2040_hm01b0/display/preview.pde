@@ -1,16 +1,12 @@
 /*
-  This sketch reads a raw Stream of RGB565 pixels
+  This sketch reads frame_link packets of grayscale pixels
  from the Serial port and displays the frame on
- the window.
- 
- Use with the Examples -> CameraCaptureRawBytes Arduino sketch.
+ the window. FrameDecoder.java does the decoding.
  
  This example code is in the public domain.
  */
 
 import processing.serial.*;
-import java.nio.ByteBuffer;
-import java.nio.ByteOrder;
 
 Serial myPort;
 
@@ -21,9 +17,7 @@ final int cameraBytesPerPixel = 1;
 final int bytesPerFrame = cameraWidth * cameraHeight * cameraBytesPerPixel;
 
 PImage myImage;
-byte[] frameBuffer = new byte[bytesPerFrame];
-byte[] header = new byte[3];
-byte[] score = new byte[2];
+FrameDecoder decoder = new FrameDecoder(bytesPerFrame);
 
 void setup()
 {
@@ -38,8 +32,6 @@ void setup()
   //  myPort = new Serial(this, "/dev/ttyUSB0", 921600);            // Linux
   // myPort = new Serial(this, "/dev/cu.usbmodem14401", 9600);     // Mac
 
-  // wait for full frame of bytes
-  myPort.buffer(bytesPerFrame);  
   myImage = createImage(cameraWidth, cameraHeight, GRAY);
   
   fill(255, 0, 0);
@@ -49,55 +41,15 @@ void draw()
 {
   image(myImage, 0, 0, 320, 320);
 }
-int state = 0;
-int read = 0;
-int result = 0;
-int startbyte;
 void serialEvent(Serial myPort) {
-  if (read == 0) {
-    startbyte = myPort.read();
-    if (startbyte == 0x55) {
-      state = 1;
-    }
-    if (startbyte == 0xAA && state == 1) {
-      read = 1; 
+  while (myPort.available() > 0) {
+    if (!decoder.decode(myPort.read()) || decoder.type != FrameDecoder.IMAGE) {
+      continue;
     }
-    if (startbyte == 0xBB && state == 1) {
-      result = 1; 
-    }
-  }
-  if (result == 1) {
-     myPort.readBytes(score);
-     result = 0;
-  }
-  if (read ==1) {
-    // read the saw bytes in
-    myPort.readBytes(frameBuffer);
-    // access raw bytes via byte buffer
-    ByteBuffer bb = ByteBuffer.wrap(frameBuffer);
-    bb.order(ByteOrder.BIG_ENDIAN);
-    int i = 0;
-    while (bb.hasRemaining()) {
-      
-      // read 16-bit pixel
-      short p = bb.getShort();
-      int p1 = (p>>8)&0xFF;
-      int p2 = p&0xFF;
-      // convert RGB565 to RGB 24-bit
-      int r = p1;//((p >> 11) & 0x1f) << 3;
-      int g = p1;//((p >> 5) & 0x3f) << 2;
-      int b = p1;//((p >> 0) & 0x1f) << 3;
-
-      // set pixel color
-      myImage .pixels[i++] = color(r, g, b);
-      r = p2;//((p >> 11) & 0x1f) << 3;
-      g = p2;//((p >> 5) & 0x3f) << 2;
-      b = p2;//((p >> 0) & 0x1f) << 3;
-
-      // set pixel color
-      myImage .pixels[i++] = color(r, g, b);
+    for (int i = 0; i < bytesPerFrame; i++) {
+      int p = decoder.data[i] & 0xFF;
+      myImage.pixels[i] = color(p, p, p);
     }
-    read = 0;
+    myImage.updatePixels();
   }
-  myImage .updatePixels();
 }
@@ -1,10 +1,14 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
+#include "hardware/dma.h"
 #include "arducam/arducam.h"
-uint8_t image_buf[324*324];
-uint8_t image_tmp[162*162];
-uint8_t image[96*96];
-uint8_t header[2] = {0x55,0xAA};
+#include "arducam/frame_link_uart.h"
+// Only the region of interest is captured, so the frames are the images
+uint8_t image_buf[2][96*96] __attribute__((aligned(4)));
+// Room for two images in flight, and the last one sent to delta code against
+uint8_t link_buf[2 * FRAME_LINK_PACKET_SIZE(96*96)];
+uint8_t link_prev[96*96];
+struct frame_link link;
 
 int main() {
 	stdio_uart_init();
@@ -12,7 +16,6 @@ int main() {
 	gpio_init(PIN_LED);
 	gpio_set_dir(PIN_LED, GPIO_OUT);
 	struct arducam_config config;
-	config.sccb = i2c0;
 	config.sccb_mode = I2C_MODE_16_8;
 	config.sensor_address = 0x24;
 	config.pin_sioc = PIN_CAM_SIOC;
@@ -21,36 +24,48 @@ int main() {
 	config.pin_xclk = PIN_CAM_XCLK;
 	config.pin_vsync = PIN_CAM_VSYNC;
 	config.pin_y2_pio_base = PIN_CAM_Y2_PIO_BASE;
+	config.bus_width = BUS_WIDTH_1;
 
 	config.pio = pio0;
 	config.pio_sm = 0;
+	config.sccb_pio = pio1;
+	config.sccb_sm = 0;
 
 	config.dma_channel = 0;
-	config.image_buf = image_buf;
-	config.image_buf_size = sizeof(image_buf);
+	config.sccb_dma_channel = 1;
+	config.image_buf = image_buf[0];
+	config.image_buf_size = sizeof(image_buf[0]);
 
 	arducam_init(&config);
-	uint16_t x, y,i, j, index;
+	// The centre 192x192 at half resolution: the sensor bins it 2x2 and
+	// the PIO drops the rest of the binned frame
+	const struct hm01b0_window window = {
+		.x = 67,
+		.y = 66,
+		.width = 96,
+		.height = 96,
+		.factor = 2,
+	};
+	arducam_set_window(&config, &window);
+	frame_link_init(&link, link_buf, sizeof(link_buf), link_prev, sizeof(link_prev));
+	frame_link_uart_init(&link, uart0, dma_claim_unused_channel(true));
+	arducam_start_streaming(&config, image_buf[0], image_buf[1]);
+	uint32_t frame_id, last_frame_id = 0;
 	while (true) {
 		gpio_put(PIN_LED, !gpio_get(PIN_LED));
-		arducam_capture_frame(&config);
-	i = 0;
-	index = 0;
-	uint8_t temp = 0;
-	for(y = 0; y< 324; y++){
-		for(x = (1+x)%2; x<324; x+=2){
-			image_tmp[index++] = config.image_buf[y*324+x];
+		// The next frame is already being captured into the other buffer
+		while ((config.image_buf = arducam_get_latest_frame(&config, &frame_id)) == NULL ||
+		       frame_id == last_frame_id) {
+			tight_loop_contents();
 		}
-	}
-	index = 0;
-	for(y = 33; y< 129; y ++){
-		for(x = 33; x<129; x++){
-			image[index++] = image_tmp[y*324+x];
+		last_frame_id = frame_id;
+		// Frames that arrive while the previous one is still going out are
+		// skipped rather than queued, so the host always sees the latest
+		if (!frame_link_uart_busy()) {
+			frame_link_uart_send(FRAME_LINK_IMAGE, config.image_buf, config.image_buf_size,
+			                     FRAME_LINK_DELTA);
 		}
-	}
-		uart_write_blocking(uart0, header, 2);
-		//uart_write_blocking(uart0, config.image_buf, config.image_buf_size);
-		uart_write_blocking(uart0, image, 96*96);	
+		arducam_release_frame(&config);
 	}
 
 	return 0;
@@ -0,0 +1,266 @@
+#include <stdint.h>
+#include <string.h>
+#include "frame_link.h"
+#include "host_test.h"
+
+#define IMAGE_SIZE (96 * 96)
+
+static uint8_t queue_buf[2 * FRAME_LINK_PACKET_SIZE(IMAGE_SIZE)];
+static uint8_t prev[IMAGE_SIZE];
+static uint8_t decode_buf[FRAME_LINK_PACKET_SIZE(IMAGE_SIZE)];
+static uint8_t decoded_image[IMAGE_SIZE];
+static uint8_t image[IMAGE_SIZE];
+static uint8_t coded[FRAME_LINK_PACKET_SIZE(IMAGE_SIZE)];
+static uint8_t roundtrip[IMAGE_SIZE];
+
+static struct frame_link link;
+static struct frame_link_decoder dec;
+
+static void setup(int with_prev) {
+	frame_link_init(&link, queue_buf, sizeof(queue_buf), with_prev ? prev : NULL, sizeof(prev));
+	frame_link_decoder_init(&dec, decode_buf, sizeof(decode_buf), decoded_image,
+	                        sizeof(decoded_image));
+}
+
+static uint32_t next_random(uint32_t *seed) {
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 16;
+}
+
+// A mostly flat scene with some noise, like a camera looking at a wall
+static void fill_scene(uint32_t seed, int noise) {
+	for (int i = 0; i < IMAGE_SIZE; i++) {
+		image[i] = 100 + (i / 96) / 8;
+		if (noise && next_random(&seed) % 8 == 0) {
+			image[i] += next_random(&seed) % 5;
+		}
+	}
+}
+
+// Sends every queued packet through the decoder, as the DMA would. Returns
+// the number of packets the decoder reported.
+static int drain(void) {
+	int packets = 0;
+	size_t size;
+	const uint8_t *packet;
+	while ((packet = frame_link_peek(&link, &size)) != NULL) {
+		for (size_t i = 0; i < size; i++) {
+			packets += frame_link_decode(&dec, packet[i]);
+		}
+		frame_link_pop(&link);
+	}
+	return packets;
+}
+
+HOST_TEST(Crc16) {
+	// The CRC-16/CCITT-FALSE check value
+	const uint8_t check[] = "123456789";
+	HOST_TEST_EXPECT_EQ(0x29B1, frame_link_crc16(0xFFFF, check, 9));
+}
+
+HOST_TEST(RleRoundTrip) {
+	uint32_t seed = 1;
+	for (int pattern = 0; pattern < 4; pattern++) {
+		for (int i = 0; i < IMAGE_SIZE; i++) {
+			uint8_t r = next_random(&seed);
+			image[i] = pattern == 0 ? r :
+			           pattern == 1 ? 7 :
+			           pattern == 2 ? (i / 3) & 1 :
+			           (r % 4 == 0 ? r : 9);
+		}
+		for (size_t size = 0; size <= IMAGE_SIZE; size += size < 300 ? 1 : 997) {
+			size_t n = frame_link_rle_encode(image, size, coded);
+			HOST_TEST_EXPECT(n <= size + (size + 127) / 128);
+			HOST_TEST_EXPECT_EQ((int)size, frame_link_rle_decode(coded, n, roundtrip, size));
+			HOST_TEST_EXPECT(memcmp(image, roundtrip, size) == 0);
+		}
+	}
+	// Runs of one byte become two bytes per 128
+	memset(image, 3, IMAGE_SIZE);
+	HOST_TEST_EXPECT_EQ(IMAGE_SIZE / 128 * 2, frame_link_rle_encode(image, IMAGE_SIZE, coded));
+	// Truncated or overlong input is rejected
+	size_t n = frame_link_rle_encode(image, IMAGE_SIZE, coded);
+	HOST_TEST_EXPECT_EQ(-1, frame_link_rle_decode(coded, n - 1, roundtrip, IMAGE_SIZE));
+	HOST_TEST_EXPECT_EQ(-1, frame_link_rle_decode(coded, n, roundtrip, IMAGE_SIZE - 1));
+}
+
+HOST_TEST(ImagesAndScores) {
+	setup(1);
+	const enum frame_link_encoding encodings[] = {FRAME_LINK_RAW, FRAME_LINK_RLE,
+	                                              FRAME_LINK_DELTA, FRAME_LINK_DELTA};
+	for (int i = 0; i < 4; i++) {
+		fill_scene(i, 1);
+		HOST_TEST_EXPECT_EQ(0, frame_link_queue(&link, FRAME_LINK_IMAGE, image, IMAGE_SIZE,
+		                                        encodings[i]));
+		HOST_TEST_EXPECT_EQ(1, drain());
+		HOST_TEST_EXPECT_EQ(FRAME_LINK_IMAGE, dec.type);
+		HOST_TEST_EXPECT_EQ(2 * i, dec.seq);
+		HOST_TEST_EXPECT_EQ(IMAGE_SIZE, dec.data_size);
+		HOST_TEST_EXPECT(memcmp(image, dec.data, IMAGE_SIZE) == 0);
+
+		const int8_t scores[2] = {(int8_t)(i * 50 - 100), -3};
+		HOST_TEST_EXPECT_EQ(0, frame_link_queue(&link, FRAME_LINK_SCORES,
+		                                        (const uint8_t *)scores, 2, FRAME_LINK_RLE));
+		HOST_TEST_EXPECT_EQ(1, drain());
+		HOST_TEST_EXPECT_EQ(FRAME_LINK_SCORES, dec.type);
+		HOST_TEST_EXPECT_EQ(2 * i + 1, dec.seq);
+		HOST_TEST_EXPECT_EQ(2, dec.data_size);
+		HOST_TEST_EXPECT(memcmp(scores, dec.data, 2) == 0);
+	}
+	HOST_TEST_EXPECT_EQ(0, dec.lost);
+	HOST_TEST_EXPECT_EQ(0, dec.crc_errors);
+}
+
+HOST_TEST(CompressionPaysOff) {
+	setup(1);
+	size_t size;
+	// A noisy first image goes out RLE coded, the unchanged second one as a
+	// delta of a few bytes
+	fill_scene(1, 1);
+	frame_link_queue(&link, FRAME_LINK_IMAGE, image, IMAGE_SIZE, FRAME_LINK_DELTA);
+	const uint8_t *packet = frame_link_peek(&link, &size);
+	HOST_TEST_EXPECT_EQ(FRAME_LINK_RLE, packet[3]);
+	HOST_TEST_EXPECT(size < IMAGE_SIZE);
+	frame_link_pop(&link);
+	frame_link_queue(&link, FRAME_LINK_IMAGE, image, IMAGE_SIZE, FRAME_LINK_DELTA);
+	packet = frame_link_peek(&link, &size);
+	HOST_TEST_EXPECT_EQ(FRAME_LINK_DELTA, packet[3]);
+	HOST_TEST_EXPECT(size < 200);
+	frame_link_pop(&link);
+
+	// Random pixels do not compress and are sent raw
+	uint32_t seed = 5;
+	for (int i = 0; i < IMAGE_SIZE; i++) {
+		image[i] = next_random(&seed);
+	}
+	frame_link_queue(&link, FRAME_LINK_IMAGE, image, IMAGE_SIZE, FRAME_LINK_RLE);
+	packet = frame_link_peek(&link, &size);
+	HOST_TEST_EXPECT_EQ(FRAME_LINK_RAW, packet[3]);
+	HOST_TEST_EXPECT_EQ(FRAME_LINK_HEADER_SIZE + IMAGE_SIZE + FRAME_LINK_CRC_SIZE, size);
+}
+
+HOST_TEST(DeltaWithoutPreviousBuffer) {
+	setup(0);
+	fill_scene(2, 0);
+	for (int i = 0; i < 2; i++) {
+		frame_link_queue(&link, FRAME_LINK_IMAGE, image, IMAGE_SIZE, FRAME_LINK_DELTA);
+		size_t size;
+		HOST_TEST_EXPECT_EQ(FRAME_LINK_RLE, frame_link_peek(&link, &size)[3]);
+		HOST_TEST_EXPECT_EQ(1, drain());
+	}
+}
+
+HOST_TEST(RecoversFromLostPacket) {
+	setup(1);
+	int broken = 0, expected_lost = 1, recovered = 0;
+	for (int i = 0; i < 2 * FRAME_LINK_KEY_INTERVAL; i++) {
+		fill_scene(i % 3, 1);
+		frame_link_queue(&link, FRAME_LINK_IMAGE, image, IMAGE_SIZE, FRAME_LINK_DELTA);
+		size_t size;
+		const uint8_t *packet = frame_link_peek(&link, &size);
+		if (i == 3) {
+			// Lost on the wire
+			HOST_TEST_EXPECT_EQ(FRAME_LINK_DELTA, packet[3]);
+			frame_link_pop(&link);
+			broken = 1;
+			continue;
+		}
+		// Deltas cannot be decoded until the next key frame
+		if (packet[3] != FRAME_LINK_DELTA) {
+			recovered |= broken;
+			broken = 0;
+		}
+		expected_lost += broken;
+		HOST_TEST_EXPECT_EQ(!broken, drain());
+		if (!broken) {
+			HOST_TEST_EXPECT(memcmp(image, dec.data, IMAGE_SIZE) == 0);
+			HOST_TEST_EXPECT_EQ(i, dec.seq);
+		}
+	}
+	HOST_TEST_EXPECT(recovered);
+	HOST_TEST_EXPECT_EQ(expected_lost, dec.lost);
+}
+
+HOST_TEST(ResyncsAfterCorruption) {
+	setup(1);
+	const uint8_t scores[3] = {FRAME_LINK_SYNC0, FRAME_LINK_SYNC1, 42};
+	for (int i = 0; i < 3; i++) {
+		frame_link_queue(&link, FRAME_LINK_SCORES, scores, 3, FRAME_LINK_RAW);
+	}
+	int packets = 0;
+	// Noise before the first packet, and a flipped bit in the second
+	const uint8_t noise[] = {0x00, FRAME_LINK_SYNC0, 0x13, FRAME_LINK_SYNC0};
+	for (size_t i = 0; i < sizeof(noise); i++) {
+		packets += frame_link_decode(&dec, noise[i]);
+	}
+	for (int n = 0; n < 3; n++) {
+		size_t size;
+		const uint8_t *packet = frame_link_peek(&link, &size);
+		for (size_t i = 0; i < size; i++) {
+			packets += frame_link_decode(&dec, n == 1 && i == 12 ? packet[i] ^ 4 : packet[i]);
+		}
+		frame_link_pop(&link);
+	}
+	HOST_TEST_EXPECT_EQ(2, packets);
+	HOST_TEST_EXPECT_EQ(1, dec.crc_errors);
+	HOST_TEST_EXPECT_EQ(2, dec.seq);
+	HOST_TEST_EXPECT_EQ(1, dec.lost);
+	HOST_TEST_EXPECT(memcmp(scores, dec.data, 3) == 0);
+}
+
+HOST_TEST(QueueWrapsAndFills) {
+	setup(0);
+	uint32_t seed = 9;
+	for (int i = 0; i < IMAGE_SIZE; i++) {
+		image[i] = next_random(&seed);
+	}
+	// Room is reserved for the worst case, so three raw packets of this size
+	// fit behind each other but a fourth does not
+	const uint16_t part = 5000;
+	for (int i = 0; i < 3; i++) {
+		HOST_TEST_EXPECT_EQ(0, frame_link_queue(&link, FRAME_LINK_IMAGE, image, part,
+		                                        FRAME_LINK_RAW));
+	}
+	HOST_TEST_EXPECT_EQ(-1, frame_link_queue(&link, FRAME_LINK_IMAGE, image, part,
+	                                         FRAME_LINK_RAW));
+	HOST_TEST_EXPECT_EQ(1, link.dropped);
+	size_t size;
+	for (int i = 0; i < 2; i++) {
+		const uint8_t *packet = frame_link_peek(&link, &size);
+		for (size_t k = 0; k < size; k++) {
+			frame_link_decode(&dec, packet[k]);
+		}
+		frame_link_pop(&link);
+	}
+	// Wraps to the start of the buffer, in front of the packet still queued;
+	// with only one packet sent the gap there would be too short
+	HOST_TEST_EXPECT_EQ(0, frame_link_queue(&link, FRAME_LINK_IMAGE, image, part,
+	                                        FRAME_LINK_RAW));
+	HOST_TEST_EXPECT(frame_link_peek(&link, &size) != link.buf);
+	HOST_TEST_EXPECT_EQ(2, drain());
+	HOST_TEST_EXPECT(link.queue[3].start == 0);
+	HOST_TEST_EXPECT_EQ(3, dec.seq);
+	HOST_TEST_EXPECT(memcmp(image, dec.data, part) == 0);
+
+	// Small packets stop at the queue depth
+	for (int i = 0; i < FRAME_LINK_QUEUE_DEPTH; i++) {
+		HOST_TEST_EXPECT_EQ(0, frame_link_queue(&link, FRAME_LINK_SCORES, image, 2,
+		                                        FRAME_LINK_RAW));
+	}
+	HOST_TEST_EXPECT_EQ(-1, frame_link_queue(&link, FRAME_LINK_SCORES, image, 2,
+	                                         FRAME_LINK_RAW));
+	HOST_TEST_EXPECT_EQ(FRAME_LINK_QUEUE_DEPTH, drain());
+	HOST_TEST_EXPECT_EQ(0, dec.lost);
+}
+
+int main(void) {
+	HOST_TEST_RUN(Crc16);
+	HOST_TEST_RUN(RleRoundTrip);
+	HOST_TEST_RUN(ImagesAndScores);
+	HOST_TEST_RUN(CompressionPaysOff);
+	HOST_TEST_RUN(DeltaWithoutPreviousBuffer);
+	HOST_TEST_RUN(RecoversFromLostPacket);
+	HOST_TEST_RUN(ResyncsAfterCorruption);
+	HOST_TEST_RUN(QueueWrapsAndFills);
+	HOST_TEST_END();
+}
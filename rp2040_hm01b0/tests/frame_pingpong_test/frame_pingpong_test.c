@@ -0,0 +1,203 @@
+#include <string.h>
+#include <stdint.h>
+#include "frame_pingpong.h"
+#include "host_test.h"
+
+// Stand-in for the PIO state machine, its joined 8-entry RX FIFO and the
+// DMA channel draining it. sim_vsync() and sim_dma_irq() do what the VSYNC
+// and DMA interrupt handlers in arducam.c do on the hardware.
+#define FRAME_SIZE 64
+#define FIFO_DEPTH 8
+
+struct sim {
+	struct frame_pingpong pp;
+	uint8_t buf[2][FRAME_SIZE];
+	uint8_t fifo[FIFO_DEPTH];
+	int fifo_count;
+	int sm_enabled;
+	uint8_t *dma_write;
+	int dma_remaining;
+	int dma_busy;
+};
+
+static void sim_init(struct sim *s) {
+	memset(s, 0, sizeof(*s));
+	pingpong_init(&s->pp, s->buf[0], s->buf[1]);
+}
+
+static void sim_dma_irq(struct sim *s) {
+	s->sm_enabled = 0;
+	pingpong_frame_done(&s->pp);
+}
+
+static void sim_vsync(struct sim *s) {
+	s->sm_enabled = 0;
+	if (s->pp.capturing != PINGPONG_NONE) {
+		// dma_channel_abort() with the completion interrupt masked
+		s->dma_busy = 0;
+	}
+	int index = pingpong_frame_start(&s->pp);
+	if (index < 0) {
+		return;
+	}
+	s->fifo_count = 0;
+	s->dma_write = s->pp.buf[index];
+	s->dma_remaining = FRAME_SIZE;
+	s->dma_busy = 1;
+	s->sm_enabled = 1;
+}
+
+static void sim_dma_service(struct sim *s) {
+	while (s->dma_busy && s->fifo_count > 0) {
+		*s->dma_write++ = s->fifo[0];
+		memmove(s->fifo, s->fifo + 1, --s->fifo_count);
+		if (--s->dma_remaining == 0) {
+			s->dma_busy = 0;
+			sim_dma_irq(s);
+		}
+	}
+}
+
+static void sim_pixel(struct sim *s, uint8_t value) {
+	// With the state machine stopped, or the FIFO full, the sensor data
+	// is simply lost.
+	if (s->sm_enabled && s->fifo_count < FIFO_DEPTH) {
+		s->fifo[s->fifo_count++] = value;
+	}
+	sim_dma_service(s);
+}
+
+static void sim_frame(struct sim *s, uint8_t value) {
+	sim_vsync(s);
+	for (int i = 0; i < FRAME_SIZE; i++) {
+		sim_pixel(s, value);
+	}
+}
+
+static int frame_is(const uint8_t *frame, uint8_t value) {
+	for (int i = 0; i < FRAME_SIZE; i++) {
+		if (frame[i] != value) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+HOST_TEST(NoFrameBeforeFirstCompletion) {
+	static struct sim s;
+	sim_init(&s);
+	HOST_TEST_EXPECT(pingpong_acquire(&s.pp, NULL) == NULL);
+	sim_vsync(&s);
+	for (int i = 0; i < FRAME_SIZE / 2; i++) {
+		sim_pixel(&s, 1);
+	}
+	HOST_TEST_EXPECT(pingpong_acquire(&s.pp, NULL) == NULL);
+}
+
+HOST_TEST(ReturnsLatestCompletedFrame) {
+	static struct sim s;
+	sim_init(&s);
+	uint32_t seq = 0;
+	sim_frame(&s, 1);
+	sim_frame(&s, 2);
+	uint8_t *frame = pingpong_acquire(&s.pp, &seq);
+	HOST_TEST_EXPECT(frame != NULL);
+	HOST_TEST_EXPECT_EQ(seq, 2);
+	HOST_TEST_EXPECT(frame_is(frame, 2));
+	// Nothing newer yet, the same frame comes back
+	HOST_TEST_EXPECT(pingpong_acquire(&s.pp, &seq) == frame);
+	HOST_TEST_EXPECT_EQ(seq, 2);
+	HOST_TEST_EXPECT_EQ(s.pp.dropped, 0);
+}
+
+HOST_TEST(CaptureNeverOverwritesHeldFrame) {
+	static struct sim s;
+	sim_init(&s);
+	uint32_t seq = 0;
+	sim_frame(&s, 1);
+	uint8_t *held = pingpong_acquire(&s.pp, &seq);
+	HOST_TEST_EXPECT_EQ(seq, 1);
+
+	// Goes into the other buffer and becomes the latest frame
+	sim_frame(&s, 2);
+	HOST_TEST_EXPECT(frame_is(held, 1));
+	HOST_TEST_EXPECT_EQ(s.pp.completed, 2);
+
+	// Both buffers are busy: this one is skipped
+	sim_frame(&s, 3);
+	HOST_TEST_EXPECT(frame_is(held, 1));
+	HOST_TEST_EXPECT_EQ(s.pp.completed, 2);
+	HOST_TEST_EXPECT_EQ(s.pp.dropped, 1);
+
+	uint8_t *latest = pingpong_acquire(&s.pp, &seq);
+	HOST_TEST_EXPECT(latest != held);
+	HOST_TEST_EXPECT_EQ(seq, 2);
+	HOST_TEST_EXPECT(frame_is(latest, 2));
+
+	// The first buffer is free again
+	sim_frame(&s, 4);
+	HOST_TEST_EXPECT(frame_is(held, 4));
+	HOST_TEST_EXPECT(frame_is(latest, 2));
+}
+
+HOST_TEST(TruncatedFrameIsRestarted) {
+	static struct sim s;
+	sim_init(&s);
+	uint32_t seq = 0;
+	sim_vsync(&s);
+	for (int i = 0; i < FRAME_SIZE / 2; i++) {
+		sim_pixel(&s, 1);
+	}
+	sim_frame(&s, 2);
+	HOST_TEST_EXPECT_EQ(s.pp.dropped, 1);
+	HOST_TEST_EXPECT_EQ(s.pp.completed, 1);
+	uint8_t *frame = pingpong_acquire(&s.pp, &seq);
+	HOST_TEST_EXPECT_EQ(seq, 1);
+	HOST_TEST_EXPECT(frame_is(frame, 2));
+}
+
+HOST_TEST(ReaderInterleavedWithCapture) {
+	static struct sim s;
+	sim_init(&s);
+	uint32_t rng = 12345;
+	uint32_t last_seq = 0;
+	uint8_t *held = NULL;
+	uint8_t held_value = 0;
+	for (int n = 1; n <= 500; n++) {
+		sim_vsync(&s);
+		for (int i = 0; i < FRAME_SIZE; i++) {
+			sim_pixel(&s, (uint8_t)n);
+			rng = rng * 1103515245 + 12345;
+			if ((rng >> 16) % 23 != 0) {
+				continue;
+			}
+			if (held != NULL) {
+				// Untouched for as long as it was held
+				HOST_TEST_EXPECT(frame_is(held, held_value));
+				pingpong_release(&s.pp);
+				held = NULL;
+			} else {
+				uint32_t seq;
+				held = pingpong_acquire(&s.pp, &seq);
+				if (held != NULL) {
+					HOST_TEST_EXPECT(seq >= last_seq);
+					last_seq = seq;
+					held_value = held[0];
+					// Never a torn frame
+					HOST_TEST_EXPECT(frame_is(held, held_value));
+				}
+			}
+		}
+	}
+	HOST_TEST_EXPECT(last_seq > 0);
+	HOST_TEST_EXPECT_EQ(s.pp.completed + s.pp.dropped, 500);
+}
+
+int main(void) {
+	HOST_TEST_RUN(NoFrameBeforeFirstCompletion);
+	HOST_TEST_RUN(ReturnsLatestCompletedFrame);
+	HOST_TEST_RUN(CaptureNeverOverwritesHeldFrame);
+	HOST_TEST_RUN(TruncatedFrameIsRestarted);
+	HOST_TEST_RUN(ReaderInterleavedWithCapture);
+	HOST_TEST_END();
+}
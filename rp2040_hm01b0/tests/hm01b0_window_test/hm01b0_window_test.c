@@ -0,0 +1,121 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "hm01b0_window.h"
+#include "host_test.h"
+
+#define BINNED_SIZE (HM01B0_FRAME_SIZE / 2)
+
+static uint8_t frame[HM01B0_FRAME_SIZE][HM01B0_FRAME_SIZE];
+static uint8_t binned[BINNED_SIZE][BINNED_SIZE];
+
+static void fill_frame(uint32_t seed) {
+	for (int y = 0; y < HM01B0_FRAME_SIZE; y++) {
+		for (int x = 0; x < HM01B0_FRAME_SIZE; x++) {
+			seed = seed * 1103515245 + 12345;
+			frame[y][x] = seed >> 16;
+		}
+	}
+	// What the sensor sends with READOUT_X/Y at 0x03: 2x2 means
+	for (int y = 0; y < BINNED_SIZE; y++) {
+		for (int x = 0; x < BINNED_SIZE; x++) {
+			binned[y][x] = (frame[2 * y][2 * x] + frame[2 * y][2 * x + 1] +
+			                frame[2 * y + 1][2 * x] + frame[2 * y + 1][2 * x + 1] + 2) / 4;
+		}
+	}
+}
+
+// The pixel the PIO ROI keeps for output i, j of plan
+static uint8_t roi_pixel(const struct hm01b0_window_plan *plan, int i, int j) {
+	const int x = plan->x + i * plan->factor;
+	const int y = plan->y + j * plan->factor;
+	return plan->binning ? binned[y][x] : frame[y][x];
+}
+
+HOST_TEST(MainWindowBins) {
+	const struct hm01b0_window window = {.x = 67, .y = 66, .width = 96, .height = 96,
+	                                     .factor = 2};
+	struct hm01b0_window_plan plan;
+	HOST_TEST_EXPECT_EQ(0, hm01b0_window_plan(&window, &plan));
+	HOST_TEST_EXPECT(plan.binning);
+	HOST_TEST_EXPECT_EQ(33, plan.x);
+	HOST_TEST_EXPECT_EQ(33, plan.y);
+	HOST_TEST_EXPECT_EQ(96, plan.width);
+	HOST_TEST_EXPECT_EQ(96, plan.height);
+	HOST_TEST_EXPECT_EQ(1, plan.factor);
+	// 162 rows and the stock 54 lines of blanking
+	HOST_TEST_EXPECT_EQ(216, plan.frame_lines);
+}
+
+HOST_TEST(OddFactorsLeftToThePio) {
+	const struct hm01b0_window window = {.x = 17, .y = 18, .width = 96, .height = 96,
+	                                     .factor = 3};
+	struct hm01b0_window_plan plan;
+	HOST_TEST_EXPECT_EQ(0, hm01b0_window_plan(&window, &plan));
+	HOST_TEST_EXPECT(!plan.binning);
+	HOST_TEST_EXPECT_EQ(17, plan.x);
+	HOST_TEST_EXPECT_EQ(18, plan.y);
+	HOST_TEST_EXPECT_EQ(3, plan.factor);
+	HOST_TEST_EXPECT_EQ(HM01B0_FRAME_LINES, plan.frame_lines);
+	fill_frame(1);
+	for (int j = 0; j < window.height; j++) {
+		for (int i = 0; i < window.width; i++) {
+			HOST_TEST_EXPECT_EQ(frame[18 + 3 * j][17 + 3 * i], roi_pixel(&plan, i, j));
+		}
+	}
+}
+
+HOST_TEST(BinnedPixelsCoverTheWindow) {
+	fill_frame(2);
+	srand(3);
+	for (int n = 0; n < 2000; n++) {
+		struct hm01b0_window window;
+		window.factor = 2 * (1 + rand() % 4);
+		window.width = 1 + rand() % (HM01B0_FRAME_SIZE / window.factor);
+		window.height = 1 + rand() % (HM01B0_FRAME_SIZE / window.factor);
+		window.x = rand() % (HM01B0_FRAME_SIZE - window.width * window.factor + 1);
+		window.y = rand() % (HM01B0_FRAME_SIZE - window.height * window.factor + 1);
+		struct hm01b0_window_plan plan;
+		HOST_TEST_EXPECT_EQ(0, hm01b0_window_plan(&window, &plan));
+		HOST_TEST_EXPECT(plan.binning);
+		HOST_TEST_EXPECT_EQ(window.factor / 2, plan.factor);
+		// Inside the binned frame
+		HOST_TEST_EXPECT(plan.x + (plan.width - 1) * plan.factor < BINNED_SIZE);
+		HOST_TEST_EXPECT(plan.y + (plan.height - 1) * plan.factor < BINNED_SIZE);
+		for (int j = 0; j < window.height; j += 7) {
+			for (int i = 0; i < window.width; i += 7) {
+				// The binned pixel holds the requested one, or starts a
+				// sensor pixel before it when x or y is odd
+				const int x = window.x + i * window.factor;
+				const int y = window.y + j * window.factor;
+				const int bx = x / 2, by = y / 2;
+				HOST_TEST_EXPECT_EQ(bx, plan.x + i * plan.factor);
+				HOST_TEST_EXPECT_EQ(by, plan.y + j * plan.factor);
+				HOST_TEST_EXPECT_EQ(binned[by][bx], roi_pixel(&plan, i, j));
+			}
+		}
+	}
+}
+
+HOST_TEST(RejectsWindowsOutsideTheFrame) {
+	struct hm01b0_window_plan plan = {0};
+	struct hm01b0_window window = {.x = 0, .y = 0, .width = 162, .height = 162, .factor = 2};
+	HOST_TEST_EXPECT_EQ(0, hm01b0_window_plan(&window, &plan));
+	window.x = 1;
+	HOST_TEST_EXPECT_EQ(-1, hm01b0_window_plan(&window, &plan));
+	window.x = 0;
+	window.height = 163;
+	HOST_TEST_EXPECT_EQ(-1, hm01b0_window_plan(&window, &plan));
+	window.height = 0;
+	HOST_TEST_EXPECT_EQ(-1, hm01b0_window_plan(&window, &plan));
+	window.height = 1;
+	window.factor = 0;
+	HOST_TEST_EXPECT_EQ(-1, hm01b0_window_plan(&window, &plan));
+}
+
+int main(void) {
+	HOST_TEST_RUN(MainWindowBins);
+	HOST_TEST_RUN(OddFactorsLeftToThePio);
+	HOST_TEST_RUN(BinnedPixelsCoverTheWindow);
+	HOST_TEST_RUN(RejectsWindowsOutsideTheFrame);
+	HOST_TEST_END();
+}
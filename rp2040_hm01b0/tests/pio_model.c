@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pio_model.h"
+
+static int parse_reg(const char *s, enum pio_reg *reg) {
+	if (strcmp(s, "x") == 0) *reg = REG_X;
+	else if (strcmp(s, "y") == 0) *reg = REG_Y;
+	else if (strcmp(s, "osr") == 0) *reg = REG_OSR;
+	else if (strcmp(s, "isr") == 0) *reg = REG_ISR;
+	else if (strcmp(s, "null") == 0) *reg = REG_NULL;
+	else if (strcmp(s, "pins") == 0) *reg = REG_PINS;
+	else if (strcmp(s, "pindirs") == 0) *reg = REG_PINDIRS;
+	else return 0;
+	return 1;
+}
+
+// Takes the side-set and delay off the end of the operands, then
+// assembles what is left.
+static int parse_insn(char *line, const struct pio_program *prog, struct pio_insn *insn) {
+	char tok[8][32];
+	int n = 0;
+	memset(insn, 0, sizeof(*insn));
+	insn->side = -1;
+	for (char *p = line; *p; p++) {
+		if (*p == ',') *p = ' ';
+	}
+	for (char *s = strtok(line, " \t"); s != NULL; s = strtok(NULL, " \t")) {
+		if (n == 8 || strlen(s) >= sizeof(tok[0])) return 0;
+		strcpy(tok[n++], s);
+	}
+	while (n > 1) {
+		if (tok[n - 1][0] == '[') {
+			insn->delay = atoi(tok[n - 1] + 1);
+			n--;
+		} else if (n > 2 && strcmp(tok[n - 2], "side") == 0) {
+			insn->side = atoi(tok[n - 1]);
+			n -= 2;
+		} else {
+			break;
+		}
+	}
+	const int side_bits = prog->side_count + prog->side_opt;
+	if (insn->delay >= 1 << (5 - side_bits)) return 0;
+	if (insn->side >= 0 ? insn->side >= 1 << prog->side_count
+	                    : prog->side_count > 0 && !prog->side_opt) {
+		return 0;
+	}
+	const char *a = tok[0], *b = tok[1], *c = tok[2], *d = tok[3];
+	if (strcmp(a, "jmp") == 0 && n == 2) {
+		insn->op = OP_JMP;
+		strcpy(insn->label, b);
+	} else if (strcmp(a, "jmp") == 0 && n == 3) {
+		insn->op = OP_JMP;
+		if (strcmp(b, "!x") == 0) insn->cond = COND_NOT_X;
+		else if (strcmp(b, "x--") == 0) insn->cond = COND_X_DEC;
+		else if (strcmp(b, "!y") == 0) insn->cond = COND_NOT_Y;
+		else if (strcmp(b, "y--") == 0) insn->cond = COND_Y_DEC;
+		else return 0;
+		strcpy(insn->label, c);
+	} else if (strcmp(a, "wait") == 0 && n == 4 && strcmp(c, "pin") == 0) {
+		insn->op = OP_WAIT;
+		insn->polarity = atoi(b);
+		insn->index = atoi(d);
+	} else if (strcmp(a, "in") == 0 && n == 3 && strcmp(b, "pins") == 0) {
+		insn->op = OP_IN;
+		insn->index = atoi(c);
+	} else if (strcmp(a, "out") == 0 && n == 3) {
+		insn->op = OP_OUT;
+		insn->index = atoi(c);
+		return parse_reg(b, &insn->dst) && insn->dst != REG_OSR && insn->dst != REG_ISR &&
+		       insn->index >= 1 && insn->index <= 32;
+	} else if (strcmp(a, "push") == 0 && n == 2 && strcmp(b, "block") == 0) {
+		insn->op = OP_PUSH;
+	} else if (strcmp(a, "pull") == 0 && n == 2 && strcmp(b, "block") == 0) {
+		insn->op = OP_PULL;
+	} else if (strcmp(a, "mov") == 0 && n == 3) {
+		insn->op = OP_MOV;
+		return parse_reg(b, &insn->dst) && parse_reg(c, &insn->src) &&
+		       insn->dst <= REG_ISR && insn->src <= REG_NULL;
+	} else if (strcmp(a, "nop") == 0 && n == 1) {
+		// As pioasm assembles it
+		insn->op = OP_MOV;
+		insn->dst = REG_Y;
+		insn->src = REG_Y;
+	} else if (strcmp(a, "set") == 0 && n == 3) {
+		insn->op = OP_SET;
+		insn->index = atoi(c);
+		return parse_reg(b, &insn->dst) && insn->dst != REG_OSR && insn->dst != REG_ISR &&
+		       insn->dst != REG_NULL && insn->index < 32;
+	} else {
+		return 0;
+	}
+	return 1;
+}
+
+// .side_set <count> [opt] [pindirs]
+static int parse_side_set(char *s, struct pio_program *prog) {
+	for (char *t = strtok(s, " \t"); t != NULL; t = strtok(NULL, " \t")) {
+		if (strcmp(t, "opt") == 0) prog->side_opt = 1;
+		else if (strcmp(t, "pindirs") == 0) prog->side_pindirs = 1;
+		else if (prog->side_count == 0) prog->side_count = atoi(t);
+		else return 0;
+	}
+	return prog->side_count > 0 && prog->side_count + prog->side_opt <= 5;
+}
+
+int pio_load_program(const char *path, const char *name, struct pio_program *prog) {
+	FILE *f = fopen(path, "r");
+	if (f == NULL) {
+		printf("cannot open %s\n", path);
+		return 0;
+	}
+	memset(prog, 0, sizeof(*prog));
+	prog->wrap = -1;
+	char line[256];
+	int in_program = 0, in_sdk = 0, ok = 1;
+	while (ok && fgets(line, sizeof(line), f)) {
+		char *comment = strstr(line, "//");
+		if (comment) *comment = '\0';
+		if ((comment = strchr(line, ';'))) *comment = '\0';
+		char *s = line;
+		while (*s == ' ' || *s == '\t') s++;
+		for (char *e = s + strlen(s); e > s && (e[-1] == '\n' || e[-1] == ' ' ||
+		                                      e[-1] == '\t' || e[-1] == '\r');) {
+			*--e = '\0';
+		}
+		if (*s == '\0') continue;
+		if (in_sdk) {
+			in_sdk = strcmp(s, "%}") != 0;
+			continue;
+		}
+		if (*s == '%') {
+			in_sdk = 1;
+			continue;
+		}
+		if (strncmp(s, ".program ", 9) == 0) {
+			if (in_program) break;
+			in_program = strcmp(s + 9, name) == 0;
+			continue;
+		}
+		if (!in_program) continue;
+		if (strcmp(s, ".wrap_target") == 0) {
+			prog->wrap_target = prog->length;
+		} else if (strcmp(s, ".wrap") == 0) {
+			prog->wrap = prog->length - 1;
+		} else if (strncmp(s, ".side_set ", 10) == 0) {
+			ok = prog->length == 0 && parse_side_set(s + 10, prog);
+			if (!ok) printf("cannot assemble '.side_set %s'\n", s + 10);
+		} else if (s[strlen(s) - 1] == ':') {
+			s[strlen(s) - 1] = '\0';
+			if (strncmp(s, "public ", 7) == 0) s += 7;
+			strcpy(prog->labels[prog->label_count], s);
+			prog->label_at[prog->label_count++] = prog->length;
+		} else if (prog->length < PIO_MAX_PROGRAM) {
+			char copy[256];
+			strcpy(copy, s);
+			ok = parse_insn(s, prog, &prog->insn[prog->length++]);
+			if (!ok) printf("cannot assemble '%s'\n", copy);
+		} else {
+			ok = 0;
+			printf("%s is longer than %d instructions\n", name, PIO_MAX_PROGRAM);
+		}
+	}
+	fclose(f);
+	if (prog->wrap < 0) prog->wrap = prog->length - 1;
+	for (int i = 0; ok && i < prog->length; i++) {
+		struct pio_insn *insn = &prog->insn[i];
+		if (insn->op != OP_JMP) continue;
+		insn->target = pio_find_label(prog, insn->label);
+		ok = insn->target >= 0;
+	}
+	return ok && prog->length > 0;
+}
+
+int pio_find_label(const struct pio_program *prog, const char *label) {
+	for (int l = 0; l < prog->label_count; l++) {
+		if (strcmp(prog->labels[l], label) == 0) return prog->label_at[l];
+	}
+	return -1;
+}
+
+void pio_sm_init(struct pio_sm *sm, const struct pio_program *prog) {
+	memset(sm, 0, sizeof(*sm));
+	sm->prog = prog;
+	sm->pc = prog->wrap_target;
+}
+
+static void push(struct pio_sm *sm) {
+	if (sm->rx_count < sm->rx_size) sm->rx[sm->rx_count] = sm->isr;
+	sm->rx_count++;
+	sm->isr = 0;
+	sm->isr_count = 0;
+}
+
+static uint32_t shift_out(struct pio_sm *sm, int bits) {
+	const uint32_t v = bits == 32 ? sm->osr : sm->osr >> (32 - bits);
+	sm->osr = bits == 32 ? 0 : sm->osr << bits;
+	return v;
+}
+
+static void write_reg(struct pio_sm *sm, enum pio_reg reg, uint32_t v) {
+	if (reg == REG_X) sm->x = v;
+	else if (reg == REG_Y) sm->y = v;
+	else if (reg == REG_OSR) sm->osr = v;
+	else if (reg == REG_ISR) sm->isr = v, sm->isr_count = 0;
+	else if (reg == REG_PINS) sm->pins = v;
+	else if (reg == REG_PINDIRS) sm->pindirs = v;
+}
+
+void pio_sm_step(struct pio_sm *sm, uint32_t in_pins) {
+	if (sm->delay > 0) {
+		sm->delay--;
+		return;
+	}
+	const struct pio_program *prog = sm->prog;
+	const struct pio_insn *insn = &prog->insn[sm->pc];
+	// Side-set takes effect as the instruction starts, even if it stalls
+	if (insn->side >= 0) {
+		if (prog->side_pindirs) sm->side_pindirs = insn->side;
+		else sm->side_pins = insn->side;
+	}
+	int next = sm->pc == prog->wrap ? prog->wrap_target : sm->pc + 1;
+	int stalled = 0;
+	switch (insn->op) {
+	case OP_JMP: {
+		int taken = 1;
+		if (insn->cond == COND_NOT_X) taken = sm->x == 0;
+		else if (insn->cond == COND_X_DEC) taken = sm->x-- != 0;
+		else if (insn->cond == COND_NOT_Y) taken = sm->y == 0;
+		else if (insn->cond == COND_Y_DEC) taken = sm->y-- != 0;
+		if (taken) next = insn->target;
+		break;
+	}
+	case OP_WAIT:
+		stalled = ((in_pins >> insn->index) & 1) != (uint32_t)insn->polarity;
+		break;
+	case OP_IN: {
+		const uint32_t mask = insn->index == 32 ? ~0u : (1u << insn->index) - 1;
+		sm->isr = (insn->index == 32 ? 0 : sm->isr << insn->index) | (in_pins & mask);
+		sm->isr_count += insn->index;
+		if (sm->push_threshold && sm->isr_count >= sm->push_threshold) push(sm);
+		break;
+	}
+	case OP_OUT:
+		write_reg(sm, insn->dst, shift_out(sm, insn->index));
+		break;
+	case OP_PUSH:
+		push(sm);
+		break;
+	case OP_PULL:
+		if (sm->tx_next < sm->tx_count) sm->osr = sm->tx[sm->tx_next++];
+		else stalled = 1;
+		break;
+	case OP_MOV: {
+		const uint32_t v = insn->src == REG_X ? sm->x : insn->src == REG_Y ? sm->y :
+		                   insn->src == REG_OSR ? sm->osr : insn->src == REG_ISR ? sm->isr : 0;
+		write_reg(sm, insn->dst, v);
+		break;
+	}
+	case OP_SET:
+		write_reg(sm, insn->dst, insn->index);
+		break;
+	}
+	if (!stalled) {
+		sm->pc = next;
+		sm->delay = insn->delay;
+	}
+}
@@ -0,0 +1,83 @@
+#ifndef _PIO_MODEL__H
+#define _PIO_MODEL__H
+#include <stdint.h>
+
+// A cycle-level model of one PIO state machine, for running the programs
+// of the driver's .pio files on the development machine.
+//
+// Programs are assembled from the source by a small assembler that knows
+// only the instructions and directives those files use; anything else
+// fails to load.
+
+#define PIO_MAX_PROGRAM 32
+
+enum pio_op { OP_JMP, OP_WAIT, OP_IN, OP_OUT, OP_PUSH, OP_PULL, OP_MOV, OP_SET };
+enum pio_reg { REG_X, REG_Y, REG_OSR, REG_ISR, REG_NULL, REG_PINS, REG_PINDIRS };
+enum pio_cond { COND_ALWAYS, COND_NOT_X, COND_X_DEC, COND_NOT_Y, COND_Y_DEC };
+
+struct pio_insn {
+	enum pio_op op;
+	enum pio_cond cond;
+	char label[32];
+	int target;
+	int polarity;
+	// Pin of a wait, bit count of an in or out, value of a set
+	int index;
+	enum pio_reg dst;
+	enum pio_reg src;
+	int delay;
+	// -1 when the instruction has no side-set
+	int side;
+};
+
+struct pio_program {
+	struct pio_insn insn[PIO_MAX_PROGRAM];
+	int length;
+	int wrap_target;
+	int wrap;
+	// From .side_set: number of pins, whether optional, whether they are
+	// pin directions rather than values
+	int side_count;
+	int side_opt;
+	int side_pindirs;
+	char labels[PIO_MAX_PROGRAM][32];
+	int label_at[PIO_MAX_PROGRAM];
+	int label_count;
+};
+
+// Assembles program `name` from the file at path. Returns 0 on any error,
+// including delays that do not fit next to the side-set bits.
+int pio_load_program(const char *path, const char *name, struct pio_program *prog);
+// Index of a label in prog, or -1
+int pio_find_label(const struct pio_program *prog, const char *label);
+
+// State machine with both shift registers shifting left and no autopull.
+// The TX FIFO is fed from tx, as a DMA channel would, and a pull stalls
+// once it runs out; pushed words go to rx, which never fills up (words
+// past rx_size are counted but dropped).
+struct pio_sm {
+	const struct pio_program *prog;
+	int pc;
+	uint32_t x, y, osr, isr;
+	int isr_count;
+	// Cycles still to wait after the current instruction
+	int delay;
+	// Autopush after this many bits shifted in; 0 for none
+	int push_threshold;
+	// Outputs, relative to the out/set base and the side-set base
+	uint32_t pins;
+	uint32_t pindirs;
+	uint32_t side_pins;
+	uint32_t side_pindirs;
+	const uint32_t *tx;
+	int tx_count;
+	int tx_next;
+	uint32_t *rx;
+	int rx_size;
+	int rx_count;
+};
+
+void pio_sm_init(struct pio_sm *sm, const struct pio_program *prog);
+// Runs one clock cycle with in_pins as the pins from the in base up.
+void pio_sm_step(struct pio_sm *sm, uint32_t in_pins);
+#endif
@@ -0,0 +1,261 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "preprocess.h"
+#include "pio_model.h"
+#include "host_test.h"
+
+// Runs the programs in image.pio on a cycle-level model of one PIO state
+// machine, fed with the waveforms of a simulated HM01B0 on each of its
+// buses, and checks the captured bytes against the frame the sensor sent.
+
+#define FRAME_WIDTH 324
+#define FRAME_HEIGHT 324
+
+// Does to prog what arducam.c does before loading it for a bus of the
+// given width: the instruction at `sample` reads that many pins and the one
+// at `pixel_clocks`, if there is one, sets the clocks per pixel minus one.
+static int set_bus_width(struct pio_program *prog, int width) {
+	int patched = 0;
+	for (int l = 0; l < prog->label_count; l++) {
+		struct pio_insn *insn = &prog->insn[prog->label_at[l]];
+		if (strcmp(prog->labels[l], "sample") == 0 && insn->op == OP_IN) {
+			insn->index = width;
+			patched++;
+		} else if (strcmp(prog->labels[l], "pixel_clocks") == 0 && insn->op == OP_SET) {
+			insn->index = 8 / width - 1;
+		}
+	}
+	return patched == 1;
+}
+
+// A HM01B0 on a bus of 1, 4 or 8 data pins: a pixel takes 8 / width PCLKs,
+// most significant bits first, with HSYNC high while a line is sent. Data
+// and HSYNC change on the falling edge and are sampled on the rising one.
+struct sensor {
+	const uint8_t *frame;
+	int period;
+	int blank_clocks;
+	// Clocks of the previous frame's last line still to come when the state
+	// machine is enabled
+	int stale_clocks;
+	// 0 for the serial bus
+	int width;
+};
+
+enum { PIN_DATA = 0, PIN_PCLK = 8, PIN_HSYNC = 9 };
+
+static int bus_width(const struct sensor *s) {
+	return s->width != 0 ? s->width : 1;
+}
+
+static uint32_t sensor_pins(const struct sensor *s, long t) {
+	const int high = s->period / 2;
+	const uint32_t pclk = (t % s->period) < high;
+	const int width = bus_width(s);
+	const int clocks = 8 / width;
+	long slot = (t + s->period - high) / s->period;
+	if (slot < s->stale_clocks) {
+		return (pclk << PIN_PCLK) | (1u << PIN_HSYNC) | (slot & 0xA5);
+	}
+	slot -= s->stale_clocks + s->blank_clocks;
+	const long line_clocks = FRAME_WIDTH * clocks + s->blank_clocks;
+	if (slot < 0 || slot / line_clocks >= FRAME_HEIGHT ||
+	    slot % line_clocks >= FRAME_WIDTH * clocks) {
+		return pclk << PIN_PCLK;
+	}
+	const int clock = slot % line_clocks;
+	const uint8_t pixel = s->frame[slot / line_clocks * FRAME_WIDTH + clock / clocks];
+	const uint32_t data = (pixel >> (8 - width * (clock % clocks + 1))) & ((1u << width) - 1);
+	return (pclk << PIN_PCLK) | (1u << PIN_HSYNC) | data;
+}
+
+static long frame_cycles(const struct sensor *s) {
+	return ((long)s->stale_clocks + s->blank_clocks +
+	        (long)FRAME_HEIGHT * (FRAME_WIDTH * 8 / bus_width(s) + s->blank_clocks)) *
+	       s->period;
+}
+
+// Runs a whole frame through the program, with autopush after 8 bits
+// shifted left and a DMA that drains the RX FIFO as soon as a byte lands.
+// The TX FIFO is fed from tx_words, as the DMA in arducam.c does. Returns
+// the number of bytes captured.
+static int run(const struct pio_program *prog, const struct sensor *s, const uint32_t *tx_words,
+               int tx_count, uint8_t *out, int out_size) {
+	static uint32_t rx[FRAME_WIDTH * FRAME_HEIGHT + 1];
+	const int rx_len = (int)(sizeof(rx) / sizeof(rx[0]));
+	struct pio_sm sm;
+	pio_sm_init(&sm, prog);
+	sm.push_threshold = 8;
+	sm.tx = tx_words;
+	sm.tx_count = tx_count;
+	sm.rx = rx;
+	sm.rx_size = out_size < rx_len ? out_size : rx_len;
+	const long end = frame_cycles(s);
+	for (long t = 0; t < end; t++) {
+		pio_sm_step(&sm, sensor_pins(s, t));
+	}
+	for (int i = 0; i < sm.rx_count && i < sm.rx_size; i++) {
+		out[i] = rx[i];
+	}
+	return sm.rx_count;
+}
+
+static uint8_t frame[FRAME_WIDTH * FRAME_HEIGHT];
+static uint8_t captured[FRAME_WIDTH * FRAME_HEIGHT + 1];
+static int8_t expected[FRAME_WIDTH * FRAME_HEIGHT];
+static uint32_t tx_words[1 + 4 * FRAME_HEIGHT];
+
+static void fill_frame(uint32_t seed) {
+	for (int i = 0; i < FRAME_WIDTH * FRAME_HEIGHT; i++) {
+		seed = seed * 1103515245 + 12345;
+		frame[i] = seed >> 16;
+	}
+}
+
+// Captures the window with image_roi and compares it with what
+// preprocess_frame() makes of the full frame.
+static int captures_window(const struct sensor *s, int x, int y, int width, int height,
+                           int factor) {
+	struct pio_program prog;
+	if (!pio_load_program(IMAGE_PIO, "image_roi", &prog) ||
+	    !set_bus_width(&prog, bus_width(s))) {
+		return 0;
+	}
+	// The words arducam_set_roi() queues
+	const int clocks = 8 / bus_width(s);
+	int count = 0;
+	tx_words[count++] = y;
+	for (int row = 0; row < height; row++) {
+		tx_words[count++] = clocks * x;
+		tx_words[count++] = width - 1;
+		tx_words[count++] = clocks * (factor - 1);
+		tx_words[count++] = factor - 1;
+	}
+	const struct preprocess_config config = {
+		.src_stride = FRAME_WIDTH, .crop_x = x, .crop_y = y,
+		.out_width = width, .out_height = height,
+		.factor = factor, .mode = PREPROCESS_SUBSAMPLE, .zero_point = 0,
+	};
+	preprocess_frame(&config, s->frame, expected);
+	const int size = width * height;
+	const int bytes = run(&prog, s, tx_words, count, captured, sizeof(captured));
+	if (bytes != size) {
+		printf("captured %d bytes instead of %d\n", bytes, size);
+		return 0;
+	}
+	return memcmp(expected, captured, size) == 0;
+}
+
+HOST_TEST(FullFrameProgram) {
+	// Checks the model against the program that captures everything
+	struct pio_program prog;
+	HOST_TEST_EXPECT(pio_load_program(IMAGE_PIO, "image", &prog));
+	HOST_TEST_EXPECT_EQ(4, prog.length);
+	fill_frame(1);
+	const struct sensor s = {.frame = frame, .period = 10, .blank_clocks = 40};
+	HOST_TEST_EXPECT_EQ(FRAME_WIDTH * FRAME_HEIGHT,
+	                    run(&prog, &s, NULL, 0, captured, sizeof(captured)));
+	HOST_TEST_EXPECT(memcmp(frame, captured, sizeof(frame)) == 0);
+}
+
+HOST_TEST(FitsNextToFullFrameProgram) {
+	struct pio_program image, roi;
+	HOST_TEST_EXPECT(pio_load_program(IMAGE_PIO, "image", &image));
+	HOST_TEST_EXPECT(pio_load_program(IMAGE_PIO, "image_roi", &roi));
+	HOST_TEST_EXPECT(image.length + roi.length <= PIO_MAX_PROGRAM);
+}
+
+HOST_TEST(PersonDetectionWindow) {
+	const struct sensor s = {.frame = frame, .period = 10, .blank_clocks = 40};
+	for (uint32_t seed = 2; seed <= 3; seed++) {
+		fill_frame(seed);
+		HOST_TEST_EXPECT(captures_window(&s, 67, 66, 96, 96, 2));
+	}
+}
+
+HOST_TEST(WindowShapes) {
+	fill_frame(4);
+	const struct sensor s = {.frame = frame, .period = 10, .blank_clocks = 40};
+	// Top-left corner, whole lines, the bottom-right corner, the bottom-right
+	// pixel alone and a factor that leaves a remainder
+	HOST_TEST_EXPECT(captures_window(&s, 0, 0, 16, 8, 1));
+	HOST_TEST_EXPECT(captures_window(&s, 0, 5, FRAME_WIDTH, 3, 1));
+	HOST_TEST_EXPECT(captures_window(&s, FRAME_WIDTH - 192, FRAME_HEIGHT - 192, 96, 96, 2));
+	HOST_TEST_EXPECT(captures_window(&s, FRAME_WIDTH - 1, FRAME_HEIGHT - 1, 1, 1, 1));
+	HOST_TEST_EXPECT(captures_window(&s, 7, 1, 50, 40, 3));
+	HOST_TEST_EXPECT(captures_window(&s, 2, 0, 80, 80, 4));
+}
+
+HOST_TEST(StartsInsideALine) {
+	// Enabled while the last line of the previous frame is still being
+	// sent, with and without lines to drop at the top
+	fill_frame(5);
+	const struct sensor s = {.frame = frame, .period = 10, .blank_clocks = 40,
+	                         .stale_clocks = 1000};
+	HOST_TEST_EXPECT(captures_window(&s, 10, 0, 40, 20, 2));
+	HOST_TEST_EXPECT(captures_window(&s, 10, 3, 40, 20, 2));
+}
+
+HOST_TEST(KeepsUpWithFastPclk) {
+	// The fastest PCLK image.pio allows, with short blanking
+	fill_frame(6);
+	const struct sensor s = {.frame = frame, .period = 8, .blank_clocks = 8};
+	HOST_TEST_EXPECT(captures_window(&s, 3, 2, 100, 10, 1));
+	HOST_TEST_EXPECT(captures_window(&s, 3, 2, 100, 10, 2));
+}
+
+// Captures a whole frame with image on the sensor's bus.
+static int captures_frame(const struct sensor *s) {
+	struct pio_program prog;
+	if (!pio_load_program(IMAGE_PIO, "image", &prog) ||
+	    !set_bus_width(&prog, bus_width(s))) {
+		return 0;
+	}
+	const int bytes = run(&prog, s, NULL, 0, captured, sizeof(captured));
+	if (bytes != FRAME_WIDTH * FRAME_HEIGHT) {
+		printf("captured %d bytes instead of %d\n", bytes, FRAME_WIDTH * FRAME_HEIGHT);
+		return 0;
+	}
+	return memcmp(s->frame, captured, FRAME_WIDTH * FRAME_HEIGHT) == 0;
+}
+
+HOST_TEST(ParallelFullFrame) {
+	fill_frame(7);
+	for (int width = 4; width <= 8; width += 4) {
+		const struct sensor s = {.frame = frame, .period = 10, .blank_clocks = 40,
+		                         .width = width};
+		HOST_TEST_EXPECT(captures_frame(&s));
+	}
+	// The fastest PCLK the program keeps up with
+	const struct sensor fast = {.frame = frame, .period = 8, .blank_clocks = 8, .width = 8};
+	HOST_TEST_EXPECT(captures_frame(&fast));
+}
+
+HOST_TEST(ParallelWindows) {
+	fill_frame(8);
+	for (int width = 4; width <= 8; width += 4) {
+		const struct sensor s = {.frame = frame, .period = 12, .blank_clocks = 40,
+		                         .width = width};
+		HOST_TEST_EXPECT(captures_window(&s, 67, 66, 96, 96, 2));
+		HOST_TEST_EXPECT(captures_window(&s, 0, 5, FRAME_WIDTH, 3, 1));
+		HOST_TEST_EXPECT(captures_window(&s, FRAME_WIDTH - 1, FRAME_HEIGHT - 1, 1, 1, 1));
+		HOST_TEST_EXPECT(captures_window(&s, 7, 1, 50, 40, 3));
+		const struct sensor stale = {.frame = frame, .period = 12, .blank_clocks = 8,
+		                             .stale_clocks = 300, .width = width};
+		HOST_TEST_EXPECT(captures_window(&stale, 10, 3, 40, 20, 2));
+	}
+}
+
+int main(void) {
+	HOST_TEST_RUN(FullFrameProgram);
+	HOST_TEST_RUN(FitsNextToFullFrameProgram);
+	HOST_TEST_RUN(PersonDetectionWindow);
+	HOST_TEST_RUN(WindowShapes);
+	HOST_TEST_RUN(StartsInsideALine);
+	HOST_TEST_RUN(KeepsUpWithFastPclk);
+	HOST_TEST_RUN(ParallelFullFrame);
+	HOST_TEST_RUN(ParallelWindows);
+	HOST_TEST_END();
+}
@@ -0,0 +1,177 @@
+#include <stdint.h>
+#include <string.h>
+#include "preprocess.h"
+#include "host_test.h"
+
+#define RAW_SIZE 324
+
+static uint32_t raw_words[(RAW_SIZE * RAW_SIZE + 3) / 4];
+static uint8_t *const raw = (uint8_t *)raw_words;
+
+static void fill_raw(uint32_t seed) {
+	for (int i = 0; i < RAW_SIZE * RAW_SIZE; i++) {
+		seed = seed * 1103515245 + 12345;
+		raw[i] = seed >> 16;
+	}
+}
+
+// The pipeline this stage replaces: main.c picks every other column into
+// image_tmp, crops 96x96 out of it, then GetImage() subtracts 128.
+static void three_loop_pipeline(const uint8_t *image_buf, int8_t *image_data) {
+	static uint8_t image_tmp[162 * 324];
+	static uint8_t image[96 * 96];
+	uint16_t x = 0, y, index;
+	index = 0;
+	for (y = 0; y < 324; y++) {
+		for (x = (1 + x) % 2; x < 324; x += 2) {
+			image_tmp[index++] = image_buf[y * 324 + x];
+		}
+	}
+	index = 0;
+	for (y = 33; y < 129; y++) {
+		for (x = 33; x < 129; x++) {
+			image[index++] = image_tmp[y * 324 + x];
+		}
+	}
+	memcpy(image_data, image, sizeof(image));
+	for (int i = 0; i < 96 * 96; ++i) {
+		image_data[i] = (uint8_t)image_data[i] - 128;
+	}
+}
+
+static void reference(const struct preprocess_config *c, const uint8_t *src, int8_t *dst) {
+	for (int y = 0; y < c->out_height; y++) {
+		for (int x = 0; x < c->out_width; x++) {
+			const uint8_t *p = src + (c->crop_y + y * c->factor) * c->src_stride +
+			                   c->crop_x + x * c->factor;
+			int value = *p;
+			if (c->mode == PREPROCESS_AVERAGE) {
+				int sum = 0;
+				for (int j = 0; j < c->factor; j++) {
+					for (int i = 0; i < c->factor; i++) {
+						sum += p[j * c->src_stride + i];
+					}
+				}
+				int count = c->factor * c->factor;
+				value = (sum + count / 2) / count;
+			}
+			dst[y * c->out_width + x] = (int8_t)(uint8_t)(value - c->zero_point);
+		}
+	}
+}
+
+static int8_t expected[RAW_SIZE * RAW_SIZE];
+static int32_t actual_words[RAW_SIZE * RAW_SIZE / 4 + 1];
+static int8_t *const actual = (int8_t *)actual_words;
+
+static int matches_reference(const struct preprocess_config *c, const uint8_t *src, int8_t *dst) {
+	reference(c, src, expected);
+	preprocess_frame(c, src, dst);
+	return memcmp(expected, dst, c->out_width * c->out_height) == 0;
+}
+
+HOST_TEST(MatchesThreeLoopPipeline) {
+	const struct preprocess_config config = {
+		.src_stride = 324, .crop_x = 67, .crop_y = 66,
+		.out_width = 96, .out_height = 96,
+		.factor = 2, .mode = PREPROCESS_SUBSAMPLE, .zero_point = 128,
+	};
+	for (uint32_t seed = 1; seed <= 4; seed++) {
+		fill_raw(seed);
+		three_loop_pipeline(raw, expected);
+		preprocess_frame(&config, raw, actual);
+		HOST_TEST_EXPECT(memcmp(expected, actual, 96 * 96) == 0);
+	}
+}
+
+HOST_TEST(SubsampleFactors) {
+	fill_raw(7);
+	for (int factor = 1; factor <= 5; factor++) {
+		for (int crop_x = 0; crop_x < 4; crop_x++) {
+			struct preprocess_config config = {
+				.src_stride = 324, .crop_x = crop_x, .crop_y = 3,
+				.out_width = 320 / factor / 4 * 4, .out_height = 20,
+				.factor = factor, .mode = PREPROCESS_SUBSAMPLE, .zero_point = 128,
+			};
+			HOST_TEST_EXPECT(matches_reference(&config, raw, actual));
+		}
+	}
+}
+
+HOST_TEST(AverageFactors) {
+	fill_raw(11);
+	for (int factor = 1; factor <= 5; factor++) {
+		for (int crop_x = 0; crop_x < 4; crop_x++) {
+			struct preprocess_config config = {
+				.src_stride = 324, .crop_x = crop_x, .crop_y = 1,
+				.out_width = 320 / factor / 4 * 4, .out_height = 300 / factor,
+				.factor = factor, .mode = PREPROCESS_AVERAGE, .zero_point = 128,
+			};
+			HOST_TEST_EXPECT(matches_reference(&config, raw, actual));
+		}
+	}
+}
+
+HOST_TEST(ArbitraryZeroPoint) {
+	fill_raw(13);
+	const uint8_t zero_points[] = {0, 1, 37, 127, 128, 200, 255};
+	for (unsigned i = 0; i < sizeof(zero_points); i++) {
+		struct preprocess_config config = {
+			.src_stride = 324, .crop_x = 66, .crop_y = 66,
+			.out_width = 96, .out_height = 96,
+			.factor = 2, .mode = PREPROCESS_AVERAGE, .zero_point = zero_points[i],
+		};
+		HOST_TEST_EXPECT(matches_reference(&config, raw, actual));
+	}
+}
+
+HOST_TEST(WidthNotMultipleOfFour) {
+	fill_raw(17);
+	struct preprocess_config config = {
+		.src_stride = 324, .crop_x = 5, .crop_y = 9,
+		.out_width = 95, .out_height = 33,
+		.factor = 2, .mode = PREPROCESS_SUBSAMPLE, .zero_point = 128,
+	};
+	HOST_TEST_EXPECT(matches_reference(&config, raw, actual));
+	// Unaligned destination
+	HOST_TEST_EXPECT(matches_reference(&config, raw, actual + 1));
+}
+
+HOST_TEST(CropEndsAtFrameEnd) {
+	fill_raw(19);
+	struct preprocess_config config = {
+		.src_stride = 324, .crop_x = 324 - 192, .crop_y = 324 - 192,
+		.out_width = 96, .out_height = 96,
+		.factor = 2, .mode = PREPROCESS_AVERAGE, .zero_point = 128,
+	};
+	HOST_TEST_EXPECT(matches_reference(&config, raw, actual));
+}
+
+HOST_TEST(ZeroPointInPlace) {
+	fill_raw(23);
+	const uint8_t zero_points[] = {0, 128, 200};
+	for (unsigned i = 0; i < sizeof(zero_points); i++) {
+		// Aligned and unaligned starts, with a tail that is not a whole word
+		for (int offset = 0; offset < 4; offset++) {
+			const int size = 96 * 96 - 5;
+			memcpy(actual + offset, raw, size);
+			preprocess_zero_point(actual + offset, size, zero_points[i]);
+			int same = 1;
+			for (int n = 0; n < size; n++) {
+				same &= actual[offset + n] == (int8_t)(uint8_t)(raw[n] - zero_points[i]);
+			}
+			HOST_TEST_EXPECT(same);
+		}
+	}
+}
+
+int main(void) {
+	HOST_TEST_RUN(MatchesThreeLoopPipeline);
+	HOST_TEST_RUN(SubsampleFactors);
+	HOST_TEST_RUN(AverageFactors);
+	HOST_TEST_RUN(ArbitraryZeroPoint);
+	HOST_TEST_RUN(WidthNotMultipleOfFour);
+	HOST_TEST_RUN(CropEndsAtFrameEnd);
+	HOST_TEST_RUN(ZeroPointInPlace);
+	HOST_TEST_END();
+}
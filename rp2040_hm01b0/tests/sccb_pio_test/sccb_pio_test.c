@@ -0,0 +1,609 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "sccb_queue.h"
+#include "pio_model.h"
+#include "host_test.h"
+
+// Runs sccb.pio on the PIO model, wired to an open-drain bus with a HM01B0
+// behind it, and records the transactions on the bus the way a logic
+// analyser decodes them. The trace of each access is compared with the one
+// the bit-banged SOFTWARE_I2C bus recorded for the same access; that bus
+// is kept below, driving the same model through gpio_put() and friends.
+//
+// The bus is a wired AND: a line is low if anyone pulls it low. The state
+// machine clock is 28 times 400 kHz, as sccb_pio_init() sets it.
+#define SENSOR_ADDRESS 0x24
+#define SM_HZ (28 * 400000L)
+#define TRACE_SIZE 4096
+#define MAX_CMDS 256
+
+// A HM01B0: 16-bit register numbers, and a register pointer that moves on
+// with every byte written or read
+struct sensor {
+	uint8_t address;
+	uint8_t regs[0x10000];
+	uint16_t ptr;
+	// Bytes of the current write transaction so far, -1 outside of one
+	int written;
+	int reading;
+	int selected;
+	// SCL rising edges of the current byte
+	int bit;
+	uint8_t shift;
+	int drive_low;
+	int sda, scl;
+};
+
+// What the logic analyser saw, and the tightest timing it measured, in
+// ticks: state machine cycles, or microseconds on the old bus
+struct analyser {
+	char trace[TRACE_SIZE];
+	int bits;
+	uint32_t shift;
+	int sda, scl;
+	long now;
+	long scl_rise, scl_fall, start, stop;
+	long min_low, min_high, min_start_setup, min_start_hold, min_stop_setup, min_free;
+	long min_period;
+};
+
+static struct sensor sensor;
+static struct analyser an;
+// What the masters drive low, and the old bus's SDA pin
+static int master_sda_low, master_scl_low;
+static int siod_out, siod_value;
+
+static void trace_add(const char *token) {
+	if (strlen(an.trace) + strlen(token) + 2 < TRACE_SIZE) {
+		if (an.trace[0] != '\0') strcat(an.trace, " ");
+		strcat(an.trace, token);
+	}
+}
+
+static void keep_min(long *min, long value) {
+	if (*min < 0 || value < *min) *min = value;
+}
+
+static void analyser_reset(void) {
+	memset(&an, 0, sizeof(an));
+	an.sda = an.scl = 1;
+	an.scl_rise = an.scl_fall = an.start = an.stop = -1;
+	an.min_low = an.min_high = an.min_start_setup = an.min_start_hold = -1;
+	an.min_stop_setup = an.min_free = an.min_period = -1;
+}
+
+static void analyser_sample(int sda, int scl) {
+	if (scl && an.scl && sda != an.sda) {
+		if (!sda) {
+			trace_add("S");
+			an.bits = 0;
+			an.start = an.now;
+			if (an.stop >= 0) keep_min(&an.min_free, an.now - an.stop);
+			else if (an.scl_rise >= 0) keep_min(&an.min_start_setup, an.now - an.scl_rise);
+			an.stop = -1;
+		} else {
+			trace_add("P");
+			an.stop = an.now;
+			if (an.scl_rise >= 0) keep_min(&an.min_stop_setup, an.now - an.scl_rise);
+		}
+	}
+	if (scl && !an.scl) {
+		if (an.scl_fall >= 0) keep_min(&an.min_low, an.now - an.scl_fall);
+		if (an.scl_rise >= 0 && an.start < an.scl_rise) {
+			keep_min(&an.min_period, an.now - an.scl_rise);
+		}
+		an.scl_rise = an.now;
+		an.shift = (an.shift << 1) | sda;
+		if (++an.bits == 9) {
+			char token[8];
+			snprintf(token, sizeof(token), "%02X %c", (an.shift >> 1) & 0xFF,
+			         an.shift & 1 ? 'N' : 'A');
+			trace_add(token);
+			an.bits = 0;
+		}
+	}
+	if (!scl && an.scl) {
+		if (an.scl_rise >= 0) keep_min(&an.min_high, an.now - an.scl_rise);
+		if (an.start > an.scl_rise) keep_min(&an.min_start_hold, an.now - an.start);
+		an.scl_fall = an.now;
+	}
+	an.sda = sda;
+	an.scl = scl;
+}
+
+static void sensor_reset(void) {
+	memset(&sensor, 0, sizeof(sensor));
+	sensor.address = SENSOR_ADDRESS;
+	sensor.written = -1;
+	sensor.sda = sensor.scl = 1;
+}
+
+// Puts the next bit of the byte being read on SDA
+static void sensor_send_bit(void) {
+	sensor.drive_low = !((sensor.shift >> (7 - sensor.bit)) & 1);
+}
+
+static void sensor_byte(uint8_t byte) {
+	if (sensor.written == 0) {
+		sensor.selected = (byte >> 1) == sensor.address;
+		sensor.reading = sensor.selected && (byte & 1);
+	} else if (sensor.written == 1) {
+		sensor.ptr = (sensor.ptr & 0x00FF) | (byte << 8);
+	} else if (sensor.written == 2) {
+		sensor.ptr = (sensor.ptr & 0xFF00) | byte;
+	} else {
+		sensor.regs[sensor.ptr++] = byte;
+	}
+	sensor.written++;
+}
+
+static void sensor_sample(int sda, int scl) {
+	if (scl && sensor.scl && sda != sensor.sda) {
+		// START or STOP
+		sensor.written = sda ? -1 : 0;
+		sensor.selected = 0;
+		sensor.reading = 0;
+		sensor.bit = 0;
+		sensor.shift = 0;
+		sensor.drive_low = 0;
+	} else if (sensor.written >= 0 && scl && !sensor.scl) {
+		if (sensor.bit < 8 && !sensor.reading) {
+			sensor.shift = (sensor.shift << 1) | sda;
+		} else if (sensor.bit == 8 && sensor.reading && sda) {
+			// Not acknowledged: the master is done reading
+			sensor.written = -1;
+		}
+		sensor.bit++;
+	} else if (sensor.written >= 0 && !scl && sensor.scl) {
+		if (sensor.bit == 8) {
+			// Acknowledge the byte, or let the master acknowledge ours
+			if (sensor.reading) sensor.drive_low = 0;
+			else {
+				sensor_byte(sensor.shift);
+				sensor.drive_low = sensor.selected;
+			}
+		} else if (sensor.bit == 9) {
+			sensor.bit = 0;
+			sensor.drive_low = 0;
+			if (sensor.reading) {
+				sensor.shift = sensor.regs[sensor.ptr++];
+				sensor_send_bit();
+			}
+		} else if (sensor.reading && sensor.bit > 0) {
+			sensor_send_bit();
+		}
+	}
+	sensor.sda = sda;
+	sensor.scl = scl;
+}
+
+// One step of time: the sensor answers what the master did, then the
+// analyser looks at the lines
+static void bus_tick(void) {
+	int scl = !master_scl_low;
+	sensor_sample(!master_sda_low && !sensor.drive_low, scl);
+	analyser_sample(!master_sda_low && !sensor.drive_low, scl);
+	an.now++;
+}
+
+static int bus_sda(void) {
+	return !master_sda_low && !sensor.drive_low;
+}
+
+static void bus_reset(void) {
+	sensor_reset();
+	analyser_reset();
+	master_sda_low = master_scl_low = 0;
+	// As arducam_init() left the old bus
+	siod_out = 1;
+	siod_value = 1;
+}
+
+// The bit-banged bus from arducam.c, as it was. Every GPIO access and
+// every sleep_us() is a tick of 1 us.
+#define PIN_CAM_SIOC 5
+#define PIN_CAM_SIOD 4
+#define GPIO_IN 0
+#define GPIO_OUT 1
+
+static void gpio_put(int pin, int value) {
+	if (pin == PIN_CAM_SIOC) master_scl_low = !value;
+	else siod_value = value;
+	master_sda_low = siod_out && !siod_value;
+	bus_tick();
+}
+
+static void gpio_set_dir(int pin, int out) {
+	(void)pin;
+	siod_out = out;
+	master_sda_low = siod_out && !siod_value;
+	bus_tick();
+}
+
+static int gpio_get(int pin) {
+	(void)pin;
+	return bus_sda();
+}
+
+static void sleep_us(int us) {
+	for (int i = 0; i < (us > 0 ? us : 1); i++) bus_tick();
+}
+
+#define SCCB_SIC_H()      gpio_put(PIN_CAM_SIOC,1)
+#define SCCB_SIC_L()      gpio_put(PIN_CAM_SIOC,0)
+#define SCCB_SID_H()      gpio_put(PIN_CAM_SIOD,1)
+#define SCCB_SID_L()      gpio_put(PIN_CAM_SIOD,0)
+#define SCCB_DATA_IN      gpio_set_dir(PIN_CAM_SIOD, GPIO_IN);
+#define SCCB_DATA_OUT     gpio_set_dir(PIN_CAM_SIOD, GPIO_OUT);
+#define SCCB_SID_STATE    gpio_get(PIN_CAM_SIOD)
+static unsigned char I2C_TIM;
+
+static void sccb_bus_start(void) {
+	SCCB_SID_H();
+	sleep_us(I2C_TIM);
+	SCCB_SIC_H();
+	sleep_us(I2C_TIM);
+	SCCB_SID_L();
+	sleep_us(I2C_TIM);
+	SCCB_SIC_L();
+	sleep_us(I2C_TIM);
+}
+
+static void sccb_bus_stop(void) {
+	SCCB_SID_L();
+	sleep_us(I2C_TIM);
+	SCCB_SIC_H();
+	sleep_us(I2C_TIM);
+	SCCB_SID_H();
+	sleep_us(I2C_TIM);
+}
+
+static void sccb_bus_send_noack(void) {
+	SCCB_SID_H();
+	sleep_us(I2C_TIM);
+	SCCB_SIC_H();
+	sleep_us(I2C_TIM);
+	SCCB_SIC_L();
+	sleep_us(I2C_TIM);
+	SCCB_SID_L();
+	sleep_us(I2C_TIM);
+}
+
+static unsigned char sccb_bus_write_byte(unsigned char data) {
+	unsigned char i;
+	unsigned char tem;
+	for (i = 0; i < 8; i++) {
+		if ((data << i) & 0x80) {
+			SCCB_SID_H();
+		} else {
+			SCCB_SID_L();
+		}
+		sleep_us(I2C_TIM);
+		SCCB_SIC_H();
+		sleep_us(I2C_TIM);
+		SCCB_SIC_L();
+	}
+	SCCB_DATA_IN;
+	sleep_us(I2C_TIM);
+	SCCB_SIC_H();
+	sleep_us(I2C_TIM);
+	tem = SCCB_SID_STATE ? 0 : 1;
+	SCCB_SIC_L();
+	sleep_us(I2C_TIM);
+	SCCB_DATA_OUT;
+	return tem;
+}
+
+static unsigned char sccb_bus_read_byte(void) {
+	unsigned char i;
+	unsigned char read = 0;
+	SCCB_DATA_IN;
+	for (i = 8; i > 0; i--) {
+		sleep_us(I2C_TIM);
+		SCCB_SIC_H();
+		sleep_us(I2C_TIM);
+		read = read << 1;
+		if (SCCB_SID_STATE) {
+			read += 1;
+		}
+		SCCB_SIC_L();
+		sleep_us(I2C_TIM);
+	}
+	SCCB_DATA_OUT;
+	return read;
+}
+
+static unsigned char wrSensorReg16_8(uint8_t slave_address, int regID, int regDat) {
+	sccb_bus_start();
+	if (0 == sccb_bus_write_byte(slave_address << 1)) {
+		sccb_bus_stop();
+		return 0;
+	}
+	sleep_us(10);
+	if (0 == sccb_bus_write_byte(regID >> 8)) {
+		sccb_bus_stop();
+		return 0;
+	}
+	sleep_us(10);
+	if (0 == sccb_bus_write_byte(regID)) {
+		sccb_bus_stop();
+		return 0;
+	}
+	sleep_us(10);
+	if (0 == sccb_bus_write_byte(regDat)) {
+		sccb_bus_stop();
+		return 0;
+	}
+	sccb_bus_stop();
+	return 1;
+}
+
+static unsigned char rdSensorReg16_8(uint8_t slave_address, unsigned int regID,
+                                     unsigned char *regDat) {
+	sccb_bus_start();
+	if (0 == sccb_bus_write_byte(slave_address << 1)) {
+		sccb_bus_stop();
+		return 0;
+	}
+	sleep_us(40);
+	if (0 == sccb_bus_write_byte(regID >> 8)) {
+		sccb_bus_stop();
+		return 0;
+	}
+	sleep_us(20);
+	if (0 == sccb_bus_write_byte(regID)) {
+		sccb_bus_stop();
+		return 0;
+	}
+	sleep_us(20);
+	sccb_bus_stop();
+	sleep_us(20);
+	sccb_bus_start();
+	if (0 == sccb_bus_write_byte((slave_address << 1) | 0x01)) {
+		sccb_bus_stop();
+		return 0;
+	}
+	sleep_us(20);
+	*regDat = sccb_bus_read_byte();
+	sccb_bus_send_noack();
+	sccb_bus_stop();
+	return 1;
+}
+
+// The start of hm01b0_324x244
+static const struct {
+	uint16_t reg;
+	uint8_t val;
+} writes[] = {
+	{0x0103, 0x00}, {0x0100, 0x00}, {0x1003, 0x08}, {0x1007, 0x08},
+	{0x3044, 0x0A}, {0x3045, 0x00}, {0x3047, 0x0A}, {0x3050, 0xC0},
+	{0x3051, 0x42}, {0x3052, 0x50}, {0x3053, 0x00}, {0x3054, 0x03},
+};
+#define WRITE_COUNT (sizeof(writes) / sizeof(writes[0]))
+
+static char reference[TRACE_SIZE];
+static uint32_t rx[16];
+
+// Runs cmds through sccb.pio until the state machine is back at its pull
+// with nothing left. Returns the cycles it took, or -1.
+static long run(const uint32_t *cmds, int count, struct pio_sm *sm) {
+	static struct pio_program prog;
+	if (!pio_load_program(SCCB_PIO, "sccb", &prog)) {
+		return -1;
+	}
+	pio_sm_init(sm, &prog);
+	sm->tx = cmds;
+	sm->tx_count = count;
+	sm->rx = rx;
+	sm->rx_size = sizeof(rx) / sizeof(rx[0]);
+	const long start = an.now;
+	for (long limit = 0; limit < 1000000; limit++) {
+		if (sm->tx_next == count && sm->pc == prog.wrap_target && sm->delay == 0) {
+			return an.now - start;
+		}
+		pio_sm_step(sm, bus_sda());
+		master_sda_low = sm->pindirs & 1;
+		master_scl_low = sm->side_pindirs & 1;
+		bus_tick();
+	}
+	return -1;
+}
+
+static double ns(long cycles) {
+	return cycles * 1e9 / SM_HZ;
+}
+
+HOST_TEST(FitsInAPio) {
+	struct pio_program prog;
+	HOST_TEST_EXPECT(pio_load_program(SCCB_PIO, "sccb", &prog));
+	// pio0 is full with the image programs; sccb gets a PIO of its own
+	HOST_TEST_EXPECT(prog.length <= PIO_MAX_PROGRAM);
+	HOST_TEST_EXPECT(prog.side_pindirs && prog.side_opt);
+}
+
+// Records writes[] on the bit-banged bus into reference
+static int record_writes(void) {
+	bus_reset();
+	for (size_t i = 0; i < WRITE_COUNT; i++) {
+		if (!wrSensorReg16_8(SENSOR_ADDRESS, writes[i].reg, writes[i].val)) return 0;
+	}
+	strcpy(reference, an.trace);
+	return 1;
+}
+
+HOST_TEST(WritesMatchBitBangedTrace) {
+	HOST_TEST_EXPECT(record_writes());
+	HOST_TEST_EXPECT(strncmp(reference, "S 48 A 01 A 03 A 00 A P S 48 A 01 A 00 A 00 A P", 47)
+	                 == 0);
+
+	bus_reset();
+	memset(sensor.regs, 0xEE, sizeof(sensor.regs));
+	static uint32_t cmds[MAX_CMDS];
+	int count = 0;
+	for (size_t i = 0; i < WRITE_COUNT; i++) {
+		count += sccb_encode_reg_write(SENSOR_ADDRESS, writes[i].reg, 2, writes[i].val,
+		                               cmds + count);
+	}
+	struct pio_sm sm;
+	const long cycles = run(cmds, count, &sm);
+	HOST_TEST_EXPECT(cycles > 0);
+	HOST_TEST_EXPECT(strcmp(reference, an.trace) == 0);
+	if (strcmp(reference, an.trace) != 0) {
+		printf("bit-banged: %s\npio:        %s\n", reference, an.trace);
+	}
+	for (size_t i = 0; i < WRITE_COUNT; i++) {
+		HOST_TEST_EXPECT_EQ(writes[i].val, sensor.regs[writes[i].reg]);
+	}
+	// Writes push nothing, and the lines are released at the end
+	HOST_TEST_EXPECT_EQ(0, sm.rx_count);
+	HOST_TEST_EXPECT(!master_sda_low && !master_scl_low);
+	printf("%d writes in %.0f us\n", (int)WRITE_COUNT, ns(cycles) / 1000);
+}
+
+HOST_TEST(ReadMatchesBitBangedTrace) {
+	bus_reset();
+	sensor.regs[0x0000] = 0x01;
+	sensor.regs[0x3059] = 0x5A;
+	unsigned char value = 0;
+	HOST_TEST_EXPECT_EQ(1, rdSensorReg16_8(SENSOR_ADDRESS, 0x3059, &value));
+	HOST_TEST_EXPECT_EQ(0x5A, value);
+	strcpy(reference, an.trace);
+	HOST_TEST_EXPECT(strcmp(reference, "S 48 A 30 A 59 A P S 49 A 5A N P") == 0);
+
+	bus_reset();
+	sensor.regs[0x3059] = 0x5A;
+	uint32_t cmds[SCCB_MAX_COMMANDS];
+	const int count = sccb_encode_reg_read(SENSOR_ADDRESS, 0x3059, 2, cmds);
+	struct pio_sm sm;
+	HOST_TEST_EXPECT(run(cmds, count, &sm) > 0);
+	HOST_TEST_EXPECT(strcmp(reference, an.trace) == 0);
+	HOST_TEST_EXPECT_EQ(1, sm.rx_count);
+	HOST_TEST_EXPECT_EQ(0x5A, sccb_decode_read(rx[0]));
+	// The master's not-acknowledge is in bit 0
+	HOST_TEST_EXPECT_EQ(1, rx[0] & 1);
+}
+
+HOST_TEST(EightBitRegisters) {
+	// OV2640 style, at 0x30
+	uint32_t cmds[2 * SCCB_MAX_COMMANDS];
+	int count = sccb_encode_reg_write(0x30, 0x12, 1, 0x80, cmds);
+	HOST_TEST_EXPECT_EQ(3, count);
+	count += sccb_encode_reg_read(0x30, 0x0A, 1, cmds + count);
+	bus_reset();
+	struct pio_sm sm;
+	HOST_TEST_EXPECT(run(cmds, count, &sm) > 0);
+	// Nobody answers at 0x30
+	HOST_TEST_EXPECT(strcmp(an.trace, "S 60 N 12 N 80 N P S 60 N 0A N P S 61 N FF N P") == 0);
+	HOST_TEST_EXPECT_EQ(0xFF, sccb_decode_read(rx[0]));
+}
+
+HOST_TEST(MeetsFastModeTiming) {
+	bus_reset();
+	uint32_t cmds[3 * SCCB_MAX_COMMANDS];
+	int count = sccb_encode_reg_write(SENSOR_ADDRESS, 0x0104, 2, 0x01, cmds);
+	count += sccb_encode_reg_read(SENSOR_ADDRESS, 0x0104, 2, cmds + count);
+	// The same read with a repeated START instead of the STOP
+	count += sccb_encode_reg_read(SENSOR_ADDRESS, 0x0104, 2, cmds + count);
+	cmds[count - 3] &= ~SCCB_STOP;
+	struct pio_sm sm;
+	const long cycles = run(cmds, count, &sm);
+	HOST_TEST_EXPECT(cycles > 0);
+	HOST_TEST_EXPECT_EQ(2, sm.rx_count);
+	HOST_TEST_EXPECT_EQ(0x01, sccb_decode_read(rx[0]));
+	HOST_TEST_EXPECT_EQ(0x01, sccb_decode_read(rx[1]));
+	// I2C fast mode limits, in ns
+	HOST_TEST_EXPECT(ns(an.min_period) >= 2500);
+	HOST_TEST_EXPECT(ns(an.min_low) >= 1300);
+	HOST_TEST_EXPECT(ns(an.min_high) >= 600);
+	HOST_TEST_EXPECT(ns(an.min_start_setup) >= 600);
+	HOST_TEST_EXPECT(ns(an.min_start_hold) >= 600);
+	HOST_TEST_EXPECT(ns(an.min_stop_setup) >= 600);
+	HOST_TEST_EXPECT(ns(an.min_free) >= 1300);
+	// Every measure was taken
+	HOST_TEST_EXPECT(an.min_start_setup > 0 && an.min_free > 0);
+	// One bit every 28 cycles: 400 kHz
+	HOST_TEST_EXPECT_EQ(28, an.min_period);
+	printf("SCL low %.0f ns, high %.0f ns, bus free %.0f ns\n", ns(an.min_low),
+	       ns(an.min_high), ns(an.min_free));
+}
+
+HOST_TEST(QueueKeepsTransactionsWhole) {
+	static uint32_t buf[16];
+	struct sccb_queue queue;
+	sccb_queue_init(&queue, buf, 16);
+	uint32_t cmds[SCCB_MAX_COMMANDS];
+	const size_t count = sccb_encode_reg_write(SENSOR_ADDRESS, 0x0100, 2, 0x01, cmds);
+	HOST_TEST_EXPECT_EQ(4, count);
+	for (int i = 0; i < 4; i++) {
+		HOST_TEST_EXPECT_EQ(0, sccb_queue_push(&queue, cmds, count));
+	}
+	HOST_TEST_EXPECT_EQ(-1, sccb_queue_push(&queue, cmds, 1));
+	size_t n;
+	HOST_TEST_EXPECT(sccb_queue_peek(&queue, &n) == buf);
+	HOST_TEST_EXPECT_EQ(16, n);
+	sccb_queue_pop(&queue, 6);
+	// Too little room for a whole write until another one has gone out
+	HOST_TEST_EXPECT_EQ(6, sccb_queue_free(&queue));
+	const size_t read_count = sccb_encode_reg_read(SENSOR_ADDRESS, 0x0100, 2, cmds);
+	HOST_TEST_EXPECT_EQ(5, read_count);
+	HOST_TEST_EXPECT_EQ(0, sccb_queue_push(&queue, cmds, read_count));
+	HOST_TEST_EXPECT_EQ(-1, sccb_queue_push(&queue, cmds, 2));
+	// The rest of the buffer first, then what wrapped around
+	HOST_TEST_EXPECT(sccb_queue_peek(&queue, &n) == buf + 6);
+	HOST_TEST_EXPECT_EQ(10, n);
+	sccb_queue_pop(&queue, n);
+	HOST_TEST_EXPECT(sccb_queue_peek(&queue, &n) == buf);
+	HOST_TEST_EXPECT_EQ(5, n);
+	HOST_TEST_EXPECT(memcmp(buf, cmds, sizeof(uint32_t) * 5) == 0);
+	sccb_queue_pop(&queue, 100);
+	HOST_TEST_EXPECT(sccb_queue_peek(&queue, &n) == NULL);
+	HOST_TEST_EXPECT_EQ(16, sccb_queue_free(&queue));
+}
+
+HOST_TEST(QueueFeedsTheStateMachine) {
+	// What sccb_pio.c does: one DMA transfer per peek, then a pop
+	static uint32_t buf[8];
+	static uint32_t sent[MAX_CMDS];
+	struct sccb_queue queue;
+	sccb_queue_init(&queue, buf, 8);
+	int count = 0;
+	for (size_t i = 0; i < WRITE_COUNT; i++) {
+		uint32_t cmds[SCCB_MAX_COMMANDS];
+		const size_t n = sccb_encode_reg_write(SENSOR_ADDRESS, writes[i].reg, 2,
+		                                       writes[i].val, cmds);
+		while (sccb_queue_push(&queue, cmds, n) != 0) {
+			size_t run_count;
+			const uint32_t *run_cmds = sccb_queue_peek(&queue, &run_count);
+			memcpy(sent + count, run_cmds, run_count * sizeof(uint32_t));
+			count += run_count;
+			sccb_queue_pop(&queue, run_count);
+		}
+	}
+	size_t run_count;
+	const uint32_t *run_cmds;
+	while ((run_cmds = sccb_queue_peek(&queue, &run_count)) != NULL) {
+		memcpy(sent + count, run_cmds, run_count * sizeof(uint32_t));
+		count += run_count;
+		sccb_queue_pop(&queue, run_count);
+	}
+	HOST_TEST_EXPECT(record_writes());
+	bus_reset();
+	struct pio_sm sm;
+	HOST_TEST_EXPECT(run(sent, count, &sm) > 0);
+	for (size_t i = 0; i < WRITE_COUNT; i++) {
+		HOST_TEST_EXPECT_EQ(writes[i].val, sensor.regs[writes[i].reg]);
+	}
+	HOST_TEST_EXPECT(strcmp(reference, an.trace) == 0);
+}
+
+int main(void) {
+	HOST_TEST_RUN(FitsInAPio);
+	HOST_TEST_RUN(WritesMatchBitBangedTrace);
+	HOST_TEST_RUN(ReadMatchesBitBangedTrace);
+	HOST_TEST_RUN(EightBitRegisters);
+	HOST_TEST_RUN(MeetsFastModeTiming);
+	HOST_TEST_RUN(QueueKeepsTransactionsWhole);
+	HOST_TEST_RUN(QueueFeedsTheStateMachine);
+	HOST_TEST_END();
+}
@@ -1,8 +1,12 @@
 /* vim: set ai et ts=4 sw=4: */
+#include <string.h>
 #include "DEV_Config.h"
 #include "st7735.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
 
 #define DELAY 0x80
+#define ST7735_MAX_DIRTY 4
 
 // based on Adafruit ST7735 library for Arduino
 static const uint8_t
@@ -83,6 +87,36 @@ static const uint8_t
     ST7735_DISPON ,    DELAY, //  4: Main screen turn on, no args w/delay
       100 };                  //     100 ms delay
 
+// A region of the panel, from (x0, y0) up to but not including (x1, y1)
+typedef struct {
+    uint16_t x0, y0, x1, y1;
+} ST7735_Rect;
+
+// One run of pixels for the data channel. The control channel copies each
+// block into the data channel's alias 3 registers, transfer count and then
+// read address, which starts it; a NULL address ends the list instead and
+// raises the data channel's interrupt.
+typedef struct {
+    uint32_t count;
+    const uint16_t *addr;
+} ST7735_Block;
+
+// RGB565 pixels, row by row. They go out with the SPI in 16-bit mode, which
+// sends the high byte first as the panel expects.
+static uint16_t framebuffer[ST7735_WIDTH * ST7735_HEIGHT] __attribute__((aligned(4)));
+// Regions drawn since the last ST7735_Update()
+static ST7735_Rect dirty[ST7735_MAX_DIRTY];
+static uint8_t dirty_count = 0;
+// Regions the update in progress is sending, and the one on the wire
+static ST7735_Rect sending[ST7735_MAX_DIRTY];
+static uint8_t sending_count = 0;
+static uint8_t sending_index = 0;
+static volatile bool busy = false;
+// At most one block per row of a region, and the end of the list
+static ST7735_Block blocks[ST7735_HEIGHT + 1];
+static uint data_chan;
+static uint ctrl_chan;
+
 static void ST7735_Select() {
    // HAL_GPIO_WritePin(ST7735_CS_GPIO_Port, ST7735_CS_Pin, GPIO_PIN_RESET);
    DEV_Digital_Write(EPD_CS_PIN, 0);
@@ -155,6 +189,92 @@ static void ST7735_SetAddressWindow(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t
     ST7735_WriteCommand(ST7735_RAMWR);
 }
 
+static void ST7735_SetFormat(uint bits) {
+    // The FIFO must drain before DC changes or the frame size does
+    while(spi_is_busy(SPI_PORT))
+        tight_loop_contents();
+    spi_set_format(SPI_PORT, bits, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+}
+
+// Sets the address window for r and starts the DMA on its pixels.
+static void ST7735_StartRect(const ST7735_Rect *r) {
+    ST7735_SetFormat(8);
+    ST7735_SetAddressWindow(r->x0, r->y0, r->x1 - 1, r->y1 - 1);
+    DEV_Digital_Write(EPD_DC_PIN, 1);
+    ST7735_SetFormat(16);
+
+    uint16_t w = r->x1 - r->x0;
+    uint n = 0;
+    if(w == ST7735_WIDTH) {
+        // Full rows follow each other in the framebuffer
+        blocks[n].count = w * (r->y1 - r->y0);
+        blocks[n++].addr = &framebuffer[r->y0 * ST7735_WIDTH];
+    } else {
+        for(uint16_t y = r->y0; y < r->y1; y++) {
+            blocks[n].count = w;
+            blocks[n++].addr = &framebuffer[y * ST7735_WIDTH + r->x0];
+        }
+    }
+    blocks[n].count = 0;
+    blocks[n].addr = NULL;
+    dma_channel_set_read_addr(ctrl_chan, blocks, true);
+}
+
+static void ST7735_DmaIrq(void) {
+    if(!dma_channel_get_irq1_status(data_chan))
+        return;
+    dma_channel_acknowledge_irq1(data_chan);
+
+    if(++sending_index < sending_count) {
+        ST7735_StartRect(&sending[sending_index]);
+        return;
+    }
+    ST7735_SetFormat(8);
+    ST7735_Unselect();
+    busy = false;
+}
+
+static void ST7735_InitDma() {
+    data_chan = dma_claim_unused_channel(true);
+    ctrl_chan = dma_claim_unused_channel(true);
+
+    dma_channel_config c = dma_channel_get_default_config(ctrl_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    // Two words per block, wrapping back onto the same two registers
+    channel_config_set_ring(&c, true, 3);
+    dma_channel_configure(
+        ctrl_chan, &c,
+        &dma_hw->ch[data_chan].al3_transfer_count,
+        blocks,
+        2,
+        false
+    );
+
+    c = dma_channel_get_default_config(data_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi_get_dreq(SPI_PORT, true));
+    channel_config_set_chain_to(&c, ctrl_chan);
+    // Interrupt only at the end of the block list, not after every block
+    channel_config_set_irq_quiet(&c, true);
+    dma_channel_configure(
+        data_chan, &c,
+        &spi_get_hw(SPI_PORT)->dr,
+        NULL,
+        0,
+        false
+    );
+
+    dma_channel_acknowledge_irq1(data_chan);
+    dma_channel_set_irq1_enabled(data_chan, true);
+    irq_add_shared_handler(DMA_IRQ_1, ST7735_DmaIrq,
+                           PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+}
+
 void ST7735_Init() {
     DEV_Module_Init();
     ST7735_Select();
@@ -163,59 +283,107 @@ void ST7735_Init() {
     ST7735_ExecuteCommandList(init_cmds2);
     ST7735_ExecuteCommandList(init_cmds3);
     ST7735_Unselect();
+    ST7735_InitDma();
 }
 
-void ST7735_DrawPixel(uint16_t x, uint16_t y, uint16_t color) {
-    if((x >= ST7735_WIDTH) || (y >= ST7735_HEIGHT))
-        return;
-
-    ST7735_Select();
+bool ST7735_IsBusy(void) {
+    return busy;
+}
 
-    ST7735_SetAddressWindow(x, y, x+1, y+1);
-    uint8_t data[] = { color >> 8, color & 0xFF };
-    ST7735_WriteData(data, sizeof(data));
+void ST7735_WaitForUpdate(void) {
+    while(busy)
+        tight_loop_contents();
+}
 
-    ST7735_Unselect();
+uint16_t *ST7735_GetFramebuffer(void) {
+    return framebuffer;
 }
 
-static void ST7735_WriteChar(uint16_t x, uint16_t y, char ch, FontDef font, uint16_t color, uint16_t bgcolor) {
-    uint32_t i, b, j;
+static uint32_t ST7735_RectArea(const ST7735_Rect *r) {
+    return (uint32_t)(r->x1 - r->x0) * (r->y1 - r->y0);
+}
 
-    ST7735_SetAddressWindow(x, y, x+font.width-1, y+font.height-1);
+static ST7735_Rect ST7735_RectUnion(const ST7735_Rect *a, const ST7735_Rect *b) {
+    ST7735_Rect u = {
+        a->x0 < b->x0 ? a->x0 : b->x0,
+        a->y0 < b->y0 ? a->y0 : b->y0,
+        a->x1 > b->x1 ? a->x1 : b->x1,
+        a->y1 > b->y1 ? a->y1 : b->y1,
+    };
+    return u;
+}
 
-    for(i = 0; i < font.height; i++) {
-        b = font.data[(ch - 32) * font.height + i];
-        for(j = 0; j < font.width; j++) {
-            if((b << j) & 0x8000)  {
-                uint8_t data[] = { color >> 8, color & 0xFF };
-                ST7735_WriteData(data, sizeof(data));
-            } else {
-                uint8_t data[] = { bgcolor >> 8, bgcolor & 0xFF };
-                ST7735_WriteData(data, sizeof(data));
-            }
+void ST7735_Invalidate(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    // clipping
+    if((x >= ST7735_WIDTH) || (y >= ST7735_HEIGHT) || (w == 0) || (h == 0)) return;
+    if((x + w - 1) >= ST7735_WIDTH) w = ST7735_WIDTH - x;
+    if((y + h - 1) >= ST7735_HEIGHT) h = ST7735_HEIGHT - y;
+    ST7735_Rect r = { x, y, x + w, y + h };
+
+    // Join a region it overlaps or touches. Failing that, keep it apart
+    // while there is room, or else join the region that grows least.
+    int join = -1, best = 0;
+    uint32_t best_growth = UINT32_MAX;
+    for(int i = 0; i < dirty_count; i++) {
+        ST7735_Rect *d = &dirty[i];
+        if(r.x0 <= d->x1 && d->x0 <= r.x1 && r.y0 <= d->y1 && d->y0 <= r.y1) {
+            join = i;
+            break;
         }
+        ST7735_Rect u = ST7735_RectUnion(d, &r);
+        uint32_t growth = ST7735_RectArea(&u) - ST7735_RectArea(d);
+        if(growth < best_growth) {
+            best = i;
+            best_growth = growth;
+        }
+    }
+    if(join < 0 && dirty_count < ST7735_MAX_DIRTY) {
+        dirty[dirty_count++] = r;
+        return;
     }
+    if(join < 0)
+        join = best;
+    dirty[join] = ST7735_RectUnion(&dirty[join], &r);
 }
 
-/*
-Simpler (and probably slower) implementation:
+void ST7735_Update(void) {
+    ST7735_WaitForUpdate();
+    if(dirty_count == 0)
+        return;
+    memcpy(sending, dirty, dirty_count * sizeof(dirty[0]));
+    sending_count = dirty_count;
+    sending_index = 0;
+    dirty_count = 0;
+    busy = true;
+
+    ST7735_Select();
+    ST7735_StartRect(&sending[0]);
+}
+
+void ST7735_DrawPixel(uint16_t x, uint16_t y, uint16_t color) {
+    if((x >= ST7735_WIDTH) || (y >= ST7735_HEIGHT))
+        return;
+
+    ST7735_WaitForUpdate();
+    framebuffer[y * ST7735_WIDTH + x] = color;
+    ST7735_Invalidate(x, y, 1, 1);
+}
 
-static void ST7735_WriteChar(uint16_t x, uint16_t y, char ch, FontDef font, uint16_t color) {
+static void ST7735_WriteChar(uint16_t x, uint16_t y, char ch, FontDef font, uint16_t color, uint16_t bgcolor) {
     uint32_t i, b, j;
 
-    for(i = 0; i < font.height; i++) {
+    for(i = 0; i < font.height && y + i < ST7735_HEIGHT; i++) {
         b = font.data[(ch - 32) * font.height + i];
-        for(j = 0; j < font.width; j++) {
-            if((b << j) & 0x8000)  {
-                ST7735_DrawPixel(x + j, y + i, color);
-            } 
+        uint16_t *row = &framebuffer[(y + i) * ST7735_WIDTH + x];
+        for(j = 0; j < font.width && x + j < ST7735_WIDTH; j++) {
+            row[j] = ((b << j) & 0x8000) ? color : bgcolor;
         }
     }
+    ST7735_Invalidate(x, y, font.width, font.height);
 }
-*/
 
 void ST7735_WriteString(uint16_t x, uint16_t y, const char* str, FontDef font, uint16_t color, uint16_t bgcolor) {
-    ST7735_Select();
+    ST7735_WaitForUpdate();
 
     while(*str) {
         if(x + font.width >= ST7735_WIDTH) {
@@ -236,8 +404,6 @@ void ST7735_WriteString(uint16_t x, uint16_t y, const char* str, FontDef font, u
         x += font.width;
         str++;
     }
-
-    ST7735_Unselect();
 }
 
 void ST7735_FillRectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
@@ -246,21 +412,14 @@ void ST7735_FillRectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16
     if((x + w - 1) >= ST7735_WIDTH) w = ST7735_WIDTH - x;
     if((y + h - 1) >= ST7735_HEIGHT) h = ST7735_HEIGHT - y;
 
-    ST7735_Select();
-    ST7735_SetAddressWindow(x, y, x+w-1, y+h-1);
-
-    uint8_t data[] = { color >> 8, color & 0xFF };
-    //HAL_GPIO_WritePin(ST7735_DC_GPIO_Port, ST7735_DC_Pin, GPIO_PIN_SET);
-
-     DEV_Digital_Write(EPD_DC_PIN, 1);
-    for(y = h; y > 0; y--) {
-        for(x = w; x > 0; x--) {
-           // HAL_SPI_Transmit(&ST7735_SPI_PORT, data, sizeof(data), HAL_MAX_DELAY);
-            spi_write_blocking(SPI_PORT, data, sizeof(data));
+    ST7735_WaitForUpdate();
+    for(uint16_t i = 0; i < h; i++) {
+        uint16_t *row = &framebuffer[(y + i) * ST7735_WIDTH + x];
+        for(uint16_t j = 0; j < w; j++) {
+            row[j] = color;
         }
     }
-
-    ST7735_Unselect();
+    ST7735_Invalidate(x, y, w, h);
 }
 
 void ST7735_FillScreen(uint16_t color) {
@@ -268,16 +427,62 @@ void ST7735_FillScreen(uint16_t color) {
 }
 
 void ST7735_DrawImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t* data) {
-    ST7735_Select();
-    ST7735_SetAddressWindow(x, y, x+w-1, y+h-1);
-    ST7735_WriteData((uint8_t*)data, sizeof(uint16_t)*w*h);
-    ST7735_Unselect();
+    // clipping, keeping the stride of the source
+    if((x >= ST7735_WIDTH) || (y >= ST7735_HEIGHT)) return;
+    uint16_t cw = (x + w - 1) >= ST7735_WIDTH ? ST7735_WIDTH - x : w;
+    uint16_t ch = (y + h - 1) >= ST7735_HEIGHT ? ST7735_HEIGHT - y : h;
+
+    ST7735_WaitForUpdate();
+    for(uint16_t i = 0; i < ch; i++) {
+        const uint8_t *src = &data[i * w * 2];
+        uint16_t *row = &framebuffer[(y + i) * ST7735_WIDTH + x];
+        for(uint16_t j = 0; j < cw; j++) {
+            row[j] = (src[2 * j] << 8) | src[2 * j + 1];
+        }
+    }
+    ST7735_Invalidate(x, y, cw, ch);
 }
 
 void ST7735_InvertColors(bool invert) {
+    ST7735_WaitForUpdate();
     ST7735_Select();
     ST7735_WriteCommand(invert ? ST7735_INVON : ST7735_INVOFF);
     ST7735_Unselect();
 }
 
+// Colours are stored as they go in the framebuffer.
+static void ST7735_PaletteSet(ST7735_Palette *palette, uint8_t index, uint8_t r, uint8_t g, uint8_t b) {
+    uint16_t color = ST7735_COLOR565(r, g, b);
+    palette->color[index] = color;
+}
 
+void ST7735_PaletteGray(ST7735_Palette *palette, uint8_t offset) {
+    for(int i = 0; i < 256; i++) {
+        uint8_t v = i + offset;
+        ST7735_PaletteSet(palette, i, v, v, v);
+    }
+}
+
+void ST7735_PaletteHeat(ST7735_Palette *palette, uint8_t offset) {
+    for(int i = 0; i < 256; i++) {
+        int v = 3 * (uint8_t)(i + offset);
+        uint8_t r = v > 255 ? 255 : v;
+        uint8_t g = v > 510 ? 255 : (v > 255 ? v - 255 : 0);
+        uint8_t b = v > 510 ? v - 510 : 0;
+        ST7735_PaletteSet(palette, i, r, g, b);
+    }
+}
+
+void ST7735_ConvertImage(const ST7735_Palette *palette, const uint8_t *src, size_t step,
+                         uint16_t *dst, size_t count) {
+    const uint16_t *lut = palette->color;
+    uint32_t *out = (uint32_t *)dst;
+    size_t i;
+    // The first pixel goes in the low half of each little-endian word
+    for(i = 0; i + 1 < count; i += 2) {
+        *out++ = (uint32_t)lut[src[0]] | ((uint32_t)lut[src[step]] << 16);
+        src += 2 * step;
+    }
+    if(i < count)
+        dst[i] = lut[src[0]];
+}
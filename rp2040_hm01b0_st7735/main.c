@@ -2,11 +2,12 @@
 #include "pico/stdlib.h"
 #include <tusb.h>
 #include "pico/multicore.h"
+#include "hardware/dma.h"
 #include "arducam/arducam.h"
 #include "lib/st7735.h"
 #include "lib/fonts.h"
 uint8_t image_buf[324*324];
-uint8_t displayBuf[80*160*2];
+ST7735_Palette palette;
 uint8_t header[2] = {0x55,0xAA};
 
 #define FLAG_VALUE 123
@@ -24,8 +25,12 @@ void core1_entry() {
 	gpio_init(PIN_LED);
 	gpio_set_dir(PIN_LED, GPIO_OUT);
 
+	// The camera uses DMA channel 0, so the display must not claim it
+	dma_channel_claim(0);
 	ST7735_Init();
 	ST7735_DrawImage(0, 0, 80, 160, arducam_logo);
+	ST7735_Update();
+	ST7735_PaletteGray(&palette, 0);
 
 	struct arducam_config config;
 	config.sccb = i2c0;
@@ -46,20 +51,19 @@ void core1_entry() {
 	config.image_buf_size = sizeof(image_buf);
 
 	arducam_init(&config);
+	uint16_t *displayBuf = ST7735_GetFramebuffer();
 	while (true) {
 	  gpio_put(PIN_LED, !gpio_get(PIN_LED));
+	  // The previous frame is still going out to the panel meanwhile
 	  arducam_capture_frame(&config);
 
-	  uint16_t index = 0;
+	  ST7735_WaitForUpdate();
 	  for (int y = 0; y < 160; y++) {
-	    for (int x = 0; x < 80; x++) {
-              uint8_t c = image_buf[(2+320-2*y)*324+(2+40+2*x)];
-              uint16_t imageRGB   = ST7735_COLOR565(c, c, c);
-              displayBuf[index++] = (uint8_t)(imageRGB >> 8) & 0xFF;
-              displayBuf[index++] = (uint8_t)(imageRGB)&0xFF;
-            }
+	    // Every other pixel of the line, from the bottom of the frame up
+	    ST7735_ConvertImage(&palette, &image_buf[(2+320-2*y)*324+(2+40)], 2, &displayBuf[y*80], 80);
 	  }
-	  ST7735_DrawImage(0, 0, 80, 160, displayBuf);
+	  ST7735_Invalidate(0, 0, 80, 160);
+	  ST7735_Update();
 	}
 }
 
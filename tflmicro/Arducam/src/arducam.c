@@ -2,25 +2,38 @@
 #include <stdio.h>
 #include <string.h>
 #include "pico/stdlib.h"
+#include "hardware/dma.h"
 #include "hardware/i2c.h"
 #include "hardware/spi.h"
 #include "hardware/irq.h"
 #include "pico/binary_info.h"
 #include "arducam.h"
+#include "fifo_luma.h"
+#include "jpeg_thumb.h"
+#include "ov2640_window.h"
+#include "sensor_seq_i2c.h"
 #include "ov2640.h"
 
+// Claimed by picoSystemInit() for fifo_luma_read()
+static uint fifo_tx_channel;
+static uint fifo_rx_channel;
+// Register tables go through this, set up by picoSystemInit()
+static struct sensor_seq_bus sensor_bus;
+static struct sensor_seq_i2c sensor_port;
+
 // Define sensor slave address
 void picoSystemInit() {
-    // This example will use I2C0 on GPIO4 (SDA) and GPIO5 (SCL)
-    i2c_init(I2C_PORT, 100 * 1000);
+    // This example will use I2C0 on GPIO4 (SDA) and GPIO5 (SCL). SCCB
+    // runs at up to 400 kHz.
+    i2c_init(I2C_PORT, 400 * 1000);
     gpio_set_function(PIN_SDA, GPIO_FUNC_I2C);
     gpio_set_function(PIN_SCL, GPIO_FUNC_I2C);
     gpio_pull_up(PIN_SDA);
     gpio_pull_up(PIN_SCL);
     // Make the I2C pins available to picotool
     bi_decl(bi_2pins_with_func(PIN_SDA, PIN_SCL, GPIO_FUNC_I2C));
-    // This example will use SPI0 at 0.5MHz.
-    spi_init(SPI_PORT, 8 * 1000 * 1000);
+    // The ArduChip takes at most 8 MHz, which the divider turns into 7.8 MHz
+    spi_init(SPI_PORT, SPI_BAUDRATE);
     gpio_set_function(PIN_MISO, GPIO_FUNC_SPI);
     gpio_set_function(PIN_SCK, GPIO_FUNC_SPI);
     gpio_set_function(PIN_MOSI, GPIO_FUNC_SPI);
@@ -28,6 +41,10 @@ void picoSystemInit() {
     gpio_init(PIN_CS);
     gpio_set_dir(PIN_CS, GPIO_OUT);
     gpio_put(PIN_CS, 1);
+    fifo_tx_channel = dma_claim_unused_channel(true);
+    fifo_rx_channel = dma_claim_unused_channel(true);
+    sensor_seq_i2c_init(&sensor_bus, &sensor_port, I2C_PORT, arducam.slave_address,
+                        dma_claim_unused_channel(true));
 }
 
 //int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
@@ -77,19 +94,11 @@ uint8_t read_reg(uint8_t address) {
 }
 
 int wrSensorRegs8_8(const struct sensor_reg reglist[]) {
-    int err = 0;
-    unsigned int reg_addr = 0;
-    unsigned int reg_val = 0;
-    const struct sensor_reg *next = reglist;
-    while ((reg_addr != 0xff) | (reg_val != 0xff))
-    {
-        reg_addr = next->reg;
-        reg_val = next->val;
-        err = wrSensorReg8_8(reg_addr, reg_val);
-        sleep_ms(10);
-        next++;
-    }
-    return err;
+    return sensor_seq_write(&sensor_bus, reglist);
+}
+
+int verifySensorRegs8_8(const struct sensor_reg reglist[]) {
+    return sensor_seq_verify(&sensor_bus, reglist, 0xff);
 }
 
 unsigned char read_fifo(void) {
@@ -180,11 +189,18 @@ void OV2640_set_JPEG_size(unsigned char size) {
     }
 }
 
+int OV2640_set_window(const struct ov2640_window *window) {
+    struct sensor_reg regs[OV2640_WINDOW_REGS];
+    if (ov2640_window_regs(window, regs) != 0) {
+        return -1;
+    }
+    return wrSensorRegs8_8(regs);
+}
+
 void ov2640Init(uint8_t format) {
     switch (format) {
     case JPEG: {
-        wrSensorReg8_8(0xff, 0x01);
-        wrSensorReg8_8(0x12, 0x80);
+        wrSensorRegs8_8(OV2640_RESET);
         wrSensorRegs8_8(OV2640_JPEG_INIT);
         wrSensorRegs8_8(OV2640_YUV422);
         wrSensorRegs8_8(OV2640_JPEG);
@@ -194,17 +210,21 @@ void ov2640Init(uint8_t format) {
         break;
     }
     case RGB565: {
-        wrSensorReg8_8(0xff, 0x01);
-        wrSensorReg8_8(0x12, 0x80);
-        sleep_ms(100);
+        wrSensorRegs8_8(OV2640_RESET);
         wrSensorRegs8_8(OV2640_QVGA);
         break;
     }
     case YUV: {
-        wrSensorReg8_8(0xff, 0x01);
-        wrSensorReg8_8(0x12, 0x80);
-        sleep_ms(100);
+        wrSensorRegs8_8(OV2640_RESET);
         wrSensorRegs8_8(OV2640_YUV_96x96);
+        // The table squeezes the whole 4:3 frame into 96x96; scale the
+        // centre square instead, so people keep their proportions
+        const struct ov2640_window window = {
+            .in_width = 1600, .in_height = 1200,
+            .x = 200, .y = 0, .width = 1200, .height = 1200,
+            .out_width = 96, .out_height = 96,
+        };
+        OV2640_set_window(&window);
         break;
     }
     }
@@ -216,23 +236,51 @@ void ov2640Init(uint8_t format) {
 }
 
 void capture(uint8_t *imageDat) {
-    uint16_t i, count;
-    uint8_t value[96 * 96 * 2 + 8];
-    uint16_t index = 0;
     while (!get_bit(ARDUCHIP_TRIG, CAP_DONE_MASK));
     int length = read_fifo_length();
     // printf("the data length: %d\r\n",length);
     cs_select();
     set_fifo_burst(); //Set fifo burst mode
-    spi_read_blocking(SPI_PORT, BURST_FIFO_READ, value, length);
+    fifo_luma_read(SPI_PORT, fifo_tx_channel, fifo_rx_channel, imageDat,
+                   fifo_luma_count(length, CAPTURE_MAX_PIXELS));
     cs_deselect();
     //Flush the FIFO
     flush_fifo();
     //Start capture
     start_capture();
-    for (i = 0; i < length - 8; i += 2) {
-        imageDat[index++] = value[i];
-    }
+}
+
+// Hands the burst FIFO to jpeg_thumb_decode() a piece at a time
+#define THUMB_CHUNK 256
+struct fifo_source {
+    size_t left;
+    uint8_t chunk[THUMB_CHUNK];
+};
+
+static const uint8_t *fifo_fill(void *ctx, size_t *size) {
+    struct fifo_source *source = (struct fifo_source *)ctx;
+    *size = source->left < THUMB_CHUNK ? source->left : THUMB_CHUNK;
+    spi_read_blocking(SPI_PORT, BURST_FIFO_READ, source->chunk, *size);
+    source->left -= *size;
+    return source->chunk;
+}
+
+int capture_thumb(uint8_t *imageDat) {
+    static struct jpeg_thumb thumb;
+    static struct fifo_source source;
+    struct jpeg_thumb_fit fit = {imageDat, CAPTURE_THUMB_SIZE};
+    while (!get_bit(ARDUCHIP_TRIG, CAP_DONE_MASK));
+    source.left = read_fifo_length();
+    cs_select();
+    set_fifo_burst(); //Set fifo burst mode
+    int err = jpeg_thumb_decode(&thumb, CAPTURE_THUMB_SCALE, fifo_fill, &source,
+                                jpeg_thumb_fit_row, &fit);
+    cs_deselect();
+    //Flush the FIFO
+    flush_fifo();
+    //Start capture
+    start_capture();
+    return err;
 }
 
 uint8_t spiBusDetect(void) {
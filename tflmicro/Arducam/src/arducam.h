@@ -11,6 +11,7 @@ extern "C" {
 #define PIN_MOSI 3
 #define PIN_MISO 4
 #define PIN_CS   5
+#define SPI_BAUDRATE (8 * 1000 * 1000)
 
 #define JPEG   0
 #define RGB565 1
@@ -92,10 +93,28 @@ extern struct camera_operate arducam;
 extern uint8_t slave_addr;
 int rdSensorReg8_8(uint8_t regID, uint8_t* regDat );
 int wrSensorReg8_8(uint8_t regID, uint8_t regDat );
+// Writes a table, see sensor_seq.h. Returns 0, or -1 if a write was not
+// acknowledged.
 int wrSensorRegs8_8(const struct sensor_reg reglist[]);
+// Reads a written table back and returns how many registers differ
+int verifySensorRegs8_8(const struct sensor_reg reglist[]);
+struct ov2640_window;
+// Makes the sensor send only a crop of the frame, scaled to the output
+// size, see ov2640_window.h. Returns 0, or -1 if the window is not
+// possible or a write failed.
+int OV2640_set_window(const struct ov2640_window *window);
 void write_reg(uint8_t address, uint8_t value);
 uint8_t read_reg(uint8_t address);
+// Most bytes capture() writes: one Y per pixel of the 96x96 YUV frame
+#define CAPTURE_MAX_PIXELS (96 * 96)
 void capture(uint8_t *data);
+// Decodes the JPEG frame in the FIFO at CAPTURE_THUMB_SCALE, see
+// jpeg_thumb.h, and fits it to a CAPTURE_THUMB_SIZE square of gray
+// pixels. With the sensor in JPEG mode at 640x480 that is the centre of
+// a 160x120 thumbnail. Returns 0 or a JPEG_THUMB_ error.
+#define CAPTURE_THUMB_SCALE 4
+#define CAPTURE_THUMB_SIZE 96
+int capture_thumb(uint8_t *data);
 #endif
 
 #ifdef __cplusplus
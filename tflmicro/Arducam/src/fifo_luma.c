@@ -0,0 +1,49 @@
+#include "fifo_luma.h"
+#include "hardware/dma.h"
+
+// Clocked out while reading, as spi_read_blocking() did
+static const uint16_t fifo_luma_filler = 0x3C3C;
+
+size_t fifo_luma_count(size_t length, size_t capacity) {
+    size_t count = length > 8 ? (length - 8 + 1) / 2 : 0;
+    return count < capacity ? count : capacity;
+}
+
+void fifo_luma_read(spi_inst_t *spi, uint tx_channel, uint rx_channel, uint8_t *dst,
+                    size_t count) {
+    if (count == 0) {
+        return;
+    }
+    // Y in bits 15:8 and U or V in bits 7:0 of every frame
+    spi_set_format(spi, 16, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+
+    dma_channel_config c = dma_channel_get_default_config(tx_channel);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi_get_dreq(spi, true));
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    dma_channel_configure(
+        tx_channel, &c,
+        &spi_get_hw(spi)->dr,
+        &fifo_luma_filler,
+        count,
+        false
+    );
+
+    c = dma_channel_get_default_config(rx_channel);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, spi_get_dreq(spi, false));
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    dma_channel_configure(
+        rx_channel, &c,
+        dst,
+        (const uint8_t *)&spi_get_hw(spi)->dr + 1,
+        count,
+        false
+    );
+
+    dma_start_channel_mask((1u << tx_channel) | (1u << rx_channel));
+    dma_channel_wait_for_finish_blocking(rx_channel);
+    spi_set_format(spi, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+}
@@ -0,0 +1,29 @@
+#ifndef _FIFO_LUMA__H
+#define _FIFO_LUMA__H
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/spi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Reads the luma of a YUV422 frame out of the ArduChip burst FIFO. The
+// frame is sent Y U Y V ..., so the SPI is switched to 16-bit frames and
+// the RX DMA channel reads only the upper byte lane of the data register:
+// every Y lands in dst as it arrives and the chroma never leaves the SPI.
+// A second channel keeps the SPI clocking. No frame sized buffer is
+// needed and nothing is left for the CPU to convert.
+
+// Number of Y samples in a FIFO of length bytes. The ArduChip pads the
+// frame with 8 bytes, which are dropped; at most capacity are kept.
+size_t fifo_luma_count(size_t length, size_t capacity);
+// Reads count Y samples into dst. The caller has selected the chip and
+// sent BURST_FIFO_READ; the SPI is back in 8-bit mode on return.
+void fifo_luma_read(spi_inst_t *spi, uint tx_channel, uint rx_channel, uint8_t *dst,
+                    size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,146 @@
+#ifndef _FRAME_LINK__H
+#define _FRAME_LINK__H
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Framed protocol for streaming images and results to a host, and the
+// queue of encoded packets waiting to be sent. It has no hardware
+// dependencies: frame_link_uart.c feeds the queue to a DMA channel. The
+// same code is in rp2040_hm01b0; both copies have host tests under tests/;
+// person_detection_display/FrameDecoder.java decodes it on the host.
+//
+// A packet is, with multi-byte fields little endian:
+//   0xA5 0x5A                   sync
+//   u8  type                    FRAME_LINK_IMAGE, FRAME_LINK_SCORES, ...
+//   u8  encoding                how the payload is coded, see below
+//   u16 seq                     increments with every packet
+//   u16 length                  payload bytes as sent
+//   u16 raw_length              payload bytes after decoding
+//   payload
+//   u16 crc                     CRC-16/CCITT-FALSE from type to the end
+//                               of the payload
+//
+// Encodings:
+//   FRAME_LINK_RAW    the data itself
+//   FRAME_LINK_RLE    PackBits: a control byte n < 128 is followed by
+//                     n + 1 literal bytes, n > 128 by one byte repeated
+//                     257 - n times; 128 is not used
+//   FRAME_LINK_DELTA  u16 seq of the image the delta is against, then
+//                     the PackBits coded byte-wise difference (mod 256)
+//                     from that image
+// Only images are ever coded; other packets are always sent raw.
+
+#define FRAME_LINK_SYNC0 0xA5
+#define FRAME_LINK_SYNC1 0x5A
+#define FRAME_LINK_HEADER_SIZE 10
+#define FRAME_LINK_CRC_SIZE 2
+// Largest packet a payload of n bytes can turn into
+#define FRAME_LINK_PACKET_SIZE(n) \
+    (FRAME_LINK_HEADER_SIZE + 2 + (n) + ((n) + 127) / 128 + FRAME_LINK_CRC_SIZE)
+// Packets that can wait in the queue at the same time
+#define FRAME_LINK_QUEUE_DEPTH 4
+// Every this many images a delta coded stream sends one that is not, so
+// a host that lost a packet recovers
+#define FRAME_LINK_KEY_INTERVAL 16
+
+enum frame_link_type {
+    // 8-bit grayscale pixels, row by row
+    FRAME_LINK_IMAGE = 1,
+    // One int8 score per class
+    FRAME_LINK_SCORES = 2,
+};
+
+enum frame_link_encoding {
+    FRAME_LINK_RAW = 0,
+    FRAME_LINK_RLE = 1,
+    FRAME_LINK_DELTA = 2,
+};
+
+struct frame_link_packet {
+    uint32_t start;
+    uint32_t size;
+};
+
+// One producer queues packets and one consumer, typically an interrupt
+// handler, takes them off. Each side only writes its own counter, so no
+// locking is needed.
+struct frame_link {
+    uint8_t *buf;
+    size_t size;
+    struct frame_link_packet queue[FRAME_LINK_QUEUE_DEPTH];
+    // Packets queued and sent; the difference is the queue length
+    volatile uint8_t pushed;
+    volatile uint8_t popped;
+    uint16_t seq;
+    // Last image queued, for FRAME_LINK_DELTA; NULL when not used
+    uint8_t *prev;
+    size_t prev_size;
+    uint16_t prev_length;
+    uint16_t prev_seq;
+    uint8_t since_key;
+    // Packets dropped because the queue was full
+    volatile uint32_t dropped;
+};
+
+uint16_t frame_link_crc16(uint16_t crc, const uint8_t *data, size_t size);
+// PackBits codes src into dst, which must hold FRAME_LINK_PACKET_SIZE(size)
+// bytes. Returns the coded size.
+size_t frame_link_rle_encode(const uint8_t *src, size_t size, uint8_t *dst);
+// Returns the decoded size, or -1 if src is malformed or does not decode
+// to exactly capacity bytes.
+int frame_link_rle_decode(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity);
+
+// buf holds the queued packets. prev, of prev_size bytes, keeps the last
+// image for FRAME_LINK_DELTA and may be NULL, in which case images asked
+// to be delta coded are RLE coded instead.
+void frame_link_init(struct frame_link *link, uint8_t *buf, size_t size, uint8_t *prev,
+                     size_t prev_size);
+// Encodes data into a new packet at the end of the queue. Uses encoding,
+// unless the result would be larger than the data, in which case it is
+// sent raw. Returns 0, or -1 if the packet was dropped for lack of room.
+int frame_link_queue(struct frame_link *link, enum frame_link_type type, const uint8_t *data,
+                     uint16_t size, enum frame_link_encoding encoding);
+// The oldest queued packet, or NULL when the queue is empty. It stays
+// valid until frame_link_pop().
+const uint8_t *frame_link_peek(struct frame_link *link, size_t *size);
+void frame_link_pop(struct frame_link *link);
+
+// Finds packets in a byte stream. Decoded images are kept in image so that
+// delta coded ones can be applied to them.
+struct frame_link_decoder {
+    uint8_t *buf;
+    size_t size;
+    uint8_t *image;
+    size_t image_size;
+    size_t fill;
+    uint16_t image_seq;
+    uint8_t image_valid;
+    uint16_t next_seq;
+    uint8_t synced;
+    // Set by frame_link_decode() for each packet it returns
+    uint8_t type;
+    uint16_t seq;
+    const uint8_t *data;
+    size_t data_size;
+    // Packets whose CRC did not match, and packets that could not be
+    // decoded or that were missing from the sequence
+    uint32_t crc_errors;
+    uint32_t lost;
+};
+
+// buf holds one packet as sent, so FRAME_LINK_PACKET_SIZE() of the largest
+// payload; image holds the largest image.
+void frame_link_decoder_init(struct frame_link_decoder *dec, uint8_t *buf, size_t size,
+                             uint8_t *image, size_t image_size);
+// Consumes one byte. Returns 1 when it completed a good packet, which is
+// then described by dec->type, seq, data and data_size until the next call.
+int frame_link_decode(struct frame_link_decoder *dec, uint8_t byte);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
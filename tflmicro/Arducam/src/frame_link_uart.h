@@ -0,0 +1,26 @@
+#ifndef _FRAME_LINK_UART__H
+#define _FRAME_LINK_UART__H
+#include <stdbool.h>
+#include "hardware/uart.h"
+#include "frame_link.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sends frame_link packets over a UART with a DMA channel. Queuing a packet
+// costs only its encoding; the transfer then overlaps with whatever the
+// application does next. Completion is handled on DMA_IRQ_1, which may be
+// shared with other handlers. There is a single link per application.
+void frame_link_uart_init(struct frame_link *link, uart_inst_t *uart, uint dma_channel);
+// frame_link_queue(), then starts sending if the UART was idle. Returns -1
+// if the packet was dropped because the queue was full.
+int frame_link_uart_send(enum frame_link_type type, const uint8_t *data, uint16_t size,
+                         enum frame_link_encoding encoding);
+// True while packets are queued or being sent
+bool frame_link_uart_busy(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,576 @@
+#include "jpeg_thumb.h"
+#include <string.h>
+
+// Where each coefficient, in zigzag order, goes in the 5x5 block of the
+// terms a 1/4 pixel takes (rows and columns 0, 1, 3, 5 and 7), or 0xff
+#define JPEG_THUMB_DROP 0xff
+static const uint8_t jpeg_thumb_slot[64] = {
+    0, 1, 5, 0xff, 6, 0xff, 2, 0xff, 0xff, 10, 0xff, 11, 0xff, 7, 0xff, 3,
+    0xff, 0xff, 0xff, 0xff, 15, 0xff, 16, 0xff, 12, 0xff, 8, 0xff, 4, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 20, 21, 0xff, 17, 0xff, 13, 0xff, 9, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 22, 0xff, 18, 0xff, 14, 0xff, 0xff, 0xff, 0xff, 23, 0xff, 19, 0xff, 0xff, 24,
+};
+
+// The mean of cos((2x + 1)u pi / 16) over x = 0..3, times sqrt(2), for
+// u = 0, 1, 3, 5, 7, in 13-bit fixed point. Over x = 4..7 the odd terms
+// change sign.
+#define JPEG_THUMB_CONST_BITS 13
+// Bits kept between the two passes
+#define JPEG_THUMB_PASS1_BITS 2
+static const int32_t jpeg_thumb_quarter[5] = {8192, 7423, -2607, 1742, -1477};
+
+// Largest dequantized coefficient kept; more than any 8-bit image gives,
+// and small enough that the 1/4 sums stay in 32 bits
+#define JPEG_THUMB_MAX_COEF 4095
+
+static int jpeg_thumb_next_byte(struct jpeg_thumb *t) {
+    if (!t->left) {
+        t->data = t->fill(t->fill_ctx, &t->left);
+        if (!t->data || !t->left) {
+            t->left = 0;
+            t->truncated = true;
+            return -1;
+        }
+    }
+    t->left--;
+    return *t->data++;
+}
+
+static int jpeg_thumb_read_u16(struct jpeg_thumb *t) {
+    const int high = jpeg_thumb_next_byte(t);
+    const int low = jpeg_thumb_next_byte(t);
+    return high < 0 || low < 0 ? -1 : high << 8 | low;
+}
+
+static int jpeg_thumb_skip(struct jpeg_thumb *t, size_t count) {
+    while (count) {
+        if (!t->left) {
+            // Pulls in the next piece
+            if (jpeg_thumb_next_byte(t) < 0) {
+                return JPEG_THUMB_TRUNCATED;
+            }
+            count--;
+            continue;
+        }
+        const size_t step = count < t->left ? count : t->left;
+        t->data += step;
+        t->left -= step;
+        count -= step;
+    }
+    return JPEG_THUMB_OK;
+}
+
+// Tops the bit buffer up to more than 24 bits. Stuffed zero bytes are
+// dropped; at a marker, or the end of the source, zeros are fed instead.
+static void jpeg_thumb_fill_bits(struct jpeg_thumb *t) {
+    while (t->bit_count <= 24) {
+        int byte = 0;
+        if (!t->marker) {
+            byte = jpeg_thumb_next_byte(t);
+            if (byte == 0xFF) {
+                int next;
+                do {
+                    next = jpeg_thumb_next_byte(t);
+                } while (next == 0xFF);
+                if (next != 0) {
+                    // The end of the source stands in for an EOI
+                    t->marker = next < 0 ? 0xD9 : next;
+                    byte = 0;
+                }
+            } else if (byte < 0) {
+                t->marker = 0xD9;
+                byte = 0;
+            }
+        }
+        t->bits |= (uint32_t)byte << (24 - t->bit_count);
+        t->bit_count += 8;
+    }
+}
+
+static uint32_t jpeg_thumb_get_bits(struct jpeg_thumb *t, int count) {
+    if (count == 0) {
+        return 0;
+    }
+    if (t->bit_count < count) {
+        jpeg_thumb_fill_bits(t);
+    }
+    const uint32_t value = t->bits >> (32 - count);
+    t->bits <<= count;
+    t->bit_count -= count;
+    return value;
+}
+
+// The value of a count bit magnitude, sign in its top bit
+static int32_t jpeg_thumb_extend(uint32_t value, int count) {
+    return value < (1u << (count - 1)) ? (int32_t)value - (1 << count) + 1 : (int32_t)value;
+}
+
+static int jpeg_thumb_decode_huffman(struct jpeg_thumb *t, const struct jpeg_thumb_huffman *h) {
+    jpeg_thumb_fill_bits(t);
+    const uint16_t fast = h->fast[t->bits >> 24];
+    if (fast) {
+        jpeg_thumb_get_bits(t, fast >> 8);
+        return fast & 0xff;
+    }
+    const uint32_t code = t->bits >> 16;
+    for (int length = 9; length <= 16; length++) {
+        if (code < h->max_code[length]) {
+            jpeg_thumb_get_bits(t, length);
+            return h->values[(code >> (16 - length)) + h->offset[length]];
+        }
+    }
+    return -1;
+}
+
+static int jpeg_thumb_build_huffman(struct jpeg_thumb_huffman *h, const uint8_t counts[16]) {
+    uint32_t code = 0;
+    int index = 0;
+    memset(h->fast, 0, sizeof(h->fast));
+    for (int length = 1; length <= 16; length++) {
+        h->offset[length] = index - (int32_t)code;
+        for (int i = 0; i < counts[length - 1]; i++, index++, code++) {
+            if (length <= 8) {
+                const uint32_t first = code << (8 - length);
+                for (uint32_t fill = 0; fill < 1u << (8 - length); fill++) {
+                    h->fast[first + fill] = (uint16_t)(length << 8 | h->values[index]);
+                }
+            }
+        }
+        if (code > 1u << length) {
+            return JPEG_THUMB_CORRUPT;
+        }
+        h->max_code[length] = code << (16 - length);
+        code <<= 1;
+    }
+    h->max_code[17] = UINT32_MAX;
+    h->set = true;
+    return JPEG_THUMB_OK;
+}
+
+static int jpeg_thumb_read_dht(struct jpeg_thumb *t, int length) {
+    while (length > 0) {
+        const int table = jpeg_thumb_next_byte(t);
+        uint8_t counts[16];
+        int total = 0;
+        for (int i = 0; i < 16; i++) {
+            const int count = jpeg_thumb_next_byte(t);
+            counts[i] = (uint8_t)count;
+            total += counts[i];
+        }
+        if (t->truncated) {
+            return JPEG_THUMB_TRUNCATED;
+        }
+        if ((table & 0x0f) > 1 || (table >> 4) > 1) {
+            return (table >> 4) > 1 ? JPEG_THUMB_CORRUPT : JPEG_THUMB_UNSUPPORTED;
+        }
+        if (total > 256 || 17 + total > length) {
+            return JPEG_THUMB_CORRUPT;
+        }
+        struct jpeg_thumb_huffman *h = table >> 4 ? &t->ac[table & 1] : &t->dc[table & 1];
+        for (int i = 0; i < total; i++) {
+            h->values[i] = (uint8_t)jpeg_thumb_next_byte(t);
+        }
+        if (t->truncated) {
+            return JPEG_THUMB_TRUNCATED;
+        }
+        const int err = jpeg_thumb_build_huffman(h, counts);
+        if (err) {
+            return err;
+        }
+        length -= 17 + total;
+    }
+    return length == 0 ? JPEG_THUMB_OK : JPEG_THUMB_CORRUPT;
+}
+
+static int jpeg_thumb_read_dqt(struct jpeg_thumb *t, int length) {
+    while (length > 0) {
+        const int table = jpeg_thumb_next_byte(t);
+        const int wide = table >> 4;
+        if (table < 0) {
+            return JPEG_THUMB_TRUNCATED;
+        }
+        if ((table & 0x0f) > 3 || wide > 1 || length < 1 + 64 * (1 + wide)) {
+            return JPEG_THUMB_CORRUPT;
+        }
+        for (int i = 0; i < 64; i++) {
+            t->quant[table & 3][i] = wide ? jpeg_thumb_read_u16(t) : jpeg_thumb_next_byte(t);
+        }
+        if (t->truncated) {
+            return JPEG_THUMB_TRUNCATED;
+        }
+        t->quant_set[table & 3] = true;
+        length -= 1 + 64 * (1 + wide);
+    }
+    return length == 0 ? JPEG_THUMB_OK : JPEG_THUMB_CORRUPT;
+}
+
+static int jpeg_thumb_read_sof(struct jpeg_thumb *t, int length) {
+    const int precision = jpeg_thumb_next_byte(t);
+    const int height = jpeg_thumb_read_u16(t);
+    const int width = jpeg_thumb_read_u16(t);
+    const int components = jpeg_thumb_next_byte(t);
+    if (components < 0) {
+        return JPEG_THUMB_TRUNCATED;
+    }
+    if (length != 6 + 3 * components || width == 0) {
+        return JPEG_THUMB_CORRUPT;
+    }
+    // 12-bit samples, a height set later by DNL, CMYK
+    if (precision != 8 || height == 0 || components > 3) {
+        return JPEG_THUMB_UNSUPPORTED;
+    }
+    t->image_width = (uint16_t)width;
+    t->image_height = (uint16_t)height;
+    t->components = (uint8_t)components;
+    t->max_h = 1;
+    t->max_v = 1;
+    for (int i = 0; i < components; i++) {
+        struct jpeg_thumb_component *c = &t->component[i];
+        c->id = (uint8_t)jpeg_thumb_next_byte(t);
+        const int sampling = jpeg_thumb_next_byte(t);
+        c->quant = (uint8_t)jpeg_thumb_next_byte(t);
+        c->h = (uint8_t)(sampling >> 4);
+        c->v = (uint8_t)(sampling & 0x0f);
+        if (c->h < 1 || c->h > 4 || c->v < 1 || c->v > 4 || c->quant > 3) {
+            return JPEG_THUMB_CORRUPT;
+        }
+        t->max_h = c->h > t->max_h ? c->h : t->max_h;
+        t->max_v = c->v > t->max_v ? c->v : t->max_v;
+    }
+    if (t->truncated) {
+        return JPEG_THUMB_TRUNCATED;
+    }
+    // The thumbnail follows the luma blocks, so they must cover the image
+    // at full resolution
+    if (t->component[0].h != t->max_h || t->component[0].v != t->max_v) {
+        return JPEG_THUMB_UNSUPPORTED;
+    }
+    t->width = (width + t->scale - 1) / t->scale;
+    t->height = (height + t->scale - 1) / t->scale;
+    // Thumbnail rows a row of MCUs makes
+    const unsigned rows = (components > 1 ? t->max_v : 1) * 8 / t->scale;
+    if (t->width > JPEG_THUMB_MAX_WIDTH || rows > JPEG_THUMB_ROWS) {
+        return JPEG_THUMB_UNSUPPORTED;
+    }
+    return JPEG_THUMB_OK;
+}
+
+static int jpeg_thumb_read_sos(struct jpeg_thumb *t, int length) {
+    const int components = jpeg_thumb_next_byte(t);
+    if (components < 0) {
+        return JPEG_THUMB_TRUNCATED;
+    }
+    if (!t->components || length != 4 + 2 * components) {
+        return JPEG_THUMB_CORRUPT;
+    }
+    // One scan with every component
+    if (components != t->components) {
+        return JPEG_THUMB_UNSUPPORTED;
+    }
+    for (int i = 0; i < components; i++) {
+        const int id = jpeg_thumb_next_byte(t);
+        const int tables = jpeg_thumb_next_byte(t);
+        struct jpeg_thumb_component *c = &t->component[i];
+        if (id != c->id) {
+            return t->truncated ? JPEG_THUMB_TRUNCATED : JPEG_THUMB_UNSUPPORTED;
+        }
+        c->dc_table = (uint8_t)(tables >> 4);
+        c->ac_table = (uint8_t)(tables & 0x0f);
+        if (c->dc_table > 1 || c->ac_table > 1 || !t->dc[c->dc_table].set ||
+            !t->ac[c->ac_table].set) {
+            return JPEG_THUMB_CORRUPT;
+        }
+        c->dc_pred = 0;
+    }
+    const int start = jpeg_thumb_next_byte(t);
+    const int end = jpeg_thumb_next_byte(t);
+    const int approximation = jpeg_thumb_next_byte(t);
+    if (approximation < 0) {
+        return JPEG_THUMB_TRUNCATED;
+    }
+    if (start != 0 || end != 63 || approximation != 0) {
+        return JPEG_THUMB_UNSUPPORTED;
+    }
+    return t->quant_set[t->component[0].quant] ? JPEG_THUMB_OK : JPEG_THUMB_CORRUPT;
+}
+
+static int32_t jpeg_thumb_clamp_coef(int32_t value) {
+    return value > JPEG_THUMB_MAX_COEF ? JPEG_THUMB_MAX_COEF :
+           value < -JPEG_THUMB_MAX_COEF ? -JPEG_THUMB_MAX_COEF : value;
+}
+
+// Decodes a block; the terms the thumbnail takes are dequantized into
+// terms unless it is NULL. At scale 8 only the DC is taken.
+static int jpeg_thumb_decode_block(struct jpeg_thumb *t, struct jpeg_thumb_component *c,
+                                   int32_t terms[25]) {
+    const int dc = jpeg_thumb_decode_huffman(t, &t->dc[c->dc_table]);
+    if (dc < 0 || dc > 11) {
+        return JPEG_THUMB_CORRUPT;
+    }
+    if (dc) {
+        c->dc_pred = (int16_t)(c->dc_pred + jpeg_thumb_extend(jpeg_thumb_get_bits(t, dc), dc));
+    }
+    const uint16_t *quant = t->quant[c->quant];
+    const bool quarter = terms && t->scale == 4;
+    if (terms) {
+        if (quarter) {
+            memset(terms, 0, 25 * sizeof(terms[0]));
+        }
+        terms[0] = jpeg_thumb_clamp_coef(c->dc_pred * quant[0]);
+    }
+    for (int k = 1; k < 64; k++) {
+        const int rs = jpeg_thumb_decode_huffman(t, &t->ac[c->ac_table]);
+        if (rs < 0) {
+            return JPEG_THUMB_CORRUPT;
+        }
+        const int size = rs & 0x0f;
+        if (size == 0) {
+            if (rs != 0xF0) {
+                break;
+            }
+            k += 15;
+            continue;
+        }
+        k += rs >> 4;
+        if (k > 63 || size > 10) {
+            return JPEG_THUMB_CORRUPT;
+        }
+        const int32_t value = jpeg_thumb_extend(jpeg_thumb_get_bits(t, size), size);
+        if (quarter && jpeg_thumb_slot[k] != JPEG_THUMB_DROP) {
+            terms[jpeg_thumb_slot[k]] = jpeg_thumb_clamp_coef(value * quant[k]);
+        }
+    }
+    return JPEG_THUMB_OK;
+}
+
+static uint8_t jpeg_thumb_pixel(int32_t value) {
+    value += 128;
+    return value < 0 ? 0 : value > 255 ? 255 : (uint8_t)value;
+}
+
+// Writes the thumbnail pixels of a luma block at column x, row y
+static void jpeg_thumb_put_block(struct jpeg_thumb *t, const int32_t terms[25], unsigned x,
+                                 unsigned y) {
+    if (t->scale == 8) {
+        if (x < t->width) {
+            t->rows[y][x] = jpeg_thumb_pixel((terms[0] + 4) >> 3);
+        }
+        return;
+    }
+    // Means of the four quarters, columns first
+    int32_t work[2][5];
+    for (int u = 0; u < 5; u++) {
+        const int32_t even = terms[u] * jpeg_thumb_quarter[0];
+        int32_t odd = 0;
+        for (int v = 1; v < 5; v++) {
+            odd += terms[v * 5 + u] * jpeg_thumb_quarter[v];
+        }
+        const int shift = JPEG_THUMB_CONST_BITS - JPEG_THUMB_PASS1_BITS;
+        work[0][u] = (even + odd + (1 << (shift - 1))) >> shift;
+        work[1][u] = (even - odd + (1 << (shift - 1))) >> shift;
+    }
+    for (int j = 0; j < 2; j++) {
+        const int32_t even = work[j][0] * jpeg_thumb_quarter[0];
+        int32_t odd = 0;
+        for (int u = 1; u < 5; u++) {
+            odd += work[j][u] * jpeg_thumb_quarter[u];
+        }
+        // And the 1/8 of the 2-D transform
+        const int shift = JPEG_THUMB_CONST_BITS + JPEG_THUMB_PASS1_BITS + 3;
+        if (x < t->width) {
+            t->rows[y + j][x] = jpeg_thumb_pixel((even + odd + (1 << (shift - 1))) >> shift);
+        }
+        if (x + 1 < t->width) {
+            t->rows[y + j][x + 1] = jpeg_thumb_pixel((even - odd + (1 << (shift - 1))) >> shift);
+        }
+    }
+}
+
+static int jpeg_thumb_restart(struct jpeg_thumb *t) {
+    t->bits = 0;
+    t->bit_count = 0;
+    // Skip to the marker if the bits before it were not all read
+    while (!t->marker) {
+        const int byte = jpeg_thumb_next_byte(t);
+        if (byte < 0) {
+            return JPEG_THUMB_TRUNCATED;
+        }
+        if (byte == 0xFF) {
+            int next;
+            do {
+                next = jpeg_thumb_next_byte(t);
+            } while (next == 0xFF);
+            if (next < 0) {
+                return JPEG_THUMB_TRUNCATED;
+            }
+            t->marker = (uint8_t)next;
+        }
+    }
+    if (t->truncated) {
+        return JPEG_THUMB_TRUNCATED;
+    }
+    if (t->marker < 0xD0 || t->marker > 0xD7) {
+        return JPEG_THUMB_CORRUPT;
+    }
+    t->marker = 0;
+    for (int i = 0; i < t->components; i++) {
+        t->component[i].dc_pred = 0;
+    }
+    return JPEG_THUMB_OK;
+}
+
+static int jpeg_thumb_decode_scan(struct jpeg_thumb *t, jpeg_thumb_row row, void *row_ctx) {
+    // A scan of one component has a block per MCU, whatever its sampling
+    const bool interleaved = t->components > 1;
+    const unsigned mcu_h = interleaved ? t->max_h : 1;
+    const unsigned mcu_v = interleaved ? t->max_v : 1;
+    const unsigned mcus_x = (t->image_width + 8 * mcu_h - 1) / (8 * mcu_h);
+    const unsigned mcus_y = (t->image_height + 8 * mcu_v - 1) / (8 * mcu_v);
+    // Thumbnail pixels across a block
+    const unsigned block = 8 / t->scale;
+    unsigned restarts_left = t->restart_interval;
+    int32_t terms[25];
+    t->bits = 0;
+    t->bit_count = 0;
+    t->marker = 0;
+    for (unsigned my = 0; my < mcus_y; my++) {
+        for (unsigned mx = 0; mx < mcus_x; mx++) {
+            if (t->restart_interval) {
+                if (restarts_left == 0) {
+                    const int err = jpeg_thumb_restart(t);
+                    if (err) {
+                        return err;
+                    }
+                    restarts_left = t->restart_interval;
+                }
+                restarts_left--;
+            }
+            for (int i = 0; i < t->components; i++) {
+                struct jpeg_thumb_component *c = &t->component[i];
+                const unsigned h = interleaved ? c->h : 1;
+                const unsigned v = interleaved ? c->v : 1;
+                for (unsigned by = 0; by < v; by++) {
+                    for (unsigned bx = 0; bx < h; bx++) {
+                        const int err = jpeg_thumb_decode_block(t, c, i == 0 ? terms : NULL);
+                        if (err) {
+                            return err;
+                        }
+                        if (i == 0) {
+                            jpeg_thumb_put_block(t, terms, (mx * h + bx) * block, by * block);
+                        }
+                    }
+                }
+            }
+        }
+        for (unsigned r = 0; r < mcu_v * block; r++) {
+            const unsigned y = my * mcu_v * block + r;
+            if (y < t->height) {
+                row(row_ctx, y, t->rows[r], t->width, t->height);
+            }
+        }
+    }
+    return t->truncated ? JPEG_THUMB_TRUNCATED : JPEG_THUMB_OK;
+}
+
+int jpeg_thumb_decode(struct jpeg_thumb *thumb, unsigned scale, jpeg_thumb_fill fill,
+                      void *fill_ctx, jpeg_thumb_row row, void *row_ctx) {
+    struct jpeg_thumb *t = thumb;
+    if (scale != 4 && scale != 8) {
+        return JPEG_THUMB_UNSUPPORTED;
+    }
+    t->fill = fill;
+    t->fill_ctx = fill_ctx;
+    t->data = NULL;
+    t->left = 0;
+    t->truncated = false;
+    t->scale = scale;
+    t->components = 0;
+    t->restart_interval = 0;
+    memset(t->quant_set, 0, sizeof(t->quant_set));
+    for (int i = 0; i < 2; i++) {
+        t->dc[i].set = false;
+        t->ac[i].set = false;
+    }
+
+    const int soi = jpeg_thumb_read_u16(t);
+    if (soi != 0xFFD8) {
+        return soi < 0 ? JPEG_THUMB_TRUNCATED : JPEG_THUMB_CORRUPT;
+    }
+    for (;;) {
+        int marker = jpeg_thumb_next_byte(t);
+        if (marker != 0xFF) {
+            return marker < 0 ? JPEG_THUMB_TRUNCATED : JPEG_THUMB_CORRUPT;
+        }
+        do {
+            marker = jpeg_thumb_next_byte(t);
+        } while (marker == 0xFF);
+        if (marker < 0) {
+            return JPEG_THUMB_TRUNCATED;
+        }
+        if (marker == 0xD8 || marker == 0xD9 || (marker >= 0xD0 && marker <= 0xD7)) {
+            return JPEG_THUMB_CORRUPT;
+        }
+        const int length = jpeg_thumb_read_u16(t);
+        if (length < 0) {
+            return JPEG_THUMB_TRUNCATED;
+        }
+        if (length < 2) {
+            return JPEG_THUMB_CORRUPT;
+        }
+        int err = JPEG_THUMB_OK;
+        switch (marker) {
+        case 0xC0: // Baseline
+        case 0xC1: // Extended, Huffman
+            err = jpeg_thumb_read_sof(t, length - 2);
+            break;
+        case 0xC4:
+            err = jpeg_thumb_read_dht(t, length - 2);
+            break;
+        case 0xDB:
+            err = jpeg_thumb_read_dqt(t, length - 2);
+            break;
+        case 0xDD: {
+            const int interval = jpeg_thumb_read_u16(t);
+            err = interval < 0 ? JPEG_THUMB_TRUNCATED :
+                  length != 4 ? JPEG_THUMB_CORRUPT : JPEG_THUMB_OK;
+            t->restart_interval = (uint16_t)interval;
+            break;
+        }
+        case 0xDA:
+            err = jpeg_thumb_read_sos(t, length - 2);
+            return err ? err : jpeg_thumb_decode_scan(t, row, row_ctx);
+        default:
+            // Progressive, lossless, arithmetic coding
+            if (marker >= 0xC2 && marker <= 0xCF) {
+                return JPEG_THUMB_UNSUPPORTED;
+            }
+            // APPn, COM and the rest say nothing about the luma
+            err = jpeg_thumb_skip(t, length - 2);
+            break;
+        }
+        if (err) {
+            return err;
+        }
+    }
+}
+
+void jpeg_thumb_fit_row(void *ctx, unsigned y, const uint8_t *pixels, unsigned width,
+                        unsigned height) {
+    const struct jpeg_thumb_fit *fit = (const struct jpeg_thumb_fit *)ctx;
+    const unsigned side = width < height ? width : height;
+    const unsigned x0 = (width - side) / 2;
+    const unsigned y0 = (height - side) / 2;
+    if (y < y0 || y >= y0 + side) {
+        return;
+    }
+    // Every output row whose centre falls in this row
+    for (unsigned oy = 0; oy < fit->size; oy++) {
+        if ((2 * oy + 1) * side / (2 * fit->size) != y - y0) {
+            continue;
+        }
+        uint8_t *dst = fit->dst + oy * fit->size;
+        for (unsigned ox = 0; ox < fit->size; ox++) {
+            dst[ox] = pixels[x0 + (2 * ox + 1) * side / (2 * fit->size)];
+        }
+    }
+}
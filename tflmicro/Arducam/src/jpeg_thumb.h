@@ -0,0 +1,121 @@
+#ifndef _JPEG_THUMB__H
+#define _JPEG_THUMB__H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Decodes a baseline JPEG straight to a grayscale thumbnail of 1/8 or 1/4
+// of its size, so the OV2640 can stay in JPEG mode at a high resolution
+// while the model gets a small frame. Only the luma is reconstructed, and
+// only from the coefficients that reach the thumbnail: a 1/8 pixel is the
+// DC term of its block, a 1/4 pixel the mean of a quarter of the block,
+// which takes the DC and the odd terms 1, 3, 5 and 7 in each direction.
+// Chroma and the other coefficients are Huffman decoded and dropped.
+//
+// The JPEG is pulled through a callback in pieces of any size and the
+// thumbnail is pushed out a row at a time, a row of MCUs after another,
+// so nothing the size of the frame is held. All the state is in struct
+// jpeg_thumb, under 6 KB; fixed-point arithmetic throughout.
+//
+// Handles what the OV2640 and common encoders write: 8-bit baseline
+// Huffman, one to three components in one scan, any sampling factors,
+// and restart markers. Progressive, arithmetic coded and multi-scan
+// files are rejected.
+
+#define JPEG_THUMB_OK 0
+// The source ran out before the end of the image
+#define JPEG_THUMB_TRUNCATED -1
+// A valid JPEG this decoder does not handle
+#define JPEG_THUMB_UNSUPPORTED -2
+#define JPEG_THUMB_CORRUPT -3
+
+// Widest image at 1/4: 1600 pixels, the OV2640 UXGA frame
+#define JPEG_THUMB_MAX_WIDTH 400
+// Thumbnail rows held: a row of MCUs two blocks high at 1/4
+#define JPEG_THUMB_ROWS 4
+
+// Sets *size to the bytes at the returned pointer, 0 at the end
+typedef const uint8_t *(*jpeg_thumb_fill)(void *ctx, size_t *size);
+// Row y of a thumbnail of width by height pixels
+typedef void (*jpeg_thumb_row)(void *ctx, unsigned y, const uint8_t *pixels, unsigned width,
+                               unsigned height);
+
+struct jpeg_thumb_huffman {
+    // Code length and value of the codes of up to 8 bits, by the next 8
+    // bits of the stream; length 0 if the code is longer
+    uint16_t fast[256];
+    // Largest code of each length plus one, shifted to 16 bits, and the
+    // index in values of the first code of each length, less that code
+    uint32_t max_code[18];
+    int32_t offset[17];
+    uint8_t values[256];
+    bool set;
+};
+
+struct jpeg_thumb_component {
+    uint8_t id;
+    uint8_t h;
+    uint8_t v;
+    uint8_t quant;
+    uint8_t dc_table;
+    uint8_t ac_table;
+    int16_t dc_pred;
+};
+
+struct jpeg_thumb {
+    // Source
+    jpeg_thumb_fill fill;
+    void *fill_ctx;
+    const uint8_t *data;
+    size_t left;
+    // Entropy coded bits, most significant first
+    uint32_t bits;
+    int bit_count;
+    // Marker found in the entropy coded data, or 0
+    uint8_t marker;
+    bool truncated;
+    // Frame
+    uint16_t image_width;
+    uint16_t image_height;
+    uint8_t components;
+    uint8_t max_h;
+    uint8_t max_v;
+    uint16_t restart_interval;
+    struct jpeg_thumb_component component[3];
+    // Tables, in zigzag order
+    uint16_t quant[4][64];
+    bool quant_set[4];
+    struct jpeg_thumb_huffman dc[2];
+    struct jpeg_thumb_huffman ac[2];
+    // Output: scale is 4 or 8
+    unsigned scale;
+    unsigned width;
+    unsigned height;
+    uint8_t rows[JPEG_THUMB_ROWS][JPEG_THUMB_MAX_WIDTH];
+};
+
+// Decodes one image, calling row for every thumbnail row in order.
+// Returns JPEG_THUMB_OK or one of the errors above; rows already sent
+// stay sent. Stops reading at the end of the image.
+int jpeg_thumb_decode(struct jpeg_thumb *thumb, unsigned scale, jpeg_thumb_fill fill,
+                      void *fill_ctx, jpeg_thumb_row row, void *row_ctx);
+
+// Fits a thumbnail to a size by size frame, taking the centre square and
+// sampling the nearest pixel. Pass jpeg_thumb_fit_row with a struct
+// jpeg_thumb_fit as the row callback.
+struct jpeg_thumb_fit {
+    uint8_t *dst;
+    unsigned size;
+};
+
+void jpeg_thumb_fit_row(void *ctx, unsigned y, const uint8_t *pixels, unsigned width,
+                        unsigned height);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,87 @@
+#include <string.h>
+#include "motion_gate.h"
+
+// |a - b| of the two bytes in bits 7:0 and 23:16 of a and b, in 16-bit
+// lanes. Adding 256 to each lane of a keeps the subtraction from
+// borrowing across lanes and leaves bit 8 set where a >= b; the other
+// lanes are negated.
+static inline uint32_t motion_gate_abs_lanes(uint32_t a, uint32_t b) {
+    const uint32_t d = (a + 0x01000100) - b;
+    const uint32_t negative = ((~d >> 8) & 0x00010001) * 0xFF;
+    return ((d & 0x00FF00FF) ^ negative) + (negative & 0x00010001);
+}
+
+uint32_t motion_gate_sad(const uint32_t *a, const uint32_t *b, size_t count) {
+    uint32_t sad = 0;
+    while (count > 0) {
+        // A lane gains at most 2 * 255 per word, so fold it every 128
+        size_t n = count < 128 ? count : 128;
+        count -= n;
+        uint32_t lanes = 0;
+        for (; n > 0; n--) {
+            // Flip the sign bits to compare as uint8
+            const uint32_t x = *a++ ^ 0x80808080;
+            const uint32_t y = *b++ ^ 0x80808080;
+            lanes += motion_gate_abs_lanes(x & 0x00FF00FF, y & 0x00FF00FF);
+            lanes += motion_gate_abs_lanes((x >> 8) & 0x00FF00FF, (y >> 8) & 0x00FF00FF);
+        }
+        sad += (lanes & 0xFFFF) + (lanes >> 16);
+    }
+    return sad;
+}
+
+void motion_gate_init(struct motion_gate *gate, uint32_t *reference, uint16_t width,
+                      uint16_t height, uint16_t block, uint32_t threshold,
+                      uint32_t max_skips) {
+    gate->reference = reference;
+    gate->width = width;
+    gate->height = height;
+    gate->block = block;
+    gate->threshold = threshold;
+    gate->max_skips = max_skips;
+    gate->skips_in_row = 0;
+    gate->primed = false;
+    gate->invoked = 0;
+    gate->skipped = 0;
+    gate->last_sad = 0;
+}
+
+// Largest block difference, stopping early once one is over the threshold
+static uint32_t motion_gate_max_sad(const struct motion_gate *gate, const uint32_t *frame) {
+    const size_t stride = gate->width / 4;
+    const size_t words = gate->block / 4;
+    uint32_t max = 0;
+    for (uint16_t by = 0; by < gate->height; by += gate->block) {
+        for (uint16_t bx = 0; bx < gate->width; bx += gate->block) {
+            uint32_t sad = 0;
+            size_t offset = by * stride + bx / 4;
+            for (uint16_t y = 0; y < gate->block; y++, offset += stride) {
+                sad += motion_gate_sad(frame + offset, gate->reference + offset, words);
+            }
+            if (sad > max) {
+                max = sad;
+                if (max > gate->threshold) {
+                    return max;
+                }
+            }
+        }
+    }
+    return max;
+}
+
+bool motion_gate_check(struct motion_gate *gate, const int8_t *frame) {
+    const uint32_t *words = (const uint32_t *)frame;
+    bool run = !gate->primed || gate->skips_in_row >= gate->max_skips;
+    gate->last_sad = gate->primed ? motion_gate_max_sad(gate, words) : 0;
+    run = run || gate->last_sad > gate->threshold;
+    if (!run) {
+        gate->skips_in_row++;
+        gate->skipped++;
+        return false;
+    }
+    memcpy(gate->reference, frame, (size_t)gate->width * gate->height);
+    gate->primed = true;
+    gate->skips_in_row = 0;
+    gate->invoked++;
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef _MOTION_GATE__H
+#define _MOTION_GATE__H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Decides whether a frame differs enough from the one inference last ran
+// on to be worth another Invoke(). The frame is cut into square blocks and
+// the sum of absolute differences of each block is compared with a
+// threshold, so a person walking into one corner counts as much as a pan,
+// while sensor noise spread over the whole frame does not. The differences
+// are taken four pixels per 32-bit word, the M0+ having no SIMD.
+//
+// Frames are the int8 model input (pixels minus 128), in word-aligned
+// buffers. The reference is updated only when inference runs, so slow
+// changes add up until they trigger it.
+
+struct motion_gate {
+    uint32_t *reference;
+    uint16_t width;
+    uint16_t height;
+    // Side of a block in pixels, a multiple of 4 dividing width and height
+    uint16_t block;
+    // Sum of absolute differences over one block above which it changed
+    uint32_t threshold;
+    // Frames skipped in a row after which inference runs anyway
+    uint32_t max_skips;
+    uint32_t skips_in_row;
+    bool primed;
+    // Frames passed to and held back from inference
+    uint32_t invoked;
+    uint32_t skipped;
+    // Largest block difference of the last frame checked, or the first
+    // one found over the threshold
+    uint32_t last_sad;
+};
+
+// reference holds width * height bytes.
+void motion_gate_init(struct motion_gate *gate, uint32_t *reference, uint16_t width,
+                      uint16_t height, uint16_t block, uint32_t threshold,
+                      uint32_t max_skips);
+// Returns true if inference should run on frame, which then becomes the
+// reference; the first frame always runs.
+bool motion_gate_check(struct motion_gate *gate, const int8_t *frame);
+// Sum of absolute differences between count words of a and b, reading
+// each byte as int8
+uint32_t motion_gate_sad(const uint32_t *a, const uint32_t *b, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -1,8 +1,17 @@
 #ifndef OV2640_REGS_H
 #define OV2640_REGS_H
 #include "arducam.h"
+#include "sensor_seq.h"
 #define OV2640_CHIPID_HIGH 	0x0A
 #define OV2640_CHIPID_LOW 	0x0B
+// Soft reset through COM7 in the sensor bank. Registers may be written
+// again a few milliseconds later.
+const struct sensor_reg OV2640_RESET[]  ={
+	{0xff, 0x1},
+	{0x12, 0x80},
+	{SENSOR_REG_DELAY, 5},
+	{0xff, 0xff},
+};
 const struct sensor_reg OV2640_YUV_96x96[]  ={
 {0xff, 0x0}, 
 	{0x2c, 0xff}, 
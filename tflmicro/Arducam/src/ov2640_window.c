@@ -0,0 +1,60 @@
+#include "ov2640_window.h"
+
+// Largest n with size >> n still at least out, as the 3-bit divider fields
+// take it
+static unsigned int divider(unsigned int size, unsigned int out) {
+    unsigned int n = 0;
+    while (n < 7 && (size >> (n + 1)) >= out) {
+        n++;
+    }
+    return n;
+}
+
+int ov2640_window_regs(const struct ov2640_window *window, struct sensor_reg *regs) {
+    const unsigned int w = window->width / 4;
+    const unsigned int h = window->height / 4;
+    const unsigned int ow = window->out_width / 4;
+    const unsigned int oh = window->out_height / 4;
+    const unsigned int x = window->x;
+    const unsigned int y = window->y;
+    if ((window->width | window->height | window->out_width | window->out_height) & 3) {
+        return -1;
+    }
+    if (ow == 0 || oh == 0 || ow > w || oh > h) {
+        return -1;
+    }
+    if (x + window->width > window->in_width || y + window->height > window->in_height) {
+        return -1;
+    }
+    // Field widths: HSIZE 10 bits, VSIZE 9, ZMOW 10, ZMOH 9, offsets 11
+    if (w > 0x3FF || h > 0x1FF || x > 0x7FF || y > 0x7FF) {
+        return -1;
+    }
+    const unsigned int h_div = divider(window->width, window->out_width);
+    const unsigned int v_div = divider(window->height, window->out_height);
+    const struct sensor_reg table[OV2640_WINDOW_REGS] = {
+        {0xff, 0x00},
+        // Hold the DVP output while the window changes
+        {0xe0, 0x04},
+        // CTRLI: LP_DP whenever a divider is used
+        {0x50, (h_div | v_div ? 0x80 : 0x00) | (v_div << 3) | h_div},
+        {0x51, w & 0xFF},
+        {0x52, h & 0xFF},
+        {0x53, x & 0xFF},
+        {0x54, y & 0xFF},
+        // VHYX: VSIZE[8], YOFF[10:8], HSIZE[8], XOFF[10:8]
+        {0x55, ((h >> 8) & 1) << 7 | ((y >> 8) & 7) << 4 | ((w >> 8) & 1) << 3 | ((x >> 8) & 7)},
+        // TEST: HSIZE[9]
+        {0x57, ((w >> 9) & 1) << 7},
+        {0x5a, ow & 0xFF},
+        {0x5b, oh & 0xFF},
+        // ZMHH: ZMOH[8], ZMOW[9:8]
+        {0x5c, ((oh >> 8) & 1) << 2 | ((ow >> 8) & 3)},
+        {0xe0, 0x00},
+        {0xff, 0xff},
+    };
+    for (int i = 0; i < OV2640_WINDOW_REGS; i++) {
+        regs[i] = table[i];
+    }
+    return 0;
+}
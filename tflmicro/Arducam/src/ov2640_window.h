@@ -0,0 +1,42 @@
+#ifndef _OV2640_WINDOW__H
+#define _OV2640_WINDOW__H
+#include <stdint.h>
+#include "arducam.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Builds the OV2640 DSP register writes that crop the image and scale the
+// crop to the output size, so the sensor sends only the pixels wanted. The
+// DSP takes the crop, halves it as often as it can while staying at least
+// as large as the output (CTRLI dividers), then zooms down to the output
+// (ZMOW, ZMOH). The fixed size tables in ov2640.h end with the same writes.
+//
+// Sizes and offsets are in pixels. Crop and output sizes are multiples of
+// 4, since the registers count in fours.
+struct ov2640_window {
+    // What HSIZE8 and VSIZE8 (0xc0, 0xc1) set the DSP input to
+    uint16_t in_width;
+    uint16_t in_height;
+    // Crop of the input
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    // At most the crop size
+    uint16_t out_width;
+    uint16_t out_height;
+};
+
+// Entries ov2640_window_regs() writes, with the end of the table
+#define OV2640_WINDOW_REGS 14
+
+// Fills regs with a table for wrSensorRegs8_8(). Returns 0, or -1 if the
+// window cannot be set, in which case regs is left alone.
+int ov2640_window_regs(const struct ov2640_window *window, struct sensor_reg *regs);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,82 @@
+#include "sensor_seq.h"
+
+static int sensor_seq_end(const struct sensor_reg *reg) {
+    return reg->reg == 0xff && reg->val == 0xff;
+}
+
+size_t sensor_seq_encode(const struct sensor_reg *regs, uint16_t *cmds) {
+    size_t count = 0;
+    while (count < SENSOR_SEQ_CHUNK && !sensor_seq_end(&regs[count]) &&
+           regs[count].reg != SENSOR_REG_DELAY) {
+        cmds[2 * count] = regs[count].reg;
+        cmds[2 * count + 1] = regs[count].val | SENSOR_SEQ_STOP;
+        count++;
+    }
+    return count;
+}
+
+int sensor_seq_write(const struct sensor_seq_bus *bus, const struct sensor_reg *regs) {
+    uint16_t cmds[2][2 * SENSOR_SEQ_CHUNK];
+    int next = 0;
+    int err = 0;
+    while (!sensor_seq_end(regs)) {
+        if (regs->reg == SENSOR_REG_DELAY) {
+            err |= bus->flush(bus->ctx);
+            bus->sleep_ms(bus->ctx, regs->val);
+            regs++;
+            continue;
+        }
+        // The buffer of the call before last is free once write() returns
+        size_t count = sensor_seq_encode(regs, cmds[next]);
+        bus->write(bus->ctx, cmds[next], 2 * count);
+        next ^= 1;
+        regs += count;
+    }
+    err |= bus->flush(bus->ctx);
+    return err ? -1 : 0;
+}
+
+// Whether a later entry of the table writes the register of regs, which
+// is in bank
+static int sensor_seq_overwritten(const struct sensor_reg *regs, uint8_t bank_reg, int bank) {
+    const unsigned int reg = regs->reg;
+    int current = bank;
+    for (regs++; !sensor_seq_end(regs); regs++) {
+        if (regs->reg == bank_reg) {
+            current = regs->val;
+        } else if (regs->reg == reg && current == bank) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int sensor_seq_verify(const struct sensor_seq_bus *bus, const struct sensor_reg *regs,
+                      uint8_t bank_reg) {
+    int mismatches = 0;
+    // Unknown until the table selects one
+    int bank = -1;
+    for (; !sensor_seq_end(regs); regs++) {
+        if (regs->reg == SENSOR_REG_DELAY) {
+            continue;
+        }
+        if (regs->reg == bank_reg) {
+            const uint16_t cmds[2] = {bank_reg, regs->val | SENSOR_SEQ_STOP};
+            bus->write(bus->ctx, cmds, 2);
+            if (bus->flush(bus->ctx) != 0) {
+                return -1;
+            }
+            bank = regs->val;
+            continue;
+        }
+        if (sensor_seq_overwritten(regs, bank_reg, bank)) {
+            continue;
+        }
+        uint8_t value;
+        if (bus->read(bus->ctx, regs->reg, &value) != 0) {
+            return -1;
+        }
+        mismatches += value != regs->val;
+    }
+    return mismatches;
+}
@@ -0,0 +1,56 @@
+#ifndef _SENSOR_SEQ__H
+#define _SENSOR_SEQ__H
+#include <stddef.h>
+#include <stdint.h>
+#include "arducam.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Writes register tables to a sensor with 8-bit registers. It has no
+// hardware dependencies: sensor_seq_i2c.c streams the writes to the I2C
+// controller with a DMA channel.
+//
+// A table is an array of struct sensor_reg ended by {0xff, 0xff}. An entry
+// {SENSOR_REG_DELAY, ms} waits ms milliseconds after every write before it
+// has been sent; no other delays are inserted, so a table carries exactly
+// the waits the sensor needs, such as after a soft reset.
+#define SENSOR_REG_DELAY 0x100
+// Every write is a transaction of its own: the register, then the value
+// with the IC_DATA_CMD bit that issues a STOP after it
+#define SENSOR_SEQ_STOP 0x200
+// Writes handed to the bus at a time, in each of two buffers
+#define SENSOR_SEQ_CHUNK 32
+
+struct sensor_seq_bus {
+    void *ctx;
+    // Starts sending count IC_DATA_CMD words. May return before they are
+    // on the wire, but not before the ones of the previous call have been
+    // read out of their buffer.
+    void (*write)(void *ctx, const uint16_t *cmds, size_t count);
+    // Waits until everything written has been sent. Returns 0, or -1 if
+    // the sensor did not acknowledge a byte since the last flush.
+    int (*flush)(void *ctx);
+    int (*read)(void *ctx, uint8_t reg, uint8_t *value);
+    void (*sleep_ms)(void *ctx, uint32_t ms);
+};
+
+// Encodes up to SENSOR_SEQ_CHUNK writes from regs into cmds, stopping at a
+// delay or at the end of the table. Returns the number of entries used.
+size_t sensor_seq_encode(const struct sensor_reg *regs, uint16_t *cmds);
+// Writes the table, overlapping the encoding of each chunk with the
+// sending of the previous one. Returns 0, or -1 if a write was not
+// acknowledged.
+int sensor_seq_write(const struct sensor_seq_bus *bus, const struct sensor_reg *regs);
+// Reads back, in one pass after the table was written, the last value
+// written to each register and returns how many differ, or -1 on a bus
+// error. Writes to bank_reg select a register bank (0xff on the OV2640)
+// and are repeated before the registers of that bank are read.
+int sensor_seq_verify(const struct sensor_seq_bus *bus, const struct sensor_reg *regs,
+                      uint8_t bank_reg);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
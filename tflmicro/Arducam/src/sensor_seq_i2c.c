@@ -0,0 +1,75 @@
+#include "sensor_seq_i2c.h"
+#include "hardware/dma.h"
+#include "pico/stdlib.h"
+
+static void sensor_seq_i2c_write(void *ctx, const uint16_t *cmds, size_t count) {
+    struct sensor_seq_i2c *port = ctx;
+    // The previous buffer must have been read before the caller reuses it
+    dma_channel_wait_for_finish_blocking(port->dma_channel);
+    dma_channel_transfer_from_buffer_now(port->dma_channel, cmds, count);
+}
+
+static int sensor_seq_i2c_flush(void *ctx) {
+    struct sensor_seq_i2c *port = ctx;
+    i2c_hw_t *hw = i2c_get_hw(port->i2c);
+    dma_channel_wait_for_finish_blocking(port->dma_channel);
+    // Then for the controller to empty its FIFO and finish the last STOP
+    while (!(hw->status & I2C_IC_STATUS_TFE_BITS) ||
+           (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS)) {
+        tight_loop_contents();
+    }
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        // A NAK flushes the FIFO and keeps it flushed, so the rest of the
+        // DMA transfer went nowhere. Reading the register releases it.
+        (void)hw->clr_tx_abrt;
+        return -1;
+    }
+    return 0;
+}
+
+static int sensor_seq_i2c_read(void *ctx, uint8_t reg, uint8_t *value) {
+    struct sensor_seq_i2c *port = ctx;
+    if (i2c_write_blocking(port->i2c, port->address, &reg, 1, true) != 1 ||
+        i2c_read_blocking(port->i2c, port->address, value, 1, false) != 1) {
+        return -1;
+    }
+    return 0;
+}
+
+static void sensor_seq_i2c_sleep_ms(void *ctx, uint32_t ms) {
+    (void)ctx;
+    sleep_ms(ms);
+}
+
+void sensor_seq_i2c_init(struct sensor_seq_bus *bus, struct sensor_seq_i2c *port,
+                         i2c_inst_t *i2c, uint8_t address, uint dma_channel) {
+    port->i2c = i2c;
+    port->address = address;
+    port->dma_channel = dma_channel;
+
+    // The controller only takes a new target address while disabled; the
+    // SDK's blocking calls set the same one again
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+    hw->enable = 0;
+    hw->tar = address;
+    hw->enable = 1;
+
+    dma_channel_config c = dma_channel_get_default_config(dma_channel);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, i2c_get_dreq(i2c, true));
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    dma_channel_configure(
+        dma_channel, &c,
+        &hw->data_cmd,
+        NULL,
+        0,
+        false
+    );
+
+    bus->ctx = port;
+    bus->write = sensor_seq_i2c_write;
+    bus->flush = sensor_seq_i2c_flush;
+    bus->read = sensor_seq_i2c_read;
+    bus->sleep_ms = sensor_seq_i2c_sleep_ms;
+}
@@ -0,0 +1,26 @@
+#ifndef _SENSOR_SEQ_I2C__H
+#define _SENSOR_SEQ_I2C__H
+#include "hardware/i2c.h"
+#include "sensor_seq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A sensor_seq_bus on a hardware I2C controller. Writes are fed to the
+// controller's command register by a DMA channel, reads use the SDK's
+// blocking calls.
+struct sensor_seq_i2c {
+    i2c_inst_t *i2c;
+    uint8_t address;
+    uint dma_channel;
+};
+
+// i2c must have been set up with i2c_init().
+void sensor_seq_i2c_init(struct sensor_seq_bus *bus, struct sensor_seq_i2c *port,
+                         i2c_inst_t *i2c, uint8_t address, uint dma_channel);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,240 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fifo_luma.h"
+#include "hardware/dma.h"
+#include "host_test.h"
+
+// Models an SPI master wired to the ArduChip burst FIFO and the DMA
+// channels fifo_luma_read() programs, and checks the result against what
+// capture() used to do: read the whole FIFO into a buffer and keep every
+// other byte but the last 8.
+//
+// The model follows the RP2040: the SPI sends a frame for every word the TX
+// channel writes to DR and clocks data_bits from the FIFO, first byte in the
+// high bits. A DMA read of DR returns the frame and keeps the byte lane of
+// the read address, so a narrow read at DR + 1 gets bits 15:8.
+#define DREQ_SPI_TX 16
+#define DREQ_SPI_RX 17
+#define CHANNELS 12
+#define FIFO_MAX (96 * 96 * 2 + 8)
+#define GUARD 16
+
+struct spi_inst {
+	spi_hw_t hw;
+	uint data_bits;
+};
+
+struct channel {
+	dma_channel_config config;
+	volatile void *write;
+	const volatile void *read;
+	uint count;
+	bool busy;
+};
+
+static struct spi_inst spi;
+static struct channel channels[CHANNELS];
+// What the ArduChip sends after BURST_FIFO_READ, and how much was clocked
+static uint8_t fifo[FIFO_MAX];
+static size_t fifo_size;
+static size_t fifo_pos;
+static uint8_t filler_seen;
+// Set when the code drives the model in a way the hardware would not allow
+static int misuse;
+
+void spi_set_format(spi_inst_t *s, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha,
+                    spi_order_t order) {
+	if (cpol != SPI_CPOL_0 || cpha != SPI_CPHA_0 || order != SPI_MSB_FIRST) {
+		misuse = 1;
+	}
+	s->data_bits = data_bits;
+}
+
+spi_hw_t *spi_get_hw(spi_inst_t *s) {
+	return &s->hw;
+}
+
+uint spi_get_dreq(spi_inst_t *s, bool is_tx) {
+	(void)s;
+	return is_tx ? DREQ_SPI_TX : DREQ_SPI_RX;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+	(void)channel;
+	const dma_channel_config c = {.read_increment = true, .size = DMA_SIZE_32};
+	return c;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+	c->read_increment = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+	c->write_increment = incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {
+	c->dreq = dreq;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c,
+                                           enum dma_channel_transfer_size size) {
+	c->size = size;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config,
+                           volatile void *write_addr, const volatile void *read_addr,
+                           uint transfer_count, bool trigger) {
+	struct channel *ch = &channels[channel];
+	ch->config = *config;
+	ch->write = write_addr;
+	ch->read = read_addr;
+	ch->count = transfer_count;
+	ch->busy = trigger;
+}
+
+void dma_start_channel_mask(uint32_t chan_mask) {
+	for (int i = 0; i < CHANNELS; i++) {
+		if (chan_mask & (1u << i)) {
+			channels[i].busy = channels[i].count > 0;
+		}
+	}
+}
+
+static struct channel *find_channel(uint dreq) {
+	for (int i = 0; i < CHANNELS; i++) {
+		if (channels[i].busy && channels[i].config.dreq == dreq) {
+			return &channels[i];
+		}
+	}
+	return NULL;
+}
+
+static uint32_t load(const volatile void *addr, enum dma_channel_transfer_size size) {
+	const uintptr_t dr = (uintptr_t)&spi.hw.dr;
+	const uintptr_t a = (uintptr_t)addr;
+	if (a >= dr && a < dr + 4) {
+		// A narrow read of DR keeps the byte lane it addresses
+		const uint32_t word = spi.hw.dr >> (8 * (a - dr));
+		return size == DMA_SIZE_8 ? word & 0xFF : size == DMA_SIZE_16 ? word & 0xFFFF : word;
+	}
+	if (size == DMA_SIZE_8) return *(const uint8_t *)addr;
+	if (size == DMA_SIZE_16) return *(const uint16_t *)addr;
+	return *(const uint32_t *)addr;
+}
+
+static void store(volatile void *addr, enum dma_channel_transfer_size size, uint32_t value) {
+	if (size == DMA_SIZE_8) *(uint8_t *)addr = value;
+	else if (size == DMA_SIZE_16) *(uint16_t *)addr = value;
+	else *(uint32_t *)addr = value;
+}
+
+static void advance(struct channel *ch) {
+	const int step = 1 << ch->config.size;
+	if (ch->config.read_increment) ch->read = (const uint8_t *)ch->read + step;
+	if (ch->config.write_increment) ch->write = (uint8_t *)ch->write + step;
+	ch->busy = --ch->count > 0;
+}
+
+// Runs the channels one SPI frame at a time until channel is done.
+void dma_channel_wait_for_finish_blocking(uint channel) {
+	while (channels[channel].busy) {
+		struct channel *tx = find_channel(DREQ_SPI_TX);
+		struct channel *rx = find_channel(DREQ_SPI_RX);
+		if (tx == NULL || rx == NULL || (void *)tx->write != (void *)&spi.hw.dr) {
+			misuse = 1;
+			return;
+		}
+		const uint32_t sent = load(tx->read, tx->config.size);
+		advance(tx);
+		uint32_t frame = 0;
+		for (uint bits = 0; bits < spi.data_bits; bits += 8) {
+			filler_seen |= (sent >> (spi.data_bits - 8 - bits)) & 0xFF;
+			if (fifo_pos >= fifo_size) {
+				misuse = 1;
+				return;
+			}
+			frame = (frame << 8) | fifo[fifo_pos++];
+		}
+		spi.hw.dr = frame;
+		store(rx->write, rx->config.size, load(rx->read, rx->config.size));
+		advance(rx);
+	}
+}
+
+// capture() before fifo_luma_read()
+static size_t reference_capture(const uint8_t *value, int length, uint8_t *imageDat) {
+	uint16_t i;
+	uint16_t index = 0;
+	for (i = 0; i < length - 8; i += 2) {
+		imageDat[index++] = value[i];
+	}
+	return index;
+}
+
+static void fill_fifo(uint32_t seed) {
+	srand(seed);
+	for (size_t i = 0; i < FIFO_MAX; i++) {
+		fifo[i] = rand();
+	}
+}
+
+// Reads a FIFO of length bytes and compares with reference_capture().
+static int matches_reference(size_t length, size_t capacity) {
+	static uint8_t expected[FIFO_MAX / 2 + GUARD];
+	static uint8_t image[FIFO_MAX / 2 + GUARD];
+	memset(expected, 0xEE, sizeof(expected));
+	memset(image, 0xEE, sizeof(image));
+	memset(channels, 0, sizeof(channels));
+	spi.data_bits = 8;
+	fifo_size = length;
+	fifo_pos = 0;
+	filler_seen = 0;
+	misuse = 0;
+
+	size_t count = reference_capture(fifo, (int)length, expected);
+	count = count < capacity ? count : capacity;
+	HOST_TEST_EXPECT_EQ(count, fifo_luma_count(length, capacity));
+	memset(expected + count, 0xEE, sizeof(expected) - count);
+	fifo_luma_read(&spi, 3, 7, image, fifo_luma_count(length, capacity));
+
+	int ok = !misuse && spi.data_bits == 8 && memcmp(expected, image, sizeof(image)) == 0;
+	// Nothing past the frame is clocked out of the FIFO
+	ok = ok && fifo_pos <= length - (length > 8 ? 7 : length);
+	// The filler is what spi_read_blocking() sent
+	ok = ok && (count == 0 || filler_seen == 0x3C);
+	if (!ok) {
+		printf("length %zu capacity %zu: misuse %d, %zu bytes clocked\n", length, capacity,
+		       misuse, fifo_pos);
+	}
+	return ok;
+}
+
+HOST_TEST(PersonDetectionFrame) {
+	fill_fifo(1);
+	HOST_TEST_EXPECT(matches_reference(FIFO_MAX, 96 * 96));
+	HOST_TEST_EXPECT_EQ(96 * 96, fifo_luma_count(FIFO_MAX, 96 * 96));
+}
+
+HOST_TEST(OddAndShortLengths) {
+	fill_fifo(2);
+	const size_t lengths[] = {0, 1, 8, 9, 10, 11, 100, 1001};
+	for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+		HOST_TEST_EXPECT(matches_reference(lengths[i], 96 * 96));
+	}
+}
+
+HOST_TEST(StopsAtCapacity) {
+	fill_fifo(3);
+	HOST_TEST_EXPECT(matches_reference(FIFO_MAX, 100));
+	HOST_TEST_EXPECT(matches_reference(FIFO_MAX, 1));
+	HOST_TEST_EXPECT_EQ(100, fifo_luma_count(1 << 19, 100));
+}
+
+int main(void) {
+	HOST_TEST_RUN(PersonDetectionFrame);
+	HOST_TEST_RUN(OddAndShortLengths);
+	HOST_TEST_RUN(StopsAtCapacity);
+	HOST_TEST_END();
+}
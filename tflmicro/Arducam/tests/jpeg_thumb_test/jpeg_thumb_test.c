@@ -0,0 +1,304 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <jpeglib.h>
+#include "jpeg_thumb.h"
+#include "host_test.h"
+
+// Decodes JPEGs with jpeg_thumb and with libjpeg's own scaled decoding,
+// which works from the same coefficients, and compares the thumbnails.
+// The images are encoded here with libjpeg in the layouts the OV2640 and
+// other encoders use, and read from the photos in the tree.
+
+#define MAX_JPEG (4 << 20)
+#define MAX_PIXELS (1600 * 1200)
+
+static uint8_t jpeg[MAX_JPEG];
+static size_t jpeg_size;
+static uint8_t rgb[MAX_PIXELS * 3];
+static uint8_t reference[MAX_PIXELS / 16];
+static unsigned reference_width, reference_height;
+static uint8_t thumb_pixels[MAX_PIXELS / 16];
+static struct jpeg_thumb thumb;
+static uint32_t seed;
+
+static uint32_t next_random(void) {
+	seed = seed * 1103515245 + 12345;
+	return seed >> 16;
+}
+
+// Gradients, a bright figure, hard edges and some noise
+static void make_scene(unsigned width, unsigned height) {
+	for (unsigned y = 0; y < height; y++) {
+		for (unsigned x = 0; x < width; x++) {
+			uint8_t *p = rgb + 3 * (y * width + x);
+			int r = 60 + 120 * x / width, g = 40 + 150 * y / height, b = 90;
+			const int dx = (int)x - (int)width / 2, dy = (int)y - (int)height / 3;
+			if (dx * dx + dy * dy < (int)(width * width / 64)) {
+				r = 230, g = 190, b = 160;
+			}
+			if ((x / 7 + y / 11) % 5 == 0) {
+				r /= 3, g /= 3, b /= 3;
+			}
+			const int noise = (int)(next_random() % 21) - 10;
+			p[0] = (uint8_t)(r + noise < 0 ? 0 : r + noise > 255 ? 255 : r + noise);
+			p[1] = (uint8_t)(g + noise < 0 ? 0 : g + noise > 255 ? 255 : g + noise);
+			p[2] = (uint8_t)b;
+		}
+	}
+}
+
+// Encodes the scene; luma sampling h by v, 0 for grayscale
+static void encode(unsigned width, unsigned height, int quality, int h, int v, int restart,
+                   int progressive) {
+	struct jpeg_compress_struct cinfo;
+	struct jpeg_error_mgr jerr;
+	unsigned char *out = NULL;
+	unsigned long out_size = 0;
+	cinfo.err = jpeg_std_error(&jerr);
+	jpeg_create_compress(&cinfo);
+	jpeg_mem_dest(&cinfo, &out, &out_size);
+	cinfo.image_width = width;
+	cinfo.image_height = height;
+	cinfo.input_components = 3;
+	cinfo.in_color_space = JCS_RGB;
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_quality(&cinfo, quality, TRUE);
+	if (h) {
+		cinfo.comp_info[0].h_samp_factor = h;
+		cinfo.comp_info[0].v_samp_factor = v;
+	} else {
+		jpeg_set_colorspace(&cinfo, JCS_GRAYSCALE);
+	}
+	cinfo.restart_interval = restart;
+	if (progressive) {
+		jpeg_simple_progression(&cinfo);
+	}
+	jpeg_start_compress(&cinfo, TRUE);
+	while (cinfo.next_scanline < height) {
+		JSAMPROW row = rgb + 3 * cinfo.next_scanline * width;
+		jpeg_write_scanlines(&cinfo, &row, 1);
+	}
+	jpeg_finish_compress(&cinfo);
+	jpeg_destroy_compress(&cinfo);
+	memcpy(jpeg, out, out_size);
+	jpeg_size = out_size;
+	free(out);
+}
+
+static int load(const char *name) {
+	char path[512];
+	snprintf(path, sizeof(path), "%s/%s", PHOTO_DIR, name);
+	FILE *f = fopen(path, "rb");
+	if (!f) {
+		printf("cannot open %s\n", path);
+		return 0;
+	}
+	jpeg_size = fread(jpeg, 1, sizeof(jpeg), f);
+	fclose(f);
+	return jpeg_size > 0;
+}
+
+static void decode_reference(unsigned scale) {
+	struct jpeg_decompress_struct cinfo;
+	struct jpeg_error_mgr jerr;
+	cinfo.err = jpeg_std_error(&jerr);
+	jpeg_create_decompress(&cinfo);
+	jpeg_mem_src(&cinfo, jpeg, jpeg_size);
+	jpeg_read_header(&cinfo, TRUE);
+	cinfo.out_color_space = JCS_GRAYSCALE;
+	cinfo.scale_num = 1;
+	cinfo.scale_denom = scale;
+	cinfo.dct_method = JDCT_ISLOW;
+	jpeg_start_decompress(&cinfo);
+	reference_width = cinfo.output_width;
+	reference_height = cinfo.output_height;
+	while (cinfo.output_scanline < cinfo.output_height) {
+		JSAMPROW row = reference + cinfo.output_scanline * reference_width;
+		jpeg_read_scanlines(&cinfo, &row, 1);
+	}
+	jpeg_finish_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+}
+
+// Hands the JPEG over chunk bytes at a time
+struct source {
+	size_t offset;
+	size_t chunk;
+	size_t size;
+};
+
+static const uint8_t *fill(void *ctx, size_t *size) {
+	struct source *s = (struct source *)ctx;
+	const size_t left = s->size - s->offset;
+	*size = left < s->chunk ? left : s->chunk;
+	const uint8_t *data = jpeg + s->offset;
+	s->offset += *size;
+	return data;
+}
+
+struct collect {
+	unsigned next_y;
+	unsigned width;
+	unsigned height;
+	int in_order;
+};
+
+static void collect_row(void *ctx, unsigned y, const uint8_t *pixels, unsigned width,
+                        unsigned height) {
+	struct collect *c = (struct collect *)ctx;
+	c->in_order &= y == c->next_y;
+	c->next_y = y + 1;
+	c->width = width;
+	c->height = height;
+	memcpy(thumb_pixels + y * width, pixels, width);
+}
+
+static int decode(unsigned scale, size_t chunk, struct collect *c) {
+	struct source s = {0, chunk, jpeg_size};
+	memset(c, 0, sizeof(*c));
+	c->in_order = 1;
+	return jpeg_thumb_decode(&thumb, scale, fill, &s, collect_row, c);
+}
+
+// Largest difference from libjpeg, or -1 if the thumbnail is not whole
+static int compare(unsigned scale, size_t chunk) {
+	struct collect c;
+	const int err = decode(scale, chunk, &c);
+	decode_reference(scale);
+	if (err != JPEG_THUMB_OK || !c.in_order || c.width != reference_width ||
+	    c.height != reference_height || c.next_y != c.height) {
+		printf("error %d, %ux%u, %u rows, libjpeg %ux%u\n", err, c.width, c.height, c.next_y,
+		       reference_width, reference_height);
+		return -1;
+	}
+	int worst = 0;
+	for (unsigned i = 0; i < c.width * c.height; i++) {
+		const int diff = abs(thumb_pixels[i] - reference[i]);
+		worst = diff > worst ? diff : worst;
+	}
+	return worst;
+}
+
+HOST_TEST(MatchesLibjpeg) {
+	static const unsigned sizes[][2] = {{320, 240}, {640, 480}, {100, 75}, {96, 96}, {1600, 1200}};
+	// OV2640 4:2:2, 4:2:0, 4:4:4 and grayscale
+	static const int sampling[][2] = {{2, 1}, {2, 2}, {1, 1}, {0, 0}};
+	seed = 1;
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		make_scene(sizes[i][0], sizes[i][1]);
+		for (size_t j = 0; j < sizeof(sampling) / sizeof(sampling[0]); j++) {
+			for (int quality = 50; quality <= 95; quality += 45) {
+				encode(sizes[i][0], sizes[i][1], quality, sampling[j][0], sampling[j][1], 0, 0);
+				// DC only is exact; the quarter means round a little
+				// differently from libjpeg's 2x2 transform
+				HOST_TEST_EXPECT_EQ(0, compare(8, 4096));
+				const int worst = compare(4, 4096);
+				HOST_TEST_EXPECT(worst >= 0 && worst <= 1);
+			}
+		}
+	}
+}
+
+HOST_TEST(AnyChunkSize) {
+	seed = 2;
+	make_scene(160, 120);
+	encode(160, 120, 80, 2, 1, 0, 0);
+	for (size_t chunk = 1; chunk <= 600; chunk += 37) {
+		HOST_TEST_EXPECT_EQ(0, compare(8, chunk));
+		const int worst = compare(4, chunk);
+		HOST_TEST_EXPECT(worst >= 0 && worst <= 1);
+	}
+}
+
+HOST_TEST(RestartMarkers) {
+	seed = 3;
+	make_scene(320, 240);
+	for (int restart = 1; restart <= 31; restart += 6) {
+		encode(320, 240, 75, 2, 1, restart, 0);
+		HOST_TEST_EXPECT_EQ(0, compare(8, 13));
+		const int worst = compare(4, 4096);
+		HOST_TEST_EXPECT(worst >= 0 && worst <= 1);
+	}
+}
+
+HOST_TEST(Photos) {
+	static const char *const photos[] = {
+		"20211124_204656.part.20pc.jpg",
+		"20211207_202449.part.50pc.jpg",
+		"20211207_220948.part.25pc.jpg",
+	};
+	for (size_t i = 0; i < sizeof(photos) / sizeof(photos[0]); i++) {
+		HOST_TEST_EXPECT(load(photos[i]));
+		HOST_TEST_EXPECT_EQ(0, compare(8, 512));
+		const int worst = compare(4, 512);
+		HOST_TEST_EXPECT(worst >= 0 && worst <= 1);
+	}
+}
+
+HOST_TEST(Rejects) {
+	struct collect c;
+	HOST_TEST_EXPECT(load("Pico4MLcbot.15pc.jpg"));
+	HOST_TEST_EXPECT_EQ(JPEG_THUMB_UNSUPPORTED, decode(4, 4096, &c));
+	seed = 4;
+	make_scene(320, 240);
+	encode(320, 240, 75, 2, 1, 0, 1);
+	HOST_TEST_EXPECT_EQ(JPEG_THUMB_UNSUPPORTED, decode(8, 4096, &c));
+	HOST_TEST_EXPECT_EQ(0, c.next_y);
+	// Too wide to hold a row of at 1/4, but not at 1/8
+	make_scene(1608, 16);
+	encode(1608, 16, 75, 2, 1, 0, 0);
+	HOST_TEST_EXPECT_EQ(JPEG_THUMB_UNSUPPORTED, decode(4, 4096, &c));
+	HOST_TEST_EXPECT_EQ(JPEG_THUMB_OK, decode(8, 4096, &c));
+	HOST_TEST_EXPECT_EQ(JPEG_THUMB_UNSUPPORTED, decode(2, 4096, &c));
+
+	make_scene(320, 240);
+	encode(320, 240, 75, 2, 1, 0, 0);
+	const size_t whole = jpeg_size;
+	// Cut off in the middle of the entropy coded data, and in the header
+	jpeg_size = whole / 2;
+	HOST_TEST_EXPECT_EQ(JPEG_THUMB_TRUNCATED, decode(8, 100, &c));
+	jpeg_size = 100;
+	HOST_TEST_EXPECT_EQ(JPEG_THUMB_TRUNCATED, decode(8, 100, &c));
+	// Not a JPEG
+	jpeg_size = whole;
+	jpeg[1] = 0xD9;
+	HOST_TEST_EXPECT_EQ(JPEG_THUMB_CORRUPT, decode(8, 100, &c));
+}
+
+HOST_TEST(FitsModelInput) {
+	// 640x480 at 1/4, centre 120x120 of the 160x120 thumbnail, to 96x96
+	static uint8_t frame[96 * 96];
+	struct jpeg_thumb_fit fit = {frame, 96};
+	seed = 5;
+	make_scene(640, 480);
+	encode(640, 480, 75, 2, 1, 0, 0);
+	struct source s = {0, 512, jpeg_size};
+	memset(frame, 0, sizeof(frame));
+	HOST_TEST_EXPECT_EQ(JPEG_THUMB_OK,
+	                    jpeg_thumb_decode(&thumb, 4, fill, &s, jpeg_thumb_fit_row, &fit));
+	decode_reference(4);
+	HOST_TEST_EXPECT_EQ(160, reference_width);
+	int worst = 0;
+	for (unsigned y = 0; y < 96; y++) {
+		for (unsigned x = 0; x < 96; x++) {
+			const unsigned sy = (2 * y + 1) * 120 / 192;
+			const unsigned sx = 20 + (2 * x + 1) * 120 / 192;
+			const int diff = abs(frame[y * 96 + x] - reference[sy * 160 + sx]);
+			worst = diff > worst ? diff : worst;
+		}
+	}
+	HOST_TEST_EXPECT(worst <= 1);
+	printf("decoder state %u bytes\n", (unsigned)sizeof(thumb));
+}
+
+int main(void) {
+	HOST_TEST_RUN(MatchesLibjpeg);
+	HOST_TEST_RUN(AnyChunkSize);
+	HOST_TEST_RUN(RestartMarkers);
+	HOST_TEST_RUN(Photos);
+	HOST_TEST_RUN(Rejects);
+	HOST_TEST_RUN(FitsModelInput);
+	HOST_TEST_END();
+}
@@ -0,0 +1,34 @@
+#ifndef _MOCK_HARDWARE_DMA__H
+#define _MOCK_HARDWARE_DMA__H
+#include <stdbool.h>
+#include <stdint.h>
+
+// The part of the Pico SDK DMA API fifo_luma.c uses. The test that
+// includes this defines the functions on top of its model of the DMA.
+typedef unsigned int uint;
+
+enum dma_channel_transfer_size {
+	DMA_SIZE_8 = 0,
+	DMA_SIZE_16 = 1,
+	DMA_SIZE_32 = 2,
+};
+
+typedef struct {
+	bool read_increment;
+	bool write_increment;
+	uint dreq;
+	enum dma_channel_transfer_size size;
+} dma_channel_config;
+
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+void channel_config_set_transfer_data_size(dma_channel_config *c,
+                                           enum dma_channel_transfer_size size);
+void dma_channel_configure(uint channel, const dma_channel_config *config,
+                           volatile void *write_addr, const volatile void *read_addr,
+                           uint transfer_count, bool trigger);
+void dma_start_channel_mask(uint32_t chan_mask);
+void dma_channel_wait_for_finish_blocking(uint channel);
+#endif
@@ -0,0 +1,27 @@
+#ifndef _MOCK_HARDWARE_SPI__H
+#define _MOCK_HARDWARE_SPI__H
+#include <stdbool.h>
+#include <stdint.h>
+
+// The part of the Pico SDK SPI API fifo_luma.c uses. The test that
+// includes this defines the functions on top of its model of the SPI.
+typedef unsigned int uint;
+
+typedef struct {
+	uint32_t cr0;
+	uint32_t cr1;
+	uint32_t dr;
+	uint32_t sr;
+} spi_hw_t;
+
+typedef struct spi_inst spi_inst_t;
+
+typedef enum { SPI_CPOL_0 = 0, SPI_CPOL_1 = 1 } spi_cpol_t;
+typedef enum { SPI_CPHA_0 = 0, SPI_CPHA_1 = 1 } spi_cpha_t;
+typedef enum { SPI_LSB_FIRST = 0, SPI_MSB_FIRST = 1 } spi_order_t;
+
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha,
+                    spi_order_t order);
+spi_hw_t *spi_get_hw(spi_inst_t *spi);
+uint spi_get_dreq(spi_inst_t *spi, bool is_tx);
+#endif
@@ -0,0 +1,189 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "motion_gate.h"
+#include "host_test.h"
+
+// Replays camera sequences through the gate the way loop() uses it:
+// GetImage(), then Invoke() only when the gate lets the frame through,
+// otherwise the scores of the last Invoke() are reported again.
+//
+// The sequences are made up like the 96x96 OV2640 frames: a textured
+// scene, sensor noise of a few codes on every pixel, exposure drifting
+// slowly, and a person-sized object walking through.
+#define WIDTH 96
+#define HEIGHT 96
+#define BLOCK 16
+// Mean difference of 6 codes over a block
+#define THRESHOLD (BLOCK * BLOCK * 6)
+#define OBJECT_WIDTH 16
+#define OBJECT_HEIGHT 40
+
+static uint32_t reference[WIDTH * HEIGHT / 4];
+static uint32_t frame_words[WIDTH * HEIGHT / 4];
+static int8_t *const frame = (int8_t *)frame_words;
+static uint8_t scene[HEIGHT][WIDTH];
+static uint32_t seed;
+
+static uint32_t next_random(void) {
+	seed = seed * 1103515245 + 12345;
+	return seed >> 16;
+}
+
+static void make_scene(void) {
+	for (int y = 0; y < HEIGHT; y++) {
+		for (int x = 0; x < WIDTH; x++) {
+			// A wall, a floor and a door frame
+			int v = y < 60 ? 150 + x / 4 : 70 + (x + y) % 24;
+			if (x >= 60 && x < 64) v = 30;
+			scene[y][x] = v;
+		}
+	}
+}
+
+// Writes the frame GetImage() returns: the scene, brightened by exposure,
+// the object with its left edge at object_x (none if negative), and noise
+static void shoot(int exposure, int object_x, int noise) {
+	for (int y = 0; y < HEIGHT; y++) {
+		for (int x = 0; x < WIDTH; x++) {
+			int v = scene[y][x] + exposure;
+			if (object_x >= 0 && x >= object_x && x < object_x + OBJECT_WIDTH && y >= 40 &&
+			    y < 40 + OBJECT_HEIGHT) {
+				v = 220;
+			}
+			v += (int)(next_random() % (2 * noise + 1)) - noise;
+			v = v < 0 ? 0 : v > 255 ? 255 : v;
+			frame[y * WIDTH + x] = (int8_t)(v - 128);
+		}
+	}
+}
+
+// Stands in for the model: whether the object is in the frame
+static int detect(void) {
+	int bright = 0;
+	for (int i = 0; i < WIDTH * HEIGHT; i++) {
+		bright += frame[i] >= 220 - 128 - 4;
+	}
+	return bright > OBJECT_WIDTH * OBJECT_HEIGHT / 2;
+}
+
+static uint32_t scalar_sad(const int8_t *a, const int8_t *b, size_t count) {
+	uint32_t sad = 0;
+	for (size_t i = 0; i < count; i++) {
+		sad += abs(a[i] - b[i]);
+	}
+	return sad;
+}
+
+HOST_TEST(SadMatchesScalar) {
+	static uint32_t a[600], b[600];
+	seed = 1;
+	for (size_t count = 0; count <= 600; count += 7) {
+		for (size_t i = 0; i < count; i++) {
+			a[i] = next_random() << 16 | next_random();
+			b[i] = next_random() << 16 | next_random();
+		}
+		HOST_TEST_EXPECT_EQ(scalar_sad((int8_t *)a, (int8_t *)b, 4 * count),
+		                    motion_gate_sad(a, b, count));
+	}
+	// The largest difference in every byte, past the 128-word fold
+	for (size_t i = 0; i < 600; i++) {
+		a[i] = 0x7F7F7F7F;
+		b[i] = 0x80808080;
+	}
+	HOST_TEST_EXPECT_EQ(600 * 4 * 255, motion_gate_sad(a, b, 600));
+	HOST_TEST_EXPECT_EQ(600 * 4 * 255, motion_gate_sad(b, a, 600));
+	HOST_TEST_EXPECT_EQ(0, motion_gate_sad(a, a, 600));
+}
+
+HOST_TEST(StaticSceneSkipsInference) {
+	struct motion_gate gate;
+	motion_gate_init(&gate, reference, WIDTH, HEIGHT, BLOCK, THRESHOLD, 1000);
+	seed = 2;
+	make_scene();
+	for (int i = 0; i < 100; i++) {
+		shoot(0, -1, 3);
+		HOST_TEST_EXPECT_EQ(i == 0, motion_gate_check(&gate, frame));
+	}
+	HOST_TEST_EXPECT_EQ(1, gate.invoked);
+	HOST_TEST_EXPECT_EQ(99, gate.skipped);
+	// Noise alone stays well under the threshold
+	HOST_TEST_EXPECT(gate.last_sad < THRESHOLD / 2);
+}
+
+HOST_TEST(StalenessIsBounded) {
+	struct motion_gate gate;
+	motion_gate_init(&gate, reference, WIDTH, HEIGHT, BLOCK, THRESHOLD, 10);
+	seed = 3;
+	make_scene();
+	for (int i = 0; i < 100; i++) {
+		shoot(0, -1, 3);
+		// Every eleventh frame: the one after ten skips in a row
+		const int due = i % 11 == 0;
+		HOST_TEST_EXPECT_EQ(due, motion_gate_check(&gate, frame));
+	}
+	HOST_TEST_EXPECT_EQ(10, gate.invoked);
+	HOST_TEST_EXPECT_EQ(90, gate.skipped);
+}
+
+HOST_TEST(SlowDriftAddsUp) {
+	// Exposure creeping up a code per frame is compared with the frame
+	// inference last ran on, not the previous one
+	struct motion_gate gate;
+	motion_gate_init(&gate, reference, WIDTH, HEIGHT, BLOCK, THRESHOLD, 1000);
+	seed = 4;
+	make_scene();
+	int last_run = 0;
+	for (int i = 0; i < 40; i++) {
+		shoot(i, -1, 0);
+		if (motion_gate_check(&gate, frame)) {
+			HOST_TEST_EXPECT(i == 0 || i - last_run == 7);
+			last_run = i;
+		}
+	}
+	HOST_TEST_EXPECT_EQ(6, gate.invoked);
+}
+
+HOST_TEST(ReplayKeepsDetections) {
+	struct motion_gate gate;
+	motion_gate_init(&gate, reference, WIDTH, HEIGHT, BLOCK, THRESHOLD, 30);
+	seed = 5;
+	make_scene();
+	int score = 0, invoked_while_moving = 0, moving_frames = 0, last_x = -1;
+	for (int i = 0; i < 300; i++) {
+		// Empty room, someone walks in and stands still by the door, then
+		// walks out; the exposure wanders by a few codes meanwhile
+		int object_x = -1;
+		if (i >= 50 && i < 90) {
+			object_x = (i - 50) * 2 - OBJECT_WIDTH / 2;
+		} else if (i >= 90 && i < 200) {
+			object_x = 72;
+		} else if (i >= 200 && i < 212) {
+			object_x = 72 + (i - 200) * 2;
+		}
+		object_x = object_x > WIDTH - OBJECT_WIDTH ? -1 : object_x < 0 ? 0 : object_x;
+		const bool moving = object_x != last_x;
+		last_x = object_x;
+		shoot((i / 40) % 3, object_x, 3);
+		if (motion_gate_check(&gate, frame)) {
+			score = detect();
+			invoked_while_moving += moving;
+		}
+		moving_frames += moving;
+		// The reused score is always the right one
+		HOST_TEST_EXPECT_EQ(object_x >= 0, score);
+	}
+	HOST_TEST_EXPECT_EQ(moving_frames, invoked_while_moving);
+	printf("%u of %u frames inferred\n", (unsigned)gate.invoked,
+	       (unsigned)(gate.invoked + gate.skipped));
+	HOST_TEST_EXPECT(gate.skipped > 3 * gate.invoked);
+}
+
+int main(void) {
+	HOST_TEST_RUN(SadMatchesScalar);
+	HOST_TEST_RUN(StaticSceneSkipsInference);
+	HOST_TEST_RUN(StalenessIsBounded);
+	HOST_TEST_RUN(SlowDriftAddsUp);
+	HOST_TEST_RUN(ReplayKeepsDetections);
+	HOST_TEST_END();
+}
@@ -0,0 +1,177 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ov2640_window.h"
+#include "ov2640.h"
+#include "host_test.h"
+
+// Checks the window registers against the fixed size tables in ov2640.h,
+// which end with the same writes worked out by hand, and that every field
+// reads back as the window asked for.
+
+// The last value a table writes to a DSP (bank 0) register, or -1
+static int dsp_value(const struct sensor_reg *regs, unsigned int reg) {
+	int bank = 0, value = -1;
+	for (; !(regs->reg == 0xff && regs->val == 0xff); regs++) {
+		if (regs->reg == 0xff) bank = regs->val;
+		else if (bank == 0 && regs->reg == reg) value = regs->val;
+	}
+	return value;
+}
+
+// Reads the window back out of the registers
+static void decode(const struct sensor_reg *regs, struct ov2640_window *w, int *h_div,
+                   int *v_div) {
+	const int vhyx = dsp_value(regs, 0x55);
+	const int zmhh = dsp_value(regs, 0x5c);
+	w->width = (dsp_value(regs, 0x51) | (vhyx >> 3 & 1) << 8 |
+	            (dsp_value(regs, 0x57) >> 7 & 1) << 9) * 4;
+	w->height = (dsp_value(regs, 0x52) | (vhyx >> 7 & 1) << 8) * 4;
+	w->x = dsp_value(regs, 0x53) | (vhyx & 7) << 8;
+	w->y = dsp_value(regs, 0x54) | (vhyx >> 4 & 7) << 8;
+	w->out_width = (dsp_value(regs, 0x5a) | (zmhh & 3) << 8) * 4;
+	w->out_height = (dsp_value(regs, 0x5b) | (zmhh >> 2 & 1) << 8) * 4;
+	*h_div = dsp_value(regs, 0x50) & 7;
+	*v_div = dsp_value(regs, 0x50) >> 3 & 7;
+}
+
+// Whether ov2640_window_regs() writes what table does for the whole DSP
+// input scaled to out_width by out_height
+static int matches_table(const struct sensor_reg *table, int out_width, int out_height) {
+	const struct ov2640_window w = {
+		.in_width = dsp_value(table, 0xc0) * 8, .in_height = dsp_value(table, 0xc1) * 8,
+		.x = 0, .y = 0,
+		.width = dsp_value(table, 0xc0) * 8, .height = dsp_value(table, 0xc1) * 8,
+		.out_width = out_width, .out_height = out_height,
+	};
+	struct sensor_reg regs[OV2640_WINDOW_REGS];
+	if (ov2640_window_regs(&w, regs) != 0) {
+		return 0;
+	}
+	int compared = 0;
+	for (int i = 0; i < OV2640_WINDOW_REGS - 1; i++) {
+		const int expected = dsp_value(table, regs[i].reg);
+		if (regs[i].reg == 0xff || regs[i].reg == 0xe0 || expected < 0) {
+			continue;
+		}
+		if ((int)regs[i].val != expected) {
+			printf("%dx%d: 0x%02x is 0x%02x, the table has 0x%02x\n", out_width, out_height,
+			       regs[i].reg, regs[i].val, expected);
+			return 0;
+		}
+		compared++;
+	}
+	// At least CTRLI, the window, the offsets and the output size
+	return compared >= 9;
+}
+
+HOST_TEST(MatchesFixedSizeTables) {
+	HOST_TEST_EXPECT(matches_table(OV2640_160x120_JPEG, 160, 120));
+	HOST_TEST_EXPECT(matches_table(OV2640_176x144_JPEG, 176, 144));
+	HOST_TEST_EXPECT(matches_table(OV2640_320x240_JPEG, 320, 240));
+	HOST_TEST_EXPECT(matches_table(OV2640_352x288_JPEG, 352, 288));
+	HOST_TEST_EXPECT(matches_table(OV2640_640x480_JPEG, 640, 480));
+	HOST_TEST_EXPECT(matches_table(OV2640_800x600_JPEG, 800, 600));
+	HOST_TEST_EXPECT(matches_table(OV2640_1024x768_JPEG, 1024, 768));
+	HOST_TEST_EXPECT(matches_table(OV2640_1600x1200_JPEG, 1600, 1200));
+	// OV2640_1280x1024_JPEG really sends 1280x960
+	HOST_TEST_EXPECT(matches_table(OV2640_1280x1024_JPEG, 1280, 960));
+}
+
+HOST_TEST(PersonDetectionWindow) {
+	// OV2640_YUV_96x96 scales all of its 1600x1200 input to 96x96
+	HOST_TEST_EXPECT_EQ(1600, dsp_value(OV2640_YUV_96x96, 0xc0) * 8);
+	HOST_TEST_EXPECT_EQ(1200, dsp_value(OV2640_YUV_96x96, 0xc1) * 8);
+	HOST_TEST_EXPECT_EQ(0x88, dsp_value(OV2640_YUV_96x96, 0x55));
+	HOST_TEST_EXPECT_EQ(24, dsp_value(OV2640_YUV_96x96, 0x5a));
+	HOST_TEST_EXPECT_EQ(24, dsp_value(OV2640_YUV_96x96, 0x5b));
+	// What ov2640Init(YUV) sets up instead: the centre square
+	const struct ov2640_window w = {
+		.in_width = 1600, .in_height = 1200,
+		.x = 200, .y = 0, .width = 1200, .height = 1200,
+		.out_width = 96, .out_height = 96,
+	};
+	struct sensor_reg regs[OV2640_WINDOW_REGS];
+	HOST_TEST_EXPECT_EQ(0, ov2640_window_regs(&w, regs));
+	// Divided by 8 to 150x150, then zoomed to 96x96
+	HOST_TEST_EXPECT_EQ(0x9b, dsp_value(regs, 0x50));
+	HOST_TEST_EXPECT_EQ(300 & 0xff, dsp_value(regs, 0x51));
+	HOST_TEST_EXPECT_EQ(300 & 0xff, dsp_value(regs, 0x52));
+	HOST_TEST_EXPECT_EQ(200, dsp_value(regs, 0x53));
+	HOST_TEST_EXPECT_EQ(0x88, dsp_value(regs, 0x55));
+	HOST_TEST_EXPECT_EQ(24, dsp_value(regs, 0x5a));
+	HOST_TEST_EXPECT_EQ(24, dsp_value(regs, 0x5b));
+	// The DVP is held only while the window changes, and the table ends
+	HOST_TEST_EXPECT_EQ(0x04, regs[1].val);
+	HOST_TEST_EXPECT_EQ(0xe0, regs[OV2640_WINDOW_REGS - 2].reg);
+	HOST_TEST_EXPECT_EQ(0x00, regs[OV2640_WINDOW_REGS - 2].val);
+	HOST_TEST_EXPECT_EQ(0xff, regs[OV2640_WINDOW_REGS - 1].val);
+}
+
+HOST_TEST(FieldsReadBack) {
+	srand(1);
+	int checked = 0;
+	while (checked < 2000) {
+		struct ov2640_window w = {.in_width = 1600, .in_height = 1200};
+		w.width = 4 * (1 + rand() % 400);
+		w.height = 4 * (1 + rand() % 300);
+		w.x = rand() % (1600 - w.width + 1);
+		w.y = rand() % (1200 - w.height + 1);
+		w.out_width = 4 * (1 + rand() % (w.width / 4));
+		w.out_height = 4 * (1 + rand() % (w.height / 4));
+		struct sensor_reg regs[OV2640_WINDOW_REGS];
+		HOST_TEST_EXPECT_EQ(0, ov2640_window_regs(&w, regs));
+		struct ov2640_window back = {.in_width = 1600, .in_height = 1200};
+		int h_div, v_div;
+		decode(regs, &back, &h_div, &v_div);
+		HOST_TEST_EXPECT(memcmp(&w, &back, sizeof(w)) == 0);
+		// Halved as often as the field allows without going under the output
+		HOST_TEST_EXPECT(w.width >> h_div >= w.out_width);
+		HOST_TEST_EXPECT(h_div == 7 || w.width >> (h_div + 1) < w.out_width);
+		HOST_TEST_EXPECT(w.height >> v_div >= w.out_height);
+		HOST_TEST_EXPECT(v_div == 7 || w.height >> (v_div + 1) < w.out_height);
+		HOST_TEST_EXPECT_EQ(h_div || v_div, dsp_value(regs, 0x50) >> 7);
+		checked++;
+	}
+}
+
+HOST_TEST(RejectsImpossibleWindows) {
+	const struct ov2640_window good = {
+		.in_width = 176, .in_height = 144,
+		.x = 16, .y = 0, .width = 144, .height = 144,
+		.out_width = 96, .out_height = 96,
+	};
+	struct sensor_reg regs[OV2640_WINDOW_REGS];
+	HOST_TEST_EXPECT_EQ(0, ov2640_window_regs(&good, regs));
+	memset(regs, 0x5A, sizeof(regs));
+	struct ov2640_window w = good;
+	w.out_width = 98;
+	HOST_TEST_EXPECT_EQ(-1, ov2640_window_regs(&w, regs));
+	w = good;
+	w.width = 146;
+	HOST_TEST_EXPECT_EQ(-1, ov2640_window_regs(&w, regs));
+	w = good;
+	w.out_height = 148;
+	HOST_TEST_EXPECT_EQ(-1, ov2640_window_regs(&w, regs));
+	w = good;
+	w.out_width = 0;
+	HOST_TEST_EXPECT_EQ(-1, ov2640_window_regs(&w, regs));
+	w = good;
+	w.x = 36;
+	HOST_TEST_EXPECT_EQ(-1, ov2640_window_regs(&w, regs));
+	w = good;
+	w.y = 4;
+	HOST_TEST_EXPECT_EQ(-1, ov2640_window_regs(&w, regs));
+	// Left alone
+	for (size_t i = 0; i < sizeof(regs); i++) {
+		HOST_TEST_EXPECT_EQ(0x5A, ((const uint8_t *)regs)[i]);
+	}
+}
+
+int main(void) {
+	HOST_TEST_RUN(MatchesFixedSizeTables);
+	HOST_TEST_RUN(PersonDetectionWindow);
+	HOST_TEST_RUN(FieldsReadBack);
+	HOST_TEST_RUN(RejectsImpossibleWindows);
+	HOST_TEST_END();
+}
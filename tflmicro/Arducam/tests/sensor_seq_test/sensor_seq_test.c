@@ -0,0 +1,267 @@
+#include <stdint.h>
+#include <string.h>
+#include "sensor_seq.h"
+#include "ov2640.h"
+#include "host_test.h"
+
+// Runs register tables through sensor_seq on a mock I2C bus with a sensor
+// behind it, and checks what reached the sensor, in what order and how
+// long it took.
+//
+// The bus reads a buffer only when the next write() or flush() comes, as
+// late as a DMA channel could, so a buffer reused too early shows up as
+// wrong writes. Time advances by the length of every transaction at
+// 400 kHz and by every sleep.
+#define MAX_EVENTS 1024
+// Start, 8 bits and an acknowledge per byte, stop: in ns at 400 kHz
+#define TRANSACTION_NS(bytes) ((2 + 9 * (bytes)) * 2500L)
+
+enum event_type { EVENT_WRITE, EVENT_READ, EVENT_SLEEP };
+
+struct event {
+	enum event_type type;
+	uint8_t reg;
+	uint8_t val;
+	uint32_t ms;
+	// When it ended
+	long ns;
+};
+
+struct mock {
+	struct event events[MAX_EVENTS];
+	int event_count;
+	long ns;
+	// The sensor: two banks selected through register 0xff
+	uint8_t regs[2][256];
+	uint8_t bank;
+	// Register whose writes are not acknowledged, and a bit that does not
+	// stick in another one; -1 for none
+	int nak_reg;
+	int stuck_reg;
+	uint8_t stuck_mask;
+	int nak_pending;
+	// The buffer handed to the last write(), not read yet
+	const uint16_t *pending;
+	size_t pending_count;
+	int malformed;
+};
+
+static struct mock mock;
+
+static void add_event(enum event_type type, uint8_t reg, uint8_t val, uint32_t ms) {
+	if (mock.event_count < MAX_EVENTS) {
+		const struct event e = {type, reg, val, ms, mock.ns};
+		mock.events[mock.event_count++] = e;
+	}
+}
+
+static void sensor_write(uint8_t reg, uint8_t val) {
+	if (reg == mock.nak_reg) {
+		mock.nak_pending = 1;
+		return;
+	}
+	if (reg == 0xff) {
+		mock.bank = val & 1;
+	}
+	if (reg == mock.stuck_reg) {
+		val &= ~mock.stuck_mask;
+	}
+	mock.regs[mock.bank][reg] = val;
+}
+
+// Sends the pending buffer: every word is a byte, and the STOP bit ends a
+// transaction, which must be a register and a value
+static void complete_pending(void) {
+	size_t start = 0;
+	for (size_t i = 0; i < mock.pending_count; i++) {
+		if (!(mock.pending[i] & SENSOR_SEQ_STOP)) {
+			continue;
+		}
+		if (i - start != 1 || (mock.pending[start] & ~0xFF) != 0) {
+			mock.malformed = 1;
+		}
+		const uint8_t reg = mock.pending[start];
+		const uint8_t val = mock.pending[i] & 0xFF;
+		mock.ns += TRANSACTION_NS(3);
+		sensor_write(reg, val);
+		add_event(EVENT_WRITE, reg, val, 0);
+		start = i + 1;
+	}
+	if (start != mock.pending_count) {
+		mock.malformed = 1;
+	}
+	mock.pending = NULL;
+	mock.pending_count = 0;
+}
+
+static void mock_write(void *ctx, const uint16_t *cmds, size_t count) {
+	(void)ctx;
+	complete_pending();
+	mock.pending = cmds;
+	mock.pending_count = count;
+}
+
+static int mock_flush(void *ctx) {
+	(void)ctx;
+	complete_pending();
+	const int err = mock.nak_pending ? -1 : 0;
+	mock.nak_pending = 0;
+	return err;
+}
+
+static int mock_read(void *ctx, uint8_t reg, uint8_t *value) {
+	(void)ctx;
+	if (mock.pending != NULL) {
+		mock.malformed = 1;
+	}
+	mock.ns += TRANSACTION_NS(2) + TRANSACTION_NS(2);
+	*value = mock.regs[mock.bank][reg];
+	add_event(EVENT_READ, reg, *value, 0);
+	return 0;
+}
+
+static void mock_sleep_ms(void *ctx, uint32_t ms) {
+	(void)ctx;
+	if (mock.pending != NULL) {
+		mock.malformed = 1;
+	}
+	mock.ns += ms * 1000000L;
+	add_event(EVENT_SLEEP, 0, 0, ms);
+}
+
+static const struct sensor_seq_bus bus = {
+	.ctx = &mock,
+	.write = mock_write,
+	.flush = mock_flush,
+	.read = mock_read,
+	.sleep_ms = mock_sleep_ms,
+};
+
+static void mock_reset(void) {
+	memset(&mock, 0, sizeof(mock));
+	mock.nak_reg = -1;
+	mock.stuck_reg = -1;
+}
+
+// Whether the events from first on are the writes of regs, in order, with
+// a sleep for every delay and nothing else
+static int events_match(const struct sensor_reg *regs, int first) {
+	int e = first;
+	for (; !(regs->reg == 0xff && regs->val == 0xff); regs++, e++) {
+		if (e >= mock.event_count) {
+			return 0;
+		}
+		const struct event *ev = &mock.events[e];
+		if (regs->reg == SENSOR_REG_DELAY) {
+			if (ev->type != EVENT_SLEEP || ev->ms != regs->val) return 0;
+		} else if (ev->type != EVENT_WRITE || ev->reg != regs->reg || ev->val != regs->val) {
+			printf("event %d: wrote 0x%02x=0x%02x\n", e, ev->reg, ev->val);
+			return 0;
+		}
+	}
+	return e == mock.event_count && !mock.malformed;
+}
+
+HOST_TEST(EncodesOneTransactionPerWrite) {
+	const struct sensor_reg regs[] = {{0x12, 0x80}, {0x3c, 0x00}, {0xff, 0xff}};
+	uint16_t cmds[2 * SENSOR_SEQ_CHUNK];
+	HOST_TEST_EXPECT_EQ(2, sensor_seq_encode(regs, cmds));
+	HOST_TEST_EXPECT_EQ(0x12, cmds[0]);
+	HOST_TEST_EXPECT_EQ(0x80 | SENSOR_SEQ_STOP, cmds[1]);
+	HOST_TEST_EXPECT_EQ(0x3c, cmds[2]);
+	HOST_TEST_EXPECT_EQ(SENSOR_SEQ_STOP, cmds[3]);
+}
+
+HOST_TEST(WritesInOrderWithoutDelays) {
+	// Several chunks, the last one partial
+	struct sensor_reg regs[3 * SENSOR_SEQ_CHUNK + 6];
+	const int n = sizeof(regs) / sizeof(regs[0]) - 1;
+	for (int i = 0; i < n; i++) {
+		regs[i].reg = (i * 7) % 0xfe;
+		regs[i].val = i;
+	}
+	regs[n].reg = 0xff;
+	regs[n].val = 0xff;
+	mock_reset();
+	HOST_TEST_EXPECT_EQ(0, sensor_seq_write(&bus, regs));
+	HOST_TEST_EXPECT(events_match(regs, 0));
+	HOST_TEST_EXPECT_EQ(n * TRANSACTION_NS(3), mock.ns);
+}
+
+HOST_TEST(SleepsOnlyAtDelays) {
+	const struct sensor_reg regs[] = {
+		{0xff, 0x01}, {0x12, 0x80}, {SENSOR_REG_DELAY, 5},
+		{0x11, 0x00}, {SENSOR_REG_DELAY, 1}, {SENSOR_REG_DELAY, 2}, {0x09, 0x02},
+		{0xff, 0xff},
+	};
+	mock_reset();
+	HOST_TEST_EXPECT_EQ(0, sensor_seq_write(&bus, regs));
+	HOST_TEST_EXPECT(events_match(regs, 0));
+	// The reset was on the wire before the sleep started
+	HOST_TEST_EXPECT_EQ(2 * TRANSACTION_NS(3), mock.events[2].ns - 5 * 1000000L);
+	HOST_TEST_EXPECT_EQ(4 * TRANSACTION_NS(3) + 8 * 1000000L, mock.ns);
+}
+
+HOST_TEST(ReportsNak) {
+	const struct sensor_reg regs[] = {{0x11, 0x00}, {0x22, 0x01}, {0x33, 0x02}, {0xff, 0xff}};
+	mock_reset();
+	mock.nak_reg = 0x22;
+	HOST_TEST_EXPECT_EQ(-1, sensor_seq_write(&bus, regs));
+	mock.nak_reg = -1;
+	HOST_TEST_EXPECT_EQ(0, sensor_seq_write(&bus, regs));
+}
+
+HOST_TEST(VerifiesLastValueInEachBank) {
+	const struct sensor_reg regs[] = {
+		{0xff, 0x00}, {0x10, 0x01}, {0x20, 0x02},
+		{0xff, 0x01}, {0x10, 0x03}, {SENSOR_REG_DELAY, 1}, {0x10, 0x04},
+		{0xff, 0x00}, {0x20, 0x05},
+		{0xff, 0xff},
+	};
+	mock_reset();
+	HOST_TEST_EXPECT_EQ(0, sensor_seq_write(&bus, regs));
+	mock.event_count = 0;
+	HOST_TEST_EXPECT_EQ(0, sensor_seq_verify(&bus, regs, 0xff));
+	// Bank 0 0x10, bank 1 0x10 and bank 0 0x20, once each
+	int reads = 0;
+	for (int e = 0; e < mock.event_count; e++) {
+		reads += mock.events[e].type == EVENT_READ;
+		HOST_TEST_EXPECT(mock.events[e].type != EVENT_SLEEP);
+	}
+	HOST_TEST_EXPECT_EQ(3, reads);
+	HOST_TEST_EXPECT(!mock.malformed);
+
+	mock_reset();
+	mock.stuck_reg = 0x20;
+	mock.stuck_mask = 0x01;
+	HOST_TEST_EXPECT_EQ(0, sensor_seq_write(&bus, regs));
+	HOST_TEST_EXPECT_EQ(1, sensor_seq_verify(&bus, regs, 0xff));
+}
+
+HOST_TEST(PersonDetectionBringUp) {
+	// What ov2640Init(YUV) writes; it used to sleep 10 ms after every write
+	mock_reset();
+	HOST_TEST_EXPECT_EQ(0, sensor_seq_write(&bus, OV2640_RESET));
+	HOST_TEST_EXPECT(events_match(OV2640_RESET, 0));
+	const int reset_events = mock.event_count;
+	HOST_TEST_EXPECT_EQ(0, sensor_seq_write(&bus, OV2640_YUV_96x96));
+	HOST_TEST_EXPECT(events_match(OV2640_YUV_96x96, reset_events));
+	int writes = 0;
+	for (int e = 0; e < mock.event_count; e++) {
+		writes += mock.events[e].type == EVENT_WRITE;
+	}
+	HOST_TEST_EXPECT(writes > 150);
+	HOST_TEST_EXPECT(mock.ns < 50 * 1000000L);
+	printf("%d writes in %ld us\n", writes, mock.ns / 1000);
+	HOST_TEST_EXPECT_EQ(0, sensor_seq_verify(&bus, OV2640_YUV_96x96, 0xff));
+}
+
+int main(void) {
+	HOST_TEST_RUN(EncodesOneTransactionPerWrite);
+	HOST_TEST_RUN(WritesInOrderWithoutDelays);
+	HOST_TEST_RUN(SleepsOnlyAtDelays);
+	HOST_TEST_RUN(ReportsNak);
+	HOST_TEST_RUN(VerifiesLastValueInEachBank);
+	HOST_TEST_RUN(PersonDetectionBringUp);
+	HOST_TEST_END();
+}
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "detection_responder.h"
+#include "frame_link_uart.h"
 #include "pico/stdlib.h"
 
 // This dummy implementation writes person and no person scores to the error
@@ -24,7 +25,7 @@ void RespondToDetection(tflite::ErrorReporter* error_reporter,
   TF_LITE_REPORT_ERROR(error_reporter, "person score:%d no person score %d",
                        person_score, no_person_score);
 #ifndef DO_NOT_OUTPUT_TO_UART
-  uint8_t header[4] = {0x55, 0xBB, (uint8_t)person_score, (uint8_t)no_person_score};
-  uart_write_blocking(uart0, header, 4);
+  const int8_t scores[2] = {person_score, no_person_score};
+  frame_link_uart_send(FRAME_LINK_SCORES, (const uint8_t *)scores, 2, FRAME_LINK_RAW);
 #endif
 }
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "model_settings.h"
 #include "arducam.h"
+#include "frame_link_uart.h"
 #include "pico/stdlib.h"
 
 #include "tensorflow/lite/micro/micro_time.h"
@@ -45,7 +46,6 @@ limitations under the License.
 
 TfLiteStatus GetImage(tflite::ErrorReporter* error_reporter, int image_width,
                       int image_height, int channels, int8_t* image_data) {
-  uint8_t header[2] = {0x55, 0xAA};
   static bool first = true;
   if (first) {
     arducam.systemInit();
@@ -57,14 +57,30 @@ TfLiteStatus GetImage(tflite::ErrorReporter* error_reporter, int image_width,
       TF_LITE_REPORT_ERROR(error_reporter, "Camera probe failed.");
       return kTfLiteError;
     }
+#ifdef CAPTURE_JPEG_THUMB
+    // JPEG at 640x480, which can go on to a host at full size, decoded
+    // to the model input at 1/4
+    arducam.cameraInit(JPEG);
+    arducam.setJpegSize(res_640x480);
+#else
     arducam.cameraInit(YUV);
+#endif
     first = false;
   }
   TF_LITE_MICRO_EXECUTION_TIME_BEGIN
+#ifdef CAPTURE_JPEG_THUMB
+  int err;
+  TF_LITE_MICRO_EXECUTION_TIME(error_reporter, err = capture_thumb((uint8_t *)image_data));
+  if (err) {
+    TF_LITE_REPORT_ERROR(error_reporter, "JPEG decode failed: %d", err);
+    return kTfLiteError;
+  }
+#else
   TF_LITE_MICRO_EXECUTION_TIME(error_reporter, capture((uint8_t *)image_data));
+#endif
 #ifndef DO_NOT_OUTPUT_TO_UART
-  TF_LITE_MICRO_EXECUTION_TIME(error_reporter, uart_write_blocking(UART_ID, header, 2));
-  TF_LITE_MICRO_EXECUTION_TIME(error_reporter, uart_write_blocking(UART_ID, (uint8_t *)image_data, kMaxImageSize));
+  // Queued while still unsigned; the DMA sends it during inference
+  TF_LITE_MICRO_EXECUTION_TIME(error_reporter, frame_link_uart_send(FRAME_LINK_IMAGE, (uint8_t *)image_data, kMaxImageSize, FRAME_LINK_DELTA));
 #endif
   for (int i = 0; i < image_width * image_height * channels; ++i) {
     image_data[i] = (uint8_t)image_data[i] - 128;
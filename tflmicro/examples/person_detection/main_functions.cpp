@@ -25,9 +25,14 @@ limitations under the License.
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/version.h"
 
+#include "motion_gate.h"
+#ifndef DO_NOT_OUTPUT_TO_UART
 #include "arducam.h"
+#include "frame_link_uart.h"
 #include "pico/stdlib.h"
+#include "hardware/dma.h"
 #include "hardware/irq.h"
+#endif
 
 #include "tensorflow/lite/micro/micro_time.h"
 #include <climits>
@@ -87,9 +92,27 @@ TfLiteTensor* input = nullptr;
 // An area of memory to use for input, output, and intermediate arrays.
 constexpr int kTensorArenaSize = 136 * 1024;
 static uint8_t tensor_arena[kTensorArenaSize];
+
+// Invoke() is skipped while no 16x16 block of the image differs from the
+// one it last ran on by more than 6 codes per pixel on average, but not for
+// more than kMotionMaxSkips frames in a row. The scores are kept here
+// rather than in the output tensor, whose memory GetImage() may overwrite.
+constexpr int kMotionBlock = 16;
+constexpr int kMotionThreshold = kMotionBlock * kMotionBlock * 6;
+constexpr int kMotionMaxSkips = 10;
+uint32_t motion_reference[kMaxImageSize / 4];
+struct motion_gate gate;
+int8_t person_score = 0;
+int8_t no_person_score = 0;
 }  // namespace
 
 #ifndef DO_NOT_OUTPUT_TO_UART
+// Images and scores queued for the display, with room for an image and the
+// scores that follow it while the previous image is still going out
+static uint8_t link_buf[2 * FRAME_LINK_PACKET_SIZE(kMaxImageSize)];
+static uint8_t link_prev[kMaxImageSize];
+static struct frame_link link;
+
 // RX interrupt handler
 void on_uart_rx() {
     uint8_t cameraCommand = 0;
@@ -124,6 +147,9 @@ void setup_uart() {
 
   // Now enable the UART to send interrupts - RX only
   uart_set_irq_enables(UART_ID, true, false);
+
+  frame_link_init(&link, link_buf, sizeof(link_buf), link_prev, sizeof(link_prev));
+  frame_link_uart_init(&link, UART_ID, dma_claim_unused_channel(true));
 }
 #else
 void setup_uart() {}
@@ -178,6 +204,9 @@ void setup() {
 
   // Get information about the memory area to use for the model's input.
   input = interpreter->input(0);
+
+  motion_gate_init(&gate, motion_reference, kNumCols, kNumRows, kMotionBlock,
+                   kMotionThreshold, kMotionMaxSkips);
 }
 
 // The name of this function is important for Arduino compatibility.
@@ -192,17 +221,25 @@ void loop() {
   }
   TF_LITE_MICRO_EXECUTION_TIME_SNIPPET_END(error_reporter, "GetImage")
 
-  TF_LITE_MICRO_EXECUTION_TIME_SNIPPET_START(error_reporter)
-  // Run the model on this input and make sure it succeeds.
-  if (kTfLiteOk != interpreter->Invoke()) {
-    TF_LITE_REPORT_ERROR(error_reporter, "Invoke failed.");
-  }
-  TF_LITE_MICRO_EXECUTION_TIME_SNIPPET_END(error_reporter, "Invoke")
+  if (motion_gate_check(&gate, input->data.int8)) {
+    TF_LITE_MICRO_EXECUTION_TIME_SNIPPET_START(error_reporter)
+    // Run the model on this input and make sure it succeeds.
+    if (kTfLiteOk != interpreter->Invoke()) {
+      TF_LITE_REPORT_ERROR(error_reporter, "Invoke failed.");
+    }
+    TF_LITE_MICRO_EXECUTION_TIME_SNIPPET_END(error_reporter, "Invoke")
 
-  TfLiteTensor* output = interpreter->output(0);
+    TfLiteTensor* output = interpreter->output(0);
+    person_score = output->data.uint8[kPersonIndex];
+    no_person_score = output->data.uint8[kNotAPersonIndex];
+  } else {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Invoke skipped, difference %d (%d run, %d skipped)",
+                         static_cast<int>(gate.last_sad),
+                         static_cast<int>(gate.invoked),
+                         static_cast<int>(gate.skipped));
+  }
 
   // Process the inference results.
-  int8_t person_score = output->data.uint8[kPersonIndex];
-  int8_t no_person_score = output->data.uint8[kNotAPersonIndex];
   RespondToDetection(error_reporter, person_score, no_person_score);
 }
@@ -25,6 +25,10 @@ limitations under the License.
 
 
 struct arducam_config config;
+// Shows the int8 input tensor, whose zero point is -128, as gray
+static ST7735_Palette palette;
+static uint16_t displayBuf[96 * 96] __attribute__((aligned(4)));
+
 TfLiteStatus ScreenInit(tflite::ErrorReporter *error_reporter) {
   stdio_init_all();
   sleep_ms(1000);
@@ -47,32 +51,36 @@ TfLiteStatus ScreenInit(tflite::ErrorReporter *error_reporter) {
   arducam_init(&config);
 
   ST7735_FillScreen(ST7735_BLACK);
+  ST7735_PaletteGray(&palette, 128);
 
   return kTfLiteOk;
 }
 
 TfLiteStatus GetImage(tflite::ErrorReporter *error_reporter, int image_width,
                       int image_height, int channels, int8_t *image_data) {
+  // Every other pixel of the centre of the 324x324 frame. The PIO drops
+  // the other pixels, so the DMA writes straight into the input tensor,
+  // which is then offset to int8 in place.
+  struct preprocess_config preprocess;
+  preprocess.src_stride = 324;
+  preprocess.crop_x     = (324 - image_width * 2) / 2 + 1;
+  preprocess.crop_y     = (324 - image_height * 2) / 2;
+  preprocess.out_width  = image_width;
+  preprocess.out_height = image_height;
+  preprocess.factor     = 2;
+  preprocess.mode       = PREPROCESS_SUBSAMPLE;
+  preprocess.zero_point = 128;
+
   TF_LITE_MICRO_EXECUTION_TIME_BEGIN
 
   TF_LITE_MICRO_EXECUTION_TIME_SNIPPET_START(error_reporter)
-  arducam_capture_frame(&config, (uint8_t *)image_data);
+  arducam_capture_frame(&config, image_data, &preprocess);
   TF_LITE_MICRO_EXECUTION_TIME_SNIPPET_END(error_reporter, "capture_frame")
 
   TF_LITE_MICRO_EXECUTION_TIME_SNIPPET_START(error_reporter)
-  uint8_t *displayBuf = new uint8_t[96 * 96 * 2];
-  uint16_t index      = 0;
-  for (int x = 0; x < 96 * 96; x++) {
-    uint16_t imageRGB   = ST7735_COLOR565(image_data[x], image_data[x], image_data[x]);
-    displayBuf[index++] = (uint8_t)(imageRGB >> 8) & 0xFF;
-    displayBuf[index++] = (uint8_t)(imageRGB)&0xFF;
-  }
-  ST7735_DrawImage(0, 0, 96, 96, displayBuf);
-  delete[] displayBuf;
+  ST7735_ConvertImage(&palette, (const uint8_t *)image_data, 1, displayBuf, 96 * 96);
+  ST7735_DrawImage(0, 0, 96, 96, (const uint8_t *)displayBuf);
   TF_LITE_MICRO_EXECUTION_TIME_SNIPPET_END(error_reporter, "Display")
 
-  for (int i = 0; i < image_width * image_height * channels; ++i) {
-    image_data[i] = (uint8_t)image_data[i] - 128;
-  }
   return kTfLiteOk;
 }
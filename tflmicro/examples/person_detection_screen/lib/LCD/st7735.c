@@ -280,4 +280,40 @@ void ST7735_InvertColors(bool invert) {
     ST7735_Unselect();
 }
 
+// Colours are stored byte-swapped, so that the converted pixels are in the
+// high byte first order ST7735_DrawImage() sends.
+static void ST7735_PaletteSet(ST7735_Palette *palette, uint8_t index, uint8_t r, uint8_t g, uint8_t b) {
+    uint16_t color = ST7735_COLOR565(r, g, b);
+    palette->color[index] = (color >> 8) | (color << 8);
+}
 
+void ST7735_PaletteGray(ST7735_Palette *palette, uint8_t offset) {
+    for(int i = 0; i < 256; i++) {
+        uint8_t v = i + offset;
+        ST7735_PaletteSet(palette, i, v, v, v);
+    }
+}
+
+void ST7735_PaletteHeat(ST7735_Palette *palette, uint8_t offset) {
+    for(int i = 0; i < 256; i++) {
+        int v = 3 * (uint8_t)(i + offset);
+        uint8_t r = v > 255 ? 255 : v;
+        uint8_t g = v > 510 ? 255 : (v > 255 ? v - 255 : 0);
+        uint8_t b = v > 510 ? v - 510 : 0;
+        ST7735_PaletteSet(palette, i, r, g, b);
+    }
+}
+
+void ST7735_ConvertImage(const ST7735_Palette *palette, const uint8_t *src, size_t step,
+                         uint16_t *dst, size_t count) {
+    const uint16_t *lut = palette->color;
+    uint32_t *out = (uint32_t *)dst;
+    size_t i;
+    // The first pixel goes in the low half of each little-endian word
+    for(i = 0; i + 1 < count; i += 2) {
+        *out++ = (uint32_t)lut[src[0]] | ((uint32_t)lut[src[step]] << 16);
+        src += 2 * step;
+    }
+    if(i < count)
+        dst[i] = lut[src[0]];
+}
@@ -4,6 +4,7 @@
 
 #include "fonts.h"
 #include <stdbool.h>
+#include <stddef.h>
 
 #define ST7735_MADCTL_MY  0x80
 #define ST7735_MADCTL_MX  0x40
@@ -243,6 +244,22 @@ void ST7735_DrawImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
                       const uint8_t *data);
 void ST7735_InvertColors(bool invert);
 
+// A colour for each value of an 8-bit pixel. Kept in RAM, a lookup is
+// cheaper than ST7735_COLOR565() and can map values to any colour.
+typedef struct {
+    uint16_t color[256];
+} ST7735_Palette;
+
+// Entry i gets the colour of value (i + offset) & 0xFF, so offset 128
+// shows int8 pixels with a zero point of -128 without converting them.
+void ST7735_PaletteGray(ST7735_Palette *palette, uint8_t offset);
+// Black through red and yellow to white, e.g. for confidence maps
+void ST7735_PaletteHeat(ST7735_Palette *palette, uint8_t offset);
+// Looks up count pixels, taking every step-th byte of src. dst must be
+// 4-byte aligned; pixels are stored two at a time.
+void ST7735_ConvertImage(const ST7735_Palette *palette, const uint8_t *src, size_t step,
+                         uint16_t *dst, size_t count);
+
 #ifdef __cplusplus
 }
 #endif
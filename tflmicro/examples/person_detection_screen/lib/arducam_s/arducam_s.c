@@ -7,6 +7,7 @@
 #include "pico/stdlib.h"
 #include "st7735.h"
 #include <stdio.h>
+#include <string.h>
 
 int PIN_LED = 25;
 
@@ -184,6 +185,30 @@ unsigned char rdSensorReg16_8(uint8_t slave_address, unsigned int regID,
 }
 #endif
 
+// PCLKs the sensor takes to send one pixel
+static uint arducam_pixel_clocks(struct arducam_config *config) {
+  return config->bus_width == BUS_WIDTH_1 ? 8 : 8 / config->bus_width;
+}
+
+// Loads program with the instructions at its `sample` and, if it has one,
+// `pixel_clocks` label rewritten for the configured bus. See image.pio.
+static uint arducam_add_program(struct arducam_config *config,
+                                const pio_program_t *program, uint sample,
+                                int pixel_clocks) {
+  uint16_t instructions[32];
+  memcpy(instructions, program->instructions, program->length * sizeof(uint16_t));
+  if (config->bus_width != BUS_WIDTH_1) {
+    instructions[sample] = pio_encode_in(pio_pins, config->bus_width);
+    if (pixel_clocks >= 0) {
+      instructions[pixel_clocks] =
+          pio_encode_set(pio_x, arducam_pixel_clocks(config) - 1);
+    }
+  }
+  pio_program_t patched = *program;
+  patched.instructions  = instructions;
+  return pio_add_program(config->pio, &patched);
+}
+
 void arducam_init(struct arducam_config *config) {
   gpio_set_function(config->pin_xclk, GPIO_FUNC_PWM);
   uint slice_num = pwm_gpio_to_slice_num(config->pin_xclk);
@@ -214,15 +239,85 @@ void arducam_init(struct arducam_config *config) {
   sleep_ms(100);
   // Initialise the camera itself over SCCB
   arducam_regs_write(config, hm01b0_324x244);
+  if (config->bus_width == BUS_WIDTH_4) {
+    arducam_regs_write(config, hm01b0_bus_4bit);
+  } else if (config->bus_width == BUS_WIDTH_8) {
+    arducam_regs_write(config, hm01b0_bus_8bit);
+  }
 
   // Enable image RX PIO
-  uint offset = pio_add_program(config->pio, &image_program);
-  image_program_init(config->pio, config->pio_sm, offset, config->pin_y2_pio_base);
+  config->pio_offset =
+      arducam_add_program(config, &image_program, image_offset_sample, -1);
+  config->pio_roi_offset = arducam_add_program(
+      config, &image_roi_program, image_roi_offset_sample, image_roi_offset_pixel_clocks);
+  // Keep the second channel off the one the caller picked
+  if (!dma_channel_is_claimed(config->dma_channel)) {
+    dma_channel_claim(config->dma_channel);
+  }
+  config->dma_roi_channel = dma_claim_unused_channel(true);
+  image_program_init(config->pio, config->pio_sm, config->pio_offset,
+                     config->pin_y2_pio_base);
 }
-void arducam_capture_frame(struct arducam_config *config, uint8_t *image) {
-  uint16_t x, y, i, j, index;  // init 0
-  uint8_t  image_buf[324 * 324];
-  //  uint8_t  image_tmp[162 * 162];
+
+// Row words of image_roi, read by a DMA ring that needs them aligned to
+// their size. See image.pio for their meaning.
+static uint32_t roi_row[4] __attribute__((aligned(16)));
+
+static void arducam_capture_roi(struct arducam_config *config, uint8_t *image,
+                                const struct preprocess_config *preprocess) {
+  const uint clocks = arducam_pixel_clocks(config);
+  roi_row[0]        = clocks * preprocess->crop_x;
+  roi_row[1]        = preprocess->out_width - 1;
+  roi_row[2]        = clocks * (preprocess->factor - 1);
+  roi_row[3]        = preprocess->factor - 1;
+  image_roi_program_init(config->pio, config->pio_sm, config->pio_roi_offset,
+                         config->pin_y2_pio_base);
+
+  dma_channel_config c = dma_channel_get_default_config(config->dma_roi_channel);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  // Wrap the read address every 16 bytes, over the four row words
+  channel_config_set_ring(&c, false, 4);
+  channel_config_set_dreq(&c, pio_get_dreq(config->pio, config->pio_sm, true));
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+  dma_channel_configure(config->dma_roi_channel, &c, &config->pio->txf[config->pio_sm],
+                        roi_row, 4 * preprocess->out_height, false);
+
+  c = dma_channel_get_default_config(config->dma_channel);
+  channel_config_set_read_increment(&c, false);
+  channel_config_set_write_increment(&c, true);
+  channel_config_set_dreq(&c, pio_get_dreq(config->pio, config->pio_sm, false));
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+  dma_channel_configure(config->dma_channel, &c, image, &config->pio->rxf[config->pio_sm],
+                        preprocess->out_width * preprocess->out_height, false);
+  // Lines to drop at the top of the frame
+  pio_sm_put(config->pio, config->pio_sm, preprocess->crop_y);
+
+  // Wait for vsync rising edge to start frame
+  while (gpio_get(config->pin_vsync) == true) {}
+
+  while (gpio_get(config->pin_vsync) == false) {}
+
+  dma_start_channel_mask((1u << config->dma_channel) | (1u << config->dma_roi_channel));
+  pio_sm_set_enabled(config->pio, config->pio_sm, true);
+
+  dma_channel_wait_for_finish_blocking(config->dma_channel);
+
+  pio_sm_set_enabled(config->pio, config->pio_sm, false);
+  dma_channel_abort(config->dma_roi_channel);
+}
+
+void arducam_capture_frame(struct arducam_config *config, int8_t *image,
+                           const struct preprocess_config *preprocess) {
+  if (preprocess->mode == PREPROCESS_SUBSAMPLE) {
+    arducam_capture_roi(config, (uint8_t *)image, preprocess);
+    preprocess_zero_point(image, preprocess->out_width * preprocess->out_height,
+                          preprocess->zero_point);
+    return;
+  }
+  image_program_init(config->pio, config->pio_sm, config->pio_offset,
+                     config->pin_y2_pio_base);
+  uint8_t image_buf[324 * 324] __attribute__((aligned(4)));
   config->image_buf      = image_buf;
   config->image_buf_size = sizeof(image_buf);
   dma_channel_config c   = dma_channel_get_default_config(config->dma_channel);
@@ -246,17 +341,7 @@ void arducam_capture_frame(struct arducam_config *config, uint8_t *image) {
 
   pio_sm_set_enabled(config->pio, config->pio_sm, false);
 
-#if 1
-  i            = 0;
-  index        = 0;
-  uint8_t temp = 0;
-  for (y = 66; y < 258; y+=2) {
-    for (x = 66+ (1 + x) % 2; x < 258; x += 2) {
-      image[index++] = config->image_buf[y * 324 + x];
-    }
-  }
-
-#endif
+  preprocess_frame(preprocess, config->image_buf, image);
 }
 
 void arducam_reg_write(struct arducam_config *config, uint16_t reg,
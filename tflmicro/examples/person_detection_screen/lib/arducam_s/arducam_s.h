@@ -9,6 +9,7 @@ extern "C" {
 #include "hardware/pio.h"
 #include "pico/stdio.h"
 #include "stdint.h"
+#include "preprocess.h"
 #define SOFTWARE_I2C 1
 
 /*spi pin source*/
@@ -31,6 +32,15 @@ struct senosr_reg {
   uint8_t  val;
 };
 
+// Data bus the HM01B0 sends pixels over. The serial bus needs only Y2;
+// the 4-bit one uses the four pins from pin_y2_pio_base up and the 8-bit
+// one all eight. Wider buses take 2 or 1 PCLKs per pixel instead of 8.
+enum bus_width {
+  BUS_WIDTH_1 = 0,
+  BUS_WIDTH_4 = 4,
+  BUS_WIDTH_8 = 8,
+};
+
 struct arducam_config {
   uint8_t       sensor_address;
   i2c_inst_t *  sccb;
@@ -42,11 +52,16 @@ struct arducam_config {
   uint          pin_vsync;
   // Y2, Y3, Y4, Y5, Y6, Y7, Y8, PCLK, HREF
   uint     pin_y2_pio_base;
+  enum bus_width bus_width;
   PIO      pio;
   uint     pio_sm;
   uint     dma_channel;
   uint8_t *image_buf;
   size_t   image_buf_size;
+  // Filled in by arducam_init()
+  uint     pio_offset;
+  uint     pio_roi_offset;
+  uint     dma_roi_channel;
 };
 
 extern int PIN_LED;
@@ -68,7 +83,13 @@ unsigned char rdSensorReg16_8(uint8_t slave_address, unsigned int regID,
                               unsigned char *regDat);
 
 void    arducam_init(struct arducam_config *config);
-void    arducam_capture_frame(struct arducam_config *config, uint8_t *image);
+// Captures one frame and runs it through preprocess_frame() into image.
+// PREPROCESS_SUBSAMPLE is done by the PIO, which hands only the wanted
+// pixels to the DMA, so image is written directly and no frame buffer is
+// needed. PREPROCESS_AVERAGE captures the whole frame into a buffer on the
+// stack first.
+void    arducam_capture_frame(struct arducam_config *config, int8_t *image,
+                              const struct preprocess_config *preprocess);
 void    arducam_reg_write(struct arducam_config *config, uint16_t reg, uint8_t value);
 uint8_t arducam_reg_read(struct arducam_config *config, uint16_t reg);
 void    arducam_regs_write(struct arducam_config *config, struct senosr_reg *regs_list);
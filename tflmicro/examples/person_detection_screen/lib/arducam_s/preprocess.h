@@ -0,0 +1,39 @@
+#ifndef _PREPROCESS__H
+#define _PREPROCESS__H
+#include <stddef.h>
+#include <stdint.h>
+
+// Turns a raw 8-bit frame straight into model input: crops a window,
+// downscales it by an integer factor and subtracts the zero point, in a
+// single pass over the source. For factors 1, 2 and 4 with word-aligned
+// buffers four output pixels are produced per 32-bit load/store, other
+// cases fall back to one pixel at a time with identical results.
+
+enum preprocess_mode {
+  // Take the top-left pixel of every factor x factor block
+  PREPROCESS_SUBSAMPLE = 0,
+  // Rounded mean of every factor x factor block
+  PREPROCESS_AVERAGE = 1,
+};
+
+struct preprocess_config {
+  // Bytes per row of the raw frame
+  uint16_t src_stride;
+  // Top-left corner of the crop window in the raw frame
+  uint16_t crop_x;
+  uint16_t crop_y;
+  // Output size; the crop window is out_width * factor wide
+  uint16_t out_width;
+  uint16_t out_height;
+  uint8_t factor;
+  enum preprocess_mode mode;
+  // 128 gives the int8 input of the person detection model, 0 leaves
+  // the pixels unchanged
+  uint8_t zero_point;
+};
+
+void preprocess_frame(const struct preprocess_config *config, const uint8_t *src, int8_t *dst);
+// Subtracts the zero point from size pixels in place, for images that the
+// camera already captured at the output size.
+void preprocess_zero_point(int8_t *image, size_t size, uint8_t zero_point);
+#endif
@@ -0,0 +1,65 @@
+// Writes the person and no person images of the example as recordings in
+// every format the replay reads, a person frame then a no person frame:
+//   make_sample_frames gray.raw ov2640.yuv hm01b0.raw
+// Each recording gives the model exactly the same input.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "model_settings.h"
+#include "no_person_image_data.h"
+#include "person_image_data.h"
+
+namespace {
+
+constexpr int kHm01b0Size = 324;
+
+bool Write(const char* path, const uint8_t* data, size_t size) {
+  FILE* f = fopen(path, "wb");
+  if (f == nullptr) {
+    return false;
+  }
+  const bool ok = fwrite(data, 1, size, f) == size;
+  return fclose(f) == 0 && ok;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc != 4) {
+    fprintf(stderr, "usage: make_sample_frames gray.raw ov2640.yuv hm01b0.raw\n");
+    return 2;
+  }
+  static uint8_t gray[2][kMaxImageSize];
+  static uint8_t yuv[2][kMaxImageSize * 2];
+  static uint8_t hm01b0[2][kHm01b0Size * kHm01b0Size];
+  const uint8_t* images[2] = {g_person_data, g_no_person_data};
+  for (int n = 0; n < 2; n++) {
+    // The person image is the int8 model input, while the no person one
+    // only scores as such read as pixels
+    const uint8_t offset = n == 0 ? 0x80 : 0x00;
+    for (int i = 0; i < kMaxImageSize; i++) {
+      gray[n][i] = images[n][i] ^ offset;
+      yuv[n][2 * i] = gray[n][i];
+      yuv[n][2 * i + 1] = 0x80;
+    }
+    // Every pixel where the subsampling of the centre picks it up, in a
+    // mid-gray frame with the other pixels of each 2x2 block darker
+    memset(hm01b0[n], 0x80, sizeof(hm01b0[n]));
+    const int x0 = (kHm01b0Size - kNumCols * 2) / 2 + 1;
+    const int y0 = (kHm01b0Size - kNumRows * 2) / 2;
+    for (int y = 0; y < kNumRows; y++) {
+      for (int x = 0; x < kNumCols; x++) {
+        uint8_t* p = &hm01b0[n][(y0 + 2 * y) * kHm01b0Size + x0 + 2 * x];
+        p[0] = gray[n][y * kNumCols + x];
+        p[1] = p[kHm01b0Size] = p[kHm01b0Size + 1] = p[0] / 2;
+      }
+    }
+  }
+  if (!Write(argv[1], gray[0], sizeof(gray)) || !Write(argv[2], yuv[0], sizeof(yuv)) ||
+      !Write(argv[3], hm01b0[0], sizeof(hm01b0))) {
+    fprintf(stderr, "cannot write the recordings\n");
+    return 1;
+  }
+  return 0;
+}
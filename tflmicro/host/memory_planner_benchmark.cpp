@@ -0,0 +1,118 @@
+// Times the GreedyMemoryPlanner against the IntervalMemoryPlanner on
+// synthetic graphs of 100 to 2000 buffers, and checks that they make the
+// same plan:
+//   memory_planner_benchmark [--repeat n]
+// The graphs are made like MobileNet-class models as the MicroAllocator
+// sees them: a chain of activations, each read by the next one or two ops,
+// skip connections living across a block, and a scratch buffer for some
+// of the ops.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/interval_memory_planner.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_time.h"
+
+namespace {
+
+struct Buffer {
+  int size;
+  int first_time_used;
+  int last_time_used;
+};
+
+uint32_t seed = 1;
+
+int NextRandom(int range) {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) % range;
+}
+
+std::vector<Buffer> MakeGraph(int buffer_count) {
+  std::vector<Buffer> buffers;
+  int op = 0;
+  while (static_cast<int>(buffers.size()) < buffer_count) {
+    // The activation op writes, 16 byte aligned, read by one or two ops
+    const int size = 16 * (64 + NextRandom(2304));
+    buffers.push_back({size, op, op + 1 + (NextRandom(4) == 0)});
+    if (NextRandom(8) == 0) {
+      buffers.push_back({size, op, op + 2 + NextRandom(6)});
+    }
+    if (NextRandom(3) == 0) {
+      buffers.push_back({16 * (1 + NextRandom(256)), op, op});
+    }
+    op++;
+  }
+  buffers.resize(buffer_count);
+  return buffers;
+}
+
+template <typename Planner>
+int32_t Plan(const std::vector<Buffer>& buffers, std::vector<unsigned char>* scratch,
+             std::vector<int>* offsets, size_t* size) {
+  static tflite::MicroErrorReporter error_reporter;
+  const int32_t start = tflite::GetCurrentTimeTicks();
+  Planner planner(scratch->data(), scratch->size());
+  for (const Buffer& b : buffers) {
+    planner.AddBuffer(&error_reporter, b.size, b.first_time_used, b.last_time_used);
+  }
+  *size = planner.GetMaximumMemorySize();
+  const int32_t ticks = tflite::GetCurrentTimeTicks() - start;
+  offsets->resize(buffers.size());
+  for (size_t i = 0; i < buffers.size(); i++) {
+    planner.GetOffsetForBuffer(&error_reporter, i, &(*offsets)[i]);
+  }
+  return ticks;
+}
+
+double Milliseconds(int64_t ticks) {
+  return ticks * 1000.0 / tflite::ticks_per_second();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int repeat = 5;
+  if (argc == 3 && strcmp(argv[1], "--repeat") == 0) {
+    repeat = atoi(argv[2]);
+  } else if (argc != 1) {
+    fprintf(stderr, "usage: memory_planner_benchmark [--repeat n]\n");
+    return 2;
+  }
+  printf("%8s %12s %12s %12s %8s\n", "buffers", "arena", "greedy ms", "interval ms",
+         "speedup");
+  int different = 0;
+  for (int count : {100, 250, 500, 1000, 2000}) {
+    const std::vector<Buffer> buffers = MakeGraph(count);
+    std::vector<unsigned char> greedy_scratch(
+        count * tflite::GreedyMemoryPlanner::per_buffer_size());
+    std::vector<unsigned char> interval_scratch(
+        count * tflite::IntervalMemoryPlanner::per_buffer_size());
+    int64_t greedy_ticks = 0;
+    int64_t interval_ticks = 0;
+    std::vector<int> greedy_offsets;
+    std::vector<int> interval_offsets;
+    size_t greedy_size = 0;
+    size_t interval_size = 0;
+    for (int r = 0; r < repeat; r++) {
+      greedy_ticks += Plan<tflite::GreedyMemoryPlanner>(buffers, &greedy_scratch,
+                                                        &greedy_offsets, &greedy_size);
+      interval_ticks += Plan<tflite::IntervalMemoryPlanner>(
+          buffers, &interval_scratch, &interval_offsets, &interval_size);
+    }
+    if (greedy_offsets != interval_offsets || greedy_size != interval_size) {
+      fprintf(stderr, "%d buffers: the plans differ, %zu and %zu bytes\n", count,
+              greedy_size, interval_size);
+      different++;
+    }
+    printf("%8d %12zu %12.3f %12.3f %7.1fx\n", count, interval_size,
+           Milliseconds(greedy_ticks) / repeat, Milliseconds(interval_ticks) / repeat,
+           interval_ticks > 0 ? static_cast<double>(greedy_ticks) / interval_ticks : 0.0);
+  }
+  return different == 0 ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+// Runs the person model with its first layers in patches, for a few layer
+// counts and patch sizes, against a plain Invoke():
+//   patch_benchmark [--repeat n]
+// Prints the arena each needs and the time per Invoke(), and fails if any
+// output differs from the plain one.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "person_detect_model_data.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_time.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+constexpr size_t kArenaSize = 512 * 1024;
+
+struct Config {
+  int layer_count;
+  int patch_height;
+  int patch_width;
+};
+
+// The first 5 layers take the model to 24x24 pixels, the first 13 to 6x6.
+const Config kConfigs[] = {
+    {0, 0, 0},   {2, 4, 48},  {3, 2, 48},  {3, 8, 48}, {5, 2, 24},
+    {5, 4, 24},  {5, 8, 8},   {7, 2, 24},  {9, 2, 12}, {13, 1, 6},
+};
+
+void FillInput(TfLiteTensor* tensor, uint32_t seed) {
+  for (size_t i = 0; i < tensor->bytes; ++i) {
+    seed = seed * 1103515245 + 12345;
+    tensor->data.uint8[i] = seed >> 16;
+  }
+}
+
+double Milliseconds(int64_t ticks) {
+  return ticks * 1000.0 / tflite::ticks_per_second();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int repeat = 5;
+  if (argc == 3 && strcmp(argv[1], "--repeat") == 0) {
+    repeat = atoi(argv[2]);
+  } else if (argc != 1) {
+    fprintf(stderr, "usage: patch_benchmark [--repeat n]\n");
+    return 2;
+  }
+
+  static tflite::MicroErrorReporter error_reporter;
+  static tflite::AllOpsResolver op_resolver;
+  const tflite::Model* model = tflite::GetModel(g_person_detect_model_data);
+  std::vector<uint8_t> reference_output;
+  std::vector<uint8_t> output;
+  int failed = 0;
+
+  printf("%7s %8s %10s %12s\n", "layers", "patch", "arena", "invoke ms");
+  for (const Config& config : kConfigs) {
+    std::vector<uint8_t> arena(kArenaSize);
+    tflite::MicroInterpreter interpreter(model, op_resolver, arena.data(),
+                                         arena.size(), &error_reporter);
+    if (config.layer_count > 0 &&
+        interpreter.SetPatchPlan(config.layer_count, config.patch_height,
+                                 config.patch_width) != kTfLiteOk) {
+      failed++;
+      continue;
+    }
+    if (interpreter.AllocateTensors() != kTfLiteOk) {
+      failed++;
+      continue;
+    }
+
+    int64_t ticks = 0;
+    output.clear();
+    for (int r = 0; r < repeat; r++) {
+      FillInput(interpreter.input(0), r);
+      const int32_t start = tflite::GetCurrentTimeTicks();
+      if (interpreter.Invoke() != kTfLiteOk) {
+        failed++;
+        break;
+      }
+      ticks += tflite::GetCurrentTimeTicks() - start;
+      const TfLiteTensor* result = interpreter.output(0);
+      output.insert(output.end(), result->data.uint8,
+                    result->data.uint8 + result->bytes);
+    }
+    if (config.layer_count == 0) {
+      reference_output = output;
+    } else if (output != reference_output) {
+      fprintf(stderr, "%d layers in %dx%d patches: the outputs differ\n",
+              config.layer_count, config.patch_height, config.patch_width);
+      failed++;
+    }
+
+    char patch[16] = "-";
+    if (config.layer_count > 0) {
+      snprintf(patch, sizeof(patch), "%dx%d", config.patch_height,
+               config.patch_width);
+    }
+    printf("%7d %8s %10zu %12.3f\n", config.layer_count, patch,
+           interpreter.arena_used_bytes(),
+           repeat > 0 ? Milliseconds(ticks) / repeat : 0.0);
+  }
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,689 @@
+// Plans the tensor arena of a model on the host and writes the offsets into
+// its OfflineMemoryAllocation metadata, so MicroAllocator places the tensors
+// where they are told instead of running the memory planner on every
+// boot, and the head can be smaller than the greedy plan:
+//   plan_offline [--search n] [--seed n] [--name array] in out
+// in and out are .tflite files, or C++ sources holding the model as an
+// array like person_detect_model_data.cpp (picked by the .cc or .cpp name).
+//
+// The sizes, lifetimes and scratch buffers are those the allocator sees:
+// the model is allocated in an interpreter with all the kernels, recording
+// the scratch buffer requests of every node. The greedy plan is the start,
+// then --search orders of the buffers are placed first fit, each scored by
+// running the IntervalMemoryPlanner as the device will, with the tensors
+// fixed and the scratch buffers still planned at runtime around them. The
+// smallest head is kept. At the end both models are allocated and invoked
+// on the same inputs, and the outputs have to match.
+//
+// The allocator lets the outputs of copy ops like Reshape and Concatenation
+// share the buffers of their inputs, but not in offline planned models. The
+// tensors it put in one buffer are planned as one here too, each written at
+// its offset inside, so the planned model keeps those copies free.
+//
+// Pipelined interpreters do not take offline offsets.
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/memory_planner/interval_memory_planner.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+
+namespace {
+
+// As in micro_allocator.cpp
+constexpr int kBufferAlignment = 16;
+constexpr char kOfflineMemAllocMetadata[] = "OfflineMemoryAllocation";
+constexpr size_t kArenaSize = 16 * 1024 * 1024;
+
+void Usage() {
+  fprintf(stderr,
+          "usage: plan_offline [--search n] [--seed n] [--name array] in out\n"
+          "in and out are .tflite files, or C++ sources with the model as an\n"
+          "array (.cc, .cpp). --search tries n more buffer orders than the\n"
+          "greedy one, 10000 by default. --name is the array written to a\n"
+          "C++ out, that of a C++ in by default.\n");
+}
+
+bool IsSource(const std::string& path) {
+  for (const char* suffix : {".cc", ".cpp"}) {
+    const size_t n = strlen(suffix);
+    if (path.size() > n && path.compare(path.size() - n, n, suffix) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// What a C++ model source has besides the bytes
+struct Source {
+  std::vector<std::string> includes;
+  std::string name;
+};
+
+bool ReadModel(const char* path, std::vector<uint8_t>* model, Source* source) {
+  FILE* f = fopen(path, "rb");
+  if (f == nullptr) {
+    return false;
+  }
+  std::string text;
+  char chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+    text.append(chunk, n);
+  }
+  fclose(f);
+  if (!IsSource(path)) {
+    model->assign(text.begin(), text.end());
+    return true;
+  }
+  // The #include lines, the name before "[] = {", and the 0x.. in the braces
+  size_t line = 0;
+  while (line < text.size()) {
+    const size_t end = text.find('\n', line);
+    const std::string s = text.substr(line, end - line);
+    if (s.compare(0, 8, "#include") == 0) {
+      source->includes.push_back(s);
+    }
+    line = end == std::string::npos ? text.size() : end + 1;
+  }
+  const size_t brackets = text.find("[]");
+  const size_t open = text.find('{', brackets);
+  const size_t close = text.find('}', open);
+  if (brackets == std::string::npos || open == std::string::npos ||
+      close == std::string::npos) {
+    return false;
+  }
+  size_t name_start = brackets;
+  while (name_start > 0 && (isalnum(text[name_start - 1]) || text[name_start - 1] == '_')) {
+    name_start--;
+  }
+  source->name = text.substr(name_start, brackets - name_start);
+  const char* p = text.c_str() + open + 1;
+  const char* const last = text.c_str() + close;
+  while (p < last) {
+    char* next;
+    const long value = strtol(p, &next, 0);
+    if (next == p) {
+      p++;
+    } else {
+      model->push_back(static_cast<uint8_t>(value));
+      p = next;
+    }
+  }
+  return !model->empty();
+}
+
+bool WriteModel(const char* path, const uint8_t* model, size_t size,
+                const Source& source) {
+  FILE* f = fopen(path, "wb");
+  if (f == nullptr) {
+    return false;
+  }
+  if (IsSource(path)) {
+    fprintf(f,
+            "// This is a TensorFlow Lite model file with offline planned tensor\n"
+            "// offsets, written by plan_offline as a C data array.\n\n");
+    for (const std::string& include : source.includes) {
+      fprintf(f, "%s\n", include.c_str());
+    }
+    // The buffers inside are aligned to 16 bytes from the start
+    fprintf(f, "\nalignas(16) const unsigned char %s[] = {", source.name.c_str());
+    for (size_t i = 0; i < size; i++) {
+      fprintf(f, "%s0x%02x,", i % 13 == 0 ? "\n    " : " ", model[i]);
+    }
+    fprintf(f, "\n};\nconst int %s_len = %zu;\n", source.name.c_str(), size);
+  } else {
+    fwrite(model, 1, size, f);
+  }
+  return fclose(f) == 0;
+}
+
+struct ScratchRequest {
+  size_t bytes;
+  int node;
+};
+
+// Records the scratch buffer requests of every node while the model is
+// prepared, which the allocator keeps only until the plan is made
+class RecordingScratchAllocator : public tflite::MicroAllocator {
+ public:
+  static RecordingScratchAllocator* Create(uint8_t* arena, size_t arena_size,
+                                           tflite::ErrorReporter* error_reporter,
+                                           std::vector<ScratchRequest>* requests) {
+    tflite::SimpleMemoryAllocator* memory_allocator =
+        tflite::SimpleMemoryAllocator::Create(error_reporter, arena, arena_size);
+    uint8_t* buffer = memory_allocator->AllocateFromTail(
+        sizeof(RecordingScratchAllocator), alignof(RecordingScratchAllocator));
+    return new (buffer)
+        RecordingScratchAllocator(memory_allocator, error_reporter, requests);
+  }
+
+  TfLiteStatus RequestScratchBufferInArena(size_t bytes, int* buffer_idx) override {
+    TF_LITE_ENSURE_STATUS(MicroAllocator::RequestScratchBufferInArena(bytes, buffer_idx));
+    requests_->push_back({bytes, -1});
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus FinishPrepareNodeAllocations(int node_id) override {
+    for (ScratchRequest& request : *requests_) {
+      if (request.node == -1) {
+        request.node = node_id;
+      }
+    }
+    return MicroAllocator::FinishPrepareNodeAllocations(node_id);
+  }
+
+  // The tensors and scratch buffers of the plan
+  size_t head_bytes() const { return memory_allocator_->GetHeadUsedBytes(); }
+
+ private:
+  RecordingScratchAllocator(tflite::SimpleMemoryAllocator* memory_allocator,
+                            tflite::ErrorReporter* error_reporter,
+                            std::vector<ScratchRequest>* requests)
+      : MicroAllocator(memory_allocator, error_reporter),
+        memory_allocator_(memory_allocator),
+        requests_(requests) {}
+
+  tflite::SimpleMemoryAllocator* memory_allocator_;
+  std::vector<ScratchRequest>* requests_;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+// A buffer of the plan, with the aligned size the planner is given
+struct Buffer {
+  int size;
+  int first_created;
+  int last_used;
+  // Index in the subgraph, -1 for a scratch buffer
+  int tensor;
+};
+
+// A tensor inside the buffer of another
+struct Alias {
+  int tensor;
+  int root;
+  int offset;
+};
+
+bool Overlap(const Buffer& a, const Buffer& b) {
+  return a.first_created <= b.last_used && b.first_created <= a.last_used;
+}
+
+bool IsCopyOp(tflite::BuiltinOperator op_code) {
+  switch (op_code) {
+    case tflite::BuiltinOperator_RESHAPE:
+    case tflite::BuiltinOperator_CONCATENATION:
+    case tflite::BuiltinOperator_PACK:
+    case tflite::BuiltinOperator_SPLIT:
+    case tflite::BuiltinOperator_SPLIT_V:
+    case tflite::BuiltinOperator_UNPACK:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// The buffers in the order AllocationInfoBuilder adds them to the plan: the
+// tensors that need allocating, then the scratch buffers. The tensors the
+// allocator put inside the buffer of another go to aliases instead, and the
+// buffer they are in lives as long as any of them.
+bool CollectBuffers(const tflite::Model* model, tflite::MicroInterpreter* interpreter,
+                    const std::vector<ScratchRequest>& requests,
+                    std::vector<Buffer>* buffers, std::vector<Alias>* aliases) {
+  const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+  const int tensor_count = subgraph->tensors()->size();
+  const int last_node = subgraph->operators()->size() - 1;
+  std::vector<Buffer> tensors(tensor_count, Buffer{0, -1, -1, 0});
+  std::vector<const uint8_t*> data(tensor_count);
+  std::vector<size_t> bytes(tensor_count);
+  for (int i = 0; i < tensor_count; i++) {
+    const TfLiteTensor* tensor = interpreter->tensor(i);
+    data[i] = tensor->data.uint8;
+    bytes[i] = tensor->bytes;
+    tensors[i].tensor = i;
+    tensors[i].size = tflite::AlignSizeUp(bytes[i], kBufferAlignment);
+  }
+  for (size_t i = 0; i < subgraph->inputs()->size(); i++) {
+    tensors[subgraph->inputs()->Get(i)].first_created = 0;
+  }
+  for (size_t i = 0; i < subgraph->outputs()->size(); i++) {
+    tensors[subgraph->outputs()->Get(i)].last_used = last_node;
+  }
+  for (int i = last_node; i >= 0; i--) {
+    const tflite::Operator* op = subgraph->operators()->Get(i);
+    for (size_t n = 0; n < op->inputs()->size(); n++) {
+      const int index = op->inputs()->Get(n);
+      if (index >= 0) {
+        tensors[index].last_used = std::max(tensors[index].last_used, i);
+      }
+    }
+    for (size_t n = 0; n < op->outputs()->size(); n++) {
+      Buffer& t = tensors[op->outputs()->Get(n)];
+      if (t.first_created == -1 || t.first_created > i) {
+        t.first_created = i;
+      }
+    }
+  }
+  std::vector<bool> planned(tensor_count);
+  for (int i = 0; i < tensor_count; i++) {
+    const tflite::Tensor* tensor = subgraph->tensors()->Get(i);
+    const tflite::Buffer* buffer = model->buffers()->Get(tensor->buffer());
+    const bool constant =
+        buffer != nullptr && buffer->data() != nullptr && buffer->data()->size() > 0;
+    planned[i] = !constant && !tensor->is_variable();
+    if (planned[i] && (tensors[i].first_created == -1 || tensors[i].last_used == -1)) {
+      fprintf(stderr, "tensor %d has no lifetime\n", i);
+      return false;
+    }
+  }
+
+  // An input and an output of one op are live at the same time, so the
+  // planner never overlaps them: if one is inside the other, the allocator
+  // aliased them. The buffer of a group is that of the member that starts
+  // first and is largest, which spans all the others.
+  std::vector<int> root(tensor_count);
+  for (int i = 0; i < tensor_count; i++) {
+    root[i] = i;
+  }
+  auto find = [&](int i) {
+    while (root[i] != i) {
+      i = root[i];
+    }
+    return i;
+  };
+  auto inside = [&](int a, int b) {
+    return data[a] >= data[b] && data[a] + bytes[a] <= data[b] + bytes[b];
+  };
+  for (int i = 0; i <= last_node; i++) {
+    const tflite::Operator* op = subgraph->operators()->Get(i);
+    if (!IsCopyOp(tflite::GetBuiltinCode(model->operator_codes()->Get(op->opcode_index())))) {
+      continue;
+    }
+    for (size_t n = 0; n < op->inputs()->size(); n++) {
+      for (size_t m = 0; m < op->outputs()->size(); m++) {
+        const int input = op->inputs()->Get(n);
+        const int output = op->outputs()->Get(m);
+        if (input < 0 || !planned[input] || !planned[output] || bytes[input] == 0 ||
+            bytes[output] == 0 || !(inside(input, output) || inside(output, input))) {
+          continue;
+        }
+        const int a = find(input);
+        const int b = find(output);
+        const bool a_spans = data[a] < data[b] || (data[a] == data[b] && bytes[a] >= bytes[b]);
+        if (a != b) {
+          root[a_spans ? b : a] = a_spans ? a : b;
+        }
+      }
+    }
+  }
+  for (int i = 0; i < tensor_count; i++) {
+    const int r = find(i);
+    if (planned[i] && r != i) {
+      tensors[r].first_created = std::min(tensors[r].first_created, tensors[i].first_created);
+      tensors[r].last_used = std::max(tensors[r].last_used, tensors[i].last_used);
+      aliases->push_back(Alias{i, r, static_cast<int>(data[i] - data[r])});
+    }
+  }
+  for (int i = 0; i < tensor_count; i++) {
+    if (planned[i] && find(i) == i) {
+      buffers->push_back(tensors[i]);
+    }
+  }
+  for (const ScratchRequest& request : requests) {
+    const int size = tflite::AlignSizeUp(request.bytes, kBufferAlignment);
+    buffers->push_back(Buffer{size, request.node, request.node, -1});
+  }
+  return true;
+}
+
+// Runs the planner as CommitStaticMemoryPlan() will: tensors with an offset
+// in offsets are placed there, the others planned around them. Returns the
+// head size, and the offset of every buffer in placed.
+size_t DevicePlan(const std::vector<Buffer>& buffers, const std::vector<int>* offsets,
+                  std::vector<int>* placed, bool check) {
+  static tflite::MicroErrorReporter error_reporter;
+  std::vector<unsigned char> scratch(buffers.size() *
+                                     tflite::IntervalMemoryPlanner::per_buffer_size());
+  tflite::IntervalMemoryPlanner planner(scratch.data(), scratch.size());
+  for (size_t i = 0; i < buffers.size(); i++) {
+    const Buffer& b = buffers[i];
+    if (offsets != nullptr && b.tensor >= 0) {
+      planner.AddBuffer(&error_reporter, b.size, b.first_created, b.last_used,
+                        (*offsets)[i]);
+    } else {
+      planner.AddBuffer(&error_reporter, b.size, b.first_created, b.last_used);
+    }
+  }
+  if (check && planner.DoAnyBuffersOverlap(&error_reporter)) {
+    return 0;
+  }
+  if (placed != nullptr) {
+    placed->resize(buffers.size());
+    for (size_t i = 0; i < buffers.size(); i++) {
+      planner.GetOffsetForBuffer(&error_reporter, i, &(*placed)[i]);
+    }
+  }
+  return tflite::AlignSizeUp(planner.GetMaximumMemorySize(), kBufferAlignment);
+}
+
+// Places the buffers in order, each at the lowest offset clear of the
+// buffers already placed that are live at the same time
+void FirstFit(const std::vector<Buffer>& buffers,
+              const std::vector<std::vector<int>>& overlapping,
+              const std::vector<int>& order, std::vector<int>* offsets) {
+  std::vector<bool> done(buffers.size(), false);
+  std::vector<std::pair<int, int>> taken;
+  for (int i : order) {
+    taken.clear();
+    for (int j : overlapping[i]) {
+      if (done[j]) {
+        taken.emplace_back((*offsets)[j], (*offsets)[j] + buffers[j].size);
+      }
+    }
+    std::sort(taken.begin(), taken.end());
+    int offset = 0;
+    for (const std::pair<int, int>& t : taken) {
+      if (offset + buffers[i].size <= t.first) {
+        break;
+      }
+      offset = std::max(offset, t.second);
+    }
+    (*offsets)[i] = offset;
+    done[i] = true;
+  }
+}
+
+// Searches buffer orders for a smaller head than the greedy plan, by moving
+// one buffer at a time in the order and keeping moves that do not lose.
+// Returns the head size of the offsets left in best.
+size_t Search(const std::vector<Buffer>& buffers, int iterations, unsigned seed,
+              std::vector<int>* best) {
+  const int n = buffers.size();
+  std::vector<std::vector<int>> overlapping(n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      if (i != j && Overlap(buffers[i], buffers[j])) {
+        overlapping[i].push_back(j);
+      }
+    }
+  }
+  // The greedy plan itself, with the tensors fixed where it put them
+  std::vector<int> offsets;
+  DevicePlan(buffers, nullptr, &offsets, false);
+  size_t best_size = DevicePlan(buffers, &offsets, nullptr, false);
+  *best = offsets;
+
+  // Starting orders: largest first as the planner does, then the buffers
+  // that live longest, and the largest in bytes times lifetime
+  std::vector<std::vector<int>> starts(3, std::vector<int>(n));
+  for (std::vector<int>& order : starts) {
+    for (int i = 0; i < n; i++) {
+      order[i] = i;
+    }
+  }
+  auto lifetime = [&](int i) { return buffers[i].last_used - buffers[i].first_created + 1; };
+  std::stable_sort(starts[0].begin(), starts[0].end(),
+                   [&](int a, int b) { return buffers[a].size > buffers[b].size; });
+  std::stable_sort(starts[1].begin(), starts[1].end(), [&](int a, int b) {
+    return lifetime(a) != lifetime(b) ? lifetime(a) > lifetime(b)
+                                      : buffers[a].size > buffers[b].size;
+  });
+  std::stable_sort(starts[2].begin(), starts[2].end(), [&](int a, int b) {
+    return static_cast<int64_t>(buffers[a].size) * lifetime(a) >
+           static_cast<int64_t>(buffers[b].size) * lifetime(b);
+  });
+
+  std::mt19937 random(seed);
+  std::vector<int> order;
+  size_t order_size = 0;
+  for (int i = -static_cast<int>(starts.size()); i < iterations; i++) {
+    std::vector<int> candidate;
+    if (i < 0) {
+      candidate = starts[starts.size() + i];
+    } else {
+      // Move one buffer to another place in the order
+      candidate = order;
+      const int from = random() % n;
+      const int to = random() % n;
+      const int moved = candidate[from];
+      candidate.erase(candidate.begin() + from);
+      candidate.insert(candidate.begin() + to, moved);
+    }
+    FirstFit(buffers, overlapping, candidate, &offsets);
+    const size_t size = DevicePlan(buffers, &offsets, nullptr, false);
+    if (i < 0 ? order.empty() || size < order_size : size <= order_size) {
+      order = candidate;
+      order_size = size;
+    }
+    if (size < best_size) {
+      best_size = size;
+      *best = offsets;
+    }
+  }
+  return best_size;
+}
+
+// The most bytes live at once, which no plan goes under
+size_t LowerBound(const std::vector<Buffer>& buffers) {
+  size_t bound = 0;
+  for (const Buffer& b : buffers) {
+    size_t live = 0;
+    for (const Buffer& other : buffers) {
+      if (other.first_created <= b.first_created && b.first_created <= other.last_used) {
+        live += other.size;
+      }
+    }
+    bound = std::max(bound, live);
+  }
+  return bound;
+}
+
+// The model with the offsets of the tensors in its metadata; -1 for those
+// left to the allocator
+std::vector<uint8_t> WithOffsets(const uint8_t* model, const std::vector<int32_t>& offsets) {
+  std::unique_ptr<tflite::ModelT> unpacked = tflite::UnPackModel(model);
+  std::vector<uint8_t> data(sizeof(int32_t) * (3 + offsets.size()));
+  const int32_t header[3] = {1, 0, static_cast<int32_t>(offsets.size())};
+  memcpy(data.data(), header, sizeof(header));
+  memcpy(data.data() + sizeof(header), offsets.data(), sizeof(int32_t) * offsets.size());
+
+  tflite::MetadataT* metadata = nullptr;
+  for (std::unique_ptr<tflite::MetadataT>& m : unpacked->metadata) {
+    if (m->name == kOfflineMemAllocMetadata) {
+      metadata = m.get();
+    }
+  }
+  if (metadata == nullptr) {
+    unpacked->metadata.emplace_back(new tflite::MetadataT);
+    metadata = unpacked->metadata.back().get();
+    metadata->name = kOfflineMemAllocMetadata;
+    metadata->buffer = unpacked->buffers.size();
+    unpacked->buffers.emplace_back(new tflite::BufferT);
+  }
+  unpacked->buffers[metadata->buffer]->data = data;
+
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::FinishModelBuffer(builder, tflite::Model::Pack(builder, unpacked.get()));
+  return std::vector<uint8_t>(builder.GetBufferPointer(),
+                              builder.GetBufferPointer() + builder.GetSize());
+}
+
+// An interpreter on its own arena, allocated
+struct Allocated {
+  std::vector<uint8_t> arena;
+  std::vector<ScratchRequest> requests;
+  RecordingScratchAllocator* allocator = nullptr;
+  tflite::MicroInterpreter* interpreter = nullptr;
+  alignas(tflite::MicroInterpreter) uint8_t storage[sizeof(tflite::MicroInterpreter)];
+
+  bool Allocate(const tflite::Model* model, const tflite::MicroOpResolver& resolver,
+                tflite::ErrorReporter* error_reporter) {
+    arena.resize(kArenaSize + kBufferAlignment);
+    uint8_t* aligned = tflite::AlignPointerUp(arena.data(), kBufferAlignment);
+    allocator = RecordingScratchAllocator::Create(aligned, kArenaSize, error_reporter,
+                                                  &requests);
+    interpreter = new (storage)
+        tflite::MicroInterpreter(model, resolver, allocator, error_reporter);
+    return interpreter->AllocateTensors() == kTfLiteOk;
+  }
+};
+
+// Invokes both models on the same inputs and compares the outputs
+bool SameOutputs(Allocated* a, Allocated* b) {
+  std::mt19937 random(1);
+  for (int run = 0; run < 3; run++) {
+    for (size_t i = 0; i < a->interpreter->inputs_size(); i++) {
+      TfLiteTensor* in_a = a->interpreter->input(i);
+      TfLiteTensor* in_b = b->interpreter->input(i);
+      for (size_t j = 0; j < in_a->bytes; j++) {
+        in_a->data.uint8[j] = run == 0 ? 0 : random();
+      }
+      memcpy(in_b->data.raw, in_a->data.raw, in_a->bytes);
+    }
+    if (a->interpreter->Invoke() != kTfLiteOk || b->interpreter->Invoke() != kTfLiteOk) {
+      return false;
+    }
+    for (size_t i = 0; i < a->interpreter->outputs_size(); i++) {
+      const TfLiteTensor* out_a = a->interpreter->output(i);
+      const TfLiteTensor* out_b = b->interpreter->output(i);
+      if (out_a->bytes != out_b->bytes ||
+          memcmp(out_a->data.raw, out_b->data.raw, out_a->bytes) != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int iterations = 10000;
+  unsigned seed = 1;
+  const char* name = nullptr;
+  const char* paths[2] = {nullptr, nullptr};
+  int path_count = 0;
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    if (strcmp(argv[i], "--search") == 0 && has_value) {
+      iterations = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+      seed = strtoul(argv[++i], nullptr, 0);
+    } else if (strcmp(argv[i], "--name") == 0 && has_value) {
+      name = argv[++i];
+    } else if (argv[i][0] == '-' || path_count == 2) {
+      Usage();
+      return 2;
+    } else {
+      paths[path_count++] = argv[i];
+    }
+  }
+  if (path_count != 2 || iterations < 0) {
+    Usage();
+    return 2;
+  }
+
+  std::vector<uint8_t> bytes;
+  Source source;
+  if (!ReadModel(paths[0], &bytes, &source)) {
+    fprintf(stderr, "%s: cannot read a model\n", paths[0]);
+    return 2;
+  }
+  if (name != nullptr) {
+    source.name = name;
+  }
+  if (IsSource(paths[1]) && source.name.empty()) {
+    fprintf(stderr, "%s: needs --name\n", paths[1]);
+    return 2;
+  }
+  // Aligned as the buffers in it expect
+  std::vector<uint64_t> aligned((bytes.size() + 7) / 8);
+  memcpy(aligned.data(), bytes.data(), bytes.size());
+  flatbuffers::Verifier verifier(reinterpret_cast<const uint8_t*>(aligned.data()),
+                                 bytes.size());
+  if (!tflite::VerifyModelBuffer(verifier)) {
+    fprintf(stderr, "%s: not a TensorFlow Lite model\n", paths[0]);
+    return 2;
+  }
+  const tflite::Model* model = tflite::GetModel(aligned.data());
+  if (model->subgraphs()->size() != 1) {
+    fprintf(stderr, "%s: only one subgraph is supported\n", paths[0]);
+    return 2;
+  }
+
+  tflite::MicroErrorReporter error_reporter;
+  tflite::AllOpsResolver resolver;
+  Allocated before;
+  if (!before.Allocate(model, resolver, &error_reporter)) {
+    return 1;
+  }
+  // Before tensor() below allocates from the tail
+  const size_t used_before = before.interpreter->arena_used_bytes();
+  std::vector<Buffer> buffers;
+  std::vector<Alias> aliases;
+  if (!CollectBuffers(model, before.interpreter, before.requests, &buffers, &aliases)) {
+    return 1;
+  }
+  const size_t greedy = DevicePlan(buffers, nullptr, nullptr, false);
+  std::vector<int> offsets;
+  const size_t planned = Search(buffers, iterations, seed, &offsets);
+  if (DevicePlan(buffers, &offsets, nullptr, true) != planned) {
+    fprintf(stderr, "the plan has overlapping buffers\n");
+    return 1;
+  }
+
+  std::vector<int32_t> tensor_offsets(model->subgraphs()->Get(0)->tensors()->size(),
+                                      tflite::kOnlinePlannedBuffer);
+  for (size_t i = 0; i < buffers.size(); i++) {
+    if (buffers[i].tensor >= 0) {
+      tensor_offsets[buffers[i].tensor] = offsets[i];
+    }
+  }
+  for (const Alias& alias : aliases) {
+    tensor_offsets[alias.tensor] = tensor_offsets[alias.root] + alias.offset;
+  }
+  const std::vector<uint8_t> out =
+      WithOffsets(reinterpret_cast<const uint8_t*>(aligned.data()), tensor_offsets);
+
+  Allocated after;
+  if (!after.Allocate(tflite::GetModel(out.data()), resolver, &error_reporter)) {
+    return 1;
+  }
+  printf("%zu buffers, %zu scratch, %zu aliased, %d orders searched\n", buffers.size(),
+         before.requests.size(), aliases.size(), iterations);
+  printf("head: %zu bytes greedy, %zu planned, %zu live at most\n", greedy, planned,
+         LowerBound(buffers));
+  printf("arena used: %zu bytes, %zu planned\n", used_before,
+         after.interpreter->arena_used_bytes());
+  if (after.allocator->head_bytes() != planned) {
+    fprintf(stderr, "the allocator made a head of %zu bytes\n",
+            after.allocator->head_bytes());
+    return 1;
+  }
+  if (!SameOutputs(&before, &after)) {
+    fprintf(stderr, "the planned model gives other outputs\n");
+    return 1;
+  }
+  if (!WriteModel(paths[1], out.data(), out.size(), source)) {
+    fprintf(stderr, "%s: cannot write\n", paths[1]);
+    return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,39 @@
+#ifndef TFLMICRO_HOST_REPLAY_H_
+#define TFLMICRO_HOST_REPLAY_H_
+
+#include <stdint.h>
+
+// Shared between the replay GetImage(), RespondToDetection() and main:
+// where frames come from, and what was measured for the current one.
+
+enum ReplayFormat {
+  // Raw 324x324 HM01B0 frames; the centre is subsampled by 2 as the
+  // person_detection_screen PIO capture does
+  kReplayHm01b0,
+  // 96x96 YUV422 frames as read out of the ArduChip FIFO, Y U Y V ...
+  kReplayOv2640Yuv,
+  // 96x96 luma, as the firmware sends over the frame link
+  kReplayGray,
+};
+
+// Returns the bytes of one frame in the format
+int ReplayFrameSize(ReplayFormat format);
+// Queues a file of back-to-back frames. Returns false if it cannot be
+// opened or does not hold a whole number of frames.
+bool ReplayAddFile(const char* path, ReplayFormat format);
+// Whether GetImage() has another frame to return
+bool ReplayHasFrame();
+// Starts again from the first frame of the first file
+void ReplayRewind();
+
+struct ReplayFrame {
+  // Reading the frame, and turning it into the model input
+  int32_t read_ticks;
+  int32_t preprocess_ticks;
+  int32_t respond_ticks;
+  int8_t person_score;
+  int8_t no_person_score;
+};
+extern ReplayFrame replay_frame;
+
+#endif  // TFLMICRO_HOST_REPLAY_H_
@@ -0,0 +1,14 @@
+#include "detection_responder.h"
+#include "replay.h"
+#include "tensorflow/lite/micro/micro_time.h"
+
+// Keeps the scores for the trace instead of acting on them
+void RespondToDetection(tflite::ErrorReporter* error_reporter,
+                        int8_t person_score, int8_t no_person_score) {
+  const int32_t start = tflite::GetCurrentTimeTicks();
+  TF_LITE_REPORT_ERROR(error_reporter, "person score:%d no person score %d",
+                       person_score, no_person_score);
+  replay_frame.person_score = person_score;
+  replay_frame.no_person_score = no_person_score;
+  replay_frame.respond_ticks = tflite::GetCurrentTimeTicks() - start;
+}
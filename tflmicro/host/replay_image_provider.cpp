@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "image_provider.h"
+#include "model_settings.h"
+#include "replay.h"
+#include "tensorflow/lite/micro/micro_time.h"
+
+extern "C" {
+#include "preprocess.h"
+}
+
+namespace {
+
+constexpr int kHm01b0Size = 324;
+
+struct ReplayFile {
+  const char* path;
+  ReplayFormat format;
+  long frames;
+};
+
+std::vector<ReplayFile> files;
+size_t file_index = 0;
+long frame_index = 0;
+FILE* current = nullptr;
+uint8_t raw[kHm01b0Size * kHm01b0Size];
+
+}  // namespace
+
+ReplayFrame replay_frame;
+
+int ReplayFrameSize(ReplayFormat format) {
+  switch (format) {
+    case kReplayHm01b0:
+      return kHm01b0Size * kHm01b0Size;
+    case kReplayOv2640Yuv:
+      return kMaxImageSize * 2;
+    case kReplayGray:
+      return kMaxImageSize;
+  }
+  return 0;
+}
+
+bool ReplayAddFile(const char* path, ReplayFormat format) {
+  FILE* f = fopen(path, "rb");
+  if (f == nullptr) {
+    return false;
+  }
+  fseek(f, 0, SEEK_END);
+  const long size = ftell(f);
+  fclose(f);
+  const int frame_size = ReplayFrameSize(format);
+  if (size <= 0 || size % frame_size != 0) {
+    return false;
+  }
+  files.push_back({path, format, size / frame_size});
+  return true;
+}
+
+bool ReplayHasFrame() {
+  return file_index < files.size() && frame_index < files[file_index].frames;
+}
+
+void ReplayRewind() {
+  if (current != nullptr) {
+    fclose(current);
+    current = nullptr;
+  }
+  file_index = 0;
+  frame_index = 0;
+}
+
+TfLiteStatus GetImage(tflite::ErrorReporter* error_reporter, int image_width,
+                      int image_height, int channels, int8_t* image_data) {
+  if (!ReplayHasFrame()) {
+    TF_LITE_REPORT_ERROR(error_reporter, "No frames left to replay.");
+    return kTfLiteError;
+  }
+  const ReplayFile& file = files[file_index];
+  const int frame_size = ReplayFrameSize(file.format);
+
+  int32_t start = tflite::GetCurrentTimeTicks();
+  if (current == nullptr) {
+    current = fopen(file.path, "rb");
+  }
+  if (current == nullptr ||
+      fread(raw, 1, frame_size, current) != static_cast<size_t>(frame_size)) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Cannot read %s.", file.path);
+    return kTfLiteError;
+  }
+  if (++frame_index == file.frames) {
+    fclose(current);
+    current = nullptr;
+    file_index++;
+    frame_index = 0;
+  }
+  replay_frame.read_ticks = tflite::GetCurrentTimeTicks() - start;
+
+  start = tflite::GetCurrentTimeTicks();
+  const int size = image_width * image_height * channels;
+  switch (file.format) {
+    case kReplayHm01b0: {
+      struct preprocess_config preprocess;
+      preprocess.src_stride = kHm01b0Size;
+      preprocess.crop_x = (kHm01b0Size - image_width * 2) / 2 + 1;
+      preprocess.crop_y = (kHm01b0Size - image_height * 2) / 2;
+      preprocess.out_width = image_width;
+      preprocess.out_height = image_height;
+      preprocess.factor = 2;
+      preprocess.mode = PREPROCESS_SUBSAMPLE;
+      preprocess.zero_point = 128;
+      preprocess_frame(&preprocess, raw, image_data);
+      break;
+    }
+    case kReplayOv2640Yuv:
+      for (int i = 0; i < size; ++i) {
+        image_data[i] = static_cast<int8_t>(raw[2 * i] - 128);
+      }
+      break;
+    case kReplayGray:
+      for (int i = 0; i < size; ++i) {
+        image_data[i] = static_cast<int8_t>(raw[i] - 128);
+      }
+      break;
+  }
+  replay_frame.preprocess_ticks = tflite::GetCurrentTimeTicks() - start;
+  return kTfLiteOk;
+}
@@ -0,0 +1,166 @@
+// Runs the person_detection setup() and loop() over recorded frames and
+// reports how long each stage took, the frame rate and the scores.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "main_functions.h"
+#include "replay.h"
+#include "tensorflow/lite/micro/micro_time.h"
+
+namespace {
+
+enum Stage { kRead, kPreprocess, kInference, kRespond, kLoop, kNumStages };
+const char* const kStageNames[kNumStages] = {"read", "preprocess", "inference",
+                                             "respond", "loop"};
+
+void Usage() {
+  fprintf(stderr,
+          "usage: person_detection_replay [--repeat n] [--trace scores.csv]\n"
+          "           [--expect PN.] [--format hm01b0|ov2640|gray] frames...\n"
+          "--format applies to the files after it, gray by default.\n"
+          "--expect gives for every frame whether the person (P) or the no\n"
+          "person (N) score has to be higher, . for either; the exit status\n"
+          "is 1 if one is not.\n");
+}
+
+int64_t Microseconds(int64_t ticks) {
+  return ticks * 1000000 / tflite::ticks_per_second();
+}
+
+void Report(const char* name, std::vector<int32_t>* ticks) {
+  if (ticks->empty()) {
+    return;
+  }
+  std::sort(ticks->begin(), ticks->end());
+  int64_t sum = 0;
+  for (int32_t t : *ticks) {
+    sum += t;
+  }
+  const size_t n = ticks->size();
+  printf("%-11s %10lld %10lld %10lld %10lld %10lld\n", name,
+         static_cast<long long>(Microseconds(sum / static_cast<int64_t>(n))),
+         static_cast<long long>(Microseconds((*ticks)[0])),
+         static_cast<long long>(Microseconds((*ticks)[n / 2])),
+         static_cast<long long>(Microseconds((*ticks)[n * 99 / 100])),
+         static_cast<long long>(Microseconds((*ticks)[n - 1])));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ReplayFormat format = kReplayGray;
+  const char* trace_path = nullptr;
+  const char* expect = nullptr;
+  int repeat = 1;
+  int files = 0;
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    if (strcmp(argv[i], "--format") == 0 && has_value) {
+      const char* name = argv[++i];
+      if (strcmp(name, "hm01b0") == 0) {
+        format = kReplayHm01b0;
+      } else if (strcmp(name, "ov2640") == 0) {
+        format = kReplayOv2640Yuv;
+      } else if (strcmp(name, "gray") == 0) {
+        format = kReplayGray;
+      } else {
+        Usage();
+        return 2;
+      }
+    } else if (strcmp(argv[i], "--trace") == 0 && has_value) {
+      trace_path = argv[++i];
+    } else if (strcmp(argv[i], "--expect") == 0 && has_value) {
+      expect = argv[++i];
+    } else if (strcmp(argv[i], "--repeat") == 0 && has_value) {
+      repeat = atoi(argv[++i]);
+    } else if (argv[i][0] == '-') {
+      Usage();
+      return 2;
+    } else if (!ReplayAddFile(argv[i], format)) {
+      fprintf(stderr, "%s: cannot open, or not a whole number of %d byte frames\n",
+              argv[i], ReplayFrameSize(format));
+      return 2;
+    } else {
+      files++;
+    }
+  }
+  if (files == 0 || repeat < 1) {
+    Usage();
+    return 2;
+  }
+  FILE* trace = nullptr;
+  if (trace_path != nullptr) {
+    trace = fopen(trace_path, "w");
+    if (trace == nullptr) {
+      fprintf(stderr, "%s: cannot create\n", trace_path);
+      return 2;
+    }
+    fprintf(trace,
+            "frame,person_score,no_person_score,read_us,preprocess_us,"
+            "inference_us,respond_us,loop_us\n");
+  }
+
+  setup();
+
+  std::vector<int32_t> ticks[kNumStages];
+  int frame = 0;
+  int wrong = 0;
+  const int32_t start = tflite::GetCurrentTimeTicks();
+  for (int pass = 0; pass < repeat; pass++) {
+    ReplayRewind();
+    for (int index = 0; ReplayHasFrame(); index++, frame++) {
+      replay_frame = ReplayFrame();
+      const int32_t loop_start = tflite::GetCurrentTimeTicks();
+      loop();
+      int32_t stage[kNumStages];
+      stage[kLoop] = tflite::GetCurrentTimeTicks() - loop_start;
+      stage[kRead] = replay_frame.read_ticks;
+      stage[kPreprocess] = replay_frame.preprocess_ticks;
+      stage[kRespond] = replay_frame.respond_ticks;
+      // Invoke(), and whatever else loop() does between the two
+      stage[kInference] = stage[kLoop] - stage[kRead] - stage[kPreprocess] -
+                          stage[kRespond];
+      for (int s = 0; s < kNumStages; s++) {
+        ticks[s].push_back(stage[s]);
+      }
+      if (trace != nullptr) {
+        fprintf(trace, "%d,%d,%d,%lld,%lld,%lld,%lld,%lld\n", frame,
+                replay_frame.person_score, replay_frame.no_person_score,
+                static_cast<long long>(Microseconds(stage[kRead])),
+                static_cast<long long>(Microseconds(stage[kPreprocess])),
+                static_cast<long long>(Microseconds(stage[kInference])),
+                static_cast<long long>(Microseconds(stage[kRespond])),
+                static_cast<long long>(Microseconds(stage[kLoop])));
+      }
+      const char expected =
+          expect != nullptr && index < static_cast<int>(strlen(expect)) ? expect[index]
+                                                                       : '.';
+      const bool person = replay_frame.person_score > replay_frame.no_person_score;
+      if ((expected == 'P' && !person) || (expected == 'N' && person)) {
+        fprintf(stderr, "frame %d: expected %c, scores %d %d\n", frame, expected,
+                replay_frame.person_score, replay_frame.no_person_score);
+        wrong++;
+      }
+    }
+  }
+  const int32_t elapsed = tflite::GetCurrentTimeTicks() - start;
+  if (trace != nullptr) {
+    fclose(trace);
+  }
+
+  printf("%d frames in %lld ms, %.2f frames/s\n", frame,
+         static_cast<long long>(Microseconds(elapsed) / 1000),
+         elapsed > 0 ? frame * static_cast<double>(tflite::ticks_per_second()) / elapsed
+                     : 0.0);
+  printf("%-11s %10s %10s %10s %10s %10s\n", "stage (us)", "mean", "min", "p50",
+         "p99", "max");
+  for (int s = 0; s < kNumStages; s++) {
+    Report(kStageNames[s], &ticks[s]);
+  }
+  return wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+/*
+  Decodes the framed packets the firmware sends with frame_link, see
+ Arducam/src/frame_link.h for the format. Feed it every byte read from the
+ serial port; decode() returns true when a packet is complete, which is
+ then described by type, seq and data until the next call.
+
+ This example code is in the public domain.
+ */
+
+public class FrameDecoder {
+  public static final int IMAGE = 1;
+  public static final int SCORES = 2;
+
+  static final int SYNC0 = 0xA5;
+  static final int SYNC1 = 0x5A;
+  static final int HEADER_SIZE = 10;
+  static final int CRC_SIZE = 2;
+  static final int RAW = 0;
+  static final int RLE = 1;
+  static final int DELTA = 2;
+
+  // Set by decode() for each packet it returns
+  public int type;
+  public int seq;
+  public byte[] data;
+  // Packets whose CRC did not match, and packets that could not be decoded
+  // or that were missing from the sequence
+  public int crcErrors = 0;
+  public int lost = 0;
+
+  byte[] buf;
+  int fill = 0;
+  byte[] image;
+  int imageSeq;
+  boolean imageValid = false;
+  int nextSeq;
+  boolean synced = false;
+
+  public FrameDecoder(int maxImageSize) {
+    buf = new byte[HEADER_SIZE + 2 + maxImageSize + (maxImageSize + 127) / 128 + CRC_SIZE];
+    image = new byte[maxImageSize];
+  }
+
+  static int get16(byte[] b, int offset) {
+    return (b[offset] & 0xFF) | ((b[offset + 1] & 0xFF) << 8);
+  }
+
+  static int crc16(byte[] b, int offset, int size) {
+    int crc = 0xFFFF;
+    for (int i = 0; i < size; i++) {
+      crc ^= (b[offset + i] & 0xFF) << 8;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x8000) != 0 ? (crc << 1) ^ 0x1021 : crc << 1;
+      }
+      crc &= 0xFFFF;
+    }
+    return crc;
+  }
+
+  // PackBits decodes into dst, or adds the decoded bytes to it when add is
+  // set. False if src is malformed or does not fill exactly size bytes.
+  static boolean rleDecode(byte[] src, int offset, int size, byte[] dst, int capacity, boolean add) {
+    int in = offset, out = 0, end = offset + size;
+    while (in < end) {
+      int n = src[in++] & 0xFF;
+      if (n < 128) {
+        int literal = n + 1;
+        if (in + literal > end || out + literal > capacity) {
+          return false;
+        }
+        for (int k = 0; k < literal; k++) {
+          dst[out + k] = (byte)(add ? dst[out + k] + src[in + k] : src[in + k]);
+        }
+        in += literal;
+        out += literal;
+      } else if (n > 128) {
+        int run = 257 - n;
+        if (in >= end || out + run > capacity) {
+          return false;
+        }
+        for (int k = 0; k < run; k++) {
+          dst[out + k] = (byte)(add ? dst[out + k] + src[in] : src[in]);
+        }
+        in++;
+        out += run;
+      } else {
+        return false;
+      }
+    }
+    return out == capacity;
+  }
+
+  public boolean decode(int b) {
+    if (fill == 0 && b != SYNC0) {
+      return false;
+    }
+    if (fill == 1 && b != SYNC1) {
+      fill = b == SYNC0 ? 1 : 0;
+      return false;
+    }
+    buf[fill++] = (byte)b;
+    if (fill < HEADER_SIZE) {
+      return false;
+    }
+    int total = HEADER_SIZE + get16(buf, 6) + CRC_SIZE;
+    if (total > buf.length) {
+      // Not a packet this decoder could hold, so not a real one
+      fill = 0;
+      return false;
+    }
+    if (fill < total) {
+      return false;
+    }
+    fill = 0;
+    int covered = total - 2 - CRC_SIZE;
+    if (crc16(buf, 2, covered) != get16(buf, 2 + covered)) {
+      crcErrors++;
+      return false;
+    }
+    return decodePacket();
+  }
+
+  boolean decodePacket() {
+    int packetType = buf[2] & 0xFF;
+    int encoding = buf[3] & 0xFF;
+    int packetSeq = get16(buf, 4);
+    int length = get16(buf, 6);
+    int rawLength = get16(buf, 8);
+    if (synced && packetSeq != nextSeq) {
+      lost += (packetSeq - nextSeq) & 0xFFFF;
+    }
+    synced = true;
+    nextSeq = (packetSeq + 1) & 0xFFFF;
+
+    if (packetType != IMAGE) {
+      if (encoding != RAW || length != rawLength) {
+        lost++;
+        return false;
+      }
+      data = java.util.Arrays.copyOfRange(buf, HEADER_SIZE, HEADER_SIZE + length);
+    } else {
+      boolean ok = rawLength <= image.length;
+      if (ok && encoding == RAW) {
+        ok = length == rawLength;
+        if (ok) {
+          System.arraycopy(buf, HEADER_SIZE, image, 0, length);
+        }
+      } else if (ok && encoding == RLE) {
+        ok = rleDecode(buf, HEADER_SIZE, length, image, rawLength, false);
+      } else if (ok && encoding == DELTA) {
+        ok = length >= 2 && imageValid && get16(buf, HEADER_SIZE) == imageSeq &&
+             rleDecode(buf, HEADER_SIZE + 2, length - 2, image, rawLength, true);
+      } else {
+        ok = false;
+      }
+      // A failed decode may have left the image half written
+      imageValid = ok;
+      if (!ok) {
+        lost++;
+        return false;
+      }
+      imageSeq = packetSeq;
+      data = java.util.Arrays.copyOf(image, rawLength);
+    }
+    type = packetType;
+    seq = packetSeq;
+    return true;
+  }
+}
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_pipeline.h"
 
 namespace tflite {
 namespace {
@@ -63,6 +64,27 @@ struct OpData {
 
   // Index to buffer for optimizations if applicable.
   int buffer_idx;
+
+  // When the output rows are split across both cores, the first row computed
+  // by the second core and the index to its own buffer. split_row is 0 when
+  // the kernel is not split.
+  int split_row;
+  int split_buffer_idx;
+};
+
+// Everything a core needs to compute its share of the output rows.
+struct SplitJob {
+  cmsis_nn_context ctx[2];
+  cmsis_nn_conv_params conv_params;
+  cmsis_nn_per_channel_quant_params quant_params;
+  cmsis_nn_dims input_dims;
+  cmsis_nn_dims filter_dims;
+  cmsis_nn_dims bias_dims;
+  cmsis_nn_dims output_dims;
+  const int8_t* input;
+  const int8_t* filter;
+  const int32_t* bias;
+  int8_t* output;
 };
 
 inline PaddingType RuntimePaddingType(TfLitePadding padding) {
@@ -77,6 +99,28 @@ inline PaddingType RuntimePaddingType(TfLitePadding padding) {
   }
 }
 
+TfLiteStatus RunSplitHalf(void* data, uint32_t half, const SplitRows& rows) {
+  const SplitJob* job = static_cast<const SplitJob*>(data);
+  cmsis_nn_conv_params conv_params = job->conv_params;
+  cmsis_nn_dims input_dims = job->input_dims;
+  cmsis_nn_dims output_dims = job->output_dims;
+  conv_params.padding.h = rows.padding;
+  input_dims.h = rows.input_height;
+  output_dims.h = rows.output_height;
+  const int8_t* input =
+      job->input + rows.input_row * input_dims.w * input_dims.c;
+  int8_t* output =
+      job->output + rows.output_row * output_dims.w * output_dims.c;
+  if (arm_convolve_wrapper_s8(&job->ctx[half], &conv_params,
+                              &job->quant_params, &input_dims, input,
+                              &job->filter_dims, job->filter, &job->bias_dims,
+                              job->bias, &output_dims,
+                              output) != ARM_MATH_SUCCESS) {
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteNode* node,
                              const TfLiteConvParams* params, int width,
                              int height, int filter_width, int filter_height,
@@ -175,6 +219,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   data->input_zero_point = input->params.zero_point;
   data->filter_zero_point = filter->params.zero_point;
   data->output_zero_point = output->params.zero_point;
+  data->split_row = 0;
+  data->split_buffer_idx = -1;
 
   if (input->type == kTfLiteInt8) {
     // Initialize cmsis-nn convolution parameters
@@ -192,6 +238,33 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
     buf_size = arm_convolve_wrapper_s8_get_buffer_size(
         &conv_params, &input_dims, &filter_dims, &output_dims);
+
+    // Split the output rows across both cores. Each half may dispatch to a
+    // different CMSIS-NN kernel, so each gets a buffer sized for its own half.
+    if (PipelineKernelSplitEnabled() && input_dims.n == 1 &&
+        output_dims.h > 1 && conv_params.dilation.h == 1 &&
+        conv_params.dilation.w == 1) {
+      data->split_row = output_dims.h / 2;
+      int32_t split_buf_size[2];
+      for (int half = 0; half < 2; ++half) {
+        cmsis_nn_conv_params half_params = conv_params;
+        cmsis_nn_dims half_input_dims = input_dims;
+        cmsis_nn_dims half_output_dims = output_dims;
+        const SplitRows rows = GetSplitRows(
+            half, data->split_row, half_params.stride.h, filter_dims.h,
+            half_params.padding.h, input_dims.h, output_dims.h);
+        half_params.padding.h = rows.padding;
+        half_input_dims.h = rows.input_height;
+        half_output_dims.h = rows.output_height;
+        split_buf_size[half] = arm_convolve_wrapper_s8_get_buffer_size(
+            &half_params, &half_input_dims, &filter_dims, &half_output_dims);
+      }
+      buf_size = split_buf_size[0];
+      if (split_buf_size[1] > 0) {
+        TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+            context, split_buf_size[1], &data->split_buffer_idx));
+      }
+    }
   }
 
   if (buf_size > 0) {
@@ -211,14 +284,16 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                            TfLiteEvalTensor* im2col,
                            TfLiteEvalTensor* hwcn_weights,
                            TfLiteEvalTensor* output) {
+  const TfLitePaddingValues& padding =
+      tflite::micro::EvalPadding(context, data.padding);
   const int32_t input_offset = -data.input_zero_point;
   const int32_t filter_offset = -data.filter_zero_point;
   const int32_t output_offset = data.output_zero_point;
 
   ConvParams op_params;
   op_params.padding_type = RuntimePaddingType(params->padding);
-  op_params.padding_values.width = data.padding.width;
-  op_params.padding_values.height = data.padding.height;
+  op_params.padding_values.width = padding.width;
+  op_params.padding_values.height = padding.height;
   op_params.stride_width = params->stride_width;
   op_params.stride_height = params->stride_height;
   op_params.dilation_width_factor = params->dilation_width_factor;
@@ -248,6 +323,8 @@ TfLiteStatus EvalQuantizedPerChannel(
     const OpData& data, const TfLiteEvalTensor* input,
     const TfLiteEvalTensor* filter, const TfLiteEvalTensor* bias,
     TfLiteEvalTensor* output, TfLiteEvalTensor* im2col) {
+  const TfLitePaddingValues& padding =
+      tflite::micro::EvalPadding(context, data.padding);
   cmsis_nn_conv_params conv_params;
   conv_params.dilation.h = params->dilation_height_factor;
   conv_params.dilation.w = params->dilation_width_factor;
@@ -260,8 +337,8 @@ TfLiteStatus EvalQuantizedPerChannel(
     conv_params.output_offset = data.output_zero_point;
     conv_params.stride.h = params->stride_height;
     conv_params.stride.w = params->stride_width;
-    conv_params.padding.h = data.padding.height;
-    conv_params.padding.w = data.padding.width;
+    conv_params.padding.h = padding.height;
+    conv_params.padding.w = padding.width;
     conv_params.activation.min = data.output_activation_min;
     conv_params.activation.max = data.output_activation_max;
 
@@ -329,6 +406,32 @@ TfLiteStatus EvalQuantizedPerChannel(
       // arm_convolve_wrapper_s8_get_buffer_size
     }
 
+    // The rows were split for the whole output, a patch runs on one core.
+    if (data.split_row > 0 && tflite::micro::PatchPadding(context) == nullptr) {
+      SplitJob job;
+      job.ctx[0] = ctx;
+      job.ctx[1].buf = nullptr;
+      job.ctx[1].size = 0;
+      if (data.split_buffer_idx > -1) {
+        job.ctx[1].buf =
+            context->GetScratchBuffer(context, data.split_buffer_idx);
+      }
+      job.conv_params = conv_params;
+      job.quant_params = quant_params;
+      job.input_dims = input_dims;
+      job.filter_dims = filter_dims;
+      job.bias_dims = bias_dims;
+      job.output_dims = output_dims;
+      job.input = tflite::micro::GetTensorData<int8_t>(input);
+      job.filter = tflite::micro::GetTensorData<int8_t>(filter);
+      job.bias = tflite::micro::GetTensorData<int32_t>(bias);
+      job.output = tflite::micro::GetTensorData<int8_t>(output);
+      return PipelineRunSplitRows(RunSplitHalf, &job, data.split_row,
+                                  conv_params.stride.h, filter_dims.h,
+                                  conv_params.padding.h, input_dims.h,
+                                  output_dims.h);
+    }
+
     // arm_convolve_wrapper_s8 dispatches the optimized kernel accordingly with
     // the parameters passed
     TFLITE_DCHECK_EQ(
@@ -348,8 +451,8 @@ TfLiteStatus EvalQuantizedPerChannel(
     op_params.stride_width = params->stride_width;
     op_params.dilation_height_factor = params->dilation_height_factor;
     op_params.dilation_width_factor = params->dilation_width_factor;
-    op_params.padding_values.height = data.padding.height;
-    op_params.padding_values.width = data.padding.width;
+    op_params.padding_values.height = padding.height;
+    op_params.padding_values.width = padding.width;
     op_params.quantized_activation_min = data.output_activation_min;
     op_params.quantized_activation_max = data.output_activation_max;
 
@@ -374,14 +477,16 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
                        const TfLiteEvalTensor* bias, TfLiteEvalTensor* im2col,
                        TfLiteEvalTensor* hwcn_weights,
                        TfLiteEvalTensor* output) {
+  const TfLitePaddingValues& padding =
+      tflite::micro::EvalPadding(context, data.padding);
   float output_activation_min, output_activation_max;
   CalculateActivationRange(params->activation, &output_activation_min,
                            &output_activation_max);
   // TODO(b/154032858): Investigate removing extra copies.
   ConvParams op_params;
   op_params.padding_type = RuntimePaddingType(params->padding);
-  op_params.padding_values.width = data.padding.width;
-  op_params.padding_values.height = data.padding.height;
+  op_params.padding_values.width = padding.width;
+  op_params.padding_values.height = padding.height;
   op_params.stride_width = params->stride_width;
   op_params.stride_height = params->stride_height;
   op_params.dilation_width_factor = params->dilation_width_factor;
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_pipeline.h"
 
 namespace tflite {
 namespace {
@@ -62,8 +63,51 @@ struct OpData {
   int32_t output_activation_max;
   // Index to buffer for optimizations if applicable.
   int buffer_idx;
+
+  // When the output rows are split across both cores, the first row computed
+  // by the second core and the index to its own buffer. split_row is 0 when
+  // the kernel is not split.
+  int split_row;
+  int split_buffer_idx;
+};
+
+// Everything a core needs to compute its share of the output rows.
+struct SplitJob {
+  cmsis_nn_context ctx[2];
+  cmsis_nn_dw_conv_params dw_conv_params;
+  cmsis_nn_per_channel_quant_params quant_params;
+  cmsis_nn_dims input_dims;
+  cmsis_nn_dims filter_dims;
+  cmsis_nn_dims bias_dims;
+  cmsis_nn_dims output_dims;
+  const int8_t* input;
+  const int8_t* filter;
+  const int32_t* bias;
+  int8_t* output;
 };
 
+TfLiteStatus RunSplitHalf(void* data, uint32_t half, const SplitRows& rows) {
+  const SplitJob* job = static_cast<const SplitJob*>(data);
+  cmsis_nn_dw_conv_params dw_conv_params = job->dw_conv_params;
+  cmsis_nn_dims input_dims = job->input_dims;
+  cmsis_nn_dims output_dims = job->output_dims;
+  dw_conv_params.padding.h = rows.padding;
+  input_dims.h = rows.input_height;
+  output_dims.h = rows.output_height;
+  const int8_t* input =
+      job->input + rows.input_row * input_dims.w * input_dims.c;
+  int8_t* output =
+      job->output + rows.output_row * output_dims.w * output_dims.c;
+  if (arm_depthwise_conv_wrapper_s8(&job->ctx[half], &dw_conv_params,
+                                    &job->quant_params, &input_dims, input,
+                                    &job->filter_dims, job->filter,
+                                    &job->bias_dims, job->bias, &output_dims,
+                                    output) != ARM_MATH_SUCCESS) {
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus CalculateOpData(TfLiteContext* context, TfLiteNode* node,
                              TfLiteDepthwiseConvParams* params, int width,
                              int height, int filter_width, int filter_height,
@@ -160,6 +204,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   data->input_zero_point = input->params.zero_point;
   data->filter_zero_point = filter->params.zero_point;
   data->output_zero_point = output->params.zero_point;
+  data->split_row = 0;
+  data->split_buffer_idx = -1;
 
   if (input->type == kTfLiteInt8) {
     RuntimeShape input_shape = GetTensorShape(input);
@@ -195,9 +241,36 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     dw_conv_params.padding.h = data->padding.height;
     dw_conv_params.padding.w = data->padding.width;
 
-    const int32_t buf_size = arm_depthwise_conv_wrapper_s8_get_buffer_size(
+    int32_t buf_size = arm_depthwise_conv_wrapper_s8_get_buffer_size(
         &dw_conv_params, &input_dims, &filter_dims, &output_dims);
 
+    // Split the output rows across both cores, each with its own buffer.
+    if (PipelineKernelSplitEnabled() && output_dims.h > 1 &&
+        params->dilation_height_factor == 1 &&
+        params->dilation_width_factor == 1) {
+      data->split_row = output_dims.h / 2;
+      dw_conv_params.stride.h = params->stride_height;
+      int32_t split_buf_size[2];
+      for (int half = 0; half < 2; ++half) {
+        cmsis_nn_dw_conv_params half_params = dw_conv_params;
+        cmsis_nn_dims half_input_dims = input_dims;
+        cmsis_nn_dims half_output_dims = output_dims;
+        const SplitRows rows = GetSplitRows(
+            half, data->split_row, half_params.stride.h, filter_dims.h,
+            half_params.padding.h, input_dims.h, output_dims.h);
+        half_params.padding.h = rows.padding;
+        half_input_dims.h = rows.input_height;
+        half_output_dims.h = rows.output_height;
+        split_buf_size[half] = arm_depthwise_conv_wrapper_s8_get_buffer_size(
+            &half_params, &half_input_dims, &filter_dims, &half_output_dims);
+      }
+      buf_size = split_buf_size[0];
+      if (split_buf_size[1] > 0) {
+        TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+            context, split_buf_size[1], &data->split_buffer_idx));
+      }
+    }
+
     if (buf_size > 0) {
       TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
           context, buf_size, &data->buffer_idx));
@@ -212,6 +285,8 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
                TfLiteDepthwiseConvParams* params, const OpData* data,
                const TfLiteEvalTensor* input, const TfLiteEvalTensor* filter,
                const TfLiteEvalTensor* bias, TfLiteEvalTensor* output) {
+  const TfLitePaddingValues& padding =
+      tflite::micro::EvalPadding(context, data->padding);
   float output_activation_min, output_activation_max;
   CalculateActivationRange(params->activation, &output_activation_min,
                            &output_activation_max);
@@ -219,8 +294,8 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   tflite::DepthwiseParams op_params;
   // Padding type is ignored, but still set.
   op_params.padding_type = PaddingType::kSame;
-  op_params.padding_values.width = data->padding.width;
-  op_params.padding_values.height = data->padding.height;
+  op_params.padding_values.width = padding.width;
+  op_params.padding_values.height = padding.height;
   op_params.stride_width = params->stride_width;
   op_params.stride_height = params->stride_height;
   op_params.dilation_width_factor = params->dilation_width_factor;
@@ -246,6 +321,8 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
                              const TfLiteEvalTensor* filter,
                              const TfLiteEvalTensor* bias,
                              TfLiteEvalTensor* output) {
+  const TfLitePaddingValues& padding =
+      tflite::micro::EvalPadding(context, data->padding);
   cmsis_nn_dw_conv_params dw_conv_params;
   dw_conv_params.dilation.h = params->dilation_height_factor;
   dw_conv_params.dilation.w = params->dilation_width_factor;
@@ -256,8 +333,8 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
     dw_conv_params.output_offset = data->output_zero_point;
     dw_conv_params.stride.h = params->stride_height;
     dw_conv_params.stride.w = params->stride_width;
-    dw_conv_params.padding.h = data->padding.height;
-    dw_conv_params.padding.w = data->padding.width;
+    dw_conv_params.padding.h = padding.height;
+    dw_conv_params.padding.w = padding.width;
     // TODO(b/130439627): Use calculated value for clamping.
     dw_conv_params.activation.min = std::numeric_limits<int8_t>::min();
     dw_conv_params.activation.max = std::numeric_limits<int8_t>::max();
@@ -315,6 +392,36 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
       ctx.buf = context->GetScratchBuffer(context, data->buffer_idx);
     }
 
+    // The rows were split for the whole output, a patch runs on one core.
+    if (data->split_row > 0 &&
+        tflite::micro::PatchPadding(context) == nullptr) {
+      SplitJob job;
+      job.ctx[0] = ctx;
+      job.ctx[1].buf = nullptr;
+      job.ctx[1].size = 0;
+      if (data->split_buffer_idx > -1) {
+        job.ctx[1].buf =
+            context->GetScratchBuffer(context, data->split_buffer_idx);
+      }
+      job.dw_conv_params = dw_conv_params;
+      job.quant_params = quant_params;
+      job.input_dims = input_dims;
+      job.filter_dims = filter_dims;
+      job.bias_dims = bias_dims;
+      job.output_dims = output_dims;
+      job.input = tflite::micro::GetTensorData<int8_t>(input);
+      job.filter = tflite::micro::GetTensorData<int8_t>(filter);
+      job.bias = tflite::micro::GetTensorData<int32_t>(bias);
+      job.output = tflite::micro::GetTensorData<int8_t>(output);
+      TFLITE_DCHECK_EQ(
+          PipelineRunSplitRows(RunSplitHalf, &job, data->split_row,
+                               dw_conv_params.stride.h, filter_dims.h,
+                               dw_conv_params.padding.h, input_dims.h,
+                               output_dims.h),
+          kTfLiteOk);
+      return;
+    }
+
     TFLITE_DCHECK_EQ(
         arm_depthwise_conv_wrapper_s8(
             &ctx, &dw_conv_params, &quant_params, &input_dims,
@@ -326,8 +433,8 @@ void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
   } else {
     DepthwiseParams op_params;
     op_params.padding_type = PaddingType::kSame;
-    op_params.padding_values.width = data->padding.width;
-    op_params.padding_values.height = data->padding.height;
+    op_params.padding_values.width = padding.width;
+    op_params.padding_values.height = padding.height;
     op_params.stride_width = params->stride_width;
     op_params.stride_height = params->stride_height;
     op_params.dilation_width_factor = params->dilation_width_factor;
@@ -358,6 +465,8 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                    const TfLiteEvalTensor* input,
                    const TfLiteEvalTensor* filter, const TfLiteEvalTensor* bias,
                    TfLiteEvalTensor* output) {
+  const TfLitePaddingValues& padding =
+      tflite::micro::EvalPadding(context, data->padding);
   const int32_t input_offset = -data->input_zero_point;
   const int32_t filter_offset = -data->filter_zero_point;
   const int32_t output_offset = data->output_zero_point;
@@ -365,8 +474,8 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
   tflite::DepthwiseParams op_params;
   // Padding type is ignored, but still set.
   op_params.padding_type = PaddingType::kSame;
-  op_params.padding_values.width = data->padding.width;
-  op_params.padding_values.height = data->padding.height;
+  op_params.padding_values.width = padding.width;
+  op_params.padding_values.height = padding.height;
   op_params.stride_width = params->stride_width;
   op_params.stride_height = params->stride_height;
   op_params.dilation_width_factor = params->dilation_width_factor;
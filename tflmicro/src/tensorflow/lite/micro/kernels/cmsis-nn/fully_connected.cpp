@@ -42,6 +42,9 @@ struct OpData {
   int input_quantized_index;
   // Index to buffer for optimizations if applicable.
   int buffer_idx;
+  // The bias with the input offset folded in, or nullptr when the input offset
+  // is applied in Eval.
+  int32_t* folded_bias;
 
   // Cached tensor zero point values for quantized operations.
   int32_t input_zero_point;
@@ -68,6 +71,7 @@ TfLiteStatus CalculateOpData(TfLiteContext* context,
   TfLiteStatus status = kTfLiteOk;
   // Set buffer index to a reset value
   data->buffer_idx = -1;
+  data->folded_bias = nullptr;
   if (data_type != kTfLiteFloat32) {
     double real_multiplier = 0.0;
     TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipler(
@@ -130,6 +134,36 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     } else {
       data->buffer_idx = -1;
     }
+
+#if defined(ARM_NN_M0PLUS)
+    // With constant weights, the input offset's contribution to each output,
+    // input_offset * sum(filter + filter_offset), is known ahead of time. It is
+    // added to the bias once here, which leaves the M0+ inner loop without the
+    // offset addition. The int32 sums wrap the same way either way, so results
+    // are bit-exact.
+    if (IsConstantTensor(filter) && IsConstantTensor(bias)) {
+      const int output_depth = filter_dims.c;
+      const int accum_depth = filter_dims.n;
+      data->folded_bias =
+          static_cast<int32_t*>(context->AllocatePersistentBuffer(
+              context, output_depth * sizeof(int32_t)));
+      TF_LITE_ENSURE(context, data->folded_bias != nullptr);
+
+      const int8_t* filter_data = GetTensorData<int8_t>(filter);
+      const int32_t* bias_data = GetTensorData<int32_t>(bias);
+      const int32_t input_offset = -data->input_zero_point;
+      const int32_t filter_offset = -data->filter_zero_point;
+      for (int out_c = 0; out_c < output_depth; ++out_c) {
+        uint32_t filter_sum = 0;
+        for (int d = 0; d < accum_depth; ++d) {
+          filter_sum += filter_data[out_c * accum_depth + d] + filter_offset;
+        }
+        data->folded_bias[out_c] = static_cast<int32_t>(
+            static_cast<uint32_t>(bias_data[out_c]) +
+            static_cast<uint32_t>(input_offset) * filter_sum);
+      }
+    }
+#endif
   }
   return kTfLiteOk;
 }
@@ -152,8 +186,13 @@ TfLiteStatus EvalQuantizedInt8(TfLiteContext* context, TfLiteNode* node,
     const int accum_depth = filter_shape.Dims(filter_dim_count - 1);
     const RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
 
+    const int32_t* bias_data = tflite::micro::GetTensorData<int32_t>(bias);
     cmsis_nn_fc_params fc_params;
     fc_params.input_offset = -data.input_zero_point;
+    if (data.folded_bias != nullptr) {
+      bias_data = data.folded_bias;
+      fc_params.input_offset = 0;
+    }
     fc_params.output_offset = data.output_zero_point;
     fc_params.filter_offset = -data.filter_zero_point;
     fc_params.activation.min = data.output_activation_min;
@@ -202,7 +241,7 @@ TfLiteStatus EvalQuantizedInt8(TfLiteContext* context, TfLiteNode* node,
             &ctx, &fc_params, &quant_params, &input_dims,
             tflite::micro::GetTensorData<int8_t>(input), &filter_dims,
             tflite::micro::GetTensorData<int8_t>(filter), &bias_dims,
-            tflite::micro::GetTensorData<int32_t>(bias), &output_dims,
+            bias_data, &output_dims,
             tflite::micro::GetTensorData<int8_t>(output)),
         ARM_MATH_SUCCESS);
   } else {
@@ -74,6 +74,8 @@ TfLiteStatus CalculateOpData(TfLiteContext* context,
 void AverageEvalFloat(const TfLiteContext* context, const TfLiteNode* node,
                       const TfLitePoolParams* params, const OpData& data,
                       const TfLiteEvalTensor* input, TfLiteEvalTensor* output) {
+  const TfLitePaddingValues& padding =
+      tflite::micro::EvalPadding(context, data.padding);
   float activation_min, activation_max;
   CalculateActivationRange(params->activation, &activation_min,
                            &activation_max);
@@ -83,8 +85,8 @@ void AverageEvalFloat(const TfLiteContext* context, const TfLiteNode* node,
   op_params.stride_width = params->stride_width;
   op_params.filter_height = params->filter_height;
   op_params.filter_width = params->filter_width;
-  op_params.padding_values.height = data.padding.height;
-  op_params.padding_values.width = data.padding.width;
+  op_params.padding_values.height = padding.height;
+  op_params.padding_values.width = padding.width;
   op_params.float_activation_min = activation_min;
   op_params.float_activation_max = activation_max;
   reference_ops::AveragePool(op_params, tflite::micro::GetTensorShape(input),
@@ -97,6 +99,8 @@ void AverageEvalQuantized(TfLiteContext* context, const TfLiteNode* node,
                           const TfLitePoolParams* params, const OpData& data,
                           const TfLiteEvalTensor* input,
                           TfLiteEvalTensor* output) {
+  const TfLitePaddingValues& padding =
+      tflite::micro::EvalPadding(context, data.padding);
   TFLITE_DCHECK(input->type == kTfLiteUInt8 || input->type == kTfLiteInt8);
 
   if (input->type == kTfLiteUInt8) {
@@ -105,8 +109,8 @@ void AverageEvalQuantized(TfLiteContext* context, const TfLiteNode* node,
     op_params.stride_width = params->stride_width;
     op_params.filter_height = params->filter_height;
     op_params.filter_width = params->filter_width;
-    op_params.padding_values.height = data.padding.height;
-    op_params.padding_values.width = data.padding.width;
+    op_params.padding_values.height = padding.height;
+    op_params.padding_values.width = padding.width;
     op_params.quantized_activation_min = data.activation_min;
     op_params.quantized_activation_max = data.activation_max;
 
@@ -138,8 +142,8 @@ void AverageEvalQuantized(TfLiteContext* context, const TfLiteNode* node,
     cmsis_nn_pool_params pool_params;
     pool_params.stride.h = params->stride_height;
     pool_params.stride.w = params->stride_width;
-    pool_params.padding.h = data.padding.height;
-    pool_params.padding.w = data.padding.width;
+    pool_params.padding.h = padding.height;
+    pool_params.padding.w = padding.width;
     pool_params.activation.min = data.activation_min;
     pool_params.activation.max = data.activation_max;
 
@@ -168,6 +172,8 @@ void AverageEvalQuantized(TfLiteContext* context, const TfLiteNode* node,
 void MaxEvalFloat(TfLiteContext* context, TfLiteNode* node,
                   TfLitePoolParams* params, const OpData& data,
                   const TfLiteEvalTensor* input, TfLiteEvalTensor* output) {
+  const TfLitePaddingValues& padding =
+      tflite::micro::EvalPadding(context, data.padding);
   float activation_min, activation_max;
   CalculateActivationRange(params->activation, &activation_min,
                            &activation_max);
@@ -176,8 +182,8 @@ void MaxEvalFloat(TfLiteContext* context, TfLiteNode* node,
   op_params.stride_width = params->stride_width;
   op_params.filter_height = params->filter_height;
   op_params.filter_width = params->filter_width;
-  op_params.padding_values.height = data.padding.height;
-  op_params.padding_values.width = data.padding.width;
+  op_params.padding_values.height = padding.height;
+  op_params.padding_values.width = padding.width;
   op_params.float_activation_min = activation_min;
   op_params.float_activation_max = activation_max;
   reference_ops::MaxPool(op_params, tflite::micro::GetTensorShape(input),
@@ -190,13 +196,15 @@ void MaxEvalQuantizedUInt8(TfLiteContext* context, TfLiteNode* node,
                            TfLitePoolParams* params, const OpData& data,
                            const TfLiteEvalTensor* input,
                            TfLiteEvalTensor* output) {
+  const TfLitePaddingValues& padding =
+      tflite::micro::EvalPadding(context, data.padding);
   tflite::PoolParams op_params;
   op_params.stride_height = params->stride_height;
   op_params.stride_width = params->stride_width;
   op_params.filter_height = params->filter_height;
   op_params.filter_width = params->filter_width;
-  op_params.padding_values.height = data.padding.height;
-  op_params.padding_values.width = data.padding.width;
+  op_params.padding_values.height = padding.height;
+  op_params.padding_values.width = padding.width;
   op_params.quantized_activation_min = data.activation_min;
   op_params.quantized_activation_max = data.activation_max;
   reference_ops::MaxPool(op_params, tflite::micro::GetTensorShape(input),
@@ -209,6 +217,8 @@ TfLiteStatus MaxEvalInt8(TfLiteContext* context, const TfLiteNode* node,
                          const TfLitePoolParams* params, const OpData& data,
                          const TfLiteEvalTensor* input,
                          TfLiteEvalTensor* output) {
+  const TfLitePaddingValues& padding =
+      tflite::micro::EvalPadding(context, data.padding);
   RuntimeShape input_shape = tflite::micro::GetTensorShape(input);
   RuntimeShape output_shape = tflite::micro::GetTensorShape(output);
   const int depth = MatchingDim(input_shape, 3, output_shape, 3);
@@ -228,8 +238,8 @@ TfLiteStatus MaxEvalInt8(TfLiteContext* context, const TfLiteNode* node,
   cmsis_nn_pool_params pool_params;
   pool_params.stride.h = params->stride_height;
   pool_params.stride.w = params->stride_width;
-  pool_params.padding.h = data.padding.height;
-  pool_params.padding.w = data.padding.width;
+  pool_params.padding.h = padding.height;
+  pool_params.padding.w = padding.width;
   pool_params.activation.min = data.activation_min;
   pool_params.activation.max = data.activation_max;
 
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_utils.h"
 
 namespace tflite {
 namespace ops {
@@ -83,8 +84,40 @@ inline void GetAllInputTensorData(const TfLiteContext* context,
   }
 }
 
+// Concatenates along an axis with only 1s before it in the output, where
+// every input is one block of the output. Inputs the allocator planned inside
+// the output are in place already, the others are copied. Returns false for
+// other axes.
+template <typename data_type>
+bool EvalContiguous(TfLiteContext* context, TfLiteNode* node, int axis) {
+  TfLiteEvalTensor* output =
+      tflite::micro::GetEvalOutput(context, node, kOutputTensor);
+  for (int i = 0; i < axis; ++i) {
+    if (output->dims->data[i] != 1) {
+      return false;
+    }
+  }
+  data_type* output_ptr = tflite::micro::GetTensorData<data_type>(output);
+  for (int i = 0; i < node->inputs->size; ++i) {
+    const TfLiteEvalTensor* t = tflite::micro::GetEvalInput(context, node, i);
+    const data_type* input_ptr = tflite::micro::GetTensorData<data_type>(t);
+    const int size = ElementCount(*t->dims);
+    if (input_ptr != output_ptr) {
+      for (int j = 0; j < size; ++j) output_ptr[j] = input_ptr[j];
+    }
+    output_ptr += size;
+  }
+  return true;
+}
+
 template <typename data_type>
 void EvalUnquantized(TfLiteContext* context, TfLiteNode* node) {
+  TFLITE_DCHECK(node->user_data != nullptr);
+  const OpData* data = static_cast<const OpData*>(node->user_data);
+  if (EvalContiguous<data_type>(context, node, data->params.axis)) {
+    return;
+  }
+
   // Collect the shapes and data pointer of input tensors
   RuntimeShape inputs_shape[kMaxInputNum];
   const RuntimeShape* inputs_shape_ptr[kMaxInputNum];
@@ -96,9 +129,6 @@ void EvalUnquantized(TfLiteContext* context, TfLiteNode* node) {
   TfLiteEvalTensor* output =
       tflite::micro::GetEvalOutput(context, node, kOutputTensor);
 
-  TFLITE_DCHECK(node->user_data != nullptr);
-  const OpData* data = static_cast<const OpData*>(node->user_data);
-
   reference_ops::Concatenation(data->params, inputs_shape_ptr, inputs_data,
                                tflite::micro::GetTensorShape(output),
                                tflite::micro::GetTensorData<data_type>(output));
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/simple_memory_allocator.h"
 
 namespace tflite {
@@ -71,7 +72,7 @@ class KernelRunner {
   TfLiteTensor* tensors_ = nullptr;
   ErrorReporter* error_reporter_ = nullptr;
 
-  TfLiteContext context_ = {};
+  MicroContext context_;
   TfLiteNode node_ = {};
 
   int scratch_buffer_count_ = 0;
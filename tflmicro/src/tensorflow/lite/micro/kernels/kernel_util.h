@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <cstdint>
 
+#include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/types.h"
@@ -69,6 +70,31 @@ const RuntimeShape GetTensorShape(const TfLiteEvalTensor* tensor);
 bool HaveSameShapes(const TfLiteEvalTensor* input1,
                     const TfLiteEvalTensor* input2);
 
+// The context MicroInterpreter and KernelRunner run kernels with: the TF Lite
+// context and the state of the micro runtime the kernels read beyond it.
+struct MicroContext : TfLiteContext {
+  MicroContext() : TfLiteContext(), patch_padding(nullptr) {}
+
+  // Set while a MicroInterpreter runs the first nodes of a model patch by
+  // patch (see MicroInterpreter::SetPatchPlan()): the padding of the current
+  // patch, which is not that of the whole tensors computed in Prepare. nullptr
+  // the rest of the time.
+  const TfLitePaddingValues* patch_padding;
+};
+
+// The padding of the patch running in context, nullptr if none is.
+inline const TfLitePaddingValues* PatchPadding(const TfLiteContext* context) {
+  return static_cast<const MicroContext*>(context)->patch_padding;
+}
+
+// The padding for a kernel to run with, the prepared one unless a patch is
+// running.
+inline const TfLitePaddingValues& EvalPadding(
+    const TfLiteContext* context, const TfLitePaddingValues& prepared) {
+  const TfLitePaddingValues* patch = PatchPadding(context);
+  return patch != nullptr ? *patch : prepared;
+}
+
 }  // namespace micro
 }  // namespace tflite
 
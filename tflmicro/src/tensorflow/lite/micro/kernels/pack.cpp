@@ -63,7 +63,11 @@ TfLiteStatus PackImpl(TfLiteContext* context, TfLiteNode* node,
       const T* input_ptr = input_data + copy_size * k;
       int loc = k * values_count * copy_size + i * copy_size;
       T* output_ptr = output_data + loc;
-      for (int j = 0; j < copy_size; ++j) output_ptr[j] = input_ptr[j];
+      // Already in place when the allocator planned the input as a slice
+      // of the output.
+      if (output_ptr != input_ptr) {
+        for (int j = 0; j < copy_size; ++j) output_ptr[j] = input_ptr[j];
+      }
     }
   }
 
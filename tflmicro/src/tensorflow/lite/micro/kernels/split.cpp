@@ -59,7 +59,11 @@ TfLiteStatus SplitImpl(TfLiteContext* context, TfLiteNode* node,
       T* output_data = tflite::micro::GetTensorData<T>(t);
       const int copy_size = output_dims->data[axis] * base_inner_size;
       T* output_ptr = output_data + k * copy_size;
-      for (int j = 0; j < copy_size; ++j) output_ptr[j] = input_ptr[j];
+      // Already in place when the allocator planned the output as a slice
+      // of the input.
+      if (output_ptr != input_ptr) {
+        for (int j = 0; j < copy_size; ++j) output_ptr[j] = input_ptr[j];
+      }
       input_ptr += copy_size;
     }
   }
@@ -66,7 +66,11 @@ TfLiteStatus UnpackImpl(TfLiteContext* context, TfLiteNode* node,
       T* output_ptr = output_data + copy_size * k;
       int loc = k * output_count * copy_size + i * copy_size;
       const T* input_ptr = input_data + loc;
-      for (int j = 0; j < copy_size; ++j) output_ptr[j] = input_ptr[j];
+      // Already in place when the allocator planned the output as a slice
+      // of the input.
+      if (output_ptr != input_ptr) {
+        for (int j = 0; j < copy_size; ++j) output_ptr[j] = input_ptr[j];
+      }
     }
   }
 
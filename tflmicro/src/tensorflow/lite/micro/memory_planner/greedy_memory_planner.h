@@ -21,8 +21,6 @@ limitations under the License.
 
 namespace tflite {
 
-constexpr int kOnlinePlannedBuffer = -1;
-
 // A memory planner that uses a greedy algorithm to arrange buffers in memory
 // to minimize the overall arena size needed.
 //
@@ -0,0 +1,250 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/memory_planner/interval_memory_planner.h"
+
+#include <algorithm>
+
+namespace tflite {
+
+IntervalMemoryPlanner::IntervalMemoryPlanner(unsigned char* scratch_buffer,
+                                             int scratch_buffer_size)
+    : buffer_count_(0), need_to_calculate_offsets_(true) {
+  // Allocate the arrays we need within the scratch buffer arena.
+  max_buffer_count_ = scratch_buffer_size / per_buffer_size();
+
+  unsigned char* next_free = scratch_buffer;
+  requirements_ = reinterpret_cast<BufferRequirements*>(next_free);
+  next_free += sizeof(BufferRequirements) * max_buffer_count_;
+
+  active_extents_ = reinterpret_cast<Extent*>(next_free);
+  next_free += sizeof(Extent) * max_buffer_count_;
+
+  placement_order_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  placement_rank_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  ids_by_first_use_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  subtree_last_use_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+
+  buffer_offsets_ = reinterpret_cast<int*>(next_free);
+}
+
+IntervalMemoryPlanner::~IntervalMemoryPlanner() {
+  // We don't own the scratch buffer, so don't deallocate anything.
+}
+
+TfLiteStatus IntervalMemoryPlanner::AddBuffer(
+    tflite::ErrorReporter* error_reporter, int size, int first_time_used,
+    int last_time_used) {
+  if (buffer_count_ >= max_buffer_count_) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Too many buffers (max is %d)",
+                         max_buffer_count_);
+    return kTfLiteError;
+  }
+  BufferRequirements* current = &requirements_[buffer_count_];
+  current->size = size;
+  current->first_time_used = first_time_used;
+  current->last_time_used = last_time_used;
+  current->offline_offset = kOnlinePlannedBuffer;
+  ++buffer_count_;
+  need_to_calculate_offsets_ = true;
+  return kTfLiteOk;
+}
+
+TfLiteStatus IntervalMemoryPlanner::AddBuffer(
+    tflite::ErrorReporter* error_reporter, int size, int first_time_used,
+    int last_time_used, int offline_offset) {
+  BufferRequirements* current = &requirements_[buffer_count_];
+  if (AddBuffer(error_reporter, size, first_time_used, last_time_used) !=
+      kTfLiteOk) {
+    return kTfLiteError;
+  }
+  current->offline_offset = offline_offset;
+  return kTfLiteOk;
+}
+
+int IntervalMemoryPlanner::BuildSubtree(int begin, int end) {
+  if (begin >= end) {
+    return -1;
+  }
+  const int root = begin + (end - begin) / 2;
+  const int left = BuildSubtree(begin, root);
+  const int right = BuildSubtree(root + 1, end);
+  const int last_used =
+      requirements_[ids_by_first_use_[root]].last_time_used;
+  subtree_last_use_[root] = std::max(last_used, std::max(left, right));
+  return subtree_last_use_[root];
+}
+
+void IntervalMemoryPlanner::CollectActive(int begin, int end,
+                                          int first_time_used,
+                                          int last_time_used, int rank,
+                                          int* count) {
+  while (begin < end) {
+    const int root = begin + (end - begin) / 2;
+    // Nothing in this subtree is still in use when the range starts.
+    if (subtree_last_use_[root] < first_time_used) {
+      return;
+    }
+    CollectActive(begin, root, first_time_used, last_time_used, rank, count);
+    const int id = ids_by_first_use_[root];
+    const BufferRequirements* requirements = &requirements_[id];
+    // Neither this buffer nor any on its right is used before the range
+    // ends.
+    if (requirements->first_time_used > last_time_used) {
+      return;
+    }
+    if (requirements->last_time_used >= first_time_used &&
+        placement_rank_[id] < rank) {
+      Extent* extent = &active_extents_[(*count)++];
+      extent->offset = buffer_offsets_[id];
+      extent->end = buffer_offsets_[id] + requirements->size;
+    }
+    begin = root + 1;
+  }
+}
+
+void IntervalMemoryPlanner::CalculateOffsetsIfNeeded() {
+  if (!need_to_calculate_offsets_ || (buffer_count_ == 0)) {
+    return;
+  }
+  need_to_calculate_offsets_ = false;
+
+  // The order GreedyMemoryPlanner places buffers in: the offline planned
+  // ones as they were added, then the others from the largest down, and of
+  // the same size the last added first.
+  const BufferRequirements* requirements = requirements_;
+  int offline_count = 0;
+  for (int i = 0; i < buffer_count_; ++i) {
+    placement_order_[i] = i;
+    ids_by_first_use_[i] = i;
+    if (requirements_[i].offline_offset != kOnlinePlannedBuffer) {
+      ++offline_count;
+    }
+  }
+  std::sort(placement_order_, placement_order_ + buffer_count_,
+            [requirements](int a, int b) {
+              const bool a_offline =
+                  requirements[a].offline_offset != kOnlinePlannedBuffer;
+              const bool b_offline =
+                  requirements[b].offline_offset != kOnlinePlannedBuffer;
+              if (a_offline || b_offline) {
+                return a_offline && b_offline ? a < b : a_offline;
+              }
+              if (requirements[a].size != requirements[b].size) {
+                return requirements[a].size > requirements[b].size;
+              }
+              return a > b;
+            });
+  for (int i = 0; i < buffer_count_; ++i) {
+    placement_rank_[placement_order_[i]] = i;
+  }
+
+  std::sort(ids_by_first_use_, ids_by_first_use_ + buffer_count_,
+            [requirements](int a, int b) {
+              return requirements[a].first_time_used <
+                     requirements[b].first_time_used;
+            });
+  BuildSubtree(0, buffer_count_);
+
+  for (int i = 0; i < buffer_count_; ++i) {
+    const int buffer_id = placement_order_[i];
+    const BufferRequirements* wanted = &requirements_[buffer_id];
+    if (i < offline_count) {
+      // Offline planned offsets are to be considered constant.
+      buffer_offsets_[buffer_id] = wanted->offline_offset;
+      continue;
+    }
+    int active_count = 0;
+    CollectActive(0, buffer_count_, wanted->first_time_used,
+                  wanted->last_time_used, i, &active_count);
+    std::sort(active_extents_, active_extents_ + active_count,
+              [](const Extent& a, const Extent& b) {
+                return a.offset < b.offset;
+              });
+    // The first gap big enough, or the end of the last active buffer.
+    int candidate_offset = 0;
+    for (int n = 0; n < active_count; ++n) {
+      if (active_extents_[n].offset - candidate_offset >= wanted->size) {
+        break;
+      }
+      candidate_offset = std::max(candidate_offset, active_extents_[n].end);
+    }
+    buffer_offsets_[buffer_id] = candidate_offset;
+  }
+}
+
+size_t IntervalMemoryPlanner::GetMaximumMemorySize() {
+  CalculateOffsetsIfNeeded();
+  size_t max_size = 0;
+  for (int i = 0; i < buffer_count_; ++i) {
+    const size_t current_size = buffer_offsets_[i] + requirements_[i].size;
+    if (current_size > max_size) {
+      max_size = current_size;
+    }
+  }
+  return max_size;
+}
+
+int IntervalMemoryPlanner::GetBufferCount() { return buffer_count_; }
+
+TfLiteStatus IntervalMemoryPlanner::GetOffsetForBuffer(
+    tflite::ErrorReporter* error_reporter, int buffer_index, int* offset) {
+  CalculateOffsetsIfNeeded();
+  if ((buffer_index < 0) || (buffer_index >= buffer_count_)) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "buffer index %d is outside range 0 to %d",
+                         buffer_index, buffer_count_);
+    return kTfLiteError;
+  }
+  *offset = buffer_offsets_[buffer_index];
+  return kTfLiteOk;
+}
+
+bool IntervalMemoryPlanner::DoAnyBuffersOverlap(
+    ErrorReporter* error_reporter) {
+  CalculateOffsetsIfNeeded();
+  bool were_overlaps_found = false;
+  for (int i = 0; i < buffer_count_; ++i) {
+    const BufferRequirements* a_requirements = &requirements_[i];
+    const int a_start_offset = buffer_offsets_[i];
+    const int a_end_offset = a_start_offset + a_requirements->size;
+    // Every buffer active at the same time, each pair looked at once.
+    int active_count = 0;
+    CollectActive(0, buffer_count_, a_requirements->first_time_used,
+                  a_requirements->last_time_used, placement_rank_[i],
+                  &active_count);
+    for (int n = 0; n < active_count; ++n) {
+      if (active_extents_[n].end <= a_start_offset ||
+          a_end_offset <= active_extents_[n].offset) {
+        continue;
+      }
+      were_overlaps_found = true;
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Overlap: buffer %d at %d-%d overlaps one at %d-%d",
+                           i, a_start_offset, a_end_offset,
+                           active_extents_[n].offset, active_extents_[n].end);
+    }
+  }
+  return were_overlaps_found;
+}
+
+}  // namespace tflite
@@ -0,0 +1,139 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_INTERVAL_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_INTERVAL_MEMORY_PLANNER_H_
+
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/memory_planner/memory_planner.h"
+
+namespace tflite {
+
+// A memory planner that makes the same plan as GreedyMemoryPlanner, buffer
+// for buffer, in O(n log n) for the usual graphs instead of O(n^2).
+//
+// The buffers are placed in the same order: offline planned buffers first,
+// then the others by descending size. Each goes into the first gap between
+// the already placed buffers that are active at the same time, or after
+// them. Where GreedyMemoryPlanner sorts with a bubble sort and walks every
+// placed buffer to find the simultaneously active ones, this planner sorts
+// with std::sort and looks them up in an interval tree over the lifetimes:
+// the buffers sorted by first use, as an implicit balanced tree keeping the
+// latest last use of every subtree. Only the k buffers active at the same
+// time are visited, in O(k log n), and sorted by offset to find the gap.
+// Graphs where every buffer is active at once still take O(n^2 log n).
+class IntervalMemoryPlanner : public MemoryPlanner {
+ public:
+  // As for GreedyMemoryPlanner, the scratch buffer holds the working arrays
+  // and has to outlive the planner. Each buffer requires per_buffer_size()
+  // bytes of scratch.
+  IntervalMemoryPlanner(unsigned char* scratch_buffer, int scratch_buffer_size);
+  ~IntervalMemoryPlanner() override;
+
+  // Record details of a buffer we want to place.
+  TfLiteStatus AddBuffer(ErrorReporter* error_reporter, int size,
+                         int first_time_used, int last_time_used) override;
+
+  // Record details of an offline planned buffer offset we want to place.
+  // offline_offset is the buffer offset from the start of the arena.
+  TfLiteStatus AddBuffer(ErrorReporter* error_reporter, int size,
+                         int first_time_used, int last_time_used,
+                         int offline_offset);
+
+  // Returns the high-water mark of used memory. This is the minimum size of a
+  // memory arena you'd need to allocate to hold these buffers.
+  size_t GetMaximumMemorySize() override;
+
+  // How many buffers have been recorded.
+  int GetBufferCount() override;
+
+  // Where a given buffer should be placed in the memory arena.
+  TfLiteStatus GetOffsetForBuffer(ErrorReporter* error_reporter,
+                                  int buffer_index, int* offset) override;
+
+  // Debug method to check whether any buffer allocations are overlapping.
+  bool DoAnyBuffersOverlap(ErrorReporter* error_reporter);
+
+  // A placed buffer active at the same time as the one being placed.
+  struct Extent {
+    int offset;
+    int end;
+  };
+
+  // Number of bytes required in order to plan a buffer.
+  static size_t per_buffer_size() {
+    const int per_buffer_size =
+        sizeof(BufferRequirements) +  // requirements_
+        sizeof(int) +                 // placement_order_
+        sizeof(int) +                 // placement_rank_
+        sizeof(int) +                 // ids_by_first_use_
+        sizeof(int) +                 // subtree_last_use_
+        sizeof(Extent) +              // active_extents_
+        sizeof(int);                  // buffer_offsets_
+    return per_buffer_size;
+  }
+
+ private:
+  // Builds the interval tree over ids_by_first_use_[begin, end), returning
+  // the latest last use in it.
+  int BuildSubtree(int begin, int end);
+
+  // Appends to active_extents_ every buffer in ids_by_first_use_[begin, end)
+  // placed before placement rank `rank` and active at some point of the
+  // time range.
+  void CollectActive(int begin, int end, int first_time_used,
+                     int last_time_used, int rank, int* count);
+
+  // If there isn't an up to date plan, calculate a new one.
+  void CalculateOffsetsIfNeeded();
+
+  // How many buffers we can plan for, based on the scratch size.
+  int max_buffer_count_;
+
+  // The number of buffers added so far.
+  int buffer_count_;
+
+  // Records the client-provided information about each buffer.
+  struct BufferRequirements {
+    int size;
+    int offline_offset;
+    int first_time_used;
+    int last_time_used;
+  };
+
+  BufferRequirements* requirements_;
+  // Buffer ids in the order they are placed, and each buffer's position in
+  // that order.
+  int* placement_order_;
+  int* placement_rank_;
+  // Buffer ids by first use, and for the subtree rooted at each position the
+  // latest last use.
+  int* ids_by_first_use_;
+  int* subtree_last_use_;
+  // Working array of the buffers found active during one placement.
+  Extent* active_extents_;
+
+  // Stores the outcome of the plan, the location of each buffer in the arena.
+  int* buffer_offsets_;
+
+  // Whether buffers have been added since the last plan was calculated.
+  bool need_to_calculate_offsets_;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MEMORY_PLANNER_INTERVAL_MEMORY_PLANNER_H_
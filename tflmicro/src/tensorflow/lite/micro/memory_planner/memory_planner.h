@@ -21,6 +21,9 @@ limitations under the License.
 
 namespace tflite {
 
+// The offline offset of a buffer the planner places itself.
+constexpr int kOnlinePlannedBuffer = -1;
+
 // Interface class for planning the layout of memory buffers during the
 // execution of a graph.
 // It's designed to be used by a client that iterates in any order through the
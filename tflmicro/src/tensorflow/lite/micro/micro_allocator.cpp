@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/micro/micro_allocator.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 
@@ -27,7 +28,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/micro/compatibility.h"
 #include "tensorflow/lite/micro/memory_helpers.h"
-#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/memory_planner/interval_memory_planner.h"
 #include "tensorflow/lite/micro/memory_planner/memory_planner.h"
 #include "tensorflow/lite/micro/micro_op_resolver.h"
 #include "tensorflow/lite/micro/simple_memory_allocator.h"
@@ -54,6 +55,24 @@ struct AllocationInfo {
   int last_used;
   int32_t offline_offset;
   bool needs_allocating;
+  // Which of the separately planned regions of the head the buffer goes to.
+  // Always kSharedRegion unless the model runs pipelined.
+  uint8_t region;
+  // The tensor whose buffer this one is a part of, and the byte offset into
+  // it, or -1 for a buffer of its own. Only buffers of their own are planned.
+  int alias_of;
+  size_t alias_offset;
+};
+
+// Regions of the head used for pipelined execution. Every region is planned on
+// its own and placed after the previous one, so buffers in different regions
+// never overlap. kSharedRegion is also the only region without pipelining.
+enum PlanRegion {
+  kSharedRegion = 0,
+  kFirstStageRegion = 0,
+  kSecondStageRegion = 1,
+  kBoundaryRegion = 2,
+  kPlanRegionCount = 3,
 };
 
 // We align tensor buffers to 16-byte boundaries, since this is a common
@@ -148,6 +167,23 @@ TfLiteStatus CheckOfflinePlannedOffsets(const Model* model,
 }
 #endif
 
+// Whether every slice along `axis` of a tensor of shape `dims` is one block of
+// memory, which is when all the dimensions before the axis are 1.
+bool SlicesAreContiguous(const TfLiteIntArray* dims, int axis) {
+  if (axis < 0) {
+    axis += dims->size;
+  }
+  if (axis < 0 || axis >= dims->size) {
+    return false;
+  }
+  for (int i = 0; i < axis; ++i) {
+    if (dims->data[i] != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // A helper class to construct AllocationInfo array. This array contains the
 // lifetime of tensors / scratch_buffer and will be used to calculate the memory
 // plan. Methods need to be called in order from `Init`, `Add*`, to `Finish`.
@@ -172,15 +208,49 @@ class AllocationInfoBuilder {
                           const int32_t* offline_offsets,
                           TfLiteEvalTensor* eval_tensors);
 
+  // Lets the outputs of the copy ops share the buffers of their inputs: a
+  // Reshape output its input, the inputs of Concatenation and Pack their slice
+  // of the output, and the outputs of Split, SplitV and Unpack their slice of
+  // the input. Must follow AddTensors, and isn't done for offline planned
+  // models: host/plan_offline.cpp writes the same sharing into their offsets.
+  TfLiteStatus AddAliases(const Model* model, const SubGraph* subgraph,
+                          const TfLiteEvalTensor* eval_tensors);
+
+  // Sets the buffers of the aliased tensors after the plan is committed.
+  void CommitAliases() const;
+
   // Add allocation information for the scratch buffers.
   TfLiteStatus AddScratchBuffers(
       internal::ScratchBufferRequest* scratch_buffer_requests,
       ScratchBufferHandle* scratch_buffer_handles);
 
+  // Assigns every buffer to a pipeline stage region. Buffers that live across
+  // the partition, and model outputs, go to the boundary region.
+  TfLiteStatus SplitForPipeline(const SubGraph* subgraph,
+                                int first_stage2_node);
+
+  // Takes the buffers of the tensors passed between the first nodes out of
+  // the plan and adds the two patch buffers after the scratch buffers, see
+  // PatchPlan. Must follow AddTensors, AddAliases and AddScratchBuffers.
+  void AddPatchBuffers(const SubGraph* subgraph, PatchPlan* patch_plan);
+
   // Returns a pointer to the built AllocationInfo array.
   const AllocationInfo* Finish() const { return info_; }
 
  private:
+  // Makes tensor `child` share the buffer of tensor `parent` from byte
+  // `offset` on, if both can. Returns whether it does.
+  bool Alias(const SubGraph* subgraph, int child, int parent, size_t offset);
+
+  // Whether any tensor sharing the buffer of `root` is in `tensors`.
+  bool GroupHasAny(const flatbuffers::Vector<int32_t>* tensors,
+                   int root) const;
+
+  int Root(int tensor_index) const {
+    return info_[tensor_index].alias_of == -1 ? tensor_index
+                                              : info_[tensor_index].alias_of;
+  }
+
   AllocationInfo* info_ = nullptr;
   size_t tensor_count_ = 0;
   size_t buffer_count_ = 0;
@@ -204,6 +274,9 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
     current->last_used = -1;
     current->needs_allocating = (eval_tensors[i].data.data == nullptr) &&
                                 (!subgraph->tensors()->Get(i)->is_variable());
+    current->region = kSharedRegion;
+    current->alias_of = -1;
+    current->alias_offset = 0;
     if (offline_offsets) {
       current->offline_offset = offline_offsets[i];
     } else {
@@ -277,7 +350,7 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
 // the model. The following encoding applies:
 //
 // |  Offset |                            Value                                |
-// |    0    | Offline allocation format version – set to 0                    |
+// |    0    | Offline allocation format version – set to 1                    |
 // |    1    | Subgraph index to which this allocation applies                 |
 // |    2    | Number offsets following: n                                     |
 // |    3    | Arena byte offset of tensor #0 or -1 to allocate at runtime     |
@@ -330,18 +403,244 @@ TfLiteStatus AllocationInfoBuilder::AddScratchBuffers(
     current->last_used = current_request->node_idx;
     current->offline_offset = kOnlinePlannedBuffer;
     current->needs_allocating = true;
+    current->region = kSharedRegion;
+    current->alias_of = -1;
+    current->alias_offset = 0;
+  }
+  return kTfLiteOk;
+}
+
+bool AllocationInfoBuilder::GroupHasAny(
+    const flatbuffers::Vector<int32_t>* tensors, int root) const {
+  for (size_t i = 0; i < tensors->size(); ++i) {
+    if (Root(tensors->Get(i)) == root) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool AllocationInfoBuilder::Alias(const SubGraph* subgraph, int child,
+                                  int parent, size_t offset) {
+  const AllocationInfo* child_info = &info_[child];
+  const AllocationInfo* parent_info = &info_[parent];
+  const bool child_planned =
+      child_info->needs_allocating || child_info->alias_of != -1;
+  const bool parent_planned =
+      parent_info->needs_allocating || parent_info->alias_of != -1;
+  if (!child_planned || !parent_planned) {
+    return false;
+  }
+  // The buffers the child already shares move along with it, so it has to
+  // span all of them. Otherwise they would cover other parts of the parent.
+  const int root = Root(child);
+  const int new_root = Root(parent);
+  AllocationInfo* moved = &info_[root];
+  AllocationInfo* target = &info_[new_root];
+  const size_t new_offset = parent_info->alias_offset + offset;
+  if (root == new_root || child_info->alias_offset != 0 ||
+      child_info->bytes != moved->bytes ||
+      new_offset % kBufferAlignment != 0 ||
+      new_offset + moved->bytes > target->bytes) {
+    return false;
+  }
+  if (moved->first_created == -1 || moved->last_used == -1 ||
+      target->first_created == -1 || target->last_used == -1) {
+    return false;
+  }
+  // A pipelined model has separate frame copies for the inputs and outputs.
+  if ((GroupHasAny(subgraph->inputs(), root) &&
+       GroupHasAny(subgraph->outputs(), new_root)) ||
+      (GroupHasAny(subgraph->outputs(), root) &&
+       GroupHasAny(subgraph->inputs(), new_root))) {
+    return false;
+  }
+
+  // The shared buffer is planned for as long as any of its tensors lives.
+  target->first_created = std::min(target->first_created, moved->first_created);
+  target->last_used = std::max(target->last_used, moved->last_used);
+  for (size_t i = 0; i < tensor_count_; ++i) {
+    if (info_[i].alias_of == root) {
+      info_[i].alias_of = new_root;
+      info_[i].alias_offset += new_offset;
+    }
+  }
+  moved->alias_of = new_root;
+  moved->alias_offset = new_offset;
+  moved->needs_allocating = false;
+  return true;
+}
+
+TfLiteStatus AllocationInfoBuilder::AddAliases(
+    const Model* model, const SubGraph* subgraph,
+    const TfLiteEvalTensor* eval_tensors) {
+  for (size_t i = 0; i < subgraph->operators()->size(); ++i) {
+    const auto* op = subgraph->operators()->Get(i);
+    const BuiltinOperator op_code =
+        GetBuiltinCode(model->operator_codes()->Get(op->opcode_index()));
+    const flatbuffers::Vector<int32_t>* inputs = op->inputs();
+    const flatbuffers::Vector<int32_t>* outputs = op->outputs();
+    switch (op_code) {
+      case BuiltinOperator_RESHAPE: {
+        Alias(subgraph, outputs->Get(0), inputs->Get(0), 0);
+        break;
+      }
+      case BuiltinOperator_CONCATENATION:
+      case BuiltinOperator_PACK: {
+        const TfLiteEvalTensor* output = &eval_tensors[outputs->Get(0)];
+        int axis = 0;
+        if (op_code == BuiltinOperator_CONCATENATION) {
+          const auto* options = op->builtin_options_as_ConcatenationOptions();
+          // uint8 inputs are rescaled to the output's quantization.
+          if (options == nullptr || output->type == kTfLiteUInt8 ||
+              options->fused_activation_function() !=
+                  ActivationFunctionType_NONE) {
+            break;
+          }
+          axis = options->axis();
+        } else {
+          const auto* options = op->builtin_options_as_PackOptions();
+          if (options == nullptr) {
+            break;
+          }
+          axis = options->axis();
+        }
+        if (!SlicesAreContiguous(output->dims, axis)) {
+          break;
+        }
+        size_t offset = 0;
+        for (size_t n = 0; n < inputs->size(); ++n) {
+          const int input = inputs->Get(n);
+          if (eval_tensors[input].type != output->type) {
+            break;
+          }
+          Alias(subgraph, input, outputs->Get(0), offset);
+          offset += info_[input].bytes;
+        }
+        break;
+      }
+      case BuiltinOperator_SPLIT:
+      case BuiltinOperator_SPLIT_V:
+      case BuiltinOperator_UNPACK: {
+        int input = inputs->Get(0);
+        int axis = 0;
+        if (op_code == BuiltinOperator_UNPACK) {
+          const auto* options = op->builtin_options_as_UnpackOptions();
+          if (options == nullptr) {
+            break;
+          }
+          axis = options->axis();
+        } else {
+          // The kernels only take a constant axis.
+          const int axis_tensor = op_code == BuiltinOperator_SPLIT
+                                      ? inputs->Get(0)
+                                      : inputs->Get(2);
+          input = op_code == BuiltinOperator_SPLIT ? inputs->Get(1)
+                                                   : inputs->Get(0);
+          if (eval_tensors[axis_tensor].data.i32 == nullptr) {
+            break;
+          }
+          axis = eval_tensors[axis_tensor].data.i32[0];
+        }
+        if (!SlicesAreContiguous(eval_tensors[input].dims, axis)) {
+          break;
+        }
+        size_t offset = 0;
+        for (size_t n = 0; n < outputs->size(); ++n) {
+          const int output = outputs->Get(n);
+          Alias(subgraph, output, input, offset);
+          offset += info_[output].bytes;
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return kTfLiteOk;
+}
+
+void AllocationInfoBuilder::CommitAliases() const {
+  for (size_t i = 0; i < tensor_count_; ++i) {
+    const AllocationInfo* current = &info_[i];
+    if (current->alias_of != -1) {
+      *current->output_ptr =
+          static_cast<uint8_t*>(*info_[current->alias_of].output_ptr) +
+          current->alias_offset;
+    }
+  }
+}
+
+void AllocationInfoBuilder::AddPatchBuffers(const SubGraph* subgraph,
+                                            PatchPlan* patch_plan) {
+  const int last_node = patch_plan->layer_count - 1;
+  for (int i = 0; i < last_node; ++i) {
+    const int tensor_index = subgraph->operators()->Get(i)->outputs()->Get(0);
+    info_[tensor_index].needs_allocating = false;
+  }
+  // Every patch reads from the first node's input and writes to the last
+  // node's output.
+  AllocationInfo* input =
+      &info_[Root(subgraph->operators()->Get(0)->inputs()->Get(0))];
+  AllocationInfo* output =
+      &info_[Root(subgraph->operators()->Get(last_node)->outputs()->Get(0))];
+  input->last_used = std::max(input->last_used, last_node);
+  output->first_created = 0;
+
+  for (int i = 0; i < 2; ++i) {
+    AllocationInfo* current = &info_[tensor_count_ + buffer_count_ + i];
+    current->output_ptr =
+        reinterpret_cast<void**>(&patch_plan->patch_buffers[i]);
+    current->bytes = patch_plan->patch_buffer_bytes[i];
+    current->first_created = 0;
+    current->last_used = last_node;
+    current->offline_offset = kOnlinePlannedBuffer;
+    current->needs_allocating = current->bytes > 0;
+    current->region = kSharedRegion;
+    current->alias_of = -1;
+    current->alias_offset = 0;
+    patch_plan->patch_buffers[i] = nullptr;
+  }
+}
+
+TfLiteStatus AllocationInfoBuilder::SplitForPipeline(const SubGraph* subgraph,
+                                                     int first_stage2_node) {
+  for (size_t i = 0; i < tensor_count_ + buffer_count_; ++i) {
+    AllocationInfo* current = &info_[i];
+    if (!current->needs_allocating) {
+      continue;
+    }
+    if (current->offline_offset != kOnlinePlannedBuffer) {
+      TF_LITE_REPORT_ERROR(reporter_,
+                           "Offline planned buffers can't be pipelined");
+      return kTfLiteError;
+    }
+    if (current->first_created >= first_stage2_node) {
+      current->region = kSecondStageRegion;
+    } else if (current->last_used < first_stage2_node) {
+      current->region = kFirstStageRegion;
+    } else {
+      current->region = kBoundaryRegion;
+    }
+  }
+  // Outputs are read by the application while the next frame is in flight.
+  for (size_t i = 0; i < subgraph->outputs()->size(); ++i) {
+    AllocationInfo* current = &info_[Root(subgraph->outputs()->Get(i))];
+    if (current->needs_allocating) {
+      current->region = kBoundaryRegion;
+    }
   }
   return kTfLiteOk;
 }
 
 TfLiteStatus CreatePlan(ErrorReporter* error_reporter,
-                        GreedyMemoryPlanner* planner,
+                        IntervalMemoryPlanner* planner,
                         const AllocationInfo* allocation_info,
-                        size_t allocation_info_size) {
+                        size_t allocation_info_size, int region) {
   // Add the tensors to our allocation plan.
   for (size_t i = 0; i < allocation_info_size; ++i) {
     const AllocationInfo* current = &allocation_info[i];
-    if (current->needs_allocating) {
+    if (current->needs_allocating && current->region == region) {
       size_t aligned_bytes_required =
           AlignSizeUp(current->bytes, kBufferAlignment);
       if (current->offline_offset == kOnlinePlannedBuffer) {
@@ -361,12 +660,12 @@ TfLiteStatus CreatePlan(ErrorReporter* error_reporter,
 TfLiteStatus CommitPlan(ErrorReporter* error_reporter, MemoryPlanner* planner,
                         uint8_t* starting_point,
                         const AllocationInfo* allocation_info,
-                        size_t allocation_info_size) {
+                        size_t allocation_info_size, int region) {
   // Figure out the actual memory addresses for each buffer, based on the plan.
   int planner_index = 0;
   for (size_t i = 0; i < allocation_info_size; ++i) {
     const AllocationInfo* current = &allocation_info[i];
-    if (current->needs_allocating) {
+    if (current->needs_allocating && current->region == region) {
       int offset = -1;
       TF_LITE_ENSURE_STATUS(
           planner->GetOffsetForBuffer(error_reporter, planner_index, &offset));
@@ -651,7 +950,8 @@ TfLiteStatus MicroAllocator::StartModelAllocation(
 
 TfLiteStatus MicroAllocator::FinishModelAllocation(
     const Model* model, TfLiteEvalTensor* eval_tensors,
-    ScratchBufferHandle** scratch_buffer_handles) {
+    ScratchBufferHandle** scratch_buffer_handles,
+    PipelinePlan* pipeline_plan, PatchPlan* patch_plan) {
   if (!model_is_allocating_) {
     TF_LITE_REPORT_ERROR(error_reporter_,
                          "MicroAllocator: Model allocation finished before "
@@ -665,7 +965,8 @@ TfLiteStatus MicroAllocator::FinishModelAllocation(
   TF_LITE_ENSURE_STATUS(AllocateScratchBufferHandles(
       scratch_buffer_handles, scratch_buffer_request_count_));
   TF_LITE_ENSURE_STATUS(CommitStaticMemoryPlan(model, subgraph, eval_tensors,
-                                               *scratch_buffer_handles));
+                                               *scratch_buffer_handles,
+                                               pipeline_plan, patch_plan));
   TF_LITE_ENSURE_STATUS(AllocateVariables(subgraph, eval_tensors));
 
   model_is_allocating_ = false;
@@ -750,6 +1051,24 @@ size_t MicroAllocator::used_bytes() const {
   return memory_allocator_->GetUsedBytes();
 }
 
+TfLiteStatus MicroAllocator::CheckHeadAvailable(const void* user) const {
+  if (head_owner_ != nullptr && head_owner_ != user) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "The head is in use by another model sharing the "
+                         "arena, which has a pipelined input in flight");
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+void MicroAllocator::HoldHead(const void* owner) { head_owner_ = owner; }
+
+void MicroAllocator::ReleaseHead(const void* owner) {
+  if (head_owner_ == owner) {
+    head_owner_ = nullptr;
+  }
+}
+
 TfLiteStatus MicroAllocator::AllocateNodeAndRegistrations(
     const Model* model, NodeAndRegistration** node_and_registrations) {
   TFLITE_DCHECK(node_and_registrations);
@@ -1022,13 +1341,16 @@ const SubGraph* MicroAllocator::GetSubGraphFromModel(const Model* model) {
 TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
     const Model* model, const SubGraph* subgraph,
     TfLiteEvalTensor* eval_tensors,
-    ScratchBufferHandle* scratch_buffer_handles) {
+    ScratchBufferHandle* scratch_buffer_handles,
+    PipelinePlan* pipeline_plan, PatchPlan* patch_plan) {
   size_t head_usage = 0;
   // Create static memory plan
   // 1. Calculate AllocationInfo to know the lifetime of each tensor/buffer.
-  // 2. Add them into the planner (such as the GreedyMemoryPlanner).
+  // 2. Add them into the planner (the IntervalMemoryPlanner, which makes the
+  //    same plan as the GreedyMemoryPlanner in less time).
   // 3. Static memory planning using the planner.
-  // 4. Set tensor/buffer pointers based on the offsets from the previous step.
+  // 4. Set tensor/buffer pointers based on the offsets from the previous step,
+  //    and those of the tensors sharing a buffer.
   //
   // Note that AllocationInfo is only needed for creating the plan. It will be
   // allocated from the temp section and cleaned up at the bottom of this
@@ -1036,6 +1358,9 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
 
   size_t allocation_info_count =
       subgraph->tensors()->size() + scratch_buffer_request_count_;
+  if (patch_plan != nullptr) {
+    allocation_info_count += 2;
+  }
   size_t bytes = sizeof(AllocationInfo) * allocation_info_count;
 
   // Allocate an array of AllocationInfo structs from the temp section. This
@@ -1060,12 +1385,25 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
       builder.GetOfflinePlannedOffsets(model, &offline_planner_offsets));
   TF_LITE_ENSURE_STATUS(
       builder.AddTensors(subgraph, offline_planner_offsets, eval_tensors));
+  if (offline_planner_offsets == nullptr) {
+    TF_LITE_ENSURE_STATUS(builder.AddAliases(model, subgraph, eval_tensors));
+  }
 
   internal::ScratchBufferRequest* scratch_buffer_requests =
       GetScratchBufferRequests();
 
   TF_LITE_ENSURE_STATUS(builder.AddScratchBuffers(scratch_buffer_requests,
                                                   scratch_buffer_handles));
+  if (patch_plan != nullptr) {
+    builder.AddPatchBuffers(subgraph, patch_plan);
+  }
+
+  int region_count = 1;
+  if (pipeline_plan != nullptr) {
+    TF_LITE_ENSURE_STATUS(
+        builder.SplitForPipeline(subgraph, pipeline_plan->first_stage2_node));
+    region_count = kPlanRegionCount;
+  }
 
   // Remaining arena size that memory planner can use for calculating offsets.
   size_t remaining_arena_size =
@@ -1073,9 +1411,30 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
   uint8_t* planner_arena =
       memory_allocator_->AllocateTemp(remaining_arena_size, kBufferAlignment);
   TF_LITE_ENSURE(error_reporter_, planner_arena != nullptr);
-  GreedyMemoryPlanner planner(planner_arena, remaining_arena_size);
-  TF_LITE_ENSURE_STATUS(CreatePlan(error_reporter_, &planner, allocation_info,
-                                   allocation_info_count));
+
+  // Plan each region on its own and lay them out one after the other. The
+  // pointers are only written to the eval tensors and scratch buffer handles
+  // here, the head itself is not touched until the size check below passed.
+  uint8_t* head = memory_allocator_->GetHeadBuffer();
+  for (int region = 0; region < region_count; ++region) {
+    IntervalMemoryPlanner planner(planner_arena, remaining_arena_size);
+    TF_LITE_ENSURE_STATUS(CreatePlan(error_reporter_, &planner,
+                                     allocation_info, allocation_info_count,
+                                     region));
+    TF_LITE_ENSURE_STATUS(CommitPlan(error_reporter_, &planner,
+                                     head + head_usage, allocation_info,
+                                     allocation_info_count, region));
+    size_t region_size =
+        AlignSizeUp(planner.GetMaximumMemorySize(), kBufferAlignment);
+    if (region == kBoundaryRegion) {
+      // The second copy, for the other frame in flight, directly follows.
+      pipeline_plan->boundary = head + head_usage;
+      pipeline_plan->boundary_bytes = region_size;
+      region_size *= 2;
+    }
+    head_usage += region_size;
+  }
+  builder.CommitAliases();
 
   // Reset all temp allocations used above:
   memory_allocator_->ResetTempAllocations();
@@ -1084,19 +1443,14 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(
       memory_allocator_->GetAvailableMemory(kBufferAlignment);
 
   // Make sure we have enough arena size.
-  if (planner.GetMaximumMemorySize() > actual_available_arena_size) {
+  if (head_usage > actual_available_arena_size) {
     TF_LITE_REPORT_ERROR(
         error_reporter_,
         "Arena size is too small for all buffers. Needed %u but only "
         "%u was available.",
-        planner.GetMaximumMemorySize(), actual_available_arena_size);
+        head_usage, actual_available_arena_size);
     return kTfLiteError;
   }
-  // Commit the plan.
-  TF_LITE_ENSURE_STATUS(CommitPlan(error_reporter_, &planner,
-                                   memory_allocator_->GetHeadBuffer(),
-                                   allocation_info, allocation_info_count));
-  head_usage = planner.GetMaximumMemorySize();
 
   // The head is used to store memory plans for one model at a time during the
   // model preparation stage, and is re-purposed to store scratch buffer handles
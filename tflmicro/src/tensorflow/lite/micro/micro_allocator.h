@@ -75,6 +75,31 @@ typedef struct {
   uint8_t* data;
 } ScratchBufferHandle;
 
+// Head layout for pipelined execution, where the nodes before
+// `first_stage2_node` and the nodes from it onwards run concurrently on
+// different frames. Buffers of either stage are planned apart, and buffers that
+// live across the partition (including model outputs) get two copies, one per
+// frame in flight.
+typedef struct {
+  int first_stage2_node;
+  // Set by the allocator: the first copy of the buffers that live across the
+  // partition. A buffer's second copy is boundary_bytes further on.
+  uint8_t* boundary;
+  size_t boundary_bytes;
+} PipelinePlan;
+
+// Head layout for running the first `layer_count` nodes patch by patch (see
+// MicroInterpreter::SetPatchPlan()). The tensors passed between those nodes
+// get no buffers of their own. Two patch buffers hold one patch of each
+// instead, used in turn, and the input of the first node and the output of
+// the last one live across all of them.
+typedef struct {
+  int layer_count;
+  size_t patch_buffer_bytes[2];
+  // Set by the allocator.
+  uint8_t* patch_buffers[2];
+} PatchPlan;
+
 // Allocator responsible for allocating memory for all intermediate tensors
 // necessary to invoke a model.
 //
@@ -134,9 +159,13 @@ class MicroAllocator {
   // passed into this class during StartModelAllocation(). Scratch buffer
   // handles are stored in the out-param `scratch_buffer_handles`. This value
   // will be used in `GetScratchBuffer` call to retrieve scratch buffers.
+  // With a `pipeline_plan` the head is planned for pipelined execution instead,
+  // see PipelinePlan, and with a `patch_plan` for patch-based execution, see
+  // PatchPlan.
   TfLiteStatus FinishModelAllocation(
       const Model* model, TfLiteEvalTensor* eval_tensors,
-      ScratchBufferHandle** scratch_buffer_handles);
+      ScratchBufferHandle** scratch_buffer_handles,
+      PipelinePlan* pipeline_plan = nullptr, PatchPlan* patch_plan = nullptr);
 
   // Allocates a TfLiteTensor struct and populates the returned value with
   // properties from the model flatbuffer. This struct is allocated from
@@ -171,18 +200,29 @@ class MicroAllocator {
   // This method only requests a buffer with a given size to be used after a
   // model has finished allocation via FinishModelAllocation(). All requested
   // buffers will be accessible by the out-param in that method.
-  TfLiteStatus RequestScratchBufferInArena(size_t bytes, int* buffer_idx);
+  virtual TfLiteStatus RequestScratchBufferInArena(size_t bytes,
+                                                   int* buffer_idx);
 
   // Finish allocating a specific NodeAndRegistration prepare block (kernel
   // entry for a model) with a given node ID. This call ensures that any scratch
   // buffer requests and temporary allocations are handled and ready for the
   // next node prepare block.
-  TfLiteStatus FinishPrepareNodeAllocations(int node_id);
+  virtual TfLiteStatus FinishPrepareNodeAllocations(int node_id);
 
   // Returns the arena usage in bytes, only available after
   // `FinishModelAllocation`. Otherwise, it will return 0.
   size_t used_bytes() const;
 
+  // Models allocated from the same allocator each keep their own tail, but
+  // share the head, which is as large as the largest of their plans. Only one
+  // of them can use it at a time: a pipelined model holds the head while it
+  // has an input in flight on the other core, and no other model may
+  // allocate or invoke until it releases it. CheckHeadAvailable() reports an
+  // error if an owner other than `user` holds the head.
+  TfLiteStatus CheckHeadAvailable(const void* user) const;
+  void HoldHead(const void* owner);
+  void ReleaseHead(const void* owner);
+
  protected:
   MicroAllocator(SimpleMemoryAllocator* memory_allocator,
                  ErrorReporter* error_reporter);
@@ -242,7 +282,8 @@ class MicroAllocator {
   virtual TfLiteStatus CommitStaticMemoryPlan(
       const Model* model, const SubGraph* subgraph,
       TfLiteEvalTensor* eval_tensors,
-      ScratchBufferHandle* scratch_buffer_handles);
+      ScratchBufferHandle* scratch_buffer_handles,
+      PipelinePlan* pipeline_plan, PatchPlan* patch_plan);
 
   // Allocates an array of ScratchBufferHandle structs in the tail section for a
   // given number of handles.
@@ -272,6 +313,9 @@ class MicroAllocator {
   // to ensure that multi-tenant allocations can share the head for buffers.
   size_t max_head_buffer_usage_ = 0;
 
+  // The model that holds the head, see HoldHead(), or nullptr.
+  const void* head_owner_ = nullptr;
+
   TF_LITE_REMOVE_VIRTUAL_DELETE
 };
 
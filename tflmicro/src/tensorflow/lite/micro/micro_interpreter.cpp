@@ -14,19 +14,28 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/micro/micro_interpreter.h"
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <new>
 
 #include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/tensor_utils.h"
+#include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/memory_helpers.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_op_resolver.h"
+#include "tensorflow/lite/micro/micro_pipeline.h"
 #include "tensorflow/lite/micro/micro_profiler.h"
+#include "tensorflow/lite/micro/micro_time.h"
 #include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/schema/schema_utils.h"
 
 namespace tflite {
 namespace {
@@ -41,6 +50,14 @@ const char* OpNameFromRegistration(const TfLiteRegistration* registration) {
 }
 #endif  // !defined(TF_LITE_STRIP_ERROR_STRINGS)
 
+// Copies `rows` rows of `row_bytes` between buffers of different row strides.
+void CopyRows(const uint8_t* from, size_t from_stride, uint8_t* to,
+              size_t to_stride, int rows, size_t row_bytes) {
+  for (int y = 0; y < rows; ++y) {
+    memcpy(to + y * to_stride, from + y * from_stride, row_bytes);
+  }
+}
+
 }  // namespace
 
 namespace internal {
@@ -82,6 +99,10 @@ void ContextHelper::ReportOpError(struct TfLiteContext* context,
 TfLiteTensor* ContextHelper::GetTensor(const struct TfLiteContext* context,
                                        int tensor_idx) {
   ContextHelper* helper = static_cast<ContextHelper*>(context->impl_);
+  if (helper->pipelined_ && !helper->holds_pipeline_lock_) {
+    PipelineLock();
+    helper->holds_pipeline_lock_ = true;
+  }
   return helper->allocator_->AllocateTempTfLiteTensor(
       helper->model_, helper->eval_tensors_, tensor_idx);
 }
@@ -101,8 +122,66 @@ void ContextHelper::SetScratchBufferHandles(
   scratch_buffer_handles_ = scratch_buffer_handles;
 }
 
+void ContextHelper::SetPipelined() { pipelined_ = true; }
+
+void ContextHelper::FinishPipelinedNode() {
+  if (holds_pipeline_lock_) {
+    allocator_->ResetTempAllocations();
+    holds_pipeline_lock_ = false;
+    PipelineUnlock();
+  }
+}
+
 }  // namespace internal
 
+// One half of the operators of a pipelined model. Each stage has its own
+// context and copy of the eval tensors, so that the tensors which are double
+// buffered can point at a different copy in either stage.
+struct MicroInterpreter::PipelineStage {
+  PipelineStage(ErrorReporter* error_reporter, MicroAllocator* allocator,
+                const Model* model)
+      : helper(error_reporter, allocator, model) {}
+
+  internal::ContextHelper helper;
+  micro::MicroContext context;
+  TfLiteEvalTensor* eval_tensors;
+  size_t first_node;
+  size_t end_node;
+  int32_t ticks;
+};
+
+struct MicroInterpreter::PipelineBuffer {
+  int tensor_index;
+  // The first copy, the second one is PipelinePlan::boundary_bytes further on.
+  uint8_t* data;
+};
+
+struct MicroInterpreter::PatchLayer {
+  int stride_height;
+  int stride_width;
+  int filter_height;
+  int filter_width;
+  // Of the whole tensors, as the kernel computed it in Prepare.
+  TfLitePaddingValues padding;
+  // Of the current patch, which is 0 unless it touches the top or left edge.
+  TfLitePaddingValues patch_padding;
+};
+
+struct MicroInterpreter::PatchTensor {
+  int tensor_index;
+  // Of the whole tensor. data is nullptr for the tensors between the nodes.
+  TfLiteIntArray* dims;
+  uint8_t* data;
+  size_t pixel_bytes;
+  // The rows [y0, y1) and columns [x0, x1) in the current patch, and its dims
+  // as a TfLiteIntArray.
+  int y0, y1, x0, x1;
+  int patch_dims[5];
+  // Whether the patch goes to a patch buffer. Otherwise it is a run of whole
+  // rows of the first node's input or the last node's output, used in place.
+  bool in_patch_buffer;
+};
+
 MicroInterpreter::MicroInterpreter(const Model* model,
                                    const MicroOpResolver& op_resolver,
                                    uint8_t* tensor_arena,
@@ -142,6 +221,10 @@ MicroInterpreter::MicroInterpreter(const Model* model,
 }
 
 MicroInterpreter::~MicroInterpreter() {
+  if (pipeline_started_) {
+    FlushPipeline();
+    PipelineWorkerStop();
+  }
   if (node_and_registrations_ != nullptr) {
     for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
       TfLiteNode* node = &(node_and_registrations_[i].node);
@@ -221,6 +304,9 @@ void MicroInterpreter::CorrectTensorDataEndianness(T* data, int32_t size) {
 }
 
 TfLiteStatus MicroInterpreter::AllocateTensors() {
+  // Other models sharing the allocator keep their tensors in the same head.
+  TF_LITE_ENSURE_STATUS(allocator_.CheckHeadAvailable(this));
+
   if (allocator_.StartModelAllocation(model_, op_resolver_,
                                       &node_and_registrations_,
                                       &eval_tensors_) != kTfLiteOk) {
@@ -308,12 +394,23 @@ TfLiteStatus MicroInterpreter::AllocateTensors() {
   context_.RequestScratchBufferInArena = nullptr;
   context_.GetScratchBuffer = context_helper_.GetScratchBuffer;
 
+  const bool pipelined = pipeline_plan_.first_stage2_node > 0;
+  const bool patched = patch_plan_.layer_count > 0;
+  if (patched) {
+    TF_LITE_ENSURE_STATUS(SetUpPatches());
+  }
   TF_LITE_ENSURE_OK(&context_,
-                    allocator_.FinishModelAllocation(model_, eval_tensors_,
-                                                     &scratch_buffer_handles_));
+                    allocator_.FinishModelAllocation(
+                        model_, eval_tensors_, &scratch_buffer_handles_,
+                        pipelined ? &pipeline_plan_ : nullptr,
+                        patched ? &patch_plan_ : nullptr));
   // TODO(b/16157777): Remove this when ContextHelper is rolled into this class.
   context_helper_.SetScratchBufferHandles(scratch_buffer_handles_);
 
+  if (pipelined) {
+    TF_LITE_ENSURE_STATUS(SetUpPipeline());
+  }
+
   TF_LITE_ENSURE_STATUS(ResetVariableTensors());
 
   tensors_allocated_ = true;
@@ -333,27 +430,168 @@ TfLiteStatus MicroInterpreter::Invoke() {
     TF_LITE_ENSURE_OK(&context_, AllocateTensors());
   }
 
-  for (size_t i = 0; i < subgraph_->operators()->size(); ++i) {
+  if (pipeline_in_flight_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Invoke() called with a pipelined input in flight\n");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_STATUS(allocator_.CheckHeadAvailable(this));
+
+  size_t first_node = 0;
+  if (patch_plan_.layer_count > 0) {
+    TF_LITE_ENSURE_STATUS(InvokePatches());
+    first_node = patch_plan_.layer_count;
+  }
+  for (size_t i = first_node; i < subgraph_->operators()->size(); ++i) {
+    TF_LITE_ENSURE_STATUS(InvokeNode(i));
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::InvokeNode(size_t node_index) {
+  auto* node = &(node_and_registrations_[node_index].node);
+  auto* registration = node_and_registrations_[node_index].registration;
+  if (registration->invoke == nullptr) {
+    return kTfLiteOk;
+  }
+
+  TfLiteStatus invoke_status;
+  // Profiling stays in release builds, it costs a null check when no
+  // profiler is attached.
+  tflite::Profiler* profiler =
+      reinterpret_cast<tflite::Profiler*>(context_.profiler);
+  {
+    // The case where profiler == nullptr is handled by
+    // ScopedOperatorProfile.
+    ScopedOperatorProfile scoped_profiler(
+        profiler, OpNameFromRegistration(registration), node_index);
+    invoke_status = registration->invoke(&context_, node);
+  }
+
+  if (profiler != nullptr) {
+    // The node's temporary allocations are still in place, so this is the
+    // arena high-water mark while it ran.
+    profiler->AddEvent(
+        "arena", Profiler::EventType::GENERAL_RUNTIME_INSTRUMENTATION_EVENT, 0,
+        0, arena_used_bytes(), node_index);
+  }
+
+  // All TfLiteTensor structs used in the kernel are allocated from temp
+  // memory in the allocator. This creates a chain of allocations in the
+  // temp section. The call below resets the chain of allocations to
+  // prepare for the next call.
+  allocator_.ResetTempAllocations();
+
+  if (invoke_status == kTfLiteError) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Node %s (number %d) failed to invoke with status %d",
+                         OpNameFromRegistration(registration), node_index,
+                         invoke_status);
+  }
+  return invoke_status;
+}
+
+TfLiteStatus MicroInterpreter::SetPipelinePartition(int first_stage2_node) {
+  if (initialization_status_ != kTfLiteOk) {
+    return kTfLiteError;
+  }
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "SetPipelinePartition() called after "
+                         "AllocateTensors()\n");
+    return kTfLiteError;
+  }
+  if (patch_plan_.layer_count > 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "A patch plan can't be pipelined as well\n");
+    return kTfLiteError;
+  }
+  const int operators_size = subgraph_->operators()->size();
+  if (first_stage2_node <= 0 || first_stage2_node >= operators_size) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Pipeline partition %d out of range (%d operators)",
+                         first_stage2_node, operators_size);
+    return kTfLiteError;
+  }
+  pipeline_plan_.first_stage2_node = first_stage2_node;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::SetUpPipeline() {
+  const size_t tensors_size = context_.tensors_size;
+  const uint8_t* boundary = pipeline_plan_.boundary;
+  const size_t boundary_bytes = pipeline_plan_.boundary_bytes;
+
+  pipeline_buffer_count_ = 0;
+  for (size_t i = 0; i < tensors_size; ++i) {
+    const uint8_t* data = eval_tensors_[i].data.uint8;
+    if (data >= boundary && data < boundary + boundary_bytes) {
+      ++pipeline_buffer_count_;
+    }
+  }
+  pipeline_buffers_ = reinterpret_cast<PipelineBuffer*>(
+      allocator_.AllocatePersistentBuffer(sizeof(PipelineBuffer) *
+                                          pipeline_buffer_count_));
+  TF_LITE_ENSURE(&context_, pipeline_buffers_ != nullptr ||
+                                pipeline_buffer_count_ == 0);
+  size_t count = 0;
+  for (size_t i = 0; i < tensors_size; ++i) {
+    uint8_t* data = eval_tensors_[i].data.uint8;
+    if (data >= boundary && data < boundary + boundary_bytes) {
+      pipeline_buffers_[count].tensor_index = i;
+      pipeline_buffers_[count].data = data;
+      ++count;
+    }
+  }
+
+  for (int s = 0; s < 2; ++s) {
+    void* stage_buffer = allocator_.AllocatePersistentBuffer(
+        sizeof(PipelineStage));
+    TfLiteEvalTensor* eval_tensors = reinterpret_cast<TfLiteEvalTensor*>(
+        allocator_.AllocatePersistentBuffer(sizeof(TfLiteEvalTensor) *
+                                            tensors_size));
+    TF_LITE_ENSURE(&context_,
+                   stage_buffer != nullptr && eval_tensors != nullptr);
+    PipelineStage* stage = new (stage_buffer)
+        PipelineStage(error_reporter_, &allocator_, model_);
+    memcpy(eval_tensors, eval_tensors_,
+           sizeof(TfLiteEvalTensor) * tensors_size);
+    stage->eval_tensors = eval_tensors;
+    stage->helper.SetTfLiteEvalTensors(eval_tensors);
+    stage->helper.SetScratchBufferHandles(scratch_buffer_handles_);
+    stage->helper.SetPipelined();
+    stage->context = context_;
+    stage->context.impl_ = static_cast<void*>(&stage->helper);
+    // The profiler isn't safe to use from two cores, the stages are timed as a
+    // whole instead.
+    stage->context.profiler = nullptr;
+    const size_t partition = pipeline_plan_.first_stage2_node;
+    stage->first_node = s == 0 ? 0 : partition;
+    stage->end_node = s == 0 ? partition : operators_size();
+    stage->ticks = 0;
+    pipeline_stages_[s] = stage;
+  }
+  SelectPipelineBuffers();
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::RunPipelineStage(PipelineStage* stage,
+                                                uint32_t frame) {
+  const size_t copy_offset =
+      (frame & 1) ? pipeline_plan_.boundary_bytes : 0;
+  for (size_t i = 0; i < pipeline_buffer_count_; ++i) {
+    stage->eval_tensors[pipeline_buffers_[i].tensor_index].data.uint8 =
+        pipeline_buffers_[i].data + copy_offset;
+  }
+
+  const int32_t start_ticks = GetCurrentTimeTicks();
+  for (size_t i = stage->first_node; i < stage->end_node; ++i) {
     auto* node = &(node_and_registrations_[i].node);
     auto* registration = node_and_registrations_[i].registration;
 
     if (registration->invoke) {
-      TfLiteStatus invoke_status;
-#ifndef NDEBUG  // Omit profiler overhead from release builds.
-      // The case where profiler == nullptr is handled by
-      // ScopedOperatorProfile.
-      tflite::Profiler* profiler =
-          reinterpret_cast<tflite::Profiler*>(context_.profiler);
-      ScopedOperatorProfile scoped_profiler(
-          profiler, OpNameFromRegistration(registration), i);
-#endif
-      invoke_status = registration->invoke(&context_, node);
-
-      // All TfLiteTensor structs used in the kernel are allocated from temp
-      // memory in the allocator. This creates a chain of allocations in the
-      // temp section. The call below resets the chain of allocations to
-      // prepare for the next call.
-      allocator_.ResetTempAllocations();
+      TfLiteStatus invoke_status = registration->invoke(&stage->context, node);
+      stage->helper.FinishPipelinedNode();
 
       if (invoke_status == kTfLiteError) {
         TF_LITE_REPORT_ERROR(
@@ -366,9 +604,418 @@ TfLiteStatus MicroInterpreter::Invoke() {
       }
     }
   }
+  stage->ticks = GetCurrentTimeTicks() - start_ticks;
   return kTfLiteOk;
 }
 
+TfLiteStatus MicroInterpreter::RunSecondPipelineStage(void* data,
+                                                      uint32_t frame) {
+  MicroInterpreter* interpreter = static_cast<MicroInterpreter*>(data);
+  return interpreter->RunPipelineStage(interpreter->pipeline_stages_[1],
+                                       frame);
+}
+
+void MicroInterpreter::SelectPipelineBuffers() {
+  // Inputs go to the copy the next frame will use, the outputs are read from
+  // the copy of the latest frame out of the second stage.
+  const uint32_t input_frame = pipeline_frames_started_;
+  const uint32_t output_frame =
+      pipeline_frames_started_ - (pipeline_in_flight_ ? 2 : 1);
+  const size_t boundary_bytes = pipeline_plan_.boundary_bytes;
+  for (size_t i = 0; i < pipeline_buffer_count_; ++i) {
+    const int tensor_index = pipeline_buffers_[i].tensor_index;
+    bool is_input = false;
+    for (size_t n = 0; n < inputs_size(); ++n) {
+      is_input = is_input || inputs().Get(n) == tensor_index;
+    }
+    const uint32_t frame = is_input ? input_frame : output_frame;
+    eval_tensors_[tensor_index].data.uint8 =
+        pipeline_buffers_[i].data + ((frame & 1) ? boundary_bytes : 0);
+  }
+  if (input_tensor_ != nullptr) {
+    input_tensor_->data.data = eval_tensors_[inputs().Get(0)].data.data;
+  }
+  if (output_tensor_ != nullptr) {
+    output_tensor_->data.data = eval_tensors_[outputs().Get(0)].data.data;
+  }
+}
+
+TfLiteStatus MicroInterpreter::InvokePipelined() {
+  if (initialization_status_ != kTfLiteOk) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "InvokePipelined() called after initialization "
+                         "failed\n");
+    return kTfLiteError;
+  }
+  if (pipeline_plan_.first_stage2_node == 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "InvokePipelined() called without a partition\n");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_STATUS(allocator_.CheckHeadAvailable(this));
+  if (!tensors_allocated_) {
+    TF_LITE_ENSURE_OK(&context_, AllocateTensors());
+  }
+  if (!pipeline_started_) {
+    TF_LITE_ENSURE_OK(&context_,
+                      PipelineWorkerStart(RunSecondPipelineStage, this));
+    pipeline_started_ = true;
+  }
+
+  PipelineStage* first_stage = pipeline_stages_[0];
+  TfLiteStatus status = RunPipelineStage(first_stage, pipeline_frames_started_);
+  if (status == kTfLiteOk) {
+    PipelineStageStats* stats = &pipeline_stage_stats_[0];
+    ++stats->runs;
+    stats->last_ticks = first_stage->ticks;
+    stats->max_ticks = std::max(stats->max_ticks, first_stage->ticks);
+    stats->total_ticks += first_stage->ticks;
+  }
+
+  // The other core can only start on this frame once it is done with the
+  // previous one.
+  TfLiteStatus previous_status = FlushPipeline();
+  if (status != kTfLiteOk) {
+    return status;
+  }
+  PipelineWorkerSubmit(pipeline_frames_started_);
+  ++pipeline_frames_started_;
+  pipeline_in_flight_ = true;
+  allocator_.HoldHead(this);
+  SelectPipelineBuffers();
+  return previous_status;
+}
+
+TfLiteStatus MicroInterpreter::FlushPipeline() {
+  if (!pipeline_in_flight_) {
+    return kTfLiteOk;
+  }
+  TfLiteStatus status = PipelineWorkerWait();
+  pipeline_in_flight_ = false;
+  allocator_.ReleaseHead(this);
+  if (status == kTfLiteOk) {
+    PipelineStage* second_stage = pipeline_stages_[1];
+    PipelineStageStats* stats = &pipeline_stage_stats_[1];
+    ++stats->runs;
+    stats->last_ticks = second_stage->ticks;
+    stats->max_ticks = std::max(stats->max_ticks, second_stage->ticks);
+    stats->total_ticks += second_stage->ticks;
+    ++pipeline_frames_completed_;
+  }
+  SelectPipelineBuffers();
+  return status;
+}
+
+TfLiteStatus MicroInterpreter::SetPatchPlan(int layer_count, int patch_height,
+                                            int patch_width) {
+  if (initialization_status_ != kTfLiteOk) {
+    return kTfLiteError;
+  }
+  if (tensors_allocated_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "SetPatchPlan() called after AllocateTensors()\n");
+    return kTfLiteError;
+  }
+  if (pipeline_plan_.first_stage2_node > 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "A pipelined model can't run in patches as well\n");
+    return kTfLiteError;
+  }
+  const int operators_size = subgraph_->operators()->size();
+  if (layer_count <= 0 || layer_count > operators_size || patch_height <= 0 ||
+      patch_width <= 0) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Patch plan of %d nodes in %dx%d patches out of range "
+                         "(%d operators)",
+                         layer_count, patch_height, patch_width,
+                         operators_size);
+    return kTfLiteError;
+  }
+
+  const auto* operators = subgraph_->operators();
+  for (int i = 0; i < layer_count; ++i) {
+    const Operator* op = operators->Get(i);
+    const BuiltinOperator op_code =
+        GetBuiltinCode(model_->operator_codes()->Get(op->opcode_index()));
+    if (op_code != BuiltinOperator_CONV_2D &&
+        op_code != BuiltinOperator_DEPTHWISE_CONV_2D &&
+        op_code != BuiltinOperator_AVERAGE_POOL_2D &&
+        op_code != BuiltinOperator_MAX_POOL_2D &&
+        op_code != BuiltinOperator_QUANTIZE) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Node %s (number %d) can't run in patches",
+                           EnumNameBuiltinOperator(op_code), i);
+      return kTfLiteError;
+    }
+    if (i == layer_count - 1) {
+      break;
+    }
+    // The tensors between the nodes only exist a patch at a time, so nothing
+    // but the next node may read them.
+    const int tensor_index = op->outputs()->Get(0);
+    bool chained = operators->Get(i + 1)->inputs()->Get(0) == tensor_index;
+    for (size_t n = 0; n < outputs_size(); ++n) {
+      chained = chained && outputs().Get(n) != tensor_index;
+    }
+    for (int j = 0; j < operators_size; ++j) {
+      const auto* inputs = operators->Get(j)->inputs();
+      for (size_t n = 0; n < inputs->size(); ++n) {
+        chained = chained && (inputs->Get(n) != tensor_index ||
+                              (j == i + 1 && n == 0));
+      }
+    }
+    if (!chained) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "The output of node %d is read outside the patches",
+                           i);
+      return kTfLiteError;
+    }
+  }
+  patch_plan_.layer_count = layer_count;
+  patch_height_ = patch_height;
+  patch_width_ = patch_width;
+  return kTfLiteOk;
+}
+
+TfLiteStatus MicroInterpreter::SetUpPatches() {
+  const int count = patch_plan_.layer_count;
+  patch_layers_ = reinterpret_cast<PatchLayer*>(
+      allocator_.AllocatePersistentBuffer(sizeof(PatchLayer) * count));
+  patch_tensors_ = reinterpret_cast<PatchTensor*>(
+      allocator_.AllocatePersistentBuffer(sizeof(PatchTensor) * (count + 1)));
+  TF_LITE_ENSURE(&context_,
+                 patch_layers_ != nullptr && patch_tensors_ != nullptr);
+
+  for (int t = 0; t <= count; ++t) {
+    PatchTensor* tensor = &patch_tensors_[t];
+    tensor->tensor_index =
+        t < count ? node_and_registrations_[t].node.inputs->data[0]
+                  : node_and_registrations_[count - 1].node.outputs->data[0];
+    const TfLiteEvalTensor* eval_tensor = &eval_tensors_[tensor->tensor_index];
+    tensor->dims = eval_tensor->dims;
+    tensor->data = nullptr;
+    // Patches are made of whole pixels of a single image.
+    TF_LITE_ENSURE(&context_,
+                   tensor->dims->size == 4 && tensor->dims->data[0] == 1);
+    size_t type_size;
+    TF_LITE_ENSURE_STATUS(TfLiteTypeSizeOf(eval_tensor->type, &type_size));
+    tensor->pixel_bytes = tensor->dims->data[3] * type_size;
+  }
+
+  for (int i = 0; i < count; ++i) {
+    const TfLiteNode& node = node_and_registrations_[i].node;
+    const TfLiteRegistration* registration =
+        node_and_registrations_[i].registration;
+    PatchLayer* layer = &patch_layers_[i];
+    *layer = PatchLayer();
+    // A quantization maps every pixel on its own.
+    TfLitePadding padding = kTfLitePaddingValid;
+    layer->stride_height = 1;
+    layer->stride_width = 1;
+    layer->filter_height = 1;
+    layer->filter_width = 1;
+    int dilation_height = 1;
+    int dilation_width = 1;
+    switch (registration->builtin_code) {
+      case BuiltinOperator_CONV_2D: {
+        const auto* params =
+            static_cast<const TfLiteConvParams*>(node.builtin_data);
+        padding = params->padding;
+        layer->stride_height = params->stride_height;
+        layer->stride_width = params->stride_width;
+        dilation_height = params->dilation_height_factor;
+        dilation_width = params->dilation_width_factor;
+        break;
+      }
+      case BuiltinOperator_DEPTHWISE_CONV_2D: {
+        const auto* params =
+            static_cast<const TfLiteDepthwiseConvParams*>(node.builtin_data);
+        padding = params->padding;
+        layer->stride_height = params->stride_height;
+        layer->stride_width = params->stride_width;
+        dilation_height = params->dilation_height_factor;
+        dilation_width = params->dilation_width_factor;
+        break;
+      }
+      case BuiltinOperator_AVERAGE_POOL_2D:
+      case BuiltinOperator_MAX_POOL_2D: {
+        const auto* params =
+            static_cast<const TfLitePoolParams*>(node.builtin_data);
+        padding = params->padding;
+        layer->stride_height = params->stride_height;
+        layer->stride_width = params->stride_width;
+        layer->filter_height = params->filter_height;
+        layer->filter_width = params->filter_width;
+        break;
+      }
+      default:
+        break;
+    }
+    if (registration->builtin_code == BuiltinOperator_CONV_2D ||
+        registration->builtin_code == BuiltinOperator_DEPTHWISE_CONV_2D) {
+      const TfLiteIntArray* filter_dims =
+          eval_tensors_[node.inputs->data[1]].dims;
+      layer->filter_height = filter_dims->data[1];
+      layer->filter_width = filter_dims->data[2];
+    }
+
+    // The same padding as the kernel's, and a check that the output is the
+    // size the patches assume.
+    const TfLiteIntArray* input_dims = patch_tensors_[i].dims;
+    const TfLiteIntArray* output_dims = patch_tensors_[i + 1].dims;
+    int output_height;
+    int output_width;
+    layer->padding = ComputePaddingHeightWidth(
+        layer->stride_height, layer->stride_width, dilation_height,
+        dilation_width, input_dims->data[1], input_dims->data[2],
+        layer->filter_height, layer->filter_width, padding, &output_height,
+        &output_width);
+    if (dilation_height != 1 || dilation_width != 1 ||
+        output_height != output_dims->data[1] ||
+        output_width != output_dims->data[2]) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Node %s (number %d) can't run in patches",
+                           OpNameFromRegistration(registration), i);
+      return kTfLiteError;
+    }
+  }
+
+  // Every patch buffer is sized for the largest patch of the tensors in it.
+  const TfLiteIntArray* output_dims = patch_tensors_[count].dims;
+  patch_plan_.patch_buffer_bytes[0] = 0;
+  patch_plan_.patch_buffer_bytes[1] = 0;
+  for (int y = 0; y < output_dims->data[1]; y += patch_height_) {
+    for (int x = 0; x < output_dims->data[2]; x += patch_width_) {
+      SetPatchRegions(y, x);
+      for (int t = 0; t <= count; ++t) {
+        const PatchTensor* tensor = &patch_tensors_[t];
+        if (tensor->in_patch_buffer) {
+          size_t* bytes = &patch_plan_.patch_buffer_bytes[(t + 1) % 2];
+          *bytes = std::max(*bytes, (tensor->y1 - tensor->y0) *
+                                        (tensor->x1 - tensor->x0) *
+                                        tensor->pixel_bytes);
+        }
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+void MicroInterpreter::SetPatchRegions(int y, int x) {
+  // From the patch of the last node's output back to the first node's input,
+  // each node reads the rows and columns its filter covers.
+  const int count = patch_plan_.layer_count;
+  PatchTensor* output = &patch_tensors_[count];
+  output->y0 = y;
+  output->y1 = std::min(y + patch_height_, output->dims->data[1]);
+  output->x0 = x;
+  output->x1 = std::min(x + patch_width_, output->dims->data[2]);
+  for (int i = count - 1; i >= 0; --i) {
+    PatchLayer* layer = &patch_layers_[i];
+    const PatchTensor* out = &patch_tensors_[i + 1];
+    PatchTensor* in = &patch_tensors_[i];
+    const int top = out->y0 * layer->stride_height - layer->padding.height;
+    const int left = out->x0 * layer->stride_width - layer->padding.width;
+    in->y0 = std::max(top, 0);
+    in->y1 = std::min((out->y1 - 1) * layer->stride_height -
+                          layer->padding.height + layer->filter_height,
+                      in->dims->data[1]);
+    in->x0 = std::max(left, 0);
+    in->x1 = std::min((out->x1 - 1) * layer->stride_width -
+                          layer->padding.width + layer->filter_width,
+                      in->dims->data[2]);
+    // Past the bottom and right edges the kernels pad by themselves.
+    layer->patch_padding.height = in->y0 - top;
+    layer->patch_padding.width = in->x0 - left;
+  }
+  for (int t = 0; t <= count; ++t) {
+    PatchTensor* tensor = &patch_tensors_[t];
+    tensor->in_patch_buffer = (t > 0 && t < count) || tensor->x0 != 0 ||
+                              tensor->x1 != tensor->dims->data[2];
+  }
+}
+
+TfLiteStatus MicroInterpreter::InvokePatches() {
+  const int count = patch_plan_.layer_count;
+  for (int t = 0; t <= count; ++t) {
+    PatchTensor* tensor = &patch_tensors_[t];
+    tensor->data = eval_tensors_[tensor->tensor_index].data.uint8;
+  }
+  const PatchTensor* input = &patch_tensors_[0];
+  const PatchTensor* output = &patch_tensors_[count];
+  const int height = output->dims->data[1];
+  const int width = output->dims->data[2];
+
+  TfLiteStatus status = kTfLiteOk;
+  for (int y = 0; y < height && status == kTfLiteOk; y += patch_height_) {
+    for (int x = 0; x < width && status == kTfLiteOk; x += patch_width_) {
+      SetPatchRegions(y, x);
+      for (int t = 0; t <= count; ++t) {
+        PatchTensor* tensor = &patch_tensors_[t];
+        TfLiteEvalTensor* eval_tensor = &eval_tensors_[tensor->tensor_index];
+        tensor->patch_dims[0] = 4;
+        tensor->patch_dims[1] = 1;
+        tensor->patch_dims[2] = tensor->y1 - tensor->y0;
+        tensor->patch_dims[3] = tensor->x1 - tensor->x0;
+        tensor->patch_dims[4] = tensor->dims->data[3];
+        eval_tensor->dims =
+            reinterpret_cast<TfLiteIntArray*>(tensor->patch_dims);
+        eval_tensor->data.uint8 =
+            tensor->in_patch_buffer
+                ? patch_plan_.patch_buffers[(t + 1) % 2]
+                : tensor->data +
+                      tensor->y0 * tensor->dims->data[2] * tensor->pixel_bytes;
+      }
+
+      const size_t input_stride = input->dims->data[2] * input->pixel_bytes;
+      const size_t input_row_bytes =
+          (input->x1 - input->x0) * input->pixel_bytes;
+      if (input->in_patch_buffer) {
+        CopyRows(input->data + input->y0 * input_stride +
+                     input->x0 * input->pixel_bytes,
+                 input_stride,
+                 eval_tensors_[input->tensor_index].data.uint8,
+                 input_row_bytes, input->y1 - input->y0, input_row_bytes);
+      }
+      for (int i = 0; i < count && status == kTfLiteOk; ++i) {
+        context_.patch_padding = &patch_layers_[i].patch_padding;
+        status = InvokeNode(i);
+      }
+      context_.patch_padding = nullptr;
+      const size_t output_stride = output->dims->data[2] * output->pixel_bytes;
+      const size_t output_row_bytes =
+          (output->x1 - output->x0) * output->pixel_bytes;
+      if (status == kTfLiteOk && output->in_patch_buffer) {
+        CopyRows(eval_tensors_[output->tensor_index].data.uint8,
+                 output_row_bytes,
+                 output->data + output->y0 * output_stride +
+                     output->x0 * output->pixel_bytes,
+                 output_stride, output->y1 - output->y0, output_row_bytes);
+      }
+    }
+  }
+
+  for (int t = 0; t <= count; ++t) {
+    const PatchTensor* tensor = &patch_tensors_[t];
+    eval_tensors_[tensor->tensor_index].dims = tensor->dims;
+    eval_tensors_[tensor->tensor_index].data.uint8 = tensor->data;
+  }
+  return status;
+}
+
+TfLiteTensor* MicroInterpreter::AllocatePersistentTensor(int tensor_index) {
+  // The second pipeline stage may be making temp allocations at the same time.
+  if (!pipeline_in_flight_) {
+    return allocator_.AllocatePersistentTfLiteTensor(model_, eval_tensors_,
+                                                     tensor_index);
+  }
+  PipelineLock();
+  TfLiteTensor* tensor = allocator_.AllocatePersistentTfLiteTensor(
+      model_, eval_tensors_, tensor_index);
+  PipelineUnlock();
+  return tensor;
+}
+
 TfLiteTensor* MicroInterpreter::input(size_t index) {
   const size_t length = inputs_size();
   if (index >= length) {
@@ -383,12 +1030,10 @@ TfLiteTensor* MicroInterpreter::input(size_t index) {
         "Input tensors not at index 0 are allocated from the "
         "persistent memory arena. Repeat calls will cause excess "
         "allocation!");
-    return allocator_.AllocatePersistentTfLiteTensor(model_, eval_tensors_,
-                                                     inputs().Get(index));
+    return AllocatePersistentTensor(inputs().Get(index));
   }
   if (input_tensor_ == nullptr) {
-    input_tensor_ = allocator_.AllocatePersistentTfLiteTensor(
-        model_, eval_tensors_, inputs().Get(index));
+    input_tensor_ = AllocatePersistentTensor(inputs().Get(index));
   }
   return input_tensor_;
 }
@@ -407,14 +1052,12 @@ TfLiteTensor* MicroInterpreter::output(size_t index) {
         "Output tensors not at index 0 are allocated from the "
         "persistent memory arena. Repeat calls will cause excess "
         "allocation!");
-    return allocator_.AllocatePersistentTfLiteTensor(model_, eval_tensors_,
-                                                     outputs().Get(index));
+    return AllocatePersistentTensor(outputs().Get(index));
   }
   if (output_tensor_ == nullptr) {
     // TODO(b/162311891): Drop these allocations when the interpreter supports
     // handling buffers from TfLiteEvalTensor.
-    output_tensor_ = allocator_.AllocatePersistentTfLiteTensor(
-        model_, eval_tensors_, outputs().Get(index));
+    output_tensor_ = AllocatePersistentTensor(outputs().Get(index));
   }
   return output_tensor_;
 }
@@ -427,8 +1070,7 @@ TfLiteTensor* MicroInterpreter::tensor(size_t index) {
                          length);
     return nullptr;
   }
-  return allocator_.AllocatePersistentTfLiteTensor(model_, eval_tensors_,
-                                                   index);
+  return AllocatePersistentTensor(index);
 }
 
 TfLiteStatus MicroInterpreter::ResetVariableTensors() {
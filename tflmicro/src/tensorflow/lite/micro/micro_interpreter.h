@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_op_resolver.h"
 #include "tensorflow/lite/portable_type_to_tflitetype.h"
@@ -60,16 +61,36 @@ class ContextHelper {
   // Sets the pointer to a list of ScratchBufferHandle instances.
   void SetScratchBufferHandles(ScratchBufferHandle* scratch_buffer_handles);
 
+  // Marks the context as one of the stages of a pipelined interpreter. The
+  // temp section of the arena is shared with the other stage, so GetTensor()
+  // takes the pipeline lock and holds it until FinishPipelinedNode().
+  void SetPipelined();
+
+  // Called after every node of a pipeline stage. Drops the node's temp
+  // allocations, if it made any, and releases the pipeline lock.
+  void FinishPipelinedNode();
+
  private:
   MicroAllocator* allocator_ = nullptr;
   ErrorReporter* error_reporter_ = nullptr;
   const Model* model_ = nullptr;
   TfLiteEvalTensor* eval_tensors_ = nullptr;
   ScratchBufferHandle* scratch_buffer_handles_ = nullptr;
+  bool pipelined_ = false;
+  bool holds_pipeline_lock_ = false;
 };
 
 }  // namespace internal
 
+// Execution times of one stage of a pipelined MicroInterpreter, in ticks as
+// returned by GetCurrentTimeTicks().
+struct PipelineStageStats {
+  uint32_t runs;
+  int32_t last_ticks;
+  int32_t max_ticks;
+  uint64_t total_ticks;
+};
+
 class MicroInterpreter {
  public:
   // The lifetime of the model, op resolver, tensor arena, error reporter and
@@ -89,6 +110,13 @@ class MicroInterpreter {
   // have allocation handled in more than one interpreter or for recording
   // allocations inside the interpreter. The lifetime of the allocator must be
   // as long as that of the interpreter object.
+  // Interpreters sharing an allocator keep their persistent allocations apart
+  // and share one head, as large as the largest model needs, so they can take
+  // turns on one arena: each Invoke() runs on its own inputs and leaves its
+  // own outputs, but those live in the head, so fill the inputs right before
+  // Invoke() and read the outputs before another model allocates or invokes.
+  // Variable tensors persist. While a pipelined interpreter has an input in
+  // flight the others fail to allocate or invoke until FlushPipeline().
   MicroInterpreter(const Model* model, const MicroOpResolver& op_resolver,
                    MicroAllocator* allocator, ErrorReporter* error_reporter,
                    tflite::Profiler* profiler = nullptr);
@@ -104,6 +132,54 @@ class MicroInterpreter {
   // TODO(b/149795762): Add this to the TfLiteStatus enum.
   TfLiteStatus Invoke();
 
+  // Pipelined execution splits the operators in two stages at
+  // `first_stage2_node`. InvokePipelined() runs the first stage on the calling
+  // core while the second stage of the previous input runs on the other core
+  // (see micro_pipeline.h), so the model's outputs lag its inputs by one call.
+  // Tensors that live across the partition are double buffered, which costs
+  // arena space; a partition with small tensors at the boundary and about the
+  // same amount of work on both sides works best. Must be called before
+  // AllocateTensors().
+  TfLiteStatus SetPipelinePartition(int first_stage2_node);
+  int pipeline_partition() const {
+    return pipeline_plan_.first_stage2_node;
+  }
+
+  // Runs the first stage for the current input and hands it to the other core
+  // once it has finished the previous one. On return the outputs hold the
+  // results for the input of the previous call, or nothing yet on the first
+  // call (see pipeline_frames_completed()), and the input tensors point at
+  // the buffer for the next input. The pointers of input(0) and output(0) are
+  // updated in place, other tensors have to be fetched again.
+  // Kernels should read tensors through GetEvalTensor() in Eval; the ones that
+  // use GetTensor() still work but serialize both stages for that node.
+  TfLiteStatus InvokePipelined();
+
+  // Waits for the input in flight, after which the outputs hold its results.
+  // Invoke() may only be called with nothing in flight.
+  TfLiteStatus FlushPipeline();
+
+  uint32_t pipeline_frames_completed() const {
+    return pipeline_frames_completed_;
+  }
+  const PipelineStageStats& pipeline_stage_stats(int stage) const {
+    return pipeline_stage_stats_[stage];
+  }
+
+  // Patch-based execution runs the first `layer_count` nodes, a chain of
+  // convolutions, depthwise convolutions, poolings and quantizations, one
+  // patch of the last node's output at a time: patch_height by patch_width
+  // pixels, and as much of each earlier tensor as it depends on. Only one
+  // patch of the tensors between those nodes is ever in the arena, so a model
+  // whose first layers have large activations needs a much smaller one. Each
+  // patch recomputes the overlap with its neighbours, which costs time; wide
+  // patches of a few rows keep that low. Other nodes run as usual, and
+  // Invoke() does both. Kernels have to read tensors through GetEvalTensor()
+  // in Eval. Must be called before AllocateTensors().
+  TfLiteStatus SetPatchPlan(int layer_count, int patch_height,
+                            int patch_width);
+  int patch_layer_count() const { return patch_plan_.layer_count; }
+
   size_t tensors_size() const { return context_.tensors_size; }
   TfLiteTensor* tensor(size_t tensor_index);
   template <class T>
@@ -182,12 +258,29 @@ class MicroInterpreter {
   template <class T>
   void CorrectTensorDataEndianness(T* data, int32_t size);
 
+  struct PipelineStage;
+  struct PipelineBuffer;
+  struct PatchLayer;
+  struct PatchTensor;
+
+  TfLiteStatus InvokeNode(size_t node_index);
+
+  TfLiteStatus SetUpPipeline();
+  TfLiteStatus RunPipelineStage(PipelineStage* stage, uint32_t frame);
+  void SelectPipelineBuffers();
+  TfLiteTensor* AllocatePersistentTensor(int tensor_index);
+  static TfLiteStatus RunSecondPipelineStage(void* data, uint32_t frame);
+
+  TfLiteStatus SetUpPatches();
+  void SetPatchRegions(int y, int x);
+  TfLiteStatus InvokePatches();
+
   NodeAndRegistration* node_and_registrations_ = nullptr;
 
   const Model* model_;
   const MicroOpResolver& op_resolver_;
   ErrorReporter* error_reporter_;
-  TfLiteContext context_ = {};
+  micro::MicroContext context_;
   MicroAllocator& allocator_;
   bool tensors_allocated_;
 
@@ -204,6 +297,26 @@ class MicroInterpreter {
   // from TfLiteEvalTensor.
   TfLiteTensor* input_tensor_;
   TfLiteTensor* output_tensor_;
+
+  PipelinePlan pipeline_plan_ = {};
+  PipelineStage* pipeline_stages_[2] = {};
+  // Tensors that have a copy per frame in flight.
+  PipelineBuffer* pipeline_buffers_ = nullptr;
+  size_t pipeline_buffer_count_ = 0;
+  bool pipeline_started_ = false;
+  bool pipeline_in_flight_ = false;
+  // Frames handed to the first stage and completed by the second stage.
+  uint32_t pipeline_frames_started_ = 0;
+  uint32_t pipeline_frames_completed_ = 0;
+  PipelineStageStats pipeline_stage_stats_[2] = {};
+
+  PatchPlan patch_plan_ = {};
+  int patch_height_ = 0;
+  int patch_width_ = 0;
+  // One per node run in patches, and one per tensor in their chain, the
+  // input of the first node to the output of the last one.
+  PatchLayer* patch_layers_ = nullptr;
+  PatchTensor* patch_tensors_ = nullptr;
 };
 
 }  // namespace tflite
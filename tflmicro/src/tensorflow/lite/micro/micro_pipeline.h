@@ -0,0 +1,95 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_PIPELINE_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_PIPELINE_H_
+
+#include <stdint.h>
+
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+
+// These functions should be implemented by each target platform that supports
+// MicroInterpreter::InvokePipelined(). They provide a second execution unit
+// (core 1 on the RP2040, a thread on the host) that runs one job at a time.
+// Only a single pipelined interpreter can use the worker at any time. Kernels
+// that split their work across both units borrow it while it is otherwise idle.
+
+// A job run on the worker. `arg` is the value passed to PipelineWorkerSubmit().
+typedef TfLiteStatus (*PipelineJob)(void* data, uint32_t arg);
+
+// Starts the worker, which then runs `job` once for every submitted argument.
+TfLiteStatus PipelineWorkerStart(PipelineJob job, void* data);
+
+// Hands `arg` to the worker. At most one job may be outstanding.
+void PipelineWorkerSubmit(uint32_t arg);
+
+// Blocks until the outstanding job has finished and returns its status.
+TfLiteStatus PipelineWorkerWait();
+
+// Stops the worker. There must be no outstanding job.
+void PipelineWorkerStop();
+
+// A lock shared by the calling core and the worker. It is held for the length
+// of a kernel invocation, so it must not spin with interrupts disabled.
+void PipelineLock();
+void PipelineUnlock();
+
+// Turns splitting of single kernels across both execution units on or off. It
+// is off by default. Kernels decide whether to split, and request the scratch
+// memory for it, in Prepare, so this has to be set before AllocateTensors().
+void PipelineSetKernelSplit(bool enabled);
+bool PipelineKernelSplitEnabled();
+
+// Runs job(data, 0) on the calling core and job(data, 1) on the worker, and
+// returns once both halves have finished. When kernel splitting is off, or the
+// worker belongs to a pipelined interpreter, both halves run one after the
+// other on the calling core.
+TfLiteStatus PipelineRunSplit(PipelineJob job, void* data);
+
+// The rest is target independent, in micro_pipeline_split.cpp.
+
+// The rows of a convolution that one half of a row split computes.
+struct SplitRows {
+  // First input row the half reads, and the rows from there on it is given.
+  int input_row;
+  int input_height;
+  // First output row the half writes, and how many.
+  int output_row;
+  int output_height;
+  // Padding rows above input_row.
+  int padding;
+};
+
+// Narrows a convolution of input_height rows to output_height rows, split at
+// output row split_row, to the rows of one half. Padding rows above the second
+// half are only kept while it still starts inside them.
+SplitRows GetSplitRows(uint32_t half, int split_row, int stride,
+                       int filter_height, int padding, int input_height,
+                       int output_height);
+
+// Computes the rows `rows` of one half of a convolution split by rows.
+typedef TfLiteStatus (*SplitRowsJob)(void* data, uint32_t half,
+                                     const SplitRows& rows);
+
+// Runs a convolution split at output row split_row through PipelineRunSplit(),
+// calling job for the rows of either half.
+TfLiteStatus PipelineRunSplitRows(SplitRowsJob job, void* data, int split_row,
+                                  int stride, int filter_height, int padding,
+                                  int input_height, int output_height);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_PIPELINE_H_
@@ -0,0 +1,78 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_pipeline.h"
+
+namespace tflite {
+namespace {
+
+struct RowsJob {
+  SplitRowsJob job;
+  void* data;
+  SplitRows rows[2];
+};
+
+TfLiteStatus RunRowsHalf(void* data, uint32_t half) {
+  const RowsJob* rows_job = static_cast<const RowsJob*>(data);
+  return rows_job->job(rows_job->data, half, rows_job->rows[half]);
+}
+
+}  // namespace
+
+SplitRows GetSplitRows(uint32_t half, int split_row, int stride,
+                       int filter_height, int padding, int input_height,
+                       int output_height) {
+  SplitRows rows;
+  if (half == 0) {
+    // Some kernels, like arm_convolve_1x1_s8_fast, size their loops by the
+    // input, so the input has to end with the last row the half reads.
+    const int end_row = (split_row - 1) * stride - padding + filter_height;
+    rows.input_row = 0;
+    rows.input_height = end_row < input_height ? end_row : input_height;
+    rows.output_row = 0;
+    rows.output_height = split_row;
+    rows.padding = padding;
+    return rows;
+  }
+  const int first_row = split_row * stride - padding;
+  rows.output_row = split_row;
+  rows.output_height = output_height - split_row;
+  if (first_row < 0) {
+    rows.input_row = 0;
+    rows.input_height = input_height;
+    rows.padding = -first_row;
+  } else {
+    rows.input_row = first_row;
+    rows.input_height = input_height - first_row;
+    rows.padding = 0;
+  }
+  return rows;
+}
+
+TfLiteStatus PipelineRunSplitRows(SplitRowsJob job, void* data, int split_row,
+                                  int stride, int filter_height, int padding,
+                                  int input_height, int output_height) {
+  RowsJob rows_job;
+  rows_job.job = job;
+  rows_job.data = data;
+  for (uint32_t half = 0; half < 2; ++half) {
+    rows_job.rows[half] =
+        GetSplitRows(half, split_row, stride, filter_height, padding,
+                     input_height, output_height);
+  }
+  return PipelineRunSplit(RunRowsHalf, &rows_job);
+}
+
+}  // namespace tflite
@@ -0,0 +1,251 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_stats_profiler.h"
+
+#include <string.h>
+
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/micro/micro_time.h"
+
+namespace tflite {
+namespace {
+
+constexpr uint8_t kBinaryVersion = 1;
+constexpr size_t kBinaryHeaderBytes = 12;
+constexpr size_t kBinaryNodeBytes = 27;
+constexpr size_t kMaxTagBytes = 255;
+
+uint8_t* Write16(uint8_t* p, uint32_t value) {
+  p[0] = value;
+  p[1] = value >> 8;
+  return p + 2;
+}
+
+uint8_t* Write32(uint8_t* p, uint32_t value) {
+  p[0] = value;
+  p[1] = value >> 8;
+  p[2] = value >> 16;
+  p[3] = value >> 24;
+  return p + 4;
+}
+
+size_t TagBytes(const char* tag) {
+  const size_t length = tag == nullptr ? 0 : strlen(tag);
+  return length < kMaxTagBytes ? length : kMaxTagBytes;
+}
+
+}  // namespace
+
+MicroStatsProfiler::MicroStatsProfiler(Record* records, int32_t* history,
+                                       int max_nodes, int history_length)
+    : records_(records),
+      history_(history),
+      max_nodes_(max_nodes),
+      history_length_(history_length) {
+  TFLITE_DCHECK(records != nullptr);
+  TFLITE_DCHECK(history != nullptr);
+  TFLITE_DCHECK(history_length > 0);
+  Reset();
+}
+
+uint32_t MicroStatsProfiler::BeginEvent(const char* tag, EventType event_type,
+                                        int64_t event_metadata1,
+                                        int64_t event_metadata2) {
+  const int32_t start_ticks = GetCurrentTimeTicks();
+  if (depth_ >= kMaxDepth) {
+    // Too deeply nested, the matching EndEvent() is dropped.
+    return kMaxDepth;
+  }
+  OpenEvent& event = open_events_[depth_];
+  event.tag = tag;
+  event.node = event_type == EventType::OPERATOR_INVOKE_EVENT
+                   ? static_cast<int>(event_metadata1)
+                   : -1;
+  event.start_ticks = start_ticks;
+  return depth_++;
+}
+
+void MicroStatsProfiler::EndEvent(uint32_t event_handle) {
+  const int32_t end_ticks = GetCurrentTimeTicks();
+  if (event_handle >= kMaxDepth) {
+    return;
+  }
+  TFLITE_DCHECK_EQ(event_handle, static_cast<uint32_t>(depth_ - 1));
+  const OpenEvent& event = open_events_[event_handle];
+  depth_ = event_handle;
+  RecordTicks(event.node, event.tag, end_ticks - event.start_ticks);
+}
+
+void MicroStatsProfiler::AddEvent(const char* tag, EventType event_type,
+                                  uint64_t start, uint64_t end,
+                                  int64_t event_metadata1,
+                                  int64_t event_metadata2) {
+  if (event_type == EventType::OPERATOR_INVOKE_EVENT) {
+    RecordTicks(static_cast<int>(event_metadata1), tag,
+                static_cast<int32_t>(end - start));
+  } else if (event_type == EventType::GENERAL_RUNTIME_INSTRUMENTATION_EVENT) {
+    const uint32_t bytes = static_cast<uint32_t>(event_metadata1);
+    const int node = static_cast<int>(event_metadata2);
+    if (bytes > arena_high_water_bytes_) {
+      arena_high_water_bytes_ = bytes;
+    }
+    if (node >= 0 && node < max_nodes_ &&
+        bytes > records_[node].arena_high_water_bytes) {
+      records_[node].arena_high_water_bytes = bytes;
+    }
+  }
+}
+
+void MicroStatsProfiler::Reset() {
+  for (int i = 0; i < max_nodes_; ++i) {
+    records_[i].tag = nullptr;
+    records_[i].invocations = 0;
+    records_[i].min_ticks = 0;
+    records_[i].max_ticks = 0;
+    records_[i].total_ticks = 0;
+    records_[i].arena_high_water_bytes = 0;
+  }
+  nodes_ = 0;
+  arena_high_water_bytes_ = 0;
+  depth_ = 0;
+}
+
+void MicroStatsProfiler::RecordTicks(int node, const char* tag,
+                                     int32_t ticks) {
+  if (node < 0 || node >= max_nodes_) {
+    return;
+  }
+  Record& record = records_[node];
+  if (record.invocations == 0) {
+    record.tag = tag;
+    record.min_ticks = ticks;
+    record.max_ticks = ticks;
+  } else {
+    record.min_ticks = ticks < record.min_ticks ? ticks : record.min_ticks;
+    record.max_ticks = ticks > record.max_ticks ? ticks : record.max_ticks;
+  }
+  record.total_ticks += ticks;
+  history_[node * history_length_ + record.invocations % history_length_] =
+      ticks;
+  ++record.invocations;
+  if (node >= nodes_) {
+    nodes_ = node + 1;
+  }
+}
+
+int32_t MicroStatsProfiler::Percentile99(int node) const {
+  const uint32_t invocations = records_[node].invocations;
+  const int count = invocations < static_cast<uint32_t>(history_length_)
+                        ? static_cast<int>(invocations)
+                        : history_length_;
+  const int32_t* samples = &history_[node * history_length_];
+  // Nearest rank: the smallest sample that at least 99% of the samples are
+  // less than or equal to. The history is short, so a quadratic search is
+  // cheaper than keeping a sorted copy.
+  const int rank = (99 * count + 99) / 100;
+  for (int i = 0; i < count; ++i) {
+    int less = 0;
+    int less_or_equal = 0;
+    for (int j = 0; j < count; ++j) {
+      less += samples[j] < samples[i];
+      less_or_equal += samples[j] <= samples[i];
+    }
+    if (less < rank && rank <= less_or_equal) {
+      return samples[i];
+    }
+  }
+  return 0;
+}
+
+bool MicroStatsProfiler::GetStats(int node, MicroOperatorStats* stats) const {
+  if (node < 0 || node >= nodes_ || records_[node].invocations == 0) {
+    return false;
+  }
+  const Record& record = records_[node];
+  stats->tag = record.tag;
+  stats->invocations = record.invocations;
+  stats->min_ticks = record.min_ticks;
+  stats->mean_ticks =
+      static_cast<int32_t>(record.total_ticks / record.invocations);
+  stats->max_ticks = record.max_ticks;
+  stats->p99_ticks = Percentile99(node);
+  stats->arena_high_water_bytes = record.arena_high_water_bytes;
+  return true;
+}
+
+void MicroStatsProfiler::LogCsv(ErrorReporter* reporter) const {
+#ifndef TF_LITE_STRIP_ERROR_STRINGS
+  TF_LITE_REPORT_ERROR(reporter,
+                       "node,op,invocations,min_ticks,mean_ticks,max_ticks,"
+                       "p99_ticks,arena_bytes");
+  for (int node = 0; node < nodes_; ++node) {
+    MicroOperatorStats stats;
+    if (GetStats(node, &stats)) {
+      TF_LITE_REPORT_ERROR(reporter, "%d,%s,%u,%d,%d,%d,%d,%u", node,
+                           stats.tag != nullptr ? stats.tag : "",
+                           stats.invocations, stats.min_ticks, stats.mean_ticks,
+                           stats.max_ticks, stats.p99_ticks,
+                           stats.arena_high_water_bytes);
+    }
+  }
+#endif
+}
+
+size_t MicroStatsProfiler::SerializeBinary(uint8_t* buffer,
+                                           size_t buffer_size) const {
+  size_t size = kBinaryHeaderBytes;
+  int node_count = 0;
+  for (int node = 0; node < nodes_; ++node) {
+    if (records_[node].invocations > 0) {
+      size += kBinaryNodeBytes + TagBytes(records_[node].tag);
+      ++node_count;
+    }
+  }
+  if (buffer == nullptr || size > buffer_size) {
+    return 0;
+  }
+
+  uint8_t* p = buffer;
+  memcpy(p, "TFPS", 4);
+  p += 4;
+  *p++ = kBinaryVersion;
+  *p++ = 0;
+  p = Write16(p, node_count);
+  p = Write32(p, arena_high_water_bytes_);
+  for (int node = 0; node < nodes_; ++node) {
+    MicroOperatorStats stats;
+    if (!GetStats(node, &stats)) {
+      continue;
+    }
+    p = Write16(p, node);
+    p = Write32(p, stats.invocations);
+    p = Write32(p, stats.min_ticks);
+    p = Write32(p, stats.mean_ticks);
+    p = Write32(p, stats.max_ticks);
+    p = Write32(p, stats.p99_ticks);
+    p = Write32(p, stats.arena_high_water_bytes);
+    const size_t tag_bytes = TagBytes(stats.tag);
+    *p++ = tag_bytes;
+    if (tag_bytes > 0) {
+      memcpy(p, stats.tag, tag_bytes);
+      p += tag_bytes;
+    }
+  }
+  TFLITE_DCHECK_EQ(static_cast<size_t>(p - buffer), size);
+  return size;
+}
+
+}  // namespace tflite
@@ -0,0 +1,141 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_STATS_PROFILER_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_STATS_PROFILER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/micro/compatibility.h"
+
+namespace tflite {
+
+// Summary of one operator node across all invocations since the last Reset().
+// Ticks are those of GetCurrentTimeTicks(). The p99 covers only the most recent
+// invocations that are still held in the history.
+struct MicroOperatorStats {
+  const char* tag;
+  uint32_t invocations;
+  int32_t min_ticks;
+  int32_t mean_ticks;
+  int32_t max_ticks;
+  int32_t p99_ticks;
+  // The most arena the interpreter had in use while the node ran, including
+  // the node's temporary allocations.
+  uint32_t arena_high_water_bytes;
+};
+
+// MicroStatsProfiler collects per-operator timing statistics over many
+// invocations, rather than printing every event like MicroProfiler. It is cheap
+// enough to leave in release builds: an event costs two timer reads and a few
+// stores, and nothing is printed until asked for.
+//
+// Usage example:
+// MicroStatsProfiler::Record records[kMaxNodes];
+// int32_t history[kMaxNodes * kHistory];
+// MicroStatsProfiler profiler(records, history, kMaxNodes, kHistory);
+// MicroInterpreter interpreter(model, resolver, arena, arena_size, reporter,
+//                              &profiler);
+// ... Invoke() as often as needed ...
+// profiler.LogCsv(reporter);
+//
+// Only OPERATOR_INVOKE_EVENT events are recorded, keyed by node index, and
+// nodes at or beyond max_nodes are ignored. Events must be properly nested and
+// at most kMaxDepth deep. The profiler is not safe to use from two cores.
+class MicroStatsProfiler : public tflite::Profiler {
+ public:
+  static constexpr int kMaxDepth = 4;
+
+  // Running statistics of one node. Storage for these is owned by the caller.
+  struct Record {
+    const char* tag;
+    uint32_t invocations;
+    int32_t min_ticks;
+    int32_t max_ticks;
+    int64_t total_ticks;
+    uint32_t arena_high_water_bytes;
+  };
+
+  // `records` holds max_nodes entries and `history` holds max_nodes *
+  // history_length tick counts, used as one ring buffer per node for the p99.
+  MicroStatsProfiler(Record* records, int32_t* history, int max_nodes,
+                     int history_length);
+  ~MicroStatsProfiler() override = default;
+
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      int64_t event_metadata1,
+                      int64_t event_metadata2) override;
+
+  void EndEvent(uint32_t event_handle) override;
+
+  // Records an operator event that was timed elsewhere, or with a
+  // GENERAL_RUNTIME_INSTRUMENTATION_EVENT the arena use in bytes
+  // (event_metadata1) while node event_metadata2 was running.
+  void AddEvent(const char* tag, EventType event_type, uint64_t start,
+                uint64_t end, int64_t event_metadata1,
+                int64_t event_metadata2) override;
+
+  // Forgets all recorded events.
+  void Reset();
+
+  // One more than the highest node index recorded.
+  int nodes() const { return nodes_; }
+
+  // Fills in `stats` for `node`. Returns false if it was never invoked.
+  bool GetStats(int node, MicroOperatorStats* stats) const;
+
+  // The most arena in use at any point of any recorded invocation.
+  uint32_t arena_high_water_bytes() const { return arena_high_water_bytes_; }
+
+  // Logs one CSV line per node, after a header line, through `reporter`.
+  void LogCsv(ErrorReporter* reporter) const;
+
+  // Writes the statistics in a compact little-endian binary form, which
+  // tools/parse_profile.py turns back into a table. Returns the number of
+  // bytes written, or 0 if `buffer_size` is too small.
+  //
+  //   "TFPS", u8 version (1), u8 0, u16 node count, u32 arena high water
+  //   per node: u16 node, u32 invocations, i32 min, i32 mean, i32 max,
+  //             i32 p99, u32 arena high water, u8 tag length, tag bytes
+  size_t SerializeBinary(uint8_t* buffer, size_t buffer_size) const;
+
+ private:
+  void RecordTicks(int node, const char* tag, int32_t ticks);
+  int32_t Percentile99(int node) const;
+
+  Record* records_;
+  int32_t* history_;
+  int max_nodes_;
+  int history_length_;
+  int nodes_;
+  uint32_t arena_high_water_bytes_;
+
+  struct OpenEvent {
+    const char* tag;
+    int node;
+    int32_t start_ticks;
+  };
+  OpenEvent open_events_[kMaxDepth];
+  int depth_;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_STATS_PROFILER_H_
@@ -0,0 +1,148 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Host implementation of the pipeline worker. Jobs run on a thread, and
+// arguments and results are handed over like the rp2 inter-core FIFOs, one
+// at a time.
+
+#include "tensorflow/lite/micro/micro_pipeline.h"
+
+#include <pthread.h>
+
+namespace tflite {
+namespace {
+
+PipelineJob pipeline_job = nullptr;
+void* pipeline_data = nullptr;
+bool running = false;
+pthread_t worker;
+pthread_mutex_t pipeline_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// The two directions of the FIFO, each holding at most one word
+pthread_mutex_t fifo_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t fifo_cond = PTHREAD_COND_INITIALIZER;
+bool arg_full = false;
+uint32_t arg_word;
+bool result_full = false;
+uint32_t result_word;
+bool stopping = false;
+
+bool kernel_split_enabled = false;
+PipelineJob split_job = nullptr;
+void* split_data = nullptr;
+
+void* WorkerEntry(void*) {
+  while (true) {
+    pthread_mutex_lock(&fifo_mutex);
+    while (!arg_full && !stopping) {
+      pthread_cond_wait(&fifo_cond, &fifo_mutex);
+    }
+    if (stopping) {
+      pthread_mutex_unlock(&fifo_mutex);
+      return nullptr;
+    }
+    const uint32_t arg = arg_word;
+    arg_full = false;
+    pthread_mutex_unlock(&fifo_mutex);
+
+    const TfLiteStatus status = pipeline_job(pipeline_data, arg);
+
+    pthread_mutex_lock(&fifo_mutex);
+    result_word = static_cast<uint32_t>(status);
+    result_full = true;
+    pthread_cond_broadcast(&fifo_cond);
+    pthread_mutex_unlock(&fifo_mutex);
+  }
+}
+
+TfLiteStatus RunSplitJob(void*, uint32_t arg) {
+  return split_job(split_data, arg);
+}
+
+}  // namespace
+
+TfLiteStatus PipelineWorkerStart(PipelineJob job, void* data) {
+  if (running) {
+    PipelineWorkerStop();
+  }
+  pipeline_job = job;
+  pipeline_data = data;
+  arg_full = false;
+  result_full = false;
+  stopping = false;
+  if (pthread_create(&worker, nullptr, WorkerEntry, nullptr) != 0) {
+    return kTfLiteError;
+  }
+  running = true;
+  return kTfLiteOk;
+}
+
+void PipelineWorkerSubmit(uint32_t arg) {
+  pthread_mutex_lock(&fifo_mutex);
+  arg_word = arg;
+  arg_full = true;
+  pthread_cond_broadcast(&fifo_cond);
+  pthread_mutex_unlock(&fifo_mutex);
+}
+
+TfLiteStatus PipelineWorkerWait() {
+  pthread_mutex_lock(&fifo_mutex);
+  while (!result_full) {
+    pthread_cond_wait(&fifo_cond, &fifo_mutex);
+  }
+  result_full = false;
+  const uint32_t status = result_word;
+  pthread_mutex_unlock(&fifo_mutex);
+  return static_cast<TfLiteStatus>(status);
+}
+
+void PipelineWorkerStop() {
+  if (!running) {
+    return;
+  }
+  pthread_mutex_lock(&fifo_mutex);
+  stopping = true;
+  pthread_cond_broadcast(&fifo_cond);
+  pthread_mutex_unlock(&fifo_mutex);
+  pthread_join(worker, nullptr);
+  running = false;
+}
+
+void PipelineLock() { pthread_mutex_lock(&pipeline_mutex); }
+
+void PipelineUnlock() { pthread_mutex_unlock(&pipeline_mutex); }
+
+void PipelineSetKernelSplit(bool enabled) { kernel_split_enabled = enabled; }
+
+bool PipelineKernelSplitEnabled() { return kernel_split_enabled; }
+
+TfLiteStatus PipelineRunSplit(PipelineJob job, void* data) {
+  // A pipelined interpreter keeps the worker for its second stage, and kernels
+  // of that stage run on the worker itself. If no thread can be started, both
+  // halves run here as well.
+  if (!kernel_split_enabled || (running && pipeline_job != RunSplitJob) ||
+      (!running && PipelineWorkerStart(RunSplitJob, nullptr) != kTfLiteOk)) {
+    TfLiteStatus status = job(data, 0);
+    return status != kTfLiteOk ? status : job(data, 1);
+  }
+  split_job = job;
+  split_data = data;
+  PipelineWorkerSubmit(1);
+  TfLiteStatus status = job(data, 0);
+  TfLiteStatus worker_status = PipelineWorkerWait();
+  return status != kTfLiteOk ? status : worker_status;
+}
+
+}  // namespace tflite
@@ -0,0 +1,101 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Raspberry Pi Pico-specific implementation of the pipeline worker. Jobs run
+// on core 1, arguments and results travel through the inter-core FIFOs.
+
+#include "tensorflow/lite/micro/micro_pipeline.h"
+
+// These are headers from the RP2's SDK.
+#include "pico/multicore.h"  // NOLINT
+#include "pico/mutex.h"      // NOLINT
+
+namespace tflite {
+namespace {
+
+PipelineJob pipeline_job = nullptr;
+void* pipeline_data = nullptr;
+bool running = false;
+auto_init_mutex(pipeline_mutex);
+
+bool kernel_split_enabled = false;
+PipelineJob split_job = nullptr;
+void* split_data = nullptr;
+
+void Core1Entry() {
+  while (true) {
+    uint32_t arg = multicore_fifo_pop_blocking();
+    TfLiteStatus status = pipeline_job(pipeline_data, arg);
+    multicore_fifo_push_blocking(static_cast<uint32_t>(status));
+  }
+}
+
+// The worker job while core 1 is lent to split kernels. split_job and
+// split_data are written before the argument is pushed through the FIFO.
+TfLiteStatus RunSplitJob(void*, uint32_t arg) {
+  return split_job(split_data, arg);
+}
+
+}  // namespace
+
+TfLiteStatus PipelineWorkerStart(PipelineJob job, void* data) {
+  pipeline_job = job;
+  pipeline_data = data;
+  // The launch handshake goes through the FIFOs, which orders the writes above
+  // before anything core 1 reads.
+  multicore_reset_core1();
+  multicore_launch_core1(Core1Entry);
+  running = true;
+  return kTfLiteOk;
+}
+
+void PipelineWorkerSubmit(uint32_t arg) { multicore_fifo_push_blocking(arg); }
+
+TfLiteStatus PipelineWorkerWait() {
+  return static_cast<TfLiteStatus>(multicore_fifo_pop_blocking());
+}
+
+void PipelineWorkerStop() {
+  multicore_reset_core1();
+  running = false;
+}
+
+void PipelineLock() { mutex_enter_blocking(&pipeline_mutex); }
+
+void PipelineUnlock() { mutex_exit(&pipeline_mutex); }
+
+void PipelineSetKernelSplit(bool enabled) { kernel_split_enabled = enabled; }
+
+bool PipelineKernelSplitEnabled() { return kernel_split_enabled; }
+
+TfLiteStatus PipelineRunSplit(PipelineJob job, void* data) {
+  // A pipelined interpreter keeps core 1 for its second stage, and kernels of
+  // that stage run on core 1 itself.
+  if (!kernel_split_enabled || (running && pipeline_job != RunSplitJob)) {
+    TfLiteStatus status = job(data, 0);
+    return status != kTfLiteOk ? status : job(data, 1);
+  }
+  if (!running) {
+    PipelineWorkerStart(RunSplitJob, nullptr);
+  }
+  split_job = job;
+  split_data = data;
+  PipelineWorkerSubmit(1);
+  TfLiteStatus status = job(data, 0);
+  TfLiteStatus worker_status = PipelineWorkerWait();
+  return status != kTfLiteOk ? status : worker_status;
+}
+
+}  // namespace tflite
@@ -99,9 +99,12 @@ class ModelBuilder {
     return AddTensorImpl(type, /* is_variable */ true, shape);
   }
 
-  // Adds a node to the model with given input and output Tensors.
+  // Adds a node to the model with given input and output Tensors, and
+  // builtin options if the operator has any.
   Node AddNode(Operator op, std::initializer_list<Tensor> inputs,
-               std::initializer_list<Tensor> outputs);
+               std::initializer_list<Tensor> outputs,
+               BuiltinOptions options_type = BuiltinOptions_NONE,
+               flatbuffers::Offset<void> options = 0);
 
   void AddMetadata(const char* description_string,
                    const int32_t* metadata_buffer_data, size_t num_elements);
@@ -156,12 +159,13 @@ ModelBuilder::Operator ModelBuilder::RegisterOp(BuiltinOperator op,
 ModelBuilder::Node ModelBuilder::AddNode(
     ModelBuilder::Operator op,
     std::initializer_list<ModelBuilder::Tensor> inputs,
-    std::initializer_list<ModelBuilder::Tensor> outputs) {
+    std::initializer_list<ModelBuilder::Tensor> outputs,
+    BuiltinOptions options_type, flatbuffers::Offset<void> options) {
   TFLITE_DCHECK(next_operator_id_ <= kMaxOperators);
   operators_[next_operator_id_] = tflite::CreateOperator(
       *builder_, op, builder_->CreateVector(inputs.begin(), inputs.size()),
-      builder_->CreateVector(outputs.begin(), outputs.size()),
-      BuiltinOptions_NONE);
+      builder_->CreateVector(outputs.begin(), outputs.size()), options_type,
+      options);
   next_operator_id_++;
   return next_operator_id_ - 1;
 }
@@ -312,6 +316,59 @@ const Model* BuildSimpleModelWithBranch() {
   return model_builder.BuildModel({t0}, {t3});
 }
 
+const Model* BuildModelWithAliases() {
+  using flatbuffers::Offset;
+  flatbuffers::FlatBufferBuilder* fb_builder = BuilderInstance();
+
+  ModelBuilder model_builder(fb_builder);
+  /* Model structure
+                 | t0
+       +---------+---------+
+       v                   v
+    +-----+             +-----+
+    | n0  |             | n2  |
+    +-----+             +-----+
+       | t1 [1, 16]        | t3 [16]
+       v                   |
+    +---------+            |
+    | n1      |            |
+    | reshape |            |
+    +---------+            |
+       | t2 [16]           |
+       v                   v
+    +---------------------------+
+    |     n3 concatenation      |
+    +---------------------------+
+                 | t4 [32]
+                 v
+              +-----+
+              | n4  |
+              +-----+
+                 | t5
+                 v
+  */
+  const int op_id =
+      model_builder.RegisterOp(BuiltinOperator_CUSTOM, "mock_custom");
+  const int reshape_id =
+      model_builder.RegisterOp(BuiltinOperator_RESHAPE, nullptr);
+  const int concatenation_id =
+      model_builder.RegisterOp(BuiltinOperator_CONCATENATION, nullptr);
+  const int t0 = model_builder.AddTensor(TensorType_FLOAT32, {16});
+  const int t1 = model_builder.AddTensor(TensorType_FLOAT32, {1, 16});
+  const int t2 = model_builder.AddTensor(TensorType_FLOAT32, {16});
+  const int t3 = model_builder.AddTensor(TensorType_FLOAT32, {16});
+  const int t4 = model_builder.AddTensor(TensorType_FLOAT32, {32});
+  const int t5 = model_builder.AddTensor(TensorType_FLOAT32, {32});
+  model_builder.AddNode(op_id, {t0}, {t1});       // n0
+  model_builder.AddNode(reshape_id, {t1}, {t2});  // n1
+  model_builder.AddNode(op_id, {t0}, {t3});       // n2
+  model_builder.AddNode(concatenation_id, {t2, t3}, {t4},  // n3
+                        BuiltinOptions_ConcatenationOptions,
+                        CreateConcatenationOptions(*fb_builder, 0).Union());
+  model_builder.AddNode(op_id, {t4}, {t5});  // n4
+  return model_builder.BuildModel({t0}, {t5});
+}
+
 const Model* BuildModelWithOfflinePlanning(int number_of_tensors,
                                            const int32_t* metadata_buffer,
                                            NodeConnection* node_conn,
@@ -867,6 +924,14 @@ const Model* GetSimpleModelWithBranch() {
   return model;
 }
 
+const Model* GetModelWithAliases() {
+  static Model* model = nullptr;
+  if (!model) {
+    model = const_cast<Model*>(BuildModelWithAliases());
+  }
+  return model;
+}
+
 const Model* GetModelWithOfflinePlanning(int num_tensors,
                                          const int32_t* metadata_buffer,
                                          NodeConnection* node_conn,
@@ -108,6 +108,10 @@ const Model* GetSimpleModelWithBranch();
 // 1 output Tensor, and 1 operator.
 const Model* GetSimpleMultipleInputsModel();
 
+// Returns a flatbuffer model with a Reshape and a Concatenation whose tensors
+// the allocator can plan in one buffer.
+const Model* GetModelWithAliases();
+
 // Returns a simple flatbuffer model with offline planned tensors
 // @param[in]       num_tensors           Number of tensors in the model.
 // @param[in]       metadata_buffer       Metadata for offline planner.
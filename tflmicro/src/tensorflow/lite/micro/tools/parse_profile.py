@@ -0,0 +1,134 @@
+# Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Turns a MicroStatsProfiler dump into a table or a flame chart.
+
+The input is either the binary written by MicroStatsProfiler::SerializeBinary()
+or a UART log that contains the output of MicroStatsProfiler::LogCsv(). Other
+lines in the log are skipped.
+
+  parse_profile.py capture.bin
+  parse_profile.py --sort mean uart.log
+  parse_profile.py --folded uart.log | flamegraph.pl > profile.svg
+
+The folded output has one line per node, weighted by its mean ticks, in the
+format read by flamegraph.pl and speedscope.
+"""
+
+import argparse
+import struct
+import sys
+
+CSV_HEADER = ("node,op,invocations,min_ticks,mean_ticks,max_ticks,p99_ticks,"
+              "arena_bytes")
+FIELDS = ("node", "op", "invocations", "min_ticks", "mean_ticks", "max_ticks",
+          "p99_ticks", "arena_bytes")
+MAGIC = b"TFPS"
+HEADER = struct.Struct("<4sBBHI")
+NODE = struct.Struct("<HIiiiiIB")
+
+
+def parse_binary(data):
+  """Returns (nodes, arena high water) from a SerializeBinary() dump."""
+  magic, version, _, count, arena = HEADER.unpack_from(data, 0)
+  if magic != MAGIC or version != 1:
+    raise ValueError("not a version 1 MicroStatsProfiler dump")
+  offset = HEADER.size
+  nodes = []
+  for _ in range(count):
+    values = NODE.unpack_from(data, offset)
+    offset += NODE.size
+    tag_length = values[-1]
+    op = data[offset:offset + tag_length].decode("ascii", "replace")
+    offset += tag_length
+    nodes.append(dict(zip(FIELDS, (values[0], op) + values[1:7])))
+  return nodes, arena
+
+
+def parse_csv(text):
+  """Returns (nodes, arena high water) from a log containing LogCsv() output."""
+  nodes = []
+  in_table = False
+  for line in text.splitlines():
+    line = line.strip()
+    if line == CSV_HEADER:
+      # A later dump replaces an earlier one.
+      nodes = []
+      in_table = True
+      continue
+    cells = line.split(",")
+    if not in_table or len(cells) != len(FIELDS):
+      in_table = False
+      continue
+    try:
+      values = [int(cells[0]), cells[1]] + [int(c) for c in cells[2:]]
+    except ValueError:
+      in_table = False
+      continue
+    nodes.append(dict(zip(FIELDS, values)))
+  arena = max([n["arena_bytes"] for n in nodes] or [0])
+  return nodes, arena
+
+
+def print_table(nodes, arena, out):
+  total = sum(n["mean_ticks"] for n in nodes) or 1
+  out.write("%4s  %-24s %7s %9s %9s %9s %9s %6s %9s\n" %
+            ("node", "op", "count", "min", "mean", "p99", "max", "%mean",
+             "arena"))
+  for n in nodes:
+    out.write("%4d  %-24s %7d %9d %9d %9d %9d %5.1f%% %9d\n" %
+              (n["node"], n["op"][:24], n["invocations"], n["min_ticks"],
+               n["mean_ticks"], n["p99_ticks"], n["max_ticks"],
+               100.0 * n["mean_ticks"] / total, n["arena_bytes"]))
+  out.write("total mean %d ticks, arena high water %d bytes\n" %
+            (sum(n["mean_ticks"] for n in nodes), arena))
+
+
+def print_folded(nodes, out):
+  for n in nodes:
+    out.write("model;%d %s %d\n" % (n["node"], n["op"], n["mean_ticks"]))
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+  parser.add_argument("input", help="binary dump or UART log, - for stdin")
+  parser.add_argument("--sort", choices=("node", "mean", "p99", "max"),
+                      default="node", help="table order")
+  parser.add_argument("--folded", action="store_true",
+                      help="write folded stacks for a flame chart")
+  args = parser.parse_args()
+
+  if args.input == "-":
+    data = sys.stdin.buffer.read()
+  else:
+    with open(args.input, "rb") as f:
+      data = f.read()
+  if data.startswith(MAGIC):
+    nodes, arena = parse_binary(data)
+  else:
+    nodes, arena = parse_csv(data.decode("ascii", "replace"))
+  if not nodes:
+    sys.exit("no profile found in " + args.input)
+
+  if args.sort != "node":
+    key = args.sort + "_ticks"
+    nodes.sort(key=lambda n: n[key], reverse=True)
+  if args.folded:
+    print_folded(nodes, sys.stdout)
+  else:
+    print_table(nodes, arena, sys.stdout)
+
+
+if __name__ == "__main__":
+  main()
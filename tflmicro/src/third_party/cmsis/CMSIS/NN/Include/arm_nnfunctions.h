@@ -1384,6 +1384,26 @@ extern    "C"
                                         const int32_t *const output_bias,
                                         q7_t *out_0);
 
+   /**
+   * @brief Matrix-multiplication function for convolution with per-channel requantization, for the Cortex-M0+.
+   *
+   * @details  For arguments and results, refer arm_nn_mat_mult_kernel_s8_s16, which calls this function when
+   *           ARM_NN_M0PLUS is defined. There are no constraints on num_col_a or output_ch, and output_bias
+   *           may be NULL.
+   *
+   */
+    q7_t *arm_nn_mat_mult_kernel_s8_s16_m0plus(const q7_t *input_a,
+                                               const q15_t *input_b,
+                                               const uint16_t output_ch,
+                                               const int32_t *out_shift,
+                                               const int32_t *out_mult,
+                                               const int32_t out_offset,
+                                               const int16_t activation_min,
+                                               const int16_t activation_max,
+                                               const uint16_t num_col_a,
+                                               const int32_t *const output_bias,
+                                               q7_t *out_0);
+
    /**
    * @brief Matrix-multiplication of re-ordered input B with A.
    *
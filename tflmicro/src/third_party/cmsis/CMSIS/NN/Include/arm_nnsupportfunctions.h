@@ -343,6 +343,28 @@ arm_status arm_nn_mat_mult_nt_t_s8(const q7_t *lhs,
                                    const int32_t activation_min,
                                    const int32_t activation_max);
 
+/**
+* @brief General Matrix-multiplication function with per-channel requantization, blocked for the Cortex-M0+.
+*        Arguments and results are the same as for arm_nn_mat_mult_nt_t_s8, which calls this function when
+*        ARM_NN_M0PLUS is defined.
+*
+* @return     The function returns <code>ARM_MATH_SUCCESS</code>
+*
+*/
+arm_status arm_nn_mat_mult_nt_t_s8_m0plus(const q7_t *lhs,
+                                          const q7_t *rhs,
+                                          const q31_t *bias,
+                                          q7_t *dst,
+                                          const int32_t *dst_multipliers,
+                                          const int32_t *dst_shifts,
+                                          const int32_t lhs_rows,
+                                          const int32_t rhs_rows,
+                                          const int32_t rhs_cols,
+                                          const int32_t lhs_offset,
+                                          const int32_t dst_offset,
+                                          const int32_t activation_min,
+                                          const int32_t activation_max);
+
 /**
  * @brief s8 Vector by Matrix (transposed) multiplication
  *
@@ -377,6 +399,30 @@ arm_status arm_nn_vec_mat_mult_t_s8(const q7_t *lhs,
                                     const int32_t activation_min,
                                     const int32_t activation_max);
 
+/**
+ * @brief s8 Vector by Matrix (transposed) multiplication, blocked for the Cortex-M0+
+ *
+ * @details Arguments and results are the same as for arm_nn_vec_mat_mult_t_s8, which calls this function when
+ *          ARM_NN_M0PLUS is defined. The inner loop is shortest with a zero lhs offset, so callers that can fold
+ *          the offset into the bias ahead of time should do so.
+ *
+ * @return         The function returns <code>ARM_MATH_SUCCESS</code>
+ *
+ */
+arm_status arm_nn_vec_mat_mult_t_s8_m0plus(const q7_t *lhs,
+                                           const q7_t *rhs,
+                                           const q31_t *bias,
+                                           q7_t *dst,
+                                           const int32_t lhs_offset,
+                                           const int32_t rhs_offset,
+                                           const int32_t dst_offset,
+                                           const int32_t dst_multiplier,
+                                           const int32_t dst_shift,
+                                           const int32_t rhs_cols,
+                                           const int32_t rhs_rows,
+                                           const int32_t activation_min,
+                                           const int32_t activation_max);
+
 /**
  * @brief Depthwise convolution of transposed rhs matrix with 4 lhs matrices. To be used in padded cases where
  *        the padding is -lhs_offset(Range: int8). Dimensions are the same for lhs and rhs.
@@ -791,6 +837,91 @@ __STATIC_FORCEINLINE q31_t arm_nn_requantize(const q31_t val, const q31_t multip
       RIGHT_SHIFT(shift));
 }
 
+/**
+ * @brief           Requantize, offset and clamp one s8 output value
+ * @param[in]       val             Accumulated value
+ * @param[in]       multiplier      Output multiplier
+ * @param[in]       shift           Output shift
+ * @param[in]       dst_offset      Offset to be added to the output value
+ * @param[in]       activation_min  Minimum value to clamp the output to. Range: int8
+ * @param[in]       activation_max  Maximum value to clamp the output to. Range: int8
+ *
+ * @return          The output value
+ *
+ */
+__STATIC_FORCEINLINE q7_t arm_nn_requantize_clamp_s8(q31_t val,
+                                                     const int32_t multiplier,
+                                                     const int32_t shift,
+                                                     const int32_t dst_offset,
+                                                     const int32_t activation_min,
+                                                     const int32_t activation_max)
+{
+    val = arm_nn_requantize(val, multiplier, shift);
+    val += dst_offset;
+    val = MAX(val, activation_min);
+    val = MIN(val, activation_max);
+    return (q7_t)val;
+}
+
+/**
+ * @brief           Multiply-accumulate one s8 lhs row with two s8 rhs rows, for the Cortex-M0+
+ * @param[in]       lhs         Pointer to the lhs row
+ * @param[in]       rhs         Pointer to the first rhs row
+ * @param[in]       rhs_cols    Number of columns
+ * @param[in]       rhs_stride  Distance from the first to the second rhs row. 0 reads the first row twice
+ * @param[in, out]  res0        Accumulator for the first rhs row
+ * @param[in, out]  res1        Accumulator for the second rhs row
+ *
+ * @details         The inner loop holds the two accumulators, the lhs value, one rhs value, both pointers, the stride
+ *                  and the loop counter, which is all of the eight low registers the Thumb-1 data processing and load
+ *                  instructions can use. It is unrolled four times so the loop overhead and the pointer updates
+ *                  are paid once per four columns.
+ *
+ */
+__STATIC_FORCEINLINE void arm_nn_mac_1x2_s8(const q7_t *lhs,
+                                            const q7_t *rhs,
+                                            const int32_t rhs_cols,
+                                            const int32_t rhs_stride,
+                                            q31_t *res0,
+                                            q31_t *res1)
+{
+    q31_t acc0 = *res0;
+    q31_t acc1 = *res1;
+    int32_t col_count = rhs_cols >> 2;
+
+    while (col_count)
+    {
+        q31_t lhs_value = lhs[0];
+        acc0 += lhs_value * rhs[0];
+        acc1 += lhs_value * rhs[rhs_stride];
+        lhs_value = lhs[1];
+        acc0 += lhs_value * rhs[1];
+        acc1 += lhs_value * rhs[rhs_stride + 1];
+        lhs_value = lhs[2];
+        acc0 += lhs_value * rhs[2];
+        acc1 += lhs_value * rhs[rhs_stride + 2];
+        lhs_value = lhs[3];
+        acc0 += lhs_value * rhs[3];
+        acc1 += lhs_value * rhs[rhs_stride + 3];
+        lhs += 4;
+        rhs += 4;
+        col_count--;
+    }
+
+    col_count = rhs_cols & 0x3;
+    while (col_count)
+    {
+        q31_t lhs_value = *lhs++;
+        acc0 += lhs_value * rhs[0];
+        acc1 += lhs_value * rhs[rhs_stride];
+        rhs++;
+        col_count--;
+    }
+
+    *res0 = acc0;
+    *res1 = acc1;
+}
+
 /**
  * @brief           memcpy optimized for MVE
  * @param[in, out]  dst         Destination pointer
@@ -200,7 +200,9 @@ arm_status arm_convolve_s8(const cmsis_nn_context* ctx,
                                      out);
         }
 
-#elif defined(ARM_MATH_DSP)
+#elif defined(ARM_MATH_DSP) || defined(ARM_NN_M0PLUS)
+        /* The Cortex-M0+ has no SIMD, but the im2col buffer still lets the kernel reuse every weight for two
+           output pixels and takes the input offset out of the inner loop. */
         (void)bias_dims;
         int32_t i_out_y, i_out_x, i_ker_y, i_ker_x;
 
@@ -271,6 +273,7 @@ arm_status arm_convolve_s8(const cmsis_nn_context* ctx,
                 /* Point to the beginning of the im2col buffer where the input is available as a rearranged column */
                 const q15_t *ip_as_col = buffer_a;
 
+#if defined(ARM_MATH_DSP)
                 /* 4 multiply and accumulates are done in one loop. */
                 uint16_t col_count = (input_ch * kernel_y * kernel_x) >> 2;
 
@@ -290,6 +293,9 @@ arm_status arm_convolve_s8(const cmsis_nn_context* ctx,
                 }
                 /* Handle left over mac */
                 col_count = input_ch * kernel_y * kernel_x & 0x3;
+#else
+                uint16_t col_count = input_ch * kernel_y * kernel_x;
+#endif
                 while (col_count)
                 {
                     q7_t ker_a1 = *ker_a++;
@@ -368,7 +374,7 @@ arm_status arm_convolve_s8(const cmsis_nn_context* ctx,
 int32_t arm_convolve_s8_get_buffer_size(const cmsis_nn_dims* input_dims,
                                         const cmsis_nn_dims* filter_dims)
 {
-#if defined(ARM_MATH_DSP)
+#if defined(ARM_MATH_DSP) || defined(ARM_NN_M0PLUS)
     return (2 * input_dims->c * filter_dims->w * filter_dims->h) * (int32_t)sizeof(int16_t);
 #else
     (void)input_dims;
@@ -373,6 +373,18 @@ q7_t *arm_nn_mat_mult_kernel_s8_s16(const q7_t *input_a,
 
     /* return the new output pointer with offset */
     return out_0;
+#elif defined(ARM_NN_M0PLUS)
+    return arm_nn_mat_mult_kernel_s8_s16_m0plus(input_a,
+                                                input_b,
+                                                output_ch,
+                                                out_shift,
+                                                out_mult,
+                                                out_offset,
+                                                activation_min,
+                                                activation_max,
+                                                num_col_a,
+                                                output_bias,
+                                                out_0);
 #else
     (void)input_a;
     (void)input_b;
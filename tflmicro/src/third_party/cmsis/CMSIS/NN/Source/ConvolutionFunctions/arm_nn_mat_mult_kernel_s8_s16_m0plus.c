@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2010-2021 Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* ----------------------------------------------------------------------
+ * Project:      CMSIS NN Library
+ * Title:        arm_nn_mat_mult_kernel_s8_s16_m0plus.c
+ * Description:  Matrix-multiplication function for convolution, blocked for the Cortex-M0+
+ *
+ * $Date:        March 3 2021
+ * $Revision:    V.1.0.0
+ *
+ * Target Processor:  Cortex-M0+
+ * -------------------------------------------------------------------- */
+
+#include "arm_math.h"
+#include "arm_nnfunctions.h"
+#include "arm_nnsupportfunctions.h"
+
+/*
+   * Matrix-multiplication function for convolution with per-channel requantization, for the Cortex-M0+.
+   *
+   * Refer header file for details.
+   *
+   */
+
+q7_t *arm_nn_mat_mult_kernel_s8_s16_m0plus(const q7_t *input_a,
+                                           const q15_t *input_b,
+                                           const uint16_t output_ch,
+                                           const int32_t *out_shift,
+                                           const int32_t *out_mult,
+                                           const int32_t out_offset,
+                                           const int16_t activation_min,
+                                           const int16_t activation_max,
+                                           const uint16_t num_col_a,
+                                           const int32_t *const output_bias,
+                                           q7_t *out_0)
+{
+    /* One row of A against both columns of B keeps the two accumulators, the weight, one input value, both
+       pointers, the column distance and the loop counter in the eight low registers. */
+    const q7_t *ip_a0 = input_a;
+
+    for (int32_t ch = 0; ch < output_ch; ch++)
+    {
+        const q15_t *ip_b0 = input_b;
+
+        q31_t ch_0_out_0 = output_bias ? output_bias[ch] : 0;
+        q31_t ch_0_out_1 = ch_0_out_0;
+
+        uint16_t col_count = num_col_a >> 2;
+        while (col_count)
+        {
+            q31_t a0 = ip_a0[0];
+            ch_0_out_0 += a0 * ip_b0[0];
+            ch_0_out_1 += a0 * ip_b0[num_col_a];
+            a0 = ip_a0[1];
+            ch_0_out_0 += a0 * ip_b0[1];
+            ch_0_out_1 += a0 * ip_b0[num_col_a + 1];
+            a0 = ip_a0[2];
+            ch_0_out_0 += a0 * ip_b0[2];
+            ch_0_out_1 += a0 * ip_b0[num_col_a + 2];
+            a0 = ip_a0[3];
+            ch_0_out_0 += a0 * ip_b0[3];
+            ch_0_out_1 += a0 * ip_b0[num_col_a + 3];
+            ip_a0 += 4;
+            ip_b0 += 4;
+            col_count--;
+        }
+        col_count = num_col_a & 0x3;
+        while (col_count)
+        {
+            q31_t a0 = *ip_a0++;
+            ch_0_out_0 += a0 * ip_b0[0];
+            ch_0_out_1 += a0 * ip_b0[num_col_a];
+            ip_b0++;
+            col_count--;
+        }
+
+        out_0[ch] = arm_nn_requantize_clamp_s8(
+            ch_0_out_0, out_mult[ch], out_shift[ch], out_offset, activation_min, activation_max);
+        out_0[output_ch + ch] = arm_nn_requantize_clamp_s8(
+            ch_0_out_1, out_mult[ch], out_shift[ch], out_offset, activation_min, activation_max);
+    }
+
+    /* return the new output pointer with offset */
+    return out_0 + 2 * output_ch;
+}
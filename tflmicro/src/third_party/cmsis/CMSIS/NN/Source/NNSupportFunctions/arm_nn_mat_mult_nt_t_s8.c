@@ -408,6 +408,20 @@ arm_status arm_nn_mat_mult_nt_t_s8(const q7_t *lhs,
             dst_ptr += rhs_rows;
         }
     }
+#elif defined(ARM_NN_M0PLUS)
+    return arm_nn_mat_mult_nt_t_s8_m0plus(lhs,
+                                          rhs,
+                                          bias,
+                                          dst,
+                                          dst_multipliers,
+                                          dst_shifts,
+                                          lhs_rows,
+                                          rhs_rows,
+                                          rhs_cols,
+                                          lhs_offset,
+                                          dst_offset,
+                                          activation_min,
+                                          activation_max);
 #else
     for (int32_t rhs_rows_idx = 0; rhs_rows_idx <= (rhs_rows - 2); rhs_rows_idx += 2)
     {
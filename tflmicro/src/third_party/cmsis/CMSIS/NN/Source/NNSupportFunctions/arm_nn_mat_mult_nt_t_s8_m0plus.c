@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2020 Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* ----------------------------------------------------------------------
+ * Project:      CMSIS NN Library
+ * Title:        arm_nn_mat_mult_nt_t_s8_m0plus
+ * Description:  Matrix multiplication support function with the right-hand-side (rhs) matrix transposed,
+ *               blocked for the Cortex-M0+
+ *
+ * $Date:        March 3 2021
+ * $Revision:    V.1.0.0
+ *
+ * Target Processor:  Cortex-M0+
+ *
+ * -------------------------------------------------------------------- */
+
+#include "arm_math.h"
+#include "arm_nnfunctions.h"
+#include "arm_nnsupportfunctions.h"
+
+/**
+ * @ingroup groupSupport
+ */
+
+/**
+ * @addtogroup NNBasicMath
+ * @{
+ */
+
+/*
+ * s8 matrix multiplication with the right-hand-side matrix transposed, for the Cortex-M0+
+ *
+ * Refer header file for details.
+ *
+ */
+arm_status arm_nn_mat_mult_nt_t_s8_m0plus(const q7_t *lhs,
+                                          const q7_t *rhs,
+                                          const q31_t *bias,
+                                          q7_t *dst,
+                                          const int32_t *dst_multipliers,
+                                          const int32_t *dst_shifts,
+                                          const int32_t lhs_rows,
+                                          const int32_t rhs_rows,
+                                          const int32_t rhs_cols,
+                                          const int32_t lhs_offset,
+                                          const int32_t dst_offset,
+                                          const int32_t activation_min,
+                                          const int32_t activation_max)
+{
+    for (int32_t rhs_rows_idx = 0; rhs_rows_idx < rhs_rows; rhs_rows_idx += 2)
+    {
+        /* The last rhs row is paired with itself when there is an odd number of them */
+        const int32_t rhs_stride = (rhs_rows_idx + 1 < rhs_rows) ? rhs_cols : 0;
+        const int32_t rhs_rows_idx1 = rhs_rows_idx + (rhs_stride ? 1 : 0);
+
+        /* The lhs offset is folded into the starting value of every output of this pair of rhs rows */
+        q31_t lhs_offset_contribution0 = 0;
+        q31_t lhs_offset_contribution1 = 0;
+        for (int32_t x = 0; x < rhs_cols; ++x)
+        {
+            lhs_offset_contribution0 += rhs[x];
+            lhs_offset_contribution1 += rhs[x + rhs_stride];
+        }
+        lhs_offset_contribution0 *= lhs_offset;
+        lhs_offset_contribution1 *= lhs_offset;
+        if (bias)
+        {
+            lhs_offset_contribution0 += bias[rhs_rows_idx];
+            lhs_offset_contribution1 += bias[rhs_rows_idx1];
+        }
+
+        const q7_t *lhs_ptr = lhs;
+        q7_t *dst_ptr = dst + rhs_rows_idx;
+
+        for (int32_t lhs_rows_idx = 0; lhs_rows_idx < lhs_rows; ++lhs_rows_idx)
+        {
+            q31_t res0 = lhs_offset_contribution0;
+            q31_t res1 = lhs_offset_contribution1;
+
+            arm_nn_mac_1x2_s8(lhs_ptr, rhs, rhs_cols, rhs_stride, &res0, &res1);
+
+            dst_ptr[0] = arm_nn_requantize_clamp_s8(res0,
+                                                    dst_multipliers[rhs_rows_idx],
+                                                    dst_shifts[rhs_rows_idx],
+                                                    dst_offset,
+                                                    activation_min,
+                                                    activation_max);
+            if (rhs_stride)
+            {
+                dst_ptr[1] = arm_nn_requantize_clamp_s8(res1,
+                                                        dst_multipliers[rhs_rows_idx1],
+                                                        dst_shifts[rhs_rows_idx1],
+                                                        dst_offset,
+                                                        activation_min,
+                                                        activation_max);
+            }
+
+            lhs_ptr += rhs_cols;
+            dst_ptr += rhs_rows;
+        }
+
+        rhs += 2 * rhs_cols;
+    }
+
+    return ARM_MATH_SUCCESS;
+}
+
+/**
+ * @} end of NNBasicMath group
+ */
@@ -379,6 +379,20 @@ arm_status arm_nn_vec_mat_mult_t_s8(const q7_t *lhs,
         *dst = (q7_t)res00;
     }
 
+#elif defined(ARM_NN_M0PLUS)
+    return arm_nn_vec_mat_mult_t_s8_m0plus(lhs,
+                                           rhs,
+                                           bias,
+                                           dst,
+                                           lhs_offset,
+                                           rhs_offset,
+                                           dst_offset,
+                                           dst_multiplier,
+                                           dst_shift,
+                                           rhs_cols,
+                                           rhs_rows,
+                                           activation_min,
+                                           activation_max);
 #else
 
     for (int32_t rhs_rows_idx = 0; rhs_rows_idx <= (rhs_rows - 2); rhs_rows_idx += 2)
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2020-2021 Arm Limited or its affiliates. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* ----------------------------------------------------------------------
+ * Project:      CMSIS NN Library
+ * Title:        arm_nn_vec_mat_mult_t_s8_m0plus
+ * Description:  s8 vector by matrix (transposed) multiplication, blocked for the Cortex-M0+
+ *
+ * $Date:        March 3 2021
+ * $Revision:    V.1.0.0
+ *
+ * Target Processor:  Cortex-M0+
+ *
+ * -------------------------------------------------------------------- */
+
+#include "arm_math.h"
+#include "arm_nnfunctions.h"
+#include "arm_nnsupportfunctions.h"
+
+/**
+ * @ingroup groupSupport
+ */
+
+/**
+ * @addtogroup NNBasicMath
+ * @{
+ */
+
+/*
+ * Same as arm_nn_mac_1x2_s8, with the lhs offset added to every lhs value. The sum is shared by both rhs rows, so
+ * it costs one extra ADD per column.
+ */
+__STATIC_FORCEINLINE void mac_1x2_s8_lhs_offset(const q7_t *lhs,
+                                                const q7_t *rhs,
+                                                const int32_t rhs_cols,
+                                                const int32_t rhs_stride,
+                                                const int32_t lhs_offset,
+                                                q31_t *res0,
+                                                q31_t *res1)
+{
+    q31_t acc0 = *res0;
+    q31_t acc1 = *res1;
+    int32_t col_count = rhs_cols >> 2;
+
+    while (col_count)
+    {
+        q31_t lhs_value = lhs[0] + lhs_offset;
+        acc0 += lhs_value * rhs[0];
+        acc1 += lhs_value * rhs[rhs_stride];
+        lhs_value = lhs[1] + lhs_offset;
+        acc0 += lhs_value * rhs[1];
+        acc1 += lhs_value * rhs[rhs_stride + 1];
+        lhs_value = lhs[2] + lhs_offset;
+        acc0 += lhs_value * rhs[2];
+        acc1 += lhs_value * rhs[rhs_stride + 2];
+        lhs_value = lhs[3] + lhs_offset;
+        acc0 += lhs_value * rhs[3];
+        acc1 += lhs_value * rhs[rhs_stride + 3];
+        lhs += 4;
+        rhs += 4;
+        col_count--;
+    }
+
+    col_count = rhs_cols & 0x3;
+    while (col_count)
+    {
+        q31_t lhs_value = *lhs++ + lhs_offset;
+        acc0 += lhs_value * rhs[0];
+        acc1 += lhs_value * rhs[rhs_stride];
+        rhs++;
+        col_count--;
+    }
+
+    *res0 = acc0;
+    *res1 = acc1;
+}
+
+/*
+ * s8 vector(lhs) by matrix (transposed) multiplication for the Cortex-M0+
+ *
+ * Refer header file for details.
+ *
+ */
+arm_status arm_nn_vec_mat_mult_t_s8_m0plus(const q7_t *lhs,
+                                           const q7_t *rhs,
+                                           const q31_t *bias,
+                                           q7_t *dst,
+                                           const int32_t lhs_offset,
+                                           const int32_t rhs_offset,
+                                           const int32_t dst_offset,
+                                           const int32_t dst_multiplier,
+                                           const int32_t dst_shift,
+                                           const int32_t rhs_cols,
+                                           const int32_t rhs_rows,
+                                           const int32_t activation_min,
+                                           const int32_t activation_max)
+{
+    /* The rhs offset contributes rhs_offset * sum(lhs + lhs_offset) to every output, so it is added once up front */
+    q31_t rhs_offset_contribution = 0;
+    if (rhs_offset)
+    {
+        for (int32_t x = 0; x < rhs_cols; ++x)
+        {
+            rhs_offset_contribution += lhs[x] + lhs_offset;
+        }
+        rhs_offset_contribution *= rhs_offset;
+    }
+
+    for (int32_t rhs_rows_idx = 0; rhs_rows_idx < rhs_rows; rhs_rows_idx += 2)
+    {
+        /* The last rhs row is paired with itself when there is an odd number of them */
+        const int32_t rhs_stride = (rhs_rows_idx + 1 < rhs_rows) ? rhs_cols : 0;
+
+        q31_t res0 = rhs_offset_contribution;
+        q31_t res1 = rhs_offset_contribution;
+        if (bias)
+        {
+            res0 += bias[rhs_rows_idx];
+            res1 += bias[rhs_rows_idx + (rhs_stride ? 1 : 0)];
+        }
+
+        if (lhs_offset)
+        {
+            mac_1x2_s8_lhs_offset(lhs, rhs, rhs_cols, rhs_stride, lhs_offset, &res0, &res1);
+        }
+        else
+        {
+            arm_nn_mac_1x2_s8(lhs, rhs, rhs_cols, rhs_stride, &res0, &res1);
+        }
+
+        dst[rhs_rows_idx] =
+            arm_nn_requantize_clamp_s8(res0, dst_multiplier, dst_shift, dst_offset, activation_min, activation_max);
+        if (rhs_stride)
+        {
+            dst[rhs_rows_idx + 1] = arm_nn_requantize_clamp_s8(
+                res1, dst_multiplier, dst_shift, dst_offset, activation_min, activation_max);
+        }
+
+        rhs += 2 * rhs_cols;
+    }
+
+    return ARM_MATH_SUCCESS;
+}
+
+/**
+ * @} end of NNBasicMath group
+ */
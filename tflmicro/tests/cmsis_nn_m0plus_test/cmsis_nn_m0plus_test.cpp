@@ -0,0 +1,262 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks the Cortex-M0+ CMSIS-NN matrix kernels against the arithmetic of the
+// portable scalar branch, and reports how many inner loop cycles each variant
+// takes on a simple model of the M0+ pipeline.
+
+#include <cstdint>
+#include <cstring>
+
+#include "CMSIS/NN/Include/arm_nnfunctions.h"
+#include "CMSIS/NN/Include/arm_nnsupportfunctions.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace {
+
+constexpr int kMaxLhsRows = 5;
+constexpr int kMaxRhsRows = 9;
+constexpr int kMaxCols = 37;
+
+int8_t lhs[kMaxLhsRows * kMaxCols];
+int8_t rhs[kMaxRhsRows * kMaxCols];
+int16_t lhs_q15[2 * kMaxCols];
+int32_t bias[kMaxRhsRows];
+int32_t multipliers[kMaxRhsRows];
+int32_t shifts[kMaxRhsRows];
+int8_t expected[kMaxLhsRows * kMaxRhsRows];
+int8_t actual[2 * kMaxLhsRows * kMaxRhsRows];
+
+uint32_t seed = 1;
+
+int32_t Random(int32_t min, int32_t max) {
+  seed = seed * 1103515245 + 12345;
+  return min + static_cast<int32_t>((seed >> 8) % (max - min + 1));
+}
+
+void FillOperands(int lhs_rows, int rhs_rows, int cols) {
+  for (int i = 0; i < lhs_rows * cols; ++i) {
+    lhs[i] = Random(-128, 127);
+  }
+  for (int i = 0; i < 2 * cols; ++i) {
+    lhs_q15[i] = Random(-255, 255);
+  }
+  for (int i = 0; i < rhs_rows * cols; ++i) {
+    rhs[i] = Random(-128, 127);
+  }
+  for (int i = 0; i < rhs_rows; ++i) {
+    bias[i] = Random(-100000, 100000);
+    multipliers[i] = Random(1 << 30, INT32_MAX);
+    shifts[i] = Random(-12, 1);
+  }
+}
+
+int8_t Requantize(int32_t acc, int channel, bool per_channel, int32_t offset,
+                  int32_t min, int32_t max) {
+  const int c = per_channel ? channel : 0;
+  acc = arm_nn_requantize(acc, multipliers[c], shifts[c]) + offset;
+  return static_cast<int8_t>(MIN(MAX(acc, min), max));
+}
+
+// Output [r][c] of lhs * transposed(rhs), the way the scalar branches compute
+// it: every operand has its offset added before the multiplication.
+int32_t Accumulate(int r, int c, int cols, const int32_t* row_bias,
+                   int32_t lhs_offset, int32_t rhs_offset) {
+  int32_t acc = row_bias ? row_bias[c] : 0;
+  for (int k = 0; k < cols; ++k) {
+    acc += (lhs[r * cols + k] + lhs_offset) * (rhs[c * cols + k] + rhs_offset);
+  }
+  return acc;
+}
+
+// A cycle-approximate model of an inner loop on the Cortex-M0+. Every load and
+// store is 2 cycles, every ALU op and MULS is 1, the taken branch back to the
+// top is 2. LDRSB and LDRSH only have a register-offset form, so a load at an
+// offset that is not already held in a register costs one more ALU op to form
+// it. Values live across the loop beyond the eight low registers are spilled
+// and reloaded, 2 cycles each per iteration. Requantization and the code
+// outside the innermost loop are not modelled.
+struct LoopModel {
+  const char* name;
+  int loads;
+  int offset_ops;
+  int alu_ops;
+  int live_values;
+  int macs;  // Multiply-accumulates per iteration.
+};
+
+int32_t CyclesPerIteration(const LoopModel& loop) {
+  const int spills = loop.live_values > 8 ? loop.live_values - 8 : 0;
+  return 2 * loop.loads + loop.offset_ops + loop.alu_ops + 2 + 2 * spills;
+}
+
+// arm_nn_mat_mult_nt_t_s8, scalar: a 2x2 block per column. 4 loads, 4 MULS,
+// 4 ADDS, 2 pointer and 2 counter updates. Live: 4 accumulators, 3 values, 2
+// pointers, the row stride, the counter and its bound.
+constexpr LoopModel kScalarMatMult = {"scalar mat_mult_nt_t", 4, 0, 12, 12, 4};
+// arm_nn_vec_mat_mult_t_s8, scalar: a 1x2 block per column. 3 loads, 3 offset
+// ADDS, 2 MULS, 2 ADDS, 2 pointer and 2 counter updates. Live: 2 accumulators,
+// 2 values, 2 pointers, the row stride, 2 offsets and the counter.
+constexpr LoopModel kScalarVecMatMult = {"scalar vec_mat_mult_t", 3, 0, 11,
+                                         10, 2};
+// arm_convolve_s8, scalar: one MAC per innermost iteration. 2 loads, an
+// offset ADDS, MULS, ADDS, 2 index updates and the compare.
+constexpr LoopModel kScalarConvolve = {"scalar convolve", 2, 0, 6, 9, 1};
+// arm_nn_mac_1x2_s8 and the M0+ kernels: a 1x2 block, 4 columns per
+// iteration. 12 loads, 9 of them at offsets that need forming, 8 MULS, 8
+// ADDS, 2 pointer updates and SUBS on the counter. Live: 2 accumulators, 2
+// values, 2 pointers, the row stride and the counter.
+constexpr LoopModel kM0PlusMac1x2 = {"m0plus 1x2x4", 12, 9, 19, 8, 8};
+// As above with the lhs offset added to each of the 4 lhs values, and the
+// offset itself live.
+constexpr LoopModel kM0PlusMac1x2Offset = {"m0plus 1x2x4 offset", 12, 9, 23,
+                                           9, 8};
+
+void ReportCycles(const char* what, const LoopModel& before,
+                  const LoopModel& after, int32_t macs) {
+  const int32_t before_cycles =
+      (macs + before.macs - 1) / before.macs * CyclesPerIteration(before);
+  const int32_t after_cycles =
+      (macs + after.macs - 1) / after.macs * CyclesPerIteration(after);
+  TF_LITE_REPORT_ERROR(micro_test::reporter,
+                       "%s: %d MACs, %s %d cycles, %s %d cycles", what,
+                       static_cast<int>(macs), before.name,
+                       static_cast<int>(before_cycles), after.name,
+                       static_cast<int>(after_cycles));
+  TF_LITE_MICRO_EXPECT_LT(after_cycles, before_cycles);
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(MatMultNtTMatchesScalar) {
+  for (int lhs_rows = 1; lhs_rows <= kMaxLhsRows; ++lhs_rows) {
+    for (int rhs_rows = 1; rhs_rows <= kMaxRhsRows; ++rhs_rows) {
+      for (int cols = 1; cols <= kMaxCols; cols += 3) {
+        FillOperands(lhs_rows, rhs_rows, cols);
+        const int32_t lhs_offset = Random(-127, 128);
+        const int32_t dst_offset = Random(-128, 127);
+        const int32_t* row_bias = (cols % 2) ? bias : nullptr;
+        for (int r = 0; r < lhs_rows; ++r) {
+          for (int c = 0; c < rhs_rows; ++c) {
+            expected[r * rhs_rows + c] =
+                Requantize(Accumulate(r, c, cols, row_bias, lhs_offset, 0), c,
+                           true, dst_offset, -128, 127);
+          }
+        }
+        const int outputs = lhs_rows * rhs_rows;
+
+        memset(actual, 0x55, sizeof(actual));
+        TF_LITE_MICRO_EXPECT_EQ(
+            ARM_MATH_SUCCESS,
+            arm_nn_mat_mult_nt_t_s8_m0plus(
+                lhs, rhs, row_bias, actual, multipliers, shifts, lhs_rows,
+                rhs_rows, cols, lhs_offset, dst_offset, -128, 127));
+        TF_LITE_MICRO_EXPECT_EQ(0, memcmp(expected, actual, outputs));
+        // Nothing past the output is touched.
+        TF_LITE_MICRO_EXPECT_EQ(0x55, actual[outputs]);
+
+        memset(actual, 0x55, sizeof(actual));
+        TF_LITE_MICRO_EXPECT_EQ(
+            ARM_MATH_SUCCESS,
+            arm_nn_mat_mult_nt_t_s8(lhs, rhs, row_bias, actual, multipliers,
+                                    shifts, lhs_rows, rhs_rows, cols,
+                                    lhs_offset, dst_offset, -128, 127));
+        TF_LITE_MICRO_EXPECT_EQ(0, memcmp(expected, actual, outputs));
+      }
+    }
+  }
+}
+
+TF_LITE_MICRO_TEST(VecMatMultMatchesScalar) {
+  for (int rhs_rows = 1; rhs_rows <= kMaxRhsRows; ++rhs_rows) {
+    for (int cols = 1; cols <= kMaxCols; ++cols) {
+      FillOperands(1, rhs_rows, cols);
+      // Both the offset-free inner loop and the one with the lhs offset.
+      const int32_t lhs_offset = (cols % 3) ? Random(-127, 128) : 0;
+      const int32_t rhs_offset = (cols % 4) ? 0 : Random(-127, 128);
+      const int32_t dst_offset = Random(-128, 127);
+      const int32_t act_min = Random(-128, -1);
+      const int32_t act_max = Random(0, 127);
+      for (int c = 0; c < rhs_rows; ++c) {
+        expected[c] =
+            Requantize(Accumulate(0, c, cols, bias, lhs_offset, rhs_offset),
+                       c, false, dst_offset, act_min, act_max);
+      }
+
+      memset(actual, 0x55, sizeof(actual));
+      TF_LITE_MICRO_EXPECT_EQ(
+          ARM_MATH_SUCCESS,
+          arm_nn_vec_mat_mult_t_s8_m0plus(
+              lhs, rhs, bias, actual, lhs_offset, rhs_offset, dst_offset,
+              multipliers[0], shifts[0], cols, rhs_rows, act_min, act_max));
+      TF_LITE_MICRO_EXPECT_EQ(0, memcmp(expected, actual, rhs_rows));
+      TF_LITE_MICRO_EXPECT_EQ(0x55, actual[rhs_rows]);
+
+      memset(actual, 0x55, sizeof(actual));
+      TF_LITE_MICRO_EXPECT_EQ(
+          ARM_MATH_SUCCESS,
+          arm_nn_vec_mat_mult_t_s8(lhs, rhs, bias, actual, lhs_offset,
+                                   rhs_offset, dst_offset, multipliers[0],
+                                   shifts[0], cols, rhs_rows, act_min,
+                                   act_max));
+      TF_LITE_MICRO_EXPECT_EQ(0, memcmp(expected, actual, rhs_rows));
+    }
+  }
+}
+
+TF_LITE_MICRO_TEST(MatMultKernelS8S16MatchesScalar) {
+  for (int output_ch = 1; output_ch <= kMaxRhsRows; ++output_ch) {
+    for (int cols = 1; cols <= kMaxCols; ++cols) {
+      FillOperands(0, output_ch, cols);
+      const int32_t out_offset = Random(-128, 127);
+      const int32_t* output_bias = (cols % 5) ? bias : nullptr;
+      // The kernel takes the im2col columns with the input offset already
+      // added, so they are multiplied as they are.
+      for (int column = 0; column < 2; ++column) {
+        for (int ch = 0; ch < output_ch; ++ch) {
+          int32_t acc = output_bias ? output_bias[ch] : 0;
+          for (int k = 0; k < cols; ++k) {
+            acc += rhs[ch * cols + k] * lhs_q15[column * cols + k];
+          }
+          expected[column * output_ch + ch] =
+              Requantize(acc, ch, true, out_offset, -128, 127);
+        }
+      }
+
+      memset(actual, 0x55, sizeof(actual));
+      int8_t* end = arm_nn_mat_mult_kernel_s8_s16_m0plus(
+          rhs, lhs_q15, output_ch, shifts, multipliers, out_offset, -128, 127,
+          cols, output_bias, actual);
+      TF_LITE_MICRO_EXPECT(end == actual + 2 * output_ch);
+      TF_LITE_MICRO_EXPECT_EQ(0, memcmp(expected, actual, 2 * output_ch));
+      TF_LITE_MICRO_EXPECT_EQ(0x55, actual[2 * output_ch]);
+    }
+  }
+}
+
+TF_LITE_MICRO_TEST(ReportModelledCycles) {
+  // Layer shapes of the size found in small vision models.
+  ReportCycles("1x1 conv 24x24x64->64", kScalarMatMult, kM0PlusMac1x2,
+               24 * 24 * 64 * 64);
+  ReportCycles("3x3 conv 48x48x1->8", kScalarConvolve, kM0PlusMac1x2,
+               48 * 48 * 9 * 8);
+  ReportCycles("fc 256->2", kScalarVecMatMult, kM0PlusMac1x2, 256 * 2);
+  ReportCycles("fc 256->2 with input offset", kScalarVecMatMult,
+               kM0PlusMac1x2Offset, 256 * 2);
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,175 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/memory_planner/interval_memory_planner.h"
+
+#include "tensorflow/lite/micro/memory_planner/greedy_memory_planner.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace {
+constexpr int kMaxBuffers = 300;
+unsigned char g_greedy_scratch[kMaxBuffers * 40];
+unsigned char g_interval_scratch[kMaxBuffers * 44];
+
+struct TestBuffer {
+  int size;
+  int first_time_used;
+  int last_time_used;
+  int offline_offset;
+};
+
+// Plans the buffers with both planners. Every buffer has to land where the
+// GreedyMemoryPlanner puts it, so the arena is never larger.
+void ExpectSamePlan(const TestBuffer* buffers, int count,
+                    size_t expected_size) {
+  tflite::MicroErrorReporter micro_error_reporter;
+  tflite::GreedyMemoryPlanner greedy(g_greedy_scratch,
+                                     sizeof(g_greedy_scratch));
+  tflite::IntervalMemoryPlanner planner(g_interval_scratch,
+                                        sizeof(g_interval_scratch));
+  for (int i = 0; i < count; ++i) {
+    const TestBuffer& b = buffers[i];
+    if (b.offline_offset == tflite::kOnlinePlannedBuffer) {
+      TF_LITE_MICRO_EXPECT_EQ(
+          kTfLiteOk, greedy.AddBuffer(&micro_error_reporter, b.size,
+                                      b.first_time_used, b.last_time_used));
+      TF_LITE_MICRO_EXPECT_EQ(
+          kTfLiteOk, planner.AddBuffer(&micro_error_reporter, b.size,
+                                       b.first_time_used, b.last_time_used));
+    } else {
+      TF_LITE_MICRO_EXPECT_EQ(
+          kTfLiteOk,
+          greedy.AddBuffer(&micro_error_reporter, b.size, b.first_time_used,
+                           b.last_time_used, b.offline_offset));
+      TF_LITE_MICRO_EXPECT_EQ(
+          kTfLiteOk,
+          planner.AddBuffer(&micro_error_reporter, b.size, b.first_time_used,
+                            b.last_time_used, b.offline_offset));
+    }
+  }
+  TF_LITE_MICRO_EXPECT_EQ(count, planner.GetBufferCount());
+  for (int i = 0; i < count; ++i) {
+    int greedy_offset = -1;
+    int offset = -1;
+    TF_LITE_MICRO_EXPECT_EQ(
+        kTfLiteOk,
+        greedy.GetOffsetForBuffer(&micro_error_reporter, i, &greedy_offset));
+    TF_LITE_MICRO_EXPECT_EQ(
+        kTfLiteOk, planner.GetOffsetForBuffer(&micro_error_reporter, i, &offset));
+    TF_LITE_MICRO_EXPECT_EQ(greedy_offset, offset);
+  }
+  TF_LITE_MICRO_EXPECT_EQ(greedy.GetMaximumMemorySize(),
+                          planner.GetMaximumMemorySize());
+  if (expected_size != 0) {
+    TF_LITE_MICRO_EXPECT_EQ(expected_size, planner.GetMaximumMemorySize());
+  }
+  TF_LITE_MICRO_EXPECT_EQ(greedy.DoAnyBuffersOverlap(&micro_error_reporter),
+                          planner.DoAnyBuffersOverlap(&micro_error_reporter));
+}
+
+uint32_t g_seed = 1;
+
+int NextRandom(int range) {
+  g_seed = g_seed * 1103515245 + 12345;
+  return (g_seed >> 8) % range;
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestIntervalBasics) {
+  const TestBuffer buffers[] = {{10, 0, 1, -1}, {20, 2, 3, -1}};
+  ExpectSamePlan(buffers, 2, 20);
+}
+
+TF_LITE_MICRO_TEST(TestIntervalMedium) {
+  const TestBuffer buffers[] = {
+      {10, 0, 1, -1}, {20, 1, 2, -1}, {30, 2, 3, -1},
+      {40, 3, 4, -1}, {50, 0, 1, -1},
+  };
+  ExpectSamePlan(buffers, 5, 90);
+}
+
+TF_LITE_MICRO_TEST(TestPersonDetectionModel) {
+  // The buffers of the same test for the GreedyMemoryPlanner, taken from the
+  // 250KB MobileNet model used in the person detection example.
+  const TestBuffer buffers[] = {
+      {9216, 0, 29, -1},  {3, 28, 29, -1},    {256, 27, 28, -1},
+      {2304, 26, 27, -1}, {2304, 25, 26, -1}, {2304, 24, 25, -1},
+      {1152, 23, 24, -1}, {4608, 22, 23, -1}, {4608, 21, 22, -1},
+      {4608, 20, 21, -1}, {4608, 19, 20, -1}, {4608, 18, 19, -1},
+      {4608, 17, 18, -1}, {4608, 16, 17, -1}, {4608, 15, 16, -1},
+      {4608, 14, 15, -1}, {4608, 13, 14, -1}, {4608, 12, 13, -1},
+      {2304, 11, 12, -1}, {9216, 10, 11, -1}, {9216, 9, 10, -1},
+      {9216, 8, 9, -1},   {4608, 7, 8, -1},   {18432, 6, 7, -1},
+      {18432, 5, 6, -1},  {18432, 4, 5, -1},  {9216, 3, 4, -1},
+      {36864, 2, 3, -1},  {18432, 1, 2, -1},  {18432, 0, 1, -1},
+  };
+  ExpectSamePlan(buffers, 30, 0);
+}
+
+TF_LITE_MICRO_TEST(TestOverlapCase) {
+  const TestBuffer buffers[] = {{100, 0, 1, -1}, {50, 2, 3, -1}, {20, 1, 2, -1}};
+  ExpectSamePlan(buffers, 3, 120);
+}
+
+TF_LITE_MICRO_TEST(TestOfflinePlannedBuffers) {
+  // Fixed buffers go where they are told, the others in the gaps.
+  const TestBuffer buffers[] = {
+      {20, 0, 1, 0},  {10, 0, 3, -1}, {30, 1, 2, 40},
+      {20, 2, 3, -1}, {16, 0, 0, 20}, {40, 3, 4, -1},
+  };
+  ExpectSamePlan(buffers, 6, 0);
+}
+
+TF_LITE_MICRO_TEST(TestEqualSizes) {
+  // Of the same size the last added is placed first, as in the greedy plan.
+  const TestBuffer buffers[] = {
+      {32, 0, 2, -1}, {32, 1, 3, -1}, {32, 2, 4, -1},
+      {32, 0, 4, -1}, {16, 1, 1, -1}, {32, 3, 5, -1},
+  };
+  ExpectSamePlan(buffers, 6, 0);
+}
+
+TF_LITE_MICRO_TEST(TestRandomGraphs) {
+  static TestBuffer buffers[kMaxBuffers];
+  for (int graph = 0; graph < 40; ++graph) {
+    const int count = 1 + NextRandom(kMaxBuffers);
+    const int ops = 1 + NextRandom(count);
+    for (int i = 0; i < count; ++i) {
+      buffers[i].size = 16 * (1 + NextRandom(64));
+      buffers[i].first_time_used = NextRandom(ops);
+      buffers[i].last_time_used =
+          buffers[i].first_time_used + NextRandom(1 + NextRandom(ops));
+      buffers[i].offline_offset = tflite::kOnlinePlannedBuffer;
+    }
+    ExpectSamePlan(buffers, count, 0);
+  }
+}
+
+TF_LITE_MICRO_TEST(TestSmallScratch) {
+  tflite::MicroErrorReporter micro_error_reporter;
+
+  constexpr int scratch_buffer_size = 44;
+  unsigned char scratch_buffer[scratch_buffer_size];
+  tflite::IntervalMemoryPlanner planner(scratch_buffer, scratch_buffer_size);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(&micro_error_reporter, 100, 0, 1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          planner.AddBuffer(&micro_error_reporter, 50, 2, 3));
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -160,6 +160,21 @@ TF_LITE_MICRO_TEST(TwoInputsAllAxesCombinations) {
       output_shape_axis1, output_value_axis1, output_data);
 }
 
+TF_LITE_MICRO_TEST(TwoInputsPlannedInPlace) {
+  // The first input is planned as the first half of the output, as the
+  // allocator does when the dimensions before the axis are all 1.
+  const int input_shape[] = {3, 1, 2, 3};
+  const float input2_value[] = {7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f};
+  const int output_shape[] = {3, 1, 4, 3};
+  const float output_value[] = {1.0f, 2.0f, 3.0f, 4.0f,  5.0f,  6.0f,
+                                7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f};
+
+  float output_data[12] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  tflite::testing::TestConcatenateTwoInputs(
+      input_shape, output_data, input_shape, input2_value, /* axis */ 1,
+      output_shape, output_value, output_data);
+}
+
 TF_LITE_MICRO_TEST(TwoInputsQuantizedUint8) {
   const int axis = 2;
   const int input_shape[] = {3, 2, 1, 2};
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/micro_pipeline.h"
 #include "tensorflow/lite/micro/micro_utils.h"
 #include "tensorflow/lite/micro/test_helpers.h"
 #include "tensorflow/lite/micro/testing/micro_test.h"
@@ -80,14 +81,19 @@ TfLiteStatus ValidateConvGoldens(TfLiteTensor* tensors, int tensors_size,
                                  int output_length,
                                  TfLiteConvParams* conv_params,
                                  float tolerance = 1e-5) {
-  TfLiteStatus status = InvokeConv(tensors, tensors_size, output_data,
-                                   output_length, conv_params);
-  if (status != kTfLiteOk) {
-    return status;
-  }
-  for (int i = 0; i < output_length; ++i) {
-    TF_LITE_MICRO_EXPECT_NEAR(expected_output_data[i], output_data[i],
-                              tolerance);
+  // Every vector is also run with the kernel split across both cores.
+  for (int split = 0; split < 2; ++split) {
+    PipelineSetKernelSplit(split == 1);
+    TfLiteStatus status = InvokeConv(tensors, tensors_size, output_data,
+                                     output_length, conv_params);
+    PipelineSetKernelSplit(false);
+    if (status != kTfLiteOk) {
+      return status;
+    }
+    for (int i = 0; i < output_length; ++i) {
+      TF_LITE_MICRO_EXPECT_NEAR(expected_output_data[i], output_data[i],
+                                tolerance);
+    }
   }
   return kTfLiteOk;
 }
@@ -227,6 +233,123 @@ void TestConvQuantizedPerChannel(
                           output_data, output_dims_count, conv_params,
                           1.0 /* tolerance */));
 }
+
+// Runs an int8 convolution over pseudo-random data with and without the output
+// rows split across both cores, and expects identical outputs.
+void TestSplitMatchesSingleCore(int input_height, int input_width,
+                                int input_depth, int filter_size,
+                                int output_depth, TfLitePadding padding,
+                                int stride) {
+  constexpr int kMaxElements = 2048;
+  constexpr int kMaxChannels = 16;
+  const int output_height =
+      padding == kTfLitePaddingSame
+          ? (input_height + stride - 1) / stride
+          : (input_height - filter_size + stride) / stride;
+  const int output_width =
+      padding == kTfLitePaddingSame
+          ? (input_width + stride - 1) / stride
+          : (input_width - filter_size + stride) / stride;
+  const int input_shape[] = {4, 1, input_height, input_width, input_depth};
+  const int filter_shape[] = {4, output_depth, filter_size, filter_size,
+                              input_depth};
+  const int bias_shape[] = {1, output_depth};
+  const int output_shape[] = {4, 1, output_height, output_width, output_depth};
+  const int input_elements = input_height * input_width * input_depth;
+  const int filter_elements =
+      output_depth * filter_size * filter_size * input_depth;
+  const int output_elements = output_height * output_width * output_depth;
+  TF_LITE_MICRO_EXPECT_LE(input_elements, kMaxElements);
+  TF_LITE_MICRO_EXPECT_LE(filter_elements, kMaxElements);
+  TF_LITE_MICRO_EXPECT_LE(output_elements, kMaxElements);
+  TF_LITE_MICRO_EXPECT_LE(output_depth, kMaxChannels);
+
+  static float input_data[kMaxElements];
+  static float filter_data[kMaxElements];
+  float bias_data[kMaxChannels];
+  uint32_t seed = input_height * 131 + filter_size * 7 + stride;
+  for (int i = 0; i < input_elements; ++i) {
+    seed = seed * 1103515245 + 12345;
+    input_data[i] = static_cast<float>((seed >> 16) % 255) / 16.0f - 8.0f;
+  }
+  for (int i = 0; i < filter_elements; ++i) {
+    seed = seed * 1103515245 + 12345;
+    filter_data[i] = static_cast<float>((seed >> 16) % 255) / 32.0f - 4.0f;
+  }
+  for (int i = 0; i < output_depth; ++i) {
+    bias_data[i] = i - output_depth / 2;
+  }
+
+  const float input_scale = 0.0625f;
+  const int input_zero_point = -3;
+  const float output_scale = 2.0f;
+  const int output_zero_point = 5;
+  static int8_t input_quantized[kMaxElements];
+  static int8_t filter_quantized[kMaxElements];
+  int32_t bias_quantized[kMaxChannels];
+  static int8_t single_core_output[kMaxElements];
+  static int8_t split_output[kMaxElements];
+
+  int filter_zero_points[kMaxChannels + 1];
+  float filter_scales[kMaxChannels + 1];
+  int bias_zero_points[kMaxChannels + 1];
+  float bias_scales[kMaxChannels + 1];
+  TfLiteAffineQuantization filter_quant;
+  TfLiteAffineQuantization bias_quant;
+  TfLiteTensor input_tensor = CreateQuantizedTensor(
+      input_data, input_quantized, IntArrayFromInts(input_shape), input_scale,
+      input_zero_point);
+  TfLiteTensor filter_tensor = CreateSymmetricPerChannelQuantizedTensor(
+      filter_data, filter_quantized, IntArrayFromInts(filter_shape),
+      filter_scales, filter_zero_points, &filter_quant,
+      0 /* quantized dimension */);
+  TfLiteTensor bias_tensor = CreatePerChannelQuantizedBiasTensor(
+      bias_data, bias_quantized, IntArrayFromInts(bias_shape), input_scale,
+      &filter_scales[1], bias_scales, bias_zero_points, &bias_quant,
+      0 /* quantized dimension */);
+  TfLiteTensor output_tensor =
+      CreateQuantizedTensor(single_core_output, IntArrayFromInts(output_shape),
+                            output_scale, output_zero_point);
+
+  float input_scales[] = {1, input_scale};
+  int input_zero_points[] = {1, input_zero_point};
+  TfLiteAffineQuantization input_quant = {FloatArrayFromFloats(input_scales),
+                                          IntArrayFromInts(input_zero_points),
+                                          0};
+  input_tensor.quantization = {kTfLiteAffineQuantization, &input_quant};
+
+  float output_scales[] = {1, output_scale};
+  int output_zero_points[] = {1, output_zero_point};
+  TfLiteAffineQuantization output_quant = {FloatArrayFromFloats(output_scales),
+                                           IntArrayFromInts(output_zero_points),
+                                           0};
+  output_tensor.quantization = {kTfLiteAffineQuantization, &output_quant};
+
+  constexpr int tensors_size = 4;
+  TfLiteTensor tensors[tensors_size] = {
+      input_tensor,
+      filter_tensor,
+      bias_tensor,
+      output_tensor,
+  };
+
+  TfLiteConvParams conv_params = {padding, stride,          stride,
+                                  kTfLiteActRelu6, 1, 1};
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, InvokeConv(tensors, tensors_size, single_core_output,
+                            output_elements, &conv_params));
+
+  tensors[3].data.int8 = split_output;
+  PipelineSetKernelSplit(true);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          InvokeConv(tensors, tensors_size, split_output,
+                                     output_elements, &conv_params));
+  PipelineSetKernelSplit(false);
+
+  for (int i = 0; i < output_elements; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(single_core_output[i], split_output[i]);
+  }
+}
 #endif  // !defined(XTENSA)
 
 }  // namespace
@@ -885,4 +1008,20 @@ TF_LITE_MICRO_TEST(Int8Input32x1Filter32x32ShouldMatchGolden) {
                      output_dims_count, &conv_params, kQuantizationTolerance));
 }
 
+#if !defined(XTENSA)
+TF_LITE_MICRO_TEST(SplitAcrossCoresMatchesSingleCore) {
+  using tflite::testing::TestSplitMatchesSingleCore;
+  // 3x3 with padding, where the second half starts inside or past the padding.
+  TestSplitMatchesSingleCore(2, 5, 4, 3, 3, kTfLitePaddingSame, 1);
+  TestSplitMatchesSingleCore(2, 4, 4, 5, 3, kTfLitePaddingSame, 1);
+  TestSplitMatchesSingleCore(9, 7, 4, 3, 5, kTfLitePaddingSame, 1);
+  TestSplitMatchesSingleCore(11, 6, 3, 3, 4, kTfLitePaddingSame, 2);
+  TestSplitMatchesSingleCore(10, 10, 8, 5, 2, kTfLitePaddingSame, 2);
+  TestSplitMatchesSingleCore(12, 5, 4, 3, 6, kTfLitePaddingValid, 1);
+  TestSplitMatchesSingleCore(13, 9, 2, 3, 3, kTfLitePaddingValid, 3);
+  // 1x1, which goes through arm_convolve_1x1_s8_fast.
+  TestSplitMatchesSingleCore(7, 6, 8, 1, 16, kTfLitePaddingValid, 1);
+}
+#endif  // !defined(XTENSA)
+
 TF_LITE_MICRO_TESTS_END
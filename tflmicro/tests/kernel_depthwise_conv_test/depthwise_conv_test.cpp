@@ -17,6 +17,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/micro/kernels/kernel_runner.h"
+#include "tensorflow/lite/micro/micro_pipeline.h"
 #include "tensorflow/lite/micro/test_helpers.h"
 #include "tensorflow/lite/micro/testing/micro_test.h"
 
@@ -50,9 +51,6 @@ TfLiteStatus ValidateDepthwiseConvGoldens(
   TfLiteIntArray* outputs_array = IntArrayFromInts(outputs_array_data);
 
   const TfLiteRegistration registration = Register_DEPTHWISE_CONV_2D();
-  micro::KernelRunner runner(
-      registration, tensors, tensors_size, inputs_array, outputs_array,
-      reinterpret_cast<void*>(conv_params), micro_test::reporter);
 
   int input_depth = tensors[0].dims->data[3];
   int output_depth = tensors[1].dims->data[3];
@@ -65,17 +63,28 @@ TfLiteStatus ValidateDepthwiseConvGoldens(
 
   const char* init_data = reinterpret_cast<const char*>(conv_params);
 
-  // TODO(b/154240825): Use a test macro here which fails and returns.
-  TfLiteStatus status = runner.InitAndPrepare(init_data);
-  if (status != kTfLiteOk) {
-    return status;
-  }
-  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
-
-  const T* output_data = tflite::GetTensorData<T>(&tensors[kOutputTensorIndex]);
-  for (int i = 0; i < output_length; ++i) {
-    TF_LITE_MICRO_EXPECT_NEAR(expected_output_data[i], output_data[i],
-                              tolerance);
+  // Every vector is also run with the kernel split across both cores.
+  for (int split = 0; split < 2; ++split) {
+    micro::KernelRunner runner(
+        registration, tensors, tensors_size, inputs_array, outputs_array,
+        reinterpret_cast<void*>(conv_params), micro_test::reporter);
+
+    // TODO(b/154240825): Use a test macro here which fails and returns.
+    PipelineSetKernelSplit(split == 1);
+    TfLiteStatus status = runner.InitAndPrepare(init_data);
+    if (status != kTfLiteOk) {
+      PipelineSetKernelSplit(false);
+      return status;
+    }
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+    PipelineSetKernelSplit(false);
+
+    const T* output_data =
+        tflite::GetTensorData<T>(&tensors[kOutputTensorIndex]);
+    for (int i = 0; i < output_length; ++i) {
+      TF_LITE_MICRO_EXPECT_NEAR(expected_output_data[i], output_data[i],
+                                tolerance);
+    }
   }
   return kTfLiteOk;
 }
@@ -229,6 +238,136 @@ void TestDepthwiseConvQuantizedPerChannel(
                                               1.0, tensors_size, tensors));
 }
 
+
+// Runs an int8 depthwise convolution over pseudo-random data with and without
+// the output rows split across both cores, and expects identical outputs.
+void TestSplitMatchesSingleCore(int input_height, int input_width,
+                                int input_depth, int depth_multiplier,
+                                int filter_size, TfLitePadding padding,
+                                int stride) {
+  constexpr int kMaxElements = 2048;
+  const int output_depth = input_depth * depth_multiplier;
+  const int output_height =
+      padding == kTfLitePaddingSame
+          ? (input_height + stride - 1) / stride
+          : (input_height - filter_size + stride) / stride;
+  const int output_width =
+      padding == kTfLitePaddingSame
+          ? (input_width + stride - 1) / stride
+          : (input_width - filter_size + stride) / stride;
+  const int input_shape[] = {4, 1, input_height, input_width, input_depth};
+  const int filter_shape[] = {4, 1, filter_size, filter_size, output_depth};
+  const int bias_shape[] = {1, output_depth};
+  const int output_shape[] = {4, 1, output_height, output_width, output_depth};
+  const int input_elements = input_height * input_width * input_depth;
+  const int filter_elements = filter_size * filter_size * output_depth;
+  const int output_elements = output_height * output_width * output_depth;
+  TF_LITE_MICRO_EXPECT_LE(input_elements, kMaxElements);
+  TF_LITE_MICRO_EXPECT_LE(filter_elements, kMaxElements);
+  TF_LITE_MICRO_EXPECT_LE(output_elements, kMaxElements);
+  TF_LITE_MICRO_EXPECT_LE(output_depth, kMaxBiasChannels);
+
+  static float input_data[kMaxElements];
+  static float filter_data[kMaxElements];
+  float bias_data[kMaxBiasChannels];
+  uint32_t seed = input_height * 131 + filter_size * 7 + stride;
+  for (int i = 0; i < input_elements; ++i) {
+    seed = seed * 1103515245 + 12345;
+    input_data[i] = static_cast<float>((seed >> 16) % 255) / 16.0f - 8.0f;
+  }
+  for (int i = 0; i < filter_elements; ++i) {
+    seed = seed * 1103515245 + 12345;
+    filter_data[i] = static_cast<float>((seed >> 16) % 255) / 32.0f - 4.0f;
+  }
+  for (int i = 0; i < output_depth; ++i) {
+    bias_data[i] = i - output_depth / 2;
+  }
+
+  const float input_scale = 0.0625f;
+  const int input_zero_point = -3;
+  const float output_scale = 0.5f;
+  const int output_zero_point = 5;
+  static int8_t input_quantized[kMaxElements];
+  static int8_t filter_quantized[kMaxElements];
+  int32_t bias_quantized[kMaxBiasChannels];
+  static int8_t single_core_output[kMaxElements];
+  static int8_t split_output[kMaxElements];
+
+  int filter_zero_points[kMaxFilterChannels];
+  float filter_scales[kMaxFilterChannels];
+  int bias_zero_points[kMaxBiasChannels];
+  float bias_scales[kMaxBiasChannels];
+  TfLiteAffineQuantization filter_quant;
+  TfLiteAffineQuantization bias_quant;
+  TfLiteTensor input_tensor = CreateQuantizedTensor(
+      input_data, input_quantized, IntArrayFromInts(input_shape), input_scale,
+      input_zero_point);
+  TfLiteTensor filter_tensor = CreateSymmetricPerChannelQuantizedTensor(
+      filter_data, filter_quantized, IntArrayFromInts(filter_shape),
+      filter_scales, filter_zero_points, &filter_quant,
+      3 /* quantized dimension */);
+  TfLiteTensor bias_tensor = CreatePerChannelQuantizedBiasTensor(
+      bias_data, bias_quantized, IntArrayFromInts(bias_shape), input_scale,
+      &filter_scales[1], bias_scales, bias_zero_points, &bias_quant,
+      0 /* quantized dimension */);
+  TfLiteTensor output_tensor =
+      CreateQuantizedTensor(single_core_output, IntArrayFromInts(output_shape),
+                            output_scale, output_zero_point);
+
+  float input_scales[] = {1, input_scale};
+  int input_zero_points[] = {1, input_zero_point};
+  TfLiteAffineQuantization input_quant = {FloatArrayFromFloats(input_scales),
+                                          IntArrayFromInts(input_zero_points),
+                                          0};
+  input_tensor.quantization = {kTfLiteAffineQuantization, &input_quant};
+
+  float output_scales[] = {1, output_scale};
+  int output_zero_points[] = {1, output_zero_point};
+  TfLiteAffineQuantization output_quant = {FloatArrayFromFloats(output_scales),
+                                           IntArrayFromInts(output_zero_points),
+                                           0};
+  output_tensor.quantization = {kTfLiteAffineQuantization, &output_quant};
+
+  constexpr int tensors_size = 4;
+  TfLiteTensor tensors[tensors_size] = {
+      input_tensor,
+      filter_tensor,
+      bias_tensor,
+      output_tensor,
+  };
+  int inputs_array_data[] = {3, 0, 1, 2};
+  TfLiteIntArray* inputs_array = IntArrayFromInts(inputs_array_data);
+  int outputs_array_data[] = {1, 3};
+  TfLiteIntArray* outputs_array = IntArrayFromInts(outputs_array_data);
+
+  TfLiteDepthwiseConvParams conv_params;
+  conv_params.padding = padding;
+  conv_params.stride_width = stride;
+  conv_params.stride_height = stride;
+  conv_params.depth_multiplier = depth_multiplier;
+  conv_params.activation = kTfLiteActNone;
+  conv_params.dilation_width_factor = 1;
+  conv_params.dilation_height_factor = 1;
+
+  const TfLiteRegistration registration = Register_DEPTHWISE_CONV_2D();
+  for (int split = 0; split < 2; ++split) {
+    tensors[kOutputTensorIndex].data.int8 =
+        split == 1 ? split_output : single_core_output;
+    micro::KernelRunner runner(
+        registration, tensors, tensors_size, inputs_array, outputs_array,
+        reinterpret_cast<void*>(&conv_params), micro_test::reporter);
+    PipelineSetKernelSplit(split == 1);
+    TF_LITE_MICRO_EXPECT_EQ(
+        kTfLiteOk,
+        runner.InitAndPrepare(reinterpret_cast<const char*>(&conv_params)));
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, runner.Invoke());
+    PipelineSetKernelSplit(false);
+  }
+
+  for (int i = 0; i < output_elements; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(single_core_output[i], split_output[i]);
+  }
+}
 #endif  // !defined(XTENSA)
 
 }  // namespace
@@ -1013,4 +1152,21 @@ TF_LITE_MICRO_TEST(Int8Input32x4Filter32x4ShouldMatchGolden) {
       kTensorsSize, tensors);
 }
 
+#if !defined(XTENSA)
+TF_LITE_MICRO_TEST(SplitAcrossCoresMatchesSingleCore) {
+  using tflite::testing::TestSplitMatchesSingleCore;
+  // 3x3 with depth multiplier 1, which goes through arm_depthwise_conv_3x3_s8.
+  TestSplitMatchesSingleCore(2, 5, 8, 1, 3, kTfLitePaddingSame, 1);
+  TestSplitMatchesSingleCore(9, 7, 8, 1, 3, kTfLitePaddingSame, 1);
+  TestSplitMatchesSingleCore(11, 6, 4, 1, 3, kTfLitePaddingSame, 2);
+  TestSplitMatchesSingleCore(12, 5, 4, 1, 3, kTfLitePaddingValid, 1);
+  // Other filter sizes, including padding wider than the first half.
+  TestSplitMatchesSingleCore(2, 4, 4, 1, 5, kTfLitePaddingSame, 1);
+  TestSplitMatchesSingleCore(10, 10, 6, 1, 5, kTfLitePaddingSame, 2);
+  // Depth multipliers other than 1 use arm_depthwise_conv_s8.
+  TestSplitMatchesSingleCore(8, 6, 3, 2, 3, kTfLitePaddingSame, 1);
+  TestSplitMatchesSingleCore(13, 9, 2, 4, 3, kTfLitePaddingValid, 3);
+}
+#endif  // !defined(XTENSA)
+
 TF_LITE_MICRO_TESTS_END
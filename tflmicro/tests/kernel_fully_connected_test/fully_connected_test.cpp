@@ -322,6 +322,16 @@ TfLiteStatus TestFullyConnectedQuantized(
   Quantize(golden, golden_quantized, output_dims_count, output_scale,
            output_zero_point);
 
+  TfLiteStatus status = ValidateFullyConnectedGoldens(
+      tensors, tensors_size, activation, 0.0f, output_dims_count,
+      golden_quantized, output_data);
+  if (status != kTfLiteOk) {
+    return status;
+  }
+
+  // Constant weights let kernels do work ahead of time in Prepare.
+  tensors[1].allocation_type = kTfLiteMmapRo;
+  tensors[2].allocation_type = kTfLiteMmapRo;
   return ValidateFullyConnectedGoldens(tensors, tensors_size, activation, 0.0f,
                                        output_dims_count, golden_quantized,
                                        output_data);
@@ -16,13 +16,16 @@ limitations under the License.
 #include "tensorflow/lite/micro/micro_interpreter.h"
 
 #include <cstdint>
+#include <cstring>
 
 #include "tensorflow/lite/core/api/flatbuffer_conversions.h"
 #include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/benchmarks/keyword_scrambled_model_data.h"
 #include "tensorflow/lite/micro/micro_utils.h"
 #include "tensorflow/lite/micro/recording_micro_allocator.h"
 #include "tensorflow/lite/micro/test_helpers.h"
 #include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_conv_model.h"
 
 namespace tflite {
 namespace {
@@ -60,6 +63,23 @@ class MockProfiler : public tflite::Profiler {
   TF_LITE_REMOVE_VIRTUAL_DELETE
 };
 
+void FillInput(TfLiteTensor* tensor, uint32_t seed) {
+  for (size_t i = 0; i < tensor->bytes; ++i) {
+    seed = seed * 1103515245 + 12345;
+    if (tensor->type == kTfLiteFloat32) {
+      tensor->data.f[i / sizeof(float)] =
+          static_cast<float>((seed >> 16) & 0xFF) / 128.0f - 1;
+    } else {
+      tensor->data.uint8[i] = seed >> 16;
+    }
+  }
+}
+
+bool OutputMatches(TfLiteTensor* expected, TfLiteTensor* actual) {
+  return expected->bytes == actual->bytes &&
+         memcmp(expected->data.raw, actual->data.raw, expected->bytes) == 0;
+}
+
 }  // namespace
 }  // namespace tflite
 
@@ -211,6 +231,58 @@ TF_LITE_MICRO_TEST(TestMultiTenantInterpreter) {
       allocator->GetSimpleMemoryAllocator()->GetHeadUsedBytes());
 }
 
+TF_LITE_MICRO_TEST(TestMultiTenantAlternatingInvoke) {
+  // The conv model has the larger head, the keyword model the larger tail and
+  // variable tensors that carry over from one Invoke() to the next.
+  const tflite::Model* conv_model = tflite::GetModel(kTestConvModelData);
+  const tflite::Model* keyword_model =
+      tflite::GetModel(g_keyword_scrambled_model_data);
+  tflite::AllOpsResolver op_resolver;
+  constexpr size_t arena_size = 48 * 1024;
+  alignas(16) static uint8_t conv_arena[arena_size];
+  alignas(16) static uint8_t keyword_arena[arena_size];
+  alignas(16) static uint8_t shared_arena[arena_size];
+
+  tflite::MicroInterpreter conv(conv_model, op_resolver, conv_arena,
+                                arena_size, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, conv.AllocateTensors());
+  tflite::MicroInterpreter keyword(keyword_model, op_resolver, keyword_arena,
+                                   arena_size, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, keyword.AllocateTensors());
+
+  tflite::MicroAllocator* allocator = tflite::MicroAllocator::Create(
+      shared_arena, arena_size, micro_test::reporter);
+  tflite::MicroInterpreter shared_conv(conv_model, op_resolver, allocator,
+                                       micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, shared_conv.AllocateTensors());
+  tflite::MicroInterpreter shared_keyword(keyword_model, op_resolver,
+                                          allocator, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, shared_keyword.AllocateTensors());
+
+  // Only the larger of the two heads is needed.
+  TF_LITE_MICRO_EXPECT_LT(shared_keyword.arena_used_bytes(),
+                          conv.arena_used_bytes() +
+                              keyword.arena_used_bytes());
+
+  // Each model's turn overwrites the other's tensors in the head, but not its
+  // results for the inputs it is given.
+  for (uint32_t seed = 0; seed < 4; ++seed) {
+    tflite::FillInput(conv.input(0), seed);
+    tflite::FillInput(shared_conv.input(0), seed);
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, conv.Invoke());
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, shared_conv.Invoke());
+    TF_LITE_MICRO_EXPECT(
+        tflite::OutputMatches(conv.output(0), shared_conv.output(0)));
+
+    tflite::FillInput(keyword.input(0), seed);
+    tflite::FillInput(shared_keyword.input(0), seed);
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, keyword.Invoke());
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, shared_keyword.Invoke());
+    TF_LITE_MICRO_EXPECT(
+        tflite::OutputMatches(keyword.output(0), shared_keyword.output(0)));
+  }
+}
+
 TF_LITE_MICRO_TEST(TestKernelMemoryPlanning) {
   const tflite::Model* model = tflite::testing::GetSimpleStatefulModel();
   TF_LITE_MICRO_EXPECT_NE(nullptr, model);
@@ -371,13 +443,8 @@ TF_LITE_MICRO_TEST(InterpreterWithProfilerShouldProfileOps) {
   TF_LITE_MICRO_EXPECT_EQ(profiler.event_ends(), 0);
   TF_LITE_MICRO_EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
   TF_LITE_MICRO_EXPECT_EQ(interpreter.Invoke(), kTfLiteOk);
-#ifndef NDEBUG
   TF_LITE_MICRO_EXPECT_EQ(profiler.event_starts(), 3);
   TF_LITE_MICRO_EXPECT_EQ(profiler.event_ends(), 3);
-#else  // Profile events will not occur on release builds.
-  TF_LITE_MICRO_EXPECT_EQ(profiler.event_starts(), 0);
-  TF_LITE_MICRO_EXPECT_EQ(profiler.event_ends(), 0);
-#endif
 }
 
 TF_LITE_MICRO_TEST(TestIncompleteInitializationAllocationsWithSmallArena) {
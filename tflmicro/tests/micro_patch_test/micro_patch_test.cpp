@@ -0,0 +1,149 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_conv_model.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+constexpr size_t kArenaSize = 64 * 1024;
+alignas(16) uint8_t reference_arena[kArenaSize];
+alignas(16) uint8_t patched_arena[kArenaSize];
+
+// The conv model runs Quantize, two 3x3 convolutions and a 2x2 max pool
+// before its Reshape.
+constexpr int kConvModelPatchLayers = 4;
+
+void FillInput(TfLiteTensor* tensor, uint32_t seed) {
+  for (size_t i = 0; i < tensor->bytes / sizeof(float); ++i) {
+    seed = seed * 1103515245 + 12345;
+    tensor->data.f[i] = static_cast<float>((seed >> 16) & 0xFF) / 128.0f - 1;
+  }
+}
+
+bool OutputsMatch(tflite::MicroInterpreter* expected,
+                  tflite::MicroInterpreter* actual) {
+  for (size_t i = 0; i < expected->outputs_size(); ++i) {
+    TfLiteTensor* a = expected->output(i);
+    TfLiteTensor* b = actual->output(i);
+    if (a->bytes != b->bytes || memcmp(a->data.raw, b->data.raw, a->bytes)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Runs the conv model with its first `layer_count` nodes in patches, and
+// checks that the outputs are those of a plain Invoke() for a few inputs.
+void TestMatchesInvoke(int layer_count, int patch_height, int patch_width) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  tflite::AllOpsResolver op_resolver;
+
+  tflite::MicroInterpreter reference(model, op_resolver, reference_arena,
+                                     kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, reference.AllocateTensors());
+
+  tflite::MicroInterpreter patched(model, op_resolver, patched_arena,
+                                   kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk,
+      patched.SetPatchPlan(layer_count, patch_height, patch_width));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, patched.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_EQ(layer_count, patched.patch_layer_count());
+
+  for (uint32_t seed = 0; seed < 3; ++seed) {
+    FillInput(reference.input(0), seed);
+    FillInput(patched.input(0), seed);
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, reference.Invoke());
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, patched.Invoke());
+    TF_LITE_MICRO_EXPECT(OutputsMatch(&reference, &patched));
+  }
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestConvModelEveryLayerCount) {
+  // Single pixels, patches that don't divide the output, whole rows, which
+  // are used in place, and one patch for the whole output.
+  const int patch_sizes[][2] = {{1, 1}, {2, 3}, {3, 5}, {4, 16}, {16, 16}};
+  for (int layer_count = 1; layer_count <= kConvModelPatchLayers;
+       ++layer_count) {
+    for (const auto& size : patch_sizes) {
+      TestMatchesInvoke(layer_count, size[0], size[1]);
+    }
+  }
+}
+
+TF_LITE_MICRO_TEST(TestPatchesShrinkTheArena) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  tflite::AllOpsResolver op_resolver;
+
+  tflite::MicroInterpreter reference(model, op_resolver, reference_arena,
+                                     kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, reference.AllocateTensors());
+
+  tflite::MicroInterpreter patched(model, op_resolver, patched_arena,
+                                   kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, patched.SetPatchPlan(kConvModelPatchLayers, 2, 6));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, patched.AllocateTensors());
+
+  // The plain plan holds both convolution outputs at once, 3136 and 4608
+  // bytes, the patches no more than 1536 bytes of either.
+  TF_LITE_MICRO_EXPECT_LE(patched.arena_used_bytes() + 2048,
+                          reference.arena_used_bytes());
+}
+
+TF_LITE_MICRO_TEST(TestInvalidPatchPlan) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  tflite::AllOpsResolver op_resolver;
+
+  tflite::MicroInterpreter interpreter(model, op_resolver, patched_arena,
+                                       kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.SetPatchPlan(0, 1, 1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.SetPatchPlan(2, 0, 1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.SetPatchPlan(2, 1, 0));
+  // The Reshape can't be run in patches.
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError,
+      interpreter.SetPatchPlan(kConvModelPatchLayers + 1, 1, 1));
+  TF_LITE_MICRO_EXPECT_EQ(0, interpreter.patch_layer_count());
+
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.SetPatchPlan(2, 1, 1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.SetPipelinePartition(3));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.SetPatchPlan(2, 1, 1));
+}
+
+TF_LITE_MICRO_TEST(TestPipelinedModelCantBePatched) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  tflite::AllOpsResolver op_resolver;
+
+  tflite::MicroInterpreter interpreter(model, op_resolver, patched_arena,
+                                       kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.SetPipelinePartition(3));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.SetPatchPlan(2, 1, 1));
+}
+
+TF_LITE_MICRO_TESTS_END
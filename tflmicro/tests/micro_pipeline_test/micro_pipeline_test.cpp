@@ -0,0 +1,219 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+#include "tensorflow/lite/micro/testing/test_conv_model.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace {
+
+constexpr size_t kArenaSize = 64 * 1024;
+alignas(16) uint8_t reference_arena[kArenaSize];
+alignas(16) uint8_t pipelined_arena[kArenaSize];
+
+constexpr int kFrames = 6;
+
+void FillInput(TfLiteTensor* tensor, uint32_t seed) {
+  if (tensor->type == kTfLiteFloat32) {
+    for (size_t i = 0; i < tensor->bytes / sizeof(float); ++i) {
+      seed = seed * 1103515245 + 12345;
+      tensor->data.f[i] = static_cast<float>((seed >> 16) & 0xFF) / 128.0f - 1;
+    }
+  } else if (tensor->type == kTfLiteInt32) {
+    for (size_t i = 0; i < tensor->bytes / sizeof(int32_t); ++i) {
+      seed = seed * 1103515245 + 12345;
+      tensor->data.i32[i] = (seed >> 16) & 0xFF;
+    }
+  } else {
+    for (size_t i = 0; i < tensor->bytes; ++i) {
+      seed = seed * 1103515245 + 12345;
+      tensor->data.uint8[i] = seed >> 16;
+    }
+  }
+}
+
+bool OutputsMatch(tflite::MicroInterpreter* expected,
+                  tflite::MicroInterpreter* actual) {
+  for (size_t i = 0; i < expected->outputs_size(); ++i) {
+    TfLiteTensor* a = expected->output(i);
+    TfLiteTensor* b = actual->output(i);
+    if (a->bytes != b->bytes || memcmp(a->data.raw, b->data.raw, a->bytes)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Feeds kFrames inputs through a pipelined interpreter and checks that every
+// output matches what a single-core Invoke() gives for the same input.
+void TestMatchesInvoke(const tflite::Model* model,
+                       const tflite::MicroOpResolver& op_resolver,
+                       int partition) {
+  tflite::MicroInterpreter reference(model, op_resolver, reference_arena,
+                                     kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, reference.AllocateTensors());
+
+  tflite::MicroInterpreter pipelined(model, op_resolver, pipelined_arena,
+                                     kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, pipelined.SetPipelinePartition(partition));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, pipelined.AllocateTensors());
+
+  for (int frame = 0; frame <= kFrames; ++frame) {
+    if (frame > 0) {
+      // The results of the previous frame.
+      FillInput(reference.input(0), frame - 1);
+      TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, reference.Invoke());
+    }
+    if (frame < kFrames) {
+      FillInput(pipelined.input(0), frame);
+      TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, pipelined.InvokePipelined());
+    } else {
+      TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, pipelined.FlushPipeline());
+    }
+    TF_LITE_MICRO_EXPECT_EQ(static_cast<uint32_t>(frame),
+                            pipelined.pipeline_frames_completed());
+    if (frame > 0) {
+      TF_LITE_MICRO_EXPECT(OutputsMatch(&reference, &pipelined));
+    }
+  }
+
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<uint32_t>(kFrames),
+                          pipelined.pipeline_stage_stats(0).runs);
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<uint32_t>(kFrames),
+                          pipelined.pipeline_stage_stats(1).runs);
+  TF_LITE_MICRO_EXPECT_LE(pipelined.pipeline_stage_stats(1).last_ticks,
+                          pipelined.pipeline_stage_stats(1).max_ticks);
+
+  // With nothing in flight the interpreter can still run single-core.
+  FillInput(reference.input(0), 100);
+  FillInput(pipelined.input(0), 100);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, reference.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, pipelined.Invoke());
+  TF_LITE_MICRO_EXPECT(OutputsMatch(&reference, &pipelined));
+}
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestComplexMockModelEveryPartition) {
+  const tflite::Model* model = tflite::testing::GetComplexMockModel();
+  tflite::AllOpsResolver op_resolver = tflite::testing::GetOpResolver();
+  const int operators_size = (*model->subgraphs())[0]->operators()->size();
+  for (int partition = 1; partition < operators_size; ++partition) {
+    TestMatchesInvoke(model, op_resolver, partition);
+  }
+}
+
+TF_LITE_MICRO_TEST(TestConvModelEveryPartition) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  tflite::AllOpsResolver op_resolver;
+  const int operators_size = (*model->subgraphs())[0]->operators()->size();
+  TF_LITE_MICRO_EXPECT_GT(operators_size, 1);
+  for (int partition = 1; partition < operators_size; ++partition) {
+    TestMatchesInvoke(model, op_resolver, partition);
+  }
+}
+
+TF_LITE_MICRO_TEST(TestBoundaryTensorsAreDoubleBuffered) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  tflite::AllOpsResolver op_resolver;
+
+  tflite::MicroInterpreter interpreter(model, op_resolver, pipelined_arena,
+                                       kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.SetPipelinePartition(1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+
+  // Each frame's output lands in the other copy, so the one handed back is
+  // never written by the frame in flight.
+  TfLiteTensor* output = interpreter.output(0);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.InvokePipelined());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.InvokePipelined());
+  void* first = output->data.data;
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.FlushPipeline());
+  void* second = output->data.data;
+  TF_LITE_MICRO_EXPECT(first != second);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.InvokePipelined());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.FlushPipeline());
+  TF_LITE_MICRO_EXPECT(first == output->data.data);
+}
+
+TF_LITE_MICRO_TEST(TestInvokeWhileInFlightFails) {
+  const tflite::Model* model = tflite::testing::GetComplexMockModel();
+  tflite::AllOpsResolver op_resolver = tflite::testing::GetOpResolver();
+
+  tflite::MicroInterpreter interpreter(model, op_resolver, pipelined_arena,
+                                       kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.SetPipelinePartition(2));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.InvokePipelined());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.FlushPipeline());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+}
+
+TF_LITE_MICRO_TEST(TestSharedHeadIsHeldWhileInFlight) {
+  const tflite::Model* model = tflite::GetModel(kTestConvModelData);
+  tflite::AllOpsResolver op_resolver;
+
+  tflite::MicroInterpreter reference(model, op_resolver, reference_arena,
+                                     kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, reference.AllocateTensors());
+
+  // A pipelined model and a plain one taking turns on one arena.
+  tflite::MicroAllocator* allocator = tflite::MicroAllocator::Create(
+      pipelined_arena, kArenaSize, micro_test::reporter);
+  tflite::MicroInterpreter pipelined(model, op_resolver, allocator,
+                                     micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, pipelined.SetPipelinePartition(2));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, pipelined.AllocateTensors());
+  tflite::MicroInterpreter other(model, op_resolver, allocator,
+                                 micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, other.AllocateTensors());
+
+  FillInput(pipelined.input(0), 1);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, pipelined.InvokePipelined());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, other.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, pipelined.FlushPipeline());
+  FillInput(reference.input(0), 1);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, reference.Invoke());
+  TF_LITE_MICRO_EXPECT(OutputsMatch(&reference, &pipelined));
+
+  FillInput(other.input(0), 2);
+  FillInput(reference.input(0), 2);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, other.Invoke());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, reference.Invoke());
+  TF_LITE_MICRO_EXPECT(OutputsMatch(&reference, &other));
+}
+
+TF_LITE_MICRO_TEST(TestInvalidPartition) {
+  const tflite::Model* model = tflite::testing::GetComplexMockModel();
+  tflite::AllOpsResolver op_resolver = tflite::testing::GetOpResolver();
+
+  tflite::MicroInterpreter interpreter(model, op_resolver, pipelined_arena,
+                                       kArenaSize, micro_test::reporter);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.SetPipelinePartition(0));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.SetPipelinePartition(3));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.InvokePipelined());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError, interpreter.SetPipelinePartition(1));
+}
+
+TF_LITE_MICRO_TESTS_END
@@ -0,0 +1,212 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_stats_profiler.h"
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/test_helpers.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+namespace {
+
+constexpr int kMaxNodes = 4;
+constexpr int kHistory = 100;
+
+tflite::MicroStatsProfiler::Record records[kMaxNodes];
+int32_t history[kMaxNodes * kHistory];
+
+using EventType = tflite::Profiler::EventType;
+
+void AddOperatorEvent(tflite::MicroStatsProfiler* profiler, const char* tag,
+                      int node, int32_t ticks) {
+  profiler->AddEvent(tag, EventType::OPERATOR_INVOKE_EVENT, 1000,
+                     1000 + ticks, node, 0);
+}
+
+void AddArenaEvent(tflite::MicroStatsProfiler* profiler, int node,
+                   uint32_t bytes) {
+  profiler->AddEvent("arena", EventType::GENERAL_RUNTIME_INSTRUMENTATION_EVENT,
+                     0, 0, bytes, node);
+}
+
+uint32_t Read32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// Counts the lines passed through it, and keeps the last one.
+class CapturingErrorReporter : public tflite::ErrorReporter {
+ public:
+  int Report(const char* format, va_list args) override {
+    vsnprintf(last_line, sizeof(last_line), format, args);
+    ++lines;
+    return 0;
+  }
+
+  char last_line[128];
+  int lines = 0;
+};
+
+}  // namespace
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestStatsAcrossInvocations) {
+  tflite::MicroStatsProfiler profiler(records, history, kMaxNodes, kHistory);
+  TF_LITE_MICRO_EXPECT_EQ(0, profiler.nodes());
+
+  // Ticks 1..100 in a scrambled order.
+  for (int i = 0; i < 100; ++i) {
+    AddOperatorEvent(&profiler, "CONV_2D", 1, (i * 37) % 100 + 1);
+  }
+  tflite::MicroOperatorStats stats;
+  TF_LITE_MICRO_EXPECT(!profiler.GetStats(0, &stats));
+  TF_LITE_MICRO_EXPECT(profiler.GetStats(1, &stats));
+  TF_LITE_MICRO_EXPECT_EQ(2, profiler.nodes());
+  TF_LITE_MICRO_EXPECT_EQ(0, strcmp("CONV_2D", stats.tag));
+  TF_LITE_MICRO_EXPECT_EQ(100u, stats.invocations);
+  TF_LITE_MICRO_EXPECT_EQ(1, stats.min_ticks);
+  TF_LITE_MICRO_EXPECT_EQ(50, stats.mean_ticks);
+  TF_LITE_MICRO_EXPECT_EQ(100, stats.max_ticks);
+  TF_LITE_MICRO_EXPECT_EQ(99, stats.p99_ticks);
+}
+
+TF_LITE_MICRO_TEST(TestP99CoversRecentHistory) {
+  tflite::MicroStatsProfiler profiler(records, history, kMaxNodes, kHistory);
+  // An early slow invocation stays in min/max/mean but leaves the history.
+  AddOperatorEvent(&profiler, "SOFTMAX", 0, 5000);
+  for (int i = 0; i < kHistory; ++i) {
+    AddOperatorEvent(&profiler, "SOFTMAX", 0, i < 2 ? 300 : 10);
+  }
+  tflite::MicroOperatorStats stats;
+  TF_LITE_MICRO_EXPECT(profiler.GetStats(0, &stats));
+  TF_LITE_MICRO_EXPECT_EQ(static_cast<uint32_t>(kHistory + 1),
+                          stats.invocations);
+  TF_LITE_MICRO_EXPECT_EQ(5000, stats.max_ticks);
+  TF_LITE_MICRO_EXPECT_EQ(10, stats.min_ticks);
+  TF_LITE_MICRO_EXPECT_EQ(300, stats.p99_ticks);
+
+  AddOperatorEvent(&profiler, "SOFTMAX", 0, 10);
+  AddOperatorEvent(&profiler, "SOFTMAX", 0, 10);
+  TF_LITE_MICRO_EXPECT(profiler.GetStats(0, &stats));
+  TF_LITE_MICRO_EXPECT_EQ(10, stats.p99_ticks);
+
+  profiler.Reset();
+  TF_LITE_MICRO_EXPECT(!profiler.GetStats(0, &stats));
+  TF_LITE_MICRO_EXPECT_EQ(0, profiler.nodes());
+}
+
+TF_LITE_MICRO_TEST(TestArenaHighWaterAndIgnoredEvents) {
+  tflite::MicroStatsProfiler profiler(records, history, kMaxNodes, kHistory);
+  AddOperatorEvent(&profiler, "ADD", 0, 1);
+  AddArenaEvent(&profiler, 0, 700);
+  AddArenaEvent(&profiler, 0, 600);
+  AddArenaEvent(&profiler, 1, 900);
+  AddOperatorEvent(&profiler, "ADD", kMaxNodes, 1);
+  AddArenaEvent(&profiler, kMaxNodes, 1200);
+
+  tflite::MicroOperatorStats stats;
+  TF_LITE_MICRO_EXPECT(profiler.GetStats(0, &stats));
+  TF_LITE_MICRO_EXPECT_EQ(700u, stats.arena_high_water_bytes);
+  TF_LITE_MICRO_EXPECT_EQ(1200u, profiler.arena_high_water_bytes());
+  TF_LITE_MICRO_EXPECT_EQ(1, profiler.nodes());
+
+  // Events other than operator invocations are timed but not recorded.
+  uint32_t handle = profiler.BeginEvent("setup", EventType::DEFAULT, 0, 0);
+  uint32_t inner =
+      profiler.BeginEvent("ADD", EventType::OPERATOR_INVOKE_EVENT, 2, 0);
+  profiler.EndEvent(inner);
+  profiler.EndEvent(handle);
+  TF_LITE_MICRO_EXPECT_EQ(3, profiler.nodes());
+  TF_LITE_MICRO_EXPECT(!profiler.GetStats(1, &stats));
+  TF_LITE_MICRO_EXPECT(profiler.GetStats(2, &stats));
+  TF_LITE_MICRO_EXPECT_EQ(1u, stats.invocations);
+}
+
+TF_LITE_MICRO_TEST(TestBinaryAndCsvDump) {
+  tflite::MicroStatsProfiler profiler(records, history, kMaxNodes, kHistory);
+  AddOperatorEvent(&profiler, "CONV_2D", 0, 40);
+  AddOperatorEvent(&profiler, "CONV_2D", 0, 60);
+  AddArenaEvent(&profiler, 0, 4096);
+  AddOperatorEvent(&profiler, "RESHAPE", 2, 3);
+
+  uint8_t buffer[128];
+  TF_LITE_MICRO_EXPECT_EQ(0u, profiler.SerializeBinary(buffer, 20));
+  const size_t size = profiler.SerializeBinary(buffer, sizeof(buffer));
+  TF_LITE_MICRO_EXPECT_EQ(12u + 27u + 7u + 27u + 7u, size);
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp("TFPS", buffer, 4));
+  TF_LITE_MICRO_EXPECT_EQ(1, buffer[4]);
+  TF_LITE_MICRO_EXPECT_EQ(2, buffer[6] | (buffer[7] << 8));
+  TF_LITE_MICRO_EXPECT_EQ(4096u, Read32(buffer + 8));
+
+  const uint8_t* node = buffer + 12;
+  TF_LITE_MICRO_EXPECT_EQ(0, node[0] | (node[1] << 8));
+  TF_LITE_MICRO_EXPECT_EQ(2u, Read32(node + 2));
+  TF_LITE_MICRO_EXPECT_EQ(40u, Read32(node + 6));
+  TF_LITE_MICRO_EXPECT_EQ(50u, Read32(node + 10));
+  TF_LITE_MICRO_EXPECT_EQ(60u, Read32(node + 14));
+  TF_LITE_MICRO_EXPECT_EQ(60u, Read32(node + 18));
+  TF_LITE_MICRO_EXPECT_EQ(4096u, Read32(node + 22));
+  TF_LITE_MICRO_EXPECT_EQ(7, node[26]);
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp("CONV_2D", node + 27, 7));
+  node += 27 + 7;
+  TF_LITE_MICRO_EXPECT_EQ(2, node[0] | (node[1] << 8));
+  TF_LITE_MICRO_EXPECT_EQ(0, memcmp("RESHAPE", node + 27, 7));
+
+  CapturingErrorReporter reporter;
+  profiler.LogCsv(&reporter);
+  TF_LITE_MICRO_EXPECT_EQ(3, reporter.lines);
+  TF_LITE_MICRO_EXPECT_EQ(0,
+                          strcmp("2,RESHAPE,1,3,3,3,3,0", reporter.last_line));
+}
+
+TF_LITE_MICRO_TEST(TestInterpreterRecordsEveryNode) {
+  const tflite::Model* model = tflite::testing::GetComplexMockModel();
+  tflite::AllOpsResolver op_resolver = tflite::testing::GetOpResolver();
+  tflite::MicroStatsProfiler profiler(records, history, kMaxNodes, kHistory);
+
+  constexpr size_t arena_size = 2048;
+  alignas(16) uint8_t arena[arena_size];
+  tflite::MicroInterpreter interpreter(model, op_resolver, arena, arena_size,
+                                       micro_test::reporter, &profiler);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.AllocateTensors());
+  constexpr int kInvocations = 5;
+  for (int i = 0; i < kInvocations; ++i) {
+    TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk, interpreter.Invoke());
+  }
+
+  TF_LITE_MICRO_EXPECT_EQ(3, profiler.nodes());
+  for (int node = 0; node < profiler.nodes(); ++node) {
+    tflite::MicroOperatorStats stats;
+    TF_LITE_MICRO_EXPECT(profiler.GetStats(node, &stats));
+    TF_LITE_MICRO_EXPECT_EQ(static_cast<uint32_t>(kInvocations),
+                            stats.invocations);
+    TF_LITE_MICRO_EXPECT_LE(stats.min_ticks, stats.mean_ticks);
+    TF_LITE_MICRO_EXPECT_LE(stats.mean_ticks, stats.max_ticks);
+    TF_LITE_MICRO_EXPECT_LE(stats.p99_ticks, stats.max_ticks);
+    TF_LITE_MICRO_EXPECT_GE(stats.arena_high_water_bytes,
+                            interpreter.arena_used_bytes());
+  }
+  TF_LITE_MICRO_EXPECT_GE(profiler.arena_high_water_bytes(),
+                          interpreter.arena_used_bytes());
+}
+
+TF_LITE_MICRO_TESTS_END